@@ -1,8 +1,11 @@
 /*
   Receiver_ESP32.ino
   - Connects to router STA using provided credentials
-  - Polls Sender at http://192.168.1.50/api/devices every 3 seconds
-  - Displays up to 4 active devices on I2C 20x4 LCD (LiquidCrystal_I2C)
+  - Polls Sender at http://192.168.1.50/api/devices?active=1&... every 3 seconds from a
+    FreeRTOS task on core 0; loop() only pages/renders the latest published snapshot
+  - Caches up to 32 active devices and pages through them 4 at a time on I2C 20x4 LCD
+    (LiquidCrystal_I2C); alarm devices get their own pages first
+  - LCD updates go through a shadow buffer (common/lcd_shadow.h): only changed cells are sent
 
   🧠 ESP32 Receiver Wiring (I²C LCD 20×4)
 LCD Pin	Connect to ESP32 Pin	Notes
@@ -14,9 +17,17 @@ SCL	GPIO 22 (D22)	I²C clock line
 
 #include <WiFi.h>
 #include <HTTPClient.h>
-#include <ArduinoJson.h>
 #include <LiquidCrystal_I2C.h>
 #include <Wire.h>
+#include <atomic>
+#include "common/lcd_shadow.h"
+#include "common/device_stream.h"
+#include "common/latency_hist.h"
+#include "common/alarm_rules.h"   // AlarmFlag bits in /api/devices
+
+#define LOG_LEVEL LOG_LEVEL_INFO   // per-poll lines are LOG_LEVEL_DEBUG
+#define LOG_LINE_MAX 160
+#include "common/log_ring.h"
 
 // ----- USER CONFIG -----
 const char* STA_SSID = "Airtel_7737476759";
@@ -25,6 +36,24 @@ const char* STA_PASS = "air49169";
 const char* SENDER_HOST = "192.168.1.50"; // Sender STA IP
 const uint16_t SENDER_HTTP_PORT = 80;
 const unsigned long POLL_INTERVAL_MS = 3000UL; // 3 seconds
+const unsigned long ACTIVE_THRESHOLD_SEC = 15; // treat devices seen within last 15s as active (sender's own threshold)
+const unsigned long PAGE_DELAY_MS = 3000UL;    // page rotation, independent of polling
+
+// Network task (runs on its own core; the render loop never waits on it)
+const BaseType_t NET_TASK_CORE = 0;            // Arduino loop() runs on core 1
+const uint32_t NET_TASK_STACK = 8192;
+const bool HTTP_REUSE = true;                  // keep the TCP connection between polls
+const uint16_t HTTP_TIMEOUT_MS = 2000;         // per-read timeout
+const int32_t HTTP_CONNECT_TIMEOUT_MS = 1500;
+const uint16_t HTTP_DRAIN_MAX = 1024;          // unparsed body read off to keep the connection; more and it is closed
+const unsigned long WIFI_RETRY_MS = 5000;      // WiFi.begin() again after this long without a link
+const unsigned long BENCH_LOG_INTERVAL_MS = 10000; // one-line JSON sensor-to-display latency on Serial; 0 disables
+
+// Paging / ordering of the cached active set
+enum SortMode { SORT_SENDER_ORDER, SORT_LOWEST_FIRST, SORT_STALEST_FIRST };
+const SortMode SORT_MODE = SORT_LOWEST_FIRST;
+const bool ALARM_PAGE = true;        // show devices in alarm (sender's rules) or anomaly first, on their own page
+const float TREND_MARK_PPH = 2.0f;    // show '+'/'-' next to the percent beyond this rate
 
 // I2C LCD settings
 const uint8_t LCD_ADDR = 0x27; // change to 0x3F if needed
@@ -33,208 +62,431 @@ const uint8_t LCD_ROWS = 4;
 // ------------------------
 
 LiquidCrystal_I2C lcd(LCD_ADDR, LCD_COLS, LCD_ROWS);
+LcdShadow<LiquidCrystal_I2C> screen(lcd); // all drawing goes through here; only changed cells hit I2C
 
-unsigned long lastPoll = 0;
-bool wifiWasConnected = false;
+unsigned long lastPageMs = 0;
 
 // a small struct for display info
 struct DisplayItem {
-  String label;   // name or MAC truncated
-  float percent;  // -1 means unknown
+  char label[14];  // name or MAC truncated to 13 chars
+  float percent;   // -1 means unknown
+  float ratePph;   // fill (+) / drain (-) rate from the sender's trend, %/hour
+  uint8_t anomaly; // sender TrendFlag bits (1 leak, 2 stuck sensor)
+  uint8_t alarm;   // sender AlarmFlag bits (1 low, 2 high, 4 stale); thresholds live on the sender
+  long ageSec;     // age reported by the sender at poll time
+  uint32_t seq;    // sensor report sequence number
+  long sampleAgeMs; // reading age when the sender answered (-1 unknown)
 };
 
-#define MAX_DISPLAY 4
+#define MAX_DISPLAY 4   // rows per page
+#define MAX_CACHE 32    // active devices kept between polls
 
-// attempt WiFi connect (non-blocking-ish: tries for up to timeoutMillis)
-bool ensureWiFi(unsigned long timeoutMillis = 10000) {
-  if (WiFi.status() == WL_CONNECTED) return true;
-  Serial.printf("Connecting to WiFi '%s' ...\n", STA_SSID);
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(STA_SSID, STA_PASS);
-  unsigned long t0 = millis();
-  while (WiFi.status() != WL_CONNECTED && (millis() - t0) < timeoutMillis) {
-    delay(200);
-    Serial.print('.');
-  }
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.printf("\nWiFi connected, IP=%s\n", WiFi.localIP().toString().c_str());
+// Active set from the last successful poll; pages are drawn from here (render loop only)
+DisplayItem cache[MAX_CACHE];
+int cacheCount = 0;
+bool cacheValid = false;
+int alarmCount = 0;     // cache[0..alarmCount) are alarm entries when ALARM_PAGE
+int currentPage = 0;
+
+// sensor-to-display latency, one sample per newly displayed (device, seq)
+LatencyHist benchE2eMs;
+unsigned long benchWindowStart = 0;
+
+/* ---------------- net task -> render loop handoff ---------------- */
+// Result of one poll. The net task fills the buffer that is not published,
+// then flips `published`. Each buffer carries a generation counter (odd while
+// being written) so the reader can detect a write racing its copy and retry.
+enum PollStatus : uint8_t { POLL_OK, POLL_NO_WIFI, POLL_HTTP_ERR, POLL_BAD_JSON, POLL_JSON_ERR };
+
+struct Snapshot {
+  std::atomic<uint32_t> gen;
+  uint32_t seq;          // increments per published poll
+  PollStatus status;
+  int httpCode;
+  unsigned long rxMs;    // when the response headers arrived
+  uint32_t rttMs;        // request to response headers
+  int count;
+  DisplayItem items[MAX_CACHE];
+};
+
+Snapshot snaps[2];
+std::atomic<uint8_t> published(0);
+uint32_t lastConsumedSeq = 0;
+
+// net task only
+Snapshot& snapshotBeginWrite() {
+  Snapshot& s = snaps[1 - published.load(std::memory_order_relaxed)];
+  s.gen.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return s;
+}
+
+void snapshotPublish(Snapshot& s) {
+  static uint32_t seq = 0;
+  s.seq = ++seq;
+  s.gen.fetch_add(1, std::memory_order_release);
+  published.store((uint8_t)(&s - snaps), std::memory_order_release);
+}
+
+// render loop only: copy the latest snapshot if it is newer than the last one consumed
+bool snapshotTake(Snapshot& out) {
+  for (int attempt = 0; attempt < 4; ++attempt) {
+    const Snapshot& s = snaps[published.load(std::memory_order_acquire)];
+    uint32_t g1 = s.gen.load(std::memory_order_acquire);
+    if (g1 & 1) continue;
+    if (s.seq == lastConsumedSeq) return false;
+    out.seq = s.seq;
+    out.status = s.status;
+    out.httpCode = s.httpCode;
+    out.rxMs = s.rxMs;
+    out.rttMs = s.rttMs;
+    int n = s.count;
+    if (n < 0 || n > MAX_CACHE) continue; // torn read
+    out.count = n;
+    memcpy(out.items, s.items, sizeof(DisplayItem) * n);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s.gen.load(std::memory_order_relaxed) != g1) continue;
+    lastConsumedSeq = out.seq;
     return true;
   }
-  Serial.println("\nWiFi connect failed");
+  return false; // writer kept racing us; pick it up next loop
+}
+
+// keep the STA link up without blocking: (re)start the association and let it run in the background
+bool netKeepWiFi() {
+  static unsigned long lastBegin = 0;
+  static bool started = false;
+  if (WiFi.status() == WL_CONNECTED) return true;
+  if (!started || millis() - lastBegin >= WIFI_RETRY_MS) {
+    LOGI("Connecting to WiFi '%s' ...", STA_SSID);
+    if (!started) WiFi.mode(WIFI_STA);
+    WiFi.begin(STA_SSID, STA_PASS);
+    lastBegin = millis();
+    started = true;
+  }
   return false;
 }
 
+// Replace the whole screen with a short message (line2 optional)
+void showMessage(const char* line1, const char* line2 = "") {
+  screen.clear();
+  screen.printLine(0, line1);
+  screen.printLine(1, line2);
+  screen.flush();
+}
+
 // Render up to 4 items on the LCD
-void renderLCD(DisplayItem items[], int count) {
-  lcd.clear();
+void renderLCD(const DisplayItem items[], int count) {
+  screen.clear();
   if (count == 0) {
-    lcd.setCursor(0, 0);
-    lcd.print("No active devices");
+    screen.printLine(0, "No active devices");
+    screen.flush();
     return;
   }
-  for (int r = 0; r < LCD_ROWS; ++r) {
-    lcd.setCursor(0, r);
-    if (r < count) {
-      String left = items[r].label;
-      if (left.length() > 14) left = left.substring(0, 14); // leave space for percent
-      // percent string
-      String pct;
-      if (items[r].percent < 0) pct = "--.-%";
-      else {
-        char buf[8];
-        snprintf(buf, sizeof(buf), "%5.1f%%", items[r].percent);
-        pct = String(buf);
-      }
-      // print left, pad, then pct at right
-      lcd.print(left);
-      int pad = LCD_COLS - left.length() - pct.length();
-      if (pad < 1) pad = 1;
-      for (int i=0;i<pad;i++) lcd.print(' ');
-      lcd.print(pct);
-    } else {
-      // empty row
-      for (int c=0;c<LCD_COLS;c++) lcd.print(' ');
-    }
+  for (int r = 0; r < LCD_ROWS && r < count; ++r) {
+    // percent string
+    char pct[8];
+    if (items[r].percent < 0) strcpy(pct, "--.-%");
+    else snprintf(pct, sizeof(pct), "%5.1f%%", items[r].percent);
+    // mark: '?' stale, '!' alarm/anomaly, '+' filling, '-' draining
+    char mark[2] = " ";
+    if (items[r].alarm & ALARM_STALE) mark[0] = '?';
+    else if (items[r].alarm || items[r].anomaly) mark[0] = '!';
+    else if (items[r].ratePph > TREND_MARK_PPH) mark[0] = '+';
+    else if (items[r].ratePph < -TREND_MARK_PPH) mark[0] = '-';
+    // left label, mark + percent at right
+    screen.print(0, r, items[r].label);
+    screen.print(LCD_COLS - strlen(pct) - 1, r, mark);
+    screen.print(LCD_COLS - strlen(pct), r, pct);
   }
+  screen.flush();
 }
 
-// Poll the Sender /api/devices and build display list
-void httpPollAndDisplay() {
-  if (WiFi.status() != WL_CONNECTED) {
-    // try reconnect a bit quicker
-    ensureWiFi(5000);
-    if (WiFi.status() != WL_CONNECTED) {
-      // show disconnected
-      lcd.clear();
-      lcd.setCursor(0,0);
-      lcd.print("WiFi disconnected");
-      return;
-    }
+bool isAlarm(const DisplayItem& d) {
+  return d.alarm || d.anomaly;
+}
+
+// true if a should be shown before b
+bool displayBefore(const DisplayItem& a, const DisplayItem& b) {
+  if (ALARM_PAGE && isAlarm(a) != isAlarm(b)) return isAlarm(a);
+  switch (SORT_MODE) {
+    case SORT_LOWEST_FIRST:
+      if ((a.percent < 0) != (b.percent < 0)) return b.percent < 0; // unknown last
+      return a.percent < b.percent;
+    case SORT_STALEST_FIRST:
+      return a.ageSec > b.ageSec;
+    default:
+      return false;
   }
+}
 
-  String url = String("http://") + SENDER_HOST + "/api/devices";
-  WiFiClient client;
-  HTTPClient http;
-  http.begin(client, url);
-  int code = http.GET();
-  if (code != 200) {
-    Serial.printf("HTTP GET failed, code=%d\n", code);
-    http.end();
-    // optional: display message for short time
-    lcd.clear();
-    lcd.setCursor(0,0);
-    lcd.print("HTTP poll failed");
-    lcd.setCursor(0,1);
-    lcd.print("code: " + String(code));
-    return;
+// order the cache (stable insertion sort, at most MAX_CACHE items) and count alarms
+void sortCache() {
+  for (int i = 1; i < cacheCount; ++i) {
+    DisplayItem key = cache[i]; int j = i - 1;
+    while (j >= 0 && displayBefore(key, cache[j])) { cache[j+1] = cache[j]; --j; }
+    cache[j+1] = key;
   }
+  alarmCount = 0;
+  if (ALARM_PAGE) while (alarmCount < cacheCount && isAlarm(cache[alarmCount])) alarmCount++;
+}
 
-  String body = http.getString();
-  http.end();
+// Page layout: alarm entries first (their own pages), then everything else
+int pageCount() {
+  if (!ALARM_PAGE || alarmCount == 0) return (cacheCount + MAX_DISPLAY - 1) / MAX_DISPLAY;
+  int alarmPages = (alarmCount + MAX_DISPLAY - 1) / MAX_DISPLAY;
+  int restPages = (cacheCount - alarmCount + MAX_DISPLAY - 1) / MAX_DISPLAY;
+  return alarmPages + restPages;
+}
+
+void renderPage(int page) {
+  int start, end;
+  int alarmPages = (ALARM_PAGE && alarmCount) ? (alarmCount + MAX_DISPLAY - 1) / MAX_DISPLAY : 0;
+  if (page < alarmPages) {
+    start = page * MAX_DISPLAY;
+    end = min(start + MAX_DISPLAY, alarmCount);
+  } else {
+    start = alarmCount + (page - alarmPages) * MAX_DISPLAY;
+    end = min(start + MAX_DISPLAY, cacheCount);
+  }
+  if (start > cacheCount) start = end = cacheCount;
+  renderLCD(cache + start, end - start);
+}
 
-  // parse JSON: expected array result like [ {mac:, ip:, rssi:, name:, percent:, age_seconds:, totalHeightCm:, sensorToMaxCm: ...}, ... ]
-  // The sender sent a JSON array at top-level. We'll parse safely.
-  const size_t CAP = 16 * 1024; // adjust if many devices
-  StaticJsonDocument<CAP> doc;
-  DeserializationError err = deserializeJson(doc, body);
-  if (err) {
-    Serial.printf("JSON parse failed: %s\n", err.c_str());
-    lcd.clear();
-    lcd.setCursor(0,0);
-    lcd.print("JSON parse error");
+// advance to the next page on the page timer; never touches the network
+void pagerTick(unsigned long now) {
+  if (!cacheValid || now - lastPageMs < PAGE_DELAY_MS) return;
+  lastPageMs = now;
+  int pages = pageCount();
+  if (pages > 1) {
+    currentPage = (currentPage + 1) % pages;
+    renderPage(currentPage);
+  }
+}
+
+// Poll the Sender /api/devices into a snapshot (net task)
+WiFiClient netClient;
+HTTPClient netHttp;
+
+// next chunk of the body into buf; 0 once the sender closed or went quiet for HTTP_TIMEOUT_MS
+int netRead(Stream& s, uint8_t* buf, int cap) {
+  unsigned long t0 = millis();
+  while (millis() - t0 < HTTP_TIMEOUT_MS) {
+    int avail = s.available();
+    if (avail > 0) return s.readBytes(buf, avail < cap ? avail : cap);
+    if (!netClient.connected()) return 0;
+    delay(1);
+  }
+  return 0;
+}
+
+// with reuse, read the rest of a body we stopped parsing early so its bytes are not taken
+// for the next response; a large or unframed remainder is cheaper to drop with the connection
+void netFinish(int bodyLen, uint32_t consumed) {
+  if (HTTP_REUSE) {
+    long left = bodyLen >= 0 ? (long)bodyLen - (long)consumed : -1;
+    if (left < 0 || left > (long)HTTP_DRAIN_MAX) netHttp.setReuse(false);
+    uint8_t buf[128];
+    Stream& s = netHttp.getStream();
+    while (left > 0) {
+      int n = netRead(s, buf, left < (long)sizeof(buf) ? (int)left : (int)sizeof(buf));
+      if (n <= 0) { netHttp.setReuse(false); break; }
+      left -= n;
+    }
+  }
+  netHttp.end(); // keeps the connection only when the body was read to its end
+}
+
+void netPoll(Snapshot& out) {
+  out.count = 0;
+  out.httpCode = 0;
+  if (!netKeepWiFi()) { out.status = POLL_NO_WIFI; return; }
+
+  // the sender filters to active devices and trims each row to what the LCD shows; devices
+  // in alarm come first (the cache orders its own pages), so MAX_CACHE never cuts one of them
+  static String url = String("http://") + SENDER_HOST + "/api/devices?active=1&alarmed=1&sort=alarm&fields=name,mac,percent,age_seconds,seq,sample_age_ms,rate_pph,anomaly,alarm&limit=" + String(MAX_CACHE);
+  // HTTP/1.0 avoids chunked transfer so the body can be parsed straight off the socket;
+  // with reuse the sender's Content-Length frames it, and netFinish reads what we skip
+  netHttp.useHTTP10(!HTTP_REUSE);
+  netHttp.setReuse(HTTP_REUSE);
+  netHttp.setConnectTimeout(HTTP_CONNECT_TIMEOUT_MS);
+  netHttp.setTimeout(HTTP_TIMEOUT_MS);
+  netHttp.begin(netClient, url);
+  // the sender may answer from its response cache; its ages are as of the build
+  static const char* AGE_HEADER[] = { "X-Age-Ms" };
+  netHttp.collectHeaders(AGE_HEADER, 1);
+  unsigned long t0 = millis();
+  int code = netHttp.GET();
+  out.rxMs = millis();
+  out.rttMs = out.rxMs - t0;
+  out.httpCode = code;
+  if (code != 200) {
+    LOGW("HTTP GET failed, code=%d", code);
+    netHttp.setReuse(false);
+    netHttp.end();
+    out.status = POLL_HTTP_ERR;
     return;
   }
 
-  // Build list of active devices: we'll consider device active if age_seconds exists and <= ACTIVE_THRESHOLD
-  const unsigned long ACTIVE_THRESHOLD_SEC = 15; // treat devices seen within last 15s as active
-  DisplayItem items[MAX_DISPLAY];
+  // The sender returns a top-level JSON array: [ {mac:, ip:, rssi:, name:, percent:, age_seconds:, ...}, ... ]
+  // Walk it row by row off the socket (common/device_stream.h) and stop reading once
+  // MAX_CACHE active devices are found.
+  int bodyLen = netHttp.getSize();
+  long bodyAgeMs = netHttp.header("X-Age-Ms").toInt();
+  Stream& stream = netHttp.getStream();
+  static DeviceStream ds;
+  deviceStreamInit(ds);
+  DeviceStreamEvent ev = DS_NONE;
   int found = 0;
+  uint32_t consumed = 0;   // off the socket, parsed or not: a chunk can run past where we stop
+  bool cut = false;
+  uint8_t buf[128];
+  while (found < MAX_CACHE && ev != DS_END && ev != DS_ERROR) {
+    int n = netRead(stream, buf, sizeof(buf));
+    if (n <= 0) { cut = true; break; }
+    consumed += n;
+    for (int k = 0; k < n && found < MAX_CACHE; ++k) {
+      ev = deviceStreamFeed(ds, (char)buf[k]);
+      if (ev == DS_END || ev == DS_ERROR) break;
+      if (ev != DS_ROW) continue;
 
-  // doc is an array (as used by Sender) or might be object — handle both
-  if (doc.is<JsonArray>()) {
-    JsonArray arr = doc.as<JsonArray>();
-    for (JsonObject o : arr) {
-      if (found >= MAX_DISPLAY) break;
-      // skip if age_seconds missing or too old
-      if (!o.containsKey("age_seconds") || o["age_seconds"].isNull()) continue;
-      long age = o["age_seconds"].as<long>();
-      if (age > (long)ACTIVE_THRESHOLD_SEC) continue;
+      // skip if age_seconds missing or too old, unless the sender flags it (stale alarm)
+      const DeviceRow& o = ds.row;
+      if (!(o.has & DR_AGE)) continue;
+      uint8_t alarm = o.alarm;
+      if (o.ageSec > (long)ACTIVE_THRESHOLD_SEC && !alarm) continue;
 
       // create label (prefer name, else mac)
-      const char* name = o["name"] | "";
-      const char* mac = o["mac"] | "";
-      String label;
-      if (name && strlen(name)) label = String(name);
-      else if (mac && strlen(mac)) label = String(mac);
-      else label = "device";
-
-      float pct = -1;
-      if (o.containsKey("percent") && !o["percent"].isNull()) {
-        pct = o["percent"].as<float>();
-      }
-      items[found].label = label;
-      items[found].percent = pct;
+      const char* label = o.name[0] ? o.name : (o.mac[0] ? o.mac : "device");
+      DisplayItem& d = out.items[found];
+      size_t len = strnlen(label, sizeof(d.label) - 1);
+      memcpy(d.label, label, len);
+      d.label[len] = 0;
+      d.percent = (o.has & DR_PERCENT) ? o.percent : -1.0f;
+      d.ageSec = o.ageSec;
+      d.seq = o.seq;
+      d.sampleAgeMs = (o.has & DR_SAMPLE_AGE) ? o.sampleAgeMs + bodyAgeMs : -1L;
+      d.ratePph = o.ratePph;
+      d.anomaly = o.anomaly;
+      d.alarm = alarm;
       found++;
     }
+  }
+  netFinish(cut ? -1 : bodyLen, consumed);
+
+  out.count = found;
+  if (ev == DS_ERROR || ds.depth == 0) {
+    LOGW("api/devices returned non-array JSON");
+    out.status = POLL_BAD_JSON;
+  } else if (cut) {
+    LOGW("api/devices body cut short after %lu bytes", (unsigned long)ds.bytes);
+    out.status = POLL_JSON_ERR;
   } else {
-    // unexpected shape
-    Serial.println("api/devices returned non-array JSON");
-    lcd.clear();
-    lcd.setCursor(0,0);
-    lcd.print("Bad devices JSON");
-    return;
+    out.status = POLL_OK;
+  }
+}
+
+void netTask(void*) {
+  TickType_t wake = xTaskGetTickCount();
+  for (;;) {
+    Snapshot& s = snapshotBeginWrite();
+    netPoll(s);
+    snapshotPublish(s);
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(POLL_INTERVAL_MS));
   }
+}
+
+// true if this (label, seq) was not in the cache before this snapshot
+bool isNewReading(const DisplayItem& d) {
+  for (int i = 0; i < cacheCount; ++i) {
+    if (strcmp(cache[i].label, d.label) == 0) return cache[i].seq != d.seq;
+  }
+  return true;
+}
 
-  renderLCD(items, found);
-  Serial.printf("Displayed %d active devices\n", found);
+void benchLogTick(unsigned long now) {
+  if (BENCH_LOG_INTERVAL_MS == 0 || now - benchWindowStart < BENCH_LOG_INTERVAL_MS) return;
+  LOGI("{\"bench\":\"e2e\",\"window_ms\":%lu,\"n\":%u,\"p50_ms\":%u,\"p99_ms\":%u,\"p999_ms\":%u,\"max_ms\":%u}",
+                now - benchWindowStart, benchE2eMs.count(), benchE2eMs.percentile(0.5f),
+                benchE2eMs.percentile(0.99f), benchE2eMs.percentile(0.999f), benchE2eMs.max());
+  benchE2eMs.reset();
+  benchWindowStart = now;
+}
+
+// Apply a new snapshot to the page cache / screen (render loop)
+void applySnapshot(const Snapshot& s) {
+  switch (s.status) {
+    case POLL_OK: {
+      // reading age at display = age when the sender answered + ~half the RTT in flight
+      // + time until this render; the stages before the sender come from the sensor's age_ms
+      bool fresh[MAX_CACHE];
+      for (int i = 0; i < s.count; ++i) fresh[i] = s.items[i].sampleAgeMs >= 0 && isNewReading(s.items[i]);
+      uint32_t baseMs = s.rttMs / 2;
+      cacheCount = s.count;
+      memcpy(cache, s.items, sizeof(DisplayItem) * s.count);
+      cacheValid = true;
+      sortCache();
+      if (currentPage >= pageCount()) currentPage = 0;
+      renderPage(currentPage); // refresh values on the page being shown; flipping stays on its timer
+      uint32_t sinceRx = millis() - s.rxMs;
+      for (int i = 0; i < s.count; ++i) {
+        if (fresh[i]) benchE2eMs.record((uint32_t)s.items[i].sampleAgeMs + baseMs + sinceRx);
+      }
+      LOGD("Cached %d active devices (%d alarm)", cacheCount, alarmCount);
+      return;
+    }
+    case POLL_NO_WIFI: {
+      cacheValid = false;
+      showMessage("WiFi disconnected");
+      return;
+    }
+    case POLL_HTTP_ERR: {
+      char line2[21]; snprintf(line2, sizeof(line2), "code: %d", s.httpCode);
+      cacheValid = false;
+      showMessage("HTTP poll failed", line2);
+      return;
+    }
+    case POLL_BAD_JSON:
+      cacheValid = false;
+      showMessage("Bad devices JSON");
+      return;
+    default:
+      cacheValid = false;
+      showMessage("JSON parse error");
+      return;
+  }
 }
 
 void setup() {
   Serial.begin(115200);
   delay(50);
-  Serial.println("\nESP32 Receiver (HTTP polling) starting...");
+  LOGI("ESP32 Receiver (HTTP polling) starting...");
 
   // initialize I2C LCD
   Wire.begin(); // default SDA=21, SCL=22 on most ESP32 boards
   lcd.init();
   lcd.backlight();
   lcd.clear();
-  lcd.setCursor(0,0);
-  lcd.print("Receiver starting...");
-
-  // attempt WiFi connect (non-blocking)
-  ensureWiFi(10000);
-  if (WiFi.status() == WL_CONNECTED) {
-    lcd.clear();
-    lcd.setCursor(0,0);
-    lcd.print("WiFi connected");
-    delay(700);
-  } else {
-    lcd.clear();
-    lcd.setCursor(0,0);
-    lcd.print("WiFi not connected");
-    delay(700);
-  }
+  screen.cleared();
+  showMessage("Receiver starting...");
 
-  lastPoll = millis() - POLL_INTERVAL_MS; // poll immediately on first loop
+  // networking runs on the other core; loop() only renders
+  netKeepWiFi();
+  if (xTaskCreatePinnedToCore(netTask, "net", NET_TASK_STACK, nullptr, 1, nullptr, NET_TASK_CORE) != pdPASS) {
+    LOGE("net task create failed");
+    showMessage("net task failed");
+  }
+  lastPageMs = millis();
 }
 
 void loop() {
-  unsigned long now = millis();
+  static Snapshot latest;
+  if (snapshotTake(latest)) applySnapshot(latest);
 
-  // Reconnect WiFi automatically when needed (quick check)
-  if (WiFi.status() != WL_CONNECTED) {
-    static unsigned long lastTry = 0;
-    if (now - lastTry > 5000) { // try every 5s
-      lastTry = now;
-      ensureWiFi(5000);
-    }
-  }
-
-  if (now - lastPoll >= POLL_INTERVAL_MS) {
-    lastPoll = now;
-    httpPollAndDisplay();
-  }
+  unsigned long now = millis();
+  pagerTick(now);
+  benchLogTick(now);
+  logDrain(Serial); // net task logs land here too; written only as the UART FIFO frees up
 
   // do short delays to let WiFi/other tasks run
   delay(10);
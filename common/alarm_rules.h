@@ -0,0 +1,63 @@
+/*
+  alarm_rules.h
+  - Per-device threshold alarms: low / high level with hysteresis, stale
+    (no report for too long)
+  - AlarmConfig is what the user sets and what is persisted; alarmCompile()
+    turns it into an AlarmRule of integer set/clear points (0.1 % units)
+    once, at config time, so evaluating a report is a few integer compares
+    with no config lookups or float math beyond one scale
+  - Disabled thresholds compile to values no reading can cross; enabled
+    ones are clamped to 0..100 %
+*/
+#pragma once
+
+#include <stdint.h>
+
+enum AlarmFlag : uint8_t { ALARM_LOW = 1 << 0, ALARM_HIGH = 1 << 1, ALARM_STALE = 1 << 2 };
+
+struct AlarmConfig {
+  float lowPct;       // alarm below this; < 0 disables
+  float highPct;      // alarm above this; > 100 disables
+  uint16_t staleSec;  // alarm after this long without a report; 0 disables
+};
+
+struct AlarmRule {
+  int16_t lowSet, lowClear;    // 0.1 % units
+  int16_t highSet, highClear;
+  uint32_t staleMs;
+};
+
+// percent clamped to 0..100 before the scale, so no config value overflows int16
+inline int16_t alarmTenths(float pct) {
+  if (pct < 0) pct = 0;
+  if (pct > 100) pct = 100;
+  return (int16_t)(pct * 10.0f + 0.5f);
+}
+
+inline AlarmRule alarmCompile(const AlarmConfig& c, float hystPct) {
+  AlarmRule r;
+  int16_t h = alarmTenths(hystPct);
+  // NaN fails both compares and disables, like an out-of-range value
+  if (!(c.lowPct >= 0)) { r.lowSet = INT16_MIN; r.lowClear = INT16_MIN; }
+  else { r.lowSet = alarmTenths(c.lowPct); r.lowClear = r.lowSet + h; }
+  if (!(c.highPct <= 100)) { r.highSet = INT16_MAX; r.highClear = INT16_MAX; }
+  else { r.highSet = alarmTenths(c.highPct); r.highClear = r.highSet - h; }
+  r.staleMs = c.staleSec ? (uint32_t)c.staleSec * 1000u : UINT32_MAX;
+  return r;
+}
+
+// new low/high bits for a fresh reading; a report always clears stale.
+// Unknown level (percent < 0) keeps the previous low/high state.
+inline uint8_t alarmOnReport(const AlarmRule& r, uint8_t state, float percent) {
+  if (percent < 0) return state & (ALARM_LOW | ALARM_HIGH);
+  int16_t p = alarmTenths(percent);
+  // set below lowSet; once set, hold until back above lowClear (same for high)
+  int16_t lowAt = (state & ALARM_LOW) ? r.lowClear : r.lowSet;
+  int16_t highAt = (state & ALARM_HIGH) ? r.highClear : r.highSet;
+  return (uint8_t)((p < lowAt) * ALARM_LOW | (p > highAt) * ALARM_HIGH);
+}
+
+// stale bit for a device last heard from ageMs ago
+inline uint8_t alarmOnSweep(const AlarmRule& r, uint8_t state, uint32_t ageMs) {
+  return (uint8_t)((state & ~ALARM_STALE) | (ageMs > r.staleMs) * ALARM_STALE);
+}
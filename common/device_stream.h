@@ -0,0 +1,178 @@
+/*
+  device_stream.h
+  - Push parser for the sender's GET /api/devices body (a top-level array of
+    flat objects), fed one byte at a time straight off the socket, so the
+    body is never buffered and reading can stop after any row
+  - Keeps only what a display row needs: name, mac, percent, age_seconds,
+    seq, sample_age_ms, rate_pph, anomaly, alarm. Other keys, and nested
+    values, are skipped; long strings are cut at the field's size
+  - Fixed memory (sizeof(DeviceStream)) whatever the fleet size;
+    tools/device_stream_bench.cpp runs recorded bodies through it
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum DeviceStreamEvent : uint8_t {
+  DS_NONE,    // keep feeding
+  DS_ROW,     // ds.row holds a complete element
+  DS_END,     // the closing ']'
+  DS_ERROR,   // not an array of objects; further bytes are ignored
+};
+
+enum DeviceRowHas : uint16_t {     // which keys were present and not null
+  DR_NAME = 1 << 0, DR_MAC = 1 << 1, DR_PERCENT = 1 << 2, DR_AGE = 1 << 3, DR_SEQ = 1 << 4,
+  DR_SAMPLE_AGE = 1 << 5, DR_RATE = 1 << 6, DR_ANOMALY = 1 << 7, DR_ALARM = 1 << 8,
+};
+
+struct DeviceRow {
+  uint16_t has;                    // DeviceRowHas bits
+  char name[32];
+  char mac[18];
+  float percent;
+  long ageSec;
+  uint32_t seq;
+  long sampleAgeMs;
+  float ratePph;
+  uint8_t anomaly;
+  uint8_t alarm;
+};
+
+struct DeviceStream {
+  uint8_t depth;                   // 0 before '[', 1 in the array, 2 in a row, more in a nested value
+  bool expectKey;                  // in a row, before the ':'
+  bool inString, escape;
+  uint8_t unicode;                 // \uXXXX hex digits still to come
+  bool scalar;                     // a number/true/false/null is being collected
+  bool done;                       // DS_END or DS_ERROR was returned
+  uint16_t key;                    // DeviceRowHas bit of the current key, 0 = not kept
+  uint8_t tokLen;
+  char tok[32];
+  uint32_t bytes;                  // fed so far
+  DeviceRow row;
+};
+
+inline void deviceStreamInit(DeviceStream& ds) {
+  memset(&ds, 0, sizeof(ds));
+}
+
+inline uint16_t deviceStreamKey(const char* k) {
+  static const char* const KEYS[] = { "name", "mac", "percent", "age_seconds", "seq",
+                                      "sample_age_ms", "rate_pph", "anomaly", "alarm" };
+  for (uint8_t i = 0; i < sizeof(KEYS) / sizeof(KEYS[0]); ++i)
+    if (strcmp(k, KEYS[i]) == 0) return 1u << i;
+  return 0;
+}
+
+// a finished value for the current key; tok is terminated, isString tells quoted from bare
+inline void deviceStreamValue(DeviceStream& ds, bool isString) {
+  DeviceRow& r = ds.row;
+  uint16_t k = ds.key;
+  if (!k || (!isString && strcmp(ds.tok, "null") == 0)) return;
+  if (k == DR_NAME || k == DR_MAC) {
+    if (!isString) return;
+    char* dst = k == DR_NAME ? r.name : r.mac;
+    size_t cap = k == DR_NAME ? sizeof(r.name) : sizeof(r.mac);
+    size_t n = strnlen(ds.tok, cap - 1);
+    memcpy(dst, ds.tok, n);
+    dst[n] = 0;
+  } else {
+    if (isString) return;
+    char* end;
+    double v = strtod(ds.tok, &end);
+    if (end == ds.tok) return;
+    switch (k) {
+      case DR_PERCENT: r.percent = (float)v; break;
+      case DR_AGE: r.ageSec = (long)v; break;
+      case DR_SEQ: r.seq = (uint32_t)v; break;
+      case DR_SAMPLE_AGE: r.sampleAgeMs = (long)v; break;
+      case DR_RATE: r.ratePph = (float)v; break;
+      case DR_ANOMALY: r.anomaly = (uint8_t)v; break;
+      case DR_ALARM: r.alarm = (uint8_t)v; break;
+    }
+  }
+  r.has |= k;
+}
+
+inline void deviceStreamStringChar(DeviceStream& ds, char c) {
+  bool keep = ds.depth == 2;
+  if (ds.unicode) {                        // non-ASCII shows as '?'
+    if (--ds.unicode) return;
+    c = '?';
+  } else if (ds.escape) {
+    ds.escape = false;
+    if (c == 'u') { ds.unicode = 4; return; }
+    if (c == 'n' || c == 't' || c == 'r' || c == 'b' || c == 'f') c = ' ';
+  } else if (c == '\\') {
+    ds.escape = true;
+    return;
+  } else if (c == '"') {
+    ds.inString = false;
+    if (!keep) return;
+    ds.tok[ds.tokLen] = 0;
+    if (ds.expectKey) ds.key = deviceStreamKey(ds.tok);
+    else deviceStreamValue(ds, true);
+    return;
+  }
+  if (keep && ds.tokLen < sizeof(ds.tok) - 1) ds.tok[ds.tokLen++] = c;
+}
+
+inline DeviceStreamEvent deviceStreamFail(DeviceStream& ds) {
+  ds.done = true;
+  return DS_ERROR;
+}
+
+// one byte of the body; after DS_ROW, ds.row is valid until the next byte
+inline DeviceStreamEvent deviceStreamFeed(DeviceStream& ds, char c) {
+  if (ds.done) return DS_NONE;
+  ds.bytes++;
+  if (ds.inString) { deviceStreamStringChar(ds, c); return DS_NONE; }
+  bool ws = c == ' ' || c == '\n' || c == '\r' || c == '\t';
+  if (ds.scalar) {
+    if (!ws && c != ',' && c != '}' && c != ']') {
+      if (ds.tokLen < sizeof(ds.tok) - 1) ds.tok[ds.tokLen++] = c;
+      return DS_NONE;
+    }
+    ds.scalar = false;
+    ds.tok[ds.tokLen] = 0;
+    deviceStreamValue(ds, false);
+  }
+  if (ws) return DS_NONE;
+  switch (ds.depth) {
+    case 0:
+      if (c != '[') return deviceStreamFail(ds);
+      ds.depth = 1;
+      return DS_NONE;
+    case 1:
+      if (c == ',') return DS_NONE;
+      if (c == ']') { ds.done = true; return DS_END; }
+      if (c != '{') return deviceStreamFail(ds);
+      memset(&ds.row, 0, sizeof(ds.row));
+      ds.depth = 2;
+      ds.expectKey = true;
+      ds.key = 0;
+      return DS_NONE;
+    case 2:
+      if (c == '"') { ds.inString = true; ds.tokLen = 0; return DS_NONE; }
+      if (c == '}') { ds.depth = 1; return DS_ROW; }
+      if (c == ',') { ds.expectKey = true; ds.key = 0; return DS_NONE; }
+      if (ds.expectKey) {
+        if (c != ':') return deviceStreamFail(ds);
+        ds.expectKey = false;
+        return DS_NONE;
+      }
+      if (c == ']' || c == ':') return deviceStreamFail(ds);
+      if (c == '{' || c == '[') { ds.depth = 3; return DS_NONE; }   // nested value: skipped
+      ds.scalar = true;
+      ds.tok[0] = c;
+      ds.tokLen = 1;
+      return DS_NONE;
+    default:
+      if (c == '"') ds.inString = true;
+      else if (c == '{' || c == '[') { if (ds.depth == 255) return deviceStreamFail(ds); ds.depth++; }
+      else if (c == '}' || c == ']') ds.depth--;
+      return DS_NONE;
+  }
+}
@@ -0,0 +1,65 @@
+/*
+  echo_gate.h
+  - Adaptive range gate for ultrasonic pings (HC-SR04 style): wait only as
+    long as the echo can take, not for the sensor's full range
+  - The window comes from the last filtered reading, widened by a margin for
+    how far the level can move between sweeps; every miss doubles the
+    margin, ECHO_GATE_MAX_MISSES in a row (or no reading yet) open it to the
+    tank's geometry (its bottom)
+  - The pause before the next ping follows the gate: twice its timeout
+    covers the surface's second bounce; after a miss the module may still
+    be waiting out its own timeout, so the full ECHO_GATE_MISS_DELAY_MS
+  - All in echo us (round trip), like level_fixed.h;
+    tools/echo_gate_sim.cpp measures the saving against fixed timeouts
+*/
+#pragma once
+
+#include <stdint.h>
+
+// pulseIn's timeout starts at the trigger; ECHO rises 200..500 us later (the 8-cycle
+// 40 kHz burst, then the module's own latency), so the slack covers the worst lead-in
+// plus reading noise (tools/echo_gate_sim.cpp)
+const uint32_t ECHO_GATE_LEADIN_US = 500;
+const uint32_t ECHO_GATE_SLACK_US = ECHO_GATE_LEADIN_US + 100;
+const uint8_t ECHO_GATE_MAX_MISSES = 3;
+const unsigned long ECHO_GATE_MIN_DELAY_MS = 10;
+const unsigned long ECHO_GATE_MISS_DELAY_MS = 60;  // HC-SR04 holds ECHO high up to ~38 ms without an echo
+
+// the tank's echo window: surface at full .. tank bottom
+struct EchoGeometry {
+  uint32_t nearUs;
+  uint32_t farUs;
+};
+
+struct EchoGate {
+  uint32_t lastUs;      // last filtered echo, 0 = none yet
+  uint8_t misses;       // pings in a row without an echo
+};
+
+inline void gateReset(EchoGate& g) { g.lastUs = 0; g.misses = 0; }
+
+// pulseIn timeout for the next ping; marginUs: how far the echo may move between sweeps
+inline uint32_t gateTimeoutUs(const EchoGate& g, const EchoGeometry& geo, uint32_t marginUs) {
+  uint32_t far = geo.farUs + ECHO_GATE_SLACK_US;
+  if (g.lastUs == 0 || g.misses >= ECHO_GATE_MAX_MISSES) return far;
+  uint32_t hi = g.lastUs + (marginUs << g.misses) + ECHO_GATE_SLACK_US;
+  return hi < far ? hi : far;
+}
+
+// pause after a ping that was given timeoutUs
+inline unsigned long gateDelayMs(const EchoGate& g, uint32_t timeoutUs) {
+  if (g.misses) return ECHO_GATE_MISS_DELAY_MS;
+  unsigned long ms = (2 * timeoutUs + 999) / 1000;
+  return ms < ECHO_GATE_MIN_DELAY_MS ? ECHO_GATE_MIN_DELAY_MS : ms;
+}
+
+// one ping's outcome: echo us, 0 = none inside the gate
+inline void gateOnPing(EchoGate& g, uint32_t us) {
+  if (us) g.misses = 0;
+  else if (g.misses < 0xFF) g.misses++;
+}
+
+// a sweep's filtered reading (median); 0 keeps the last one as the centre
+inline void gateOnReading(EchoGate& g, uint32_t us) {
+  if (us) g.lastUs = us;
+}
@@ -0,0 +1,71 @@
+/*
+  espnow_frame.h
+  - Frames of the ESP-NOW transport between esp8266.cpp (sensor) and
+    sender-server.cpp: one datagram per report, no association, no TCP/HTTP
+  - EspNowReport carries what POST /api/report does; the sensor's MAC is
+    the ESP-NOW source address, so it is not in the frame. Level in per
+    mille (common/level_fixed.h), heights as the sensor stores them
+  - EspNowConfig is the sender's answer: seq echoes the report (= ACK), the
+    rest is what GET /api/config returns
+  - A sender built with -DESPNOW_UDP_STANDIN also takes the same frames
+    over UDP (ESPNOW_STANDIN_PORT), prefixed with a 6-byte MAC, so host
+    tools can stand in for sensors (tools/report_bench.py)
+  - Packed so both ends agree byte for byte; little-endian like both chips
+*/
+#pragma once
+
+#include <stdint.h>
+#include "level_fixed.h"
+
+const uint8_t ESPNOW_MAGIC = 0x54;    // 'T'
+const uint8_t ESPNOW_VERSION = 1;
+const uint8_t ESPNOW_CHANNEL = 6;     // the sender's AP channel; both ends must be on it
+const uint16_t ESPNOW_STANDIN_PORT = 4210;
+
+enum EspNowType : uint8_t {
+  ESPNOW_REPORT = 1,
+  ESPNOW_CONFIG = 2,
+};
+
+struct __attribute__((packed)) EspNowHeader {
+  uint8_t magic;
+  uint8_t version;
+  uint8_t type;       // EspNowType
+  uint8_t flags;      // reserved, 0
+};
+
+struct __attribute__((packed)) EspNowReport {
+  EspNowHeader hdr;
+  uint32_t seq;
+  uint32_t ageMs;             // reading taken this long before sending
+  uint16_t permille;          // LEVEL_NO_ECHO = no echo
+  int8_t rssi;                // sensor's view of the sender, 0 = unknown
+  float totalHeightCm;
+  float sensorToMaxCm;
+  char name[16];
+};
+
+struct __attribute__((packed)) EspNowConfig {
+  EspNowHeader hdr;
+  uint32_t seq;               // of the report answered
+  uint32_t reportIntervalMs;
+  float totalHeightCm;
+  float sensorToMaxCm;
+  char name[16];
+};
+
+inline void espNowHeader(EspNowHeader& h, EspNowType type) {
+  h.magic = ESPNOW_MAGIC;
+  h.version = ESPNOW_VERSION;
+  h.type = type;
+  h.flags = 0;
+}
+
+inline bool espNowValid(const uint8_t* data, int len, EspNowType type, int size) {
+  const EspNowHeader* h = (const EspNowHeader*)data;
+  return len == size && h->magic == ESPNOW_MAGIC && h->version == ESPNOW_VERSION && h->type == type;
+}
+
+// tools/report_bench.py packs these by hand
+static_assert(sizeof(EspNowReport) == 39, "EspNowReport layout");
+static_assert(sizeof(EspNowConfig) == 36, "EspNowConfig layout");
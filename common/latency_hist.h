@@ -0,0 +1,81 @@
+/*
+  latency_hist.h
+  - Fixed-memory log-linear histogram: exact below 8, then 4 sub-buckets per
+    power of two (<= 12.5% relative error), 124 buckets covering uint32
+  - record() is O(1) and allocation free; percentile() walks the buckets and
+    interpolates inside the one holding the requested rank
+  - Units are the caller's (us for handler timing, ms for end-to-end)
+*/
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+class LatencyHist {
+public:
+  static const int SUB_BITS = 2;
+  static const int SUB = 1 << SUB_BITS;
+  static const int LINEAR = 2 * SUB;
+  static const int BUCKETS = LINEAR + (32 - SUB_BITS - 1) * SUB;
+
+  LatencyHist() { reset(); }
+
+  void reset() {
+    memset(counts_, 0, sizeof(counts_));
+    n_ = 0; sum_ = 0; max_ = 0;
+  }
+
+  void record(uint32_t v) {
+    counts_[bucketOf(v)]++;
+    n_++;
+    sum_ += v;
+    if (v > max_) max_ = v;
+  }
+
+  uint32_t count() const { return n_; }
+  uint64_t sum() const { return sum_; }
+  uint32_t max() const { return max_; }
+  uint32_t bucketCount(int b) const { return counts_[b]; }
+
+  // estimated value at quantile q (0..1)
+  uint32_t percentile(float q) const {
+    if (n_ == 0) return 0;
+    uint32_t rank = (uint32_t)(q * (float)(n_ - 1)) + 1;
+    uint32_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+      if (counts_[b] == 0) continue;
+      if (seen + counts_[b] >= rank) {
+        uint32_t v = lowerBound(b) + (uint32_t)(((uint64_t)bucketWidth(b) * (rank - seen)) / counts_[b]) - 1;
+        return v < max_ ? v : max_;
+      }
+      seen += counts_[b];
+    }
+    return max_;
+  }
+
+  static int bucketOf(uint32_t v) {
+    if (v < (uint32_t)LINEAR) return (int)v;
+    int msb = 31 - __builtin_clz(v);
+    int sub = (int)((v >> (msb - SUB_BITS)) & (SUB - 1));
+    return LINEAR + (msb - SUB_BITS - 1) * SUB + sub;
+  }
+
+  static uint32_t lowerBound(int b) {
+    if (b < LINEAR) return (uint32_t)b;
+    int msb = (b - LINEAR) / SUB + SUB_BITS + 1;
+    uint32_t sub = (uint32_t)((b - LINEAR) % SUB);
+    return (1u << msb) | (sub << (msb - SUB_BITS));
+  }
+
+  static uint32_t bucketWidth(int b) {
+    if (b < LINEAR) return 1;
+    int msb = (b - LINEAR) / SUB + SUB_BITS + 1;
+    return 1u << (msb - SUB_BITS);
+  }
+
+private:
+  uint32_t counts_[BUCKETS];
+  uint32_t n_;
+  uint64_t sum_;
+  uint32_t max_;
+};
@@ -0,0 +1,84 @@
+/*
+  lcd_shadow.h
+  - Shadow framebuffer for HD44780-style character LCDs (20x4 by default)
+  - Draw a whole frame into the back buffer, then flush() sends only the
+    cells that changed, one setCursor per changed run
+  - Works with any driver that has setCursor(col,row) and write(uint8_t)
+    (LiquidCrystal_I2C, hd44780_I2Cexp, ...)
+  - tools/lcd_shadow_bench.cpp counts the I2C bytes per frame against a mock
+    PCF8574 backpack
+*/
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+template <class Lcd, uint8_t COLS = 20, uint8_t ROWS = 4>
+class LcdShadow {
+public:
+  explicit LcdShadow(Lcd& lcd) : lcd_(lcd) {
+    memset(back_, ' ', sizeof(back_));
+    cleared();
+  }
+
+  // call after lcd.clear()/init: the panel now shows all blanks
+  void cleared() { memset(front_, ' ', sizeof(front_)); }
+
+  // forget what the panel shows; next flush() repaints every cell
+  void invalidate() { memset(front_, 0, sizeof(front_)); }
+
+  // blank the back buffer (nothing is sent until flush)
+  void clear() { memset(back_, ' ', sizeof(back_)); }
+
+  // write txt at (col,row), clipped at the right edge
+  void print(uint8_t col, uint8_t row, const char* txt) {
+    if (row >= ROWS || !txt) return;
+    for (uint8_t c = col; c < COLS && *txt; ++c) back_[row][c] = (uint8_t)*txt++;
+  }
+
+  // replace a whole row: txt left-aligned, rest padded with blanks
+  void printLine(uint8_t row, const char* txt) {
+    if (row >= ROWS) return;
+    memset(back_[row], ' ', COLS);
+    print(0, row, txt);
+  }
+
+  // send the difference between back and front buffers; returns LCD writes
+  // (one per character plus one per cursor move). On the I2C bus each write
+  // is several bytes, depending on the backpack driver; see
+  // tools/lcd_shadow_bench.cpp
+  uint16_t flush() {
+    uint16_t sent = 0;
+    for (uint8_t r = 0; r < ROWS; ++r) {
+      uint8_t c = 0;
+      while (c < COLS) {
+        if (back_[r][c] == front_[r][c]) { ++c; continue; }
+        // extend the run; a single unchanged cell between two changes is
+        // cheaper to rewrite than to skip with another cursor move
+        uint8_t end = c + 1;
+        while (end < COLS) {
+          if (back_[r][end] != front_[r][end]) { ++end; continue; }
+          if (end + 1 < COLS && back_[r][end + 1] != front_[r][end + 1]) { end += 2; continue; }
+          break;
+        }
+        lcd_.setCursor(c, r);
+        ++sent;
+        for (uint8_t k = c; k < end; ++k) {
+          lcd_.write(back_[r][k]);
+          front_[r][k] = back_[r][k];
+          ++sent;
+        }
+        c = end;
+      }
+    }
+    lastFlushWrites = sent;
+    return sent;
+  }
+
+  uint16_t lastFlushWrites = 0;
+
+private:
+  Lcd& lcd_;
+  uint8_t back_[ROWS][COLS];
+  uint8_t front_[ROWS][COLS];
+};
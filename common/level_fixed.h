@@ -0,0 +1,59 @@
+/*
+  level_fixed.h
+  - Integer level kernel for sensors without an FPU (ESP8266): echo time
+    (us, round trip) -> distance (1/16 mm) -> fill in per mille, with
+    multiplies and shifts only on the per-reading path
+  - Per-tank factors live in a LevelScale, computed once when the config
+    loads (esp8266.cpp) or at compile time for a fixed table
+    (lora/sender.c's tankCfg); levelScale() is constexpr for both
+  - Geometry: filled = base - distance, clamped to 0..height; base is where
+    the surface would sit at distance 0 (height + offsetFull in
+    lora/sender.c, totalHeight - sensorToMax in esp8266.cpp)
+  - Within 0.1 % (1 per mille) of the float path over both sketches'
+    ranges; tools/level_fixed_bench.cpp checks that and times both
+*/
+#pragma once
+
+#include <stdint.h>
+
+const uint16_t LEVEL_NO_ECHO = 0xFFFF;   // no echo / out of range; same value as lora_proto.h's LORA_NO_ECHO
+const int LEVEL_Q = 16;                  // distances in 1/LEVEL_Q mm
+const int LEVEL_US_SHIFT = 12;           // us -> 1/16 mm factor is Q12
+
+// us of round trip -> 1/16 mm factor, from the speed of sound either way round
+constexpr uint32_t levelUsFactorCmPerUs(float cmPerUs) {
+  return (uint32_t)(cmPerUs / 2.0f * 10.0f * LEVEL_Q * (1 << LEVEL_US_SHIFT) + 0.5f);
+}
+constexpr uint32_t levelUsFactorUsPerCm(float usPerCm) {
+  return (uint32_t)(10.0f * LEVEL_Q * (1 << LEVEL_US_SHIFT) / (2.0f * usPerCm) + 0.5f);
+}
+
+// round trip time of an echo from cmPerUs at distance cm (range gates)
+constexpr uint32_t levelUsForCm(float cm, float cmPerUs) { return (uint32_t)(2.0f * cm / cmPerUs + 0.5f); }
+
+struct LevelScale {
+  uint32_t usK;         // us -> 1/16 mm: us * usK >> LEVEL_US_SHIFT
+  int32_t baseQ;        // 1/16 mm
+  int32_t heightQ;      // 1/16 mm
+  uint32_t permilleK;   // 1/16 mm -> per mille: q * permilleK >> 16
+};
+
+// heightCm must be > 0 (a zero height gives an all-empty scale)
+constexpr LevelScale levelScale(uint32_t usK, float heightCm, float baseCm) {
+  return heightCm <= 0 ? LevelScale{ usK, 0, 0, 0 }
+                       : LevelScale{ usK, (int32_t)(baseCm * 10.0f * LEVEL_Q + 0.5f), (int32_t)(heightCm * 10.0f * LEVEL_Q + 0.5f),
+                                     (uint32_t)(1000.0f * 65536.0f / (heightCm * 10.0f * LEVEL_Q) + 0.5f) };
+}
+
+// us up to ~300 ms of echo stay inside 32 bits (usK ~11300)
+inline uint32_t levelDistQ(const LevelScale& s, uint32_t us) { return (us * s.usK) >> LEVEL_US_SHIFT; }
+
+// echo time -> per mille full; 0 us (no echo) -> LEVEL_NO_ECHO
+inline uint16_t levelPermille(const LevelScale& s, uint32_t us) {
+  if (us == 0) return LEVEL_NO_ECHO;
+  int32_t filled = s.baseQ - (int32_t)levelDistQ(s, us);
+  if (filled <= 0) return 0;
+  if (filled >= s.heightQ) return 1000;
+  uint32_t p = ((uint32_t)filled * s.permilleK + 0x8000) >> 16;
+  return p > 1000 ? 1000 : (uint16_t)p;
+}
@@ -0,0 +1,95 @@
+/*
+  link_stats.h
+  - Per-link quality, updated incrementally per frame, fixed memory:
+    * EWMA RSSI (dBm) and SNR (dB, LoRa) from whichever side measured them
+    * loss: EWMA of per-frame loss from sequence-number gaps (%), plus totals
+    * inter-arrival interval and jitter (EWMA of |interval - mean|), per
+      frame so a gap does not read as jitter
+  - A sequence jump backwards or by more than LINK_RESYNC_GAP is a sender
+    restart: counters resync, nothing is counted as lost
+  - linkSuggestIntervalMs() turns the stats into a report interval; LoRa
+    SF/power are adapted by lora/lora_adr.h from the same SNR
+*/
+#pragma once
+
+#include <stdint.h>
+
+const float LINK_ALPHA = 1.0f / 16.0f;       // RSSI/SNR/interval/jitter smoothing
+const float LINK_LOSS_ALPHA = 1.0f / 32.0f;  // loss smoothing, per frame (sent or lost)
+const uint32_t LINK_RESYNC_GAP = 1000;
+const float LINK_WEAK_RSSI = -80.0f;         // dBm; below: report slower
+const float LINK_STRONG_RSSI = -65.0f;       // dBm; above (and clean): report faster
+const float LINK_LOSSY_PCT = 10.0f;
+const float LINK_CLEAN_PCT = 1.0f;
+
+struct LinkStats {
+  float rssi;              // dBm
+  float snr;               // dB
+  float lossPct;           // recent loss, %
+  float intervalMs;        // mean time between frames
+  float jitterMs;          // mean deviation from intervalMs
+  uint32_t lastSeq;
+  unsigned long lastArrivalMs;
+  uint32_t received;
+  uint32_t lost;
+  bool haveRssi, haveSnr, haveSeq;
+};
+
+inline void linkReset(LinkStats& l) {
+  l.rssi = 0; l.snr = 0; l.lossPct = 0; l.intervalMs = 0; l.jitterMs = 0;
+  l.lastSeq = 0; l.lastArrivalMs = 0; l.received = 0; l.lost = 0;
+  l.haveRssi = false; l.haveSnr = false; l.haveSeq = false;
+}
+
+inline void linkOnRssi(LinkStats& l, float dbm) {
+  l.rssi = l.haveRssi ? l.rssi + LINK_ALPHA * (dbm - l.rssi) : dbm;
+  l.haveRssi = true;
+}
+
+inline void linkOnSnr(LinkStats& l, float db) {
+  l.snr = l.haveSnr ? l.snr + LINK_ALPHA * (db - l.snr) : db;
+  l.haveSnr = true;
+}
+
+// a frame with sequence number seq arrived at nowMs; seqMask narrows the
+// wrap for short counters (0xFFFF for a 16-bit seq)
+inline void linkOnFrame(LinkStats& l, uint32_t seq, unsigned long nowMs, uint32_t seqMask = 0xFFFFFFFFu) {
+  uint32_t gap = (seq - l.lastSeq) & seqMask;
+  if (l.haveSeq && gap == 0) return;  // duplicate
+  l.received++;
+  if (!l.haveSeq || gap > LINK_RESYNC_GAP) {
+    l.lastSeq = seq; l.lastArrivalMs = nowMs; l.haveSeq = true;
+    return;
+  }
+  uint32_t missed = gap - 1;
+  l.lost += missed;
+  // one loss step per missed frame (capped; beyond that the EWMA is ~1 anyway)
+  for (uint32_t k = 0; k < missed && k < 64; ++k) l.lossPct += LINK_LOSS_ALPHA * (100.0f - l.lossPct);
+  l.lossPct -= LINK_LOSS_ALPHA * l.lossPct;
+
+  float perFrame = (float)(nowMs - l.lastArrivalMs) / (float)gap;
+  if (l.intervalMs == 0) l.intervalMs = perFrame;
+  else {
+    float dev = perFrame - l.intervalMs;
+    l.intervalMs += LINK_ALPHA * dev;
+    l.jitterMs += LINK_ALPHA * ((dev < 0 ? -dev : dev) - l.jitterMs);
+  }
+  l.lastSeq = seq;
+  l.lastArrivalMs = nowMs;
+}
+
+// lossy or weak links report less often (fewer retries, less airtime),
+// strong clean links more often; clamped to [minMs, maxMs]
+inline unsigned long linkSuggestIntervalMs(const LinkStats& l, unsigned long baseMs, unsigned long minMs, unsigned long maxMs) {
+  unsigned long ms = baseMs;
+  if (l.haveSeq && l.received >= 16) {
+    bool weak = (l.haveRssi && l.rssi < LINK_WEAK_RSSI) || l.lossPct > LINK_LOSSY_PCT;
+    bool strong = (!l.haveRssi || l.rssi > LINK_STRONG_RSSI) && l.lossPct < LINK_CLEAN_PCT;
+    if (l.lossPct > 2.5f * LINK_LOSSY_PCT) ms = baseMs * 4;
+    else if (weak) ms = baseMs * 2;
+    else if (strong) ms = baseMs / 2;
+  }
+  if (ms < minMs) ms = minMs;
+  if (ms > maxMs) ms = maxMs;
+  return ms;
+}
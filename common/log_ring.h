@@ -0,0 +1,158 @@
+/*
+  log_ring.h
+  - Deferred logging: LOGE/LOGW/LOGI/LOGD format into a fixed slot ring and
+    return; logDrain() writes queued lines to Serial when there is room in
+    the UART FIFO, so the hot path never waits on the baud rate
+  - Compile-time level: #define LOG_LEVEL before including this header;
+    calls above it compile to nothing (arguments are not evaluated)
+  - Multi-producer safe without locks (slot claim by CAS, per-slot ready
+    flag); a single consumer drains. A full ring drops the new line and
+    counts it; the drain reports the count
+  - Drain from loop() idle time (logDrain(Serial)) or, on ESP32, from a
+    low-priority task (logStartDrainTask())
+  - tools/log_ring_bench.cpp times a call against the blocking
+    Serial.printf it replaced, behind a model 115200-baud UART
+*/
+#pragma once
+
+#include "port.h"
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#ifndef LOG_SLOTS
+#define LOG_SLOTS 32        // power of two
+#endif
+#ifndef LOG_LINE_MAX
+#define LOG_LINE_MAX 96     // longer lines are truncated (max 255)
+#endif
+
+struct LogSlot {
+  std::atomic<uint8_t> ready;
+  uint8_t len;
+  char text[LOG_LINE_MAX];
+};
+
+struct LogRing {
+  LogSlot slots[LOG_SLOTS];
+  std::atomic<uint32_t> head;     // next slot to claim (producers)
+  std::atomic<uint32_t> tail;     // next slot to drain (consumer)
+  std::atomic<uint32_t> dropped;
+  uint32_t droppedReported;
+  uint8_t sent;                   // bytes of the tail slot already written
+};
+
+inline LogRing& logRing() { static LogRing r; return r; }
+
+inline void logWrite(char level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+inline void logWrite(char level, const char* fmt, ...) {
+  LogRing& r = logRing();
+  uint32_t h = r.head.load(std::memory_order_relaxed);
+  do {
+    if (h - r.tail.load(std::memory_order_relaxed) >= LOG_SLOTS || r.slots[h & (LOG_SLOTS - 1)].ready.load(std::memory_order_acquire)) {
+      r.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  } while (!r.head.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel));
+
+  LogSlot& s = r.slots[h & (LOG_SLOTS - 1)];
+  s.text[0] = level;
+  s.text[1] = ' ';
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(s.text + 2, LOG_LINE_MAX - 2, fmt, ap);
+  va_end(ap);
+  if (n < 0) n = 0;
+  n += 2;
+  if (n > LOG_LINE_MAX - 1) n = LOG_LINE_MAX - 1;
+  if (s.text[n - 1] != '\n') s.text[n++] = '\n';
+  s.len = (uint8_t)n;
+  s.ready.store(1, std::memory_order_release);
+}
+
+// Write queued lines to out while it can take them without blocking.
+// Out needs write(const uint8_t*, size_t) and availableForWrite().
+template <class Out>
+int logDrain(Out& out, int maxLines = LOG_SLOTS) {
+  LogRing& r = logRing();
+  int lines = 0;
+  uint32_t dropped = r.dropped.load(std::memory_order_relaxed);
+  if (dropped != r.droppedReported && r.sent == 0 && out.availableForWrite() >= 32) {
+    char msg[32];
+    int n = snprintf(msg, sizeof(msg), "W [log] %lu dropped\n", (unsigned long)(dropped - r.droppedReported));
+    out.write((const uint8_t*)msg, n);
+    r.droppedReported = dropped;
+  }
+  uint32_t t = r.tail.load(std::memory_order_relaxed);
+  while (lines < maxLines) {
+    LogSlot& s = r.slots[t & (LOG_SLOTS - 1)];
+    if (!s.ready.load(std::memory_order_acquire)) break;
+    // never more than the FIFO has room for; a long line goes out over several calls
+    int room = out.availableForWrite();
+    int left = s.len - r.sent;
+    if (room <= 0) break;
+    int n = left < room ? left : room;
+    out.write((const uint8_t*)s.text + r.sent, n);
+    r.sent += n;
+    if (r.sent < s.len) break;
+    r.sent = 0;
+    s.ready.store(0, std::memory_order_release);
+    r.tail.store(++t, std::memory_order_release);
+    lines++;
+  }
+  return lines;
+}
+
+// Drain everything, waiting on the UART if needed (setup, before restarts)
+template <class Out>
+void logFlush(Out& out) {
+  LogRing& r = logRing();
+  while (r.tail.load(std::memory_order_acquire) != r.head.load(std::memory_order_acquire)) {
+    if (logDrain(out) == 0) delay(1);
+  }
+}
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOGE(...) logWrite('E', __VA_ARGS__)
+#else
+#define LOGE(...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOGW(...) logWrite('W', __VA_ARGS__)
+#else
+#define LOGW(...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOGI(...) logWrite('I', __VA_ARGS__)
+#else
+#define LOGI(...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOGD(...) logWrite('D', __VA_ARGS__)
+#else
+#define LOGD(...) do {} while (0)
+#endif
+
+#if defined(ARDUINO) && defined(ESP32)
+// ESP32: drain from an idle-priority task so even a loop() that blocks in
+// pulseIn()/delay() gets its log out
+inline void logDrainTask(void*) {
+  for (;;) {
+    logDrain(Serial);
+    vTaskDelay(pdMS_TO_TICKS(5));
+  }
+}
+
+inline bool logStartDrainTask() {
+  return xTaskCreate(logDrainTask, "log", 2048, nullptr, tskIDLE_PRIORITY + 1, nullptr) == pdPASS;
+}
+#endif
@@ -0,0 +1,159 @@
+/*
+  mqtt_egress.h
+  - Outbound side of sender-server's MQTT publisher, kept apart from the
+    client so tools/mqtt_egress_bench.cpp can drive it
+  - Per-device dirty bits coalesce changes between flushes: a device that
+    reports five times in an interval is published once, with the value it
+    has at flush time
+  - A flush moves at most SLOTS dirty devices (round robin) into a bounded
+    queue that the client drains; if the queue is still full of an earlier
+    flush, the oldest message goes and its device is marked dirty again, so
+    a retained topic still ends on the latest value
+  - Nothing is flushed while the broker is away; changes wait as dirty bits
+  - Topic and payload builders take plain values, so the sender and the
+    bench publish the same bytes; a topic longer than MQTT_TOPIC_MAX is
+    not built, and its message is skipped and counted rather than
+    published under a cut-off name
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+const int MQTT_PAYLOAD_MAX = 96;
+const int MQTT_BASE_MAX = 32;   // chars of the topic base
+const int MQTT_ID_MAX = 31;     // chars of the device name (Device::name[32]) in a topic
+const int MQTT_TOPIC_MAX = MQTT_BASE_MAX + 1 + MQTT_ID_MAX + sizeof("/level");   // with the NUL
+
+enum MqttKind : uint8_t {    // also the dirty bits
+  MQTT_LEVEL = 1 << 0,       // <base>/<device>/level
+  MQTT_ALARM = 1 << 1,       // <base>/<device>/alarm
+};
+
+struct MqttMsg {
+  int16_t dev;
+  uint8_t kind;              // one MqttKind
+  uint8_t qos;
+  uint16_t len;
+  char payload[MQTT_PAYLOAD_MAX];
+};
+
+template <int DEVICES, int SLOTS>
+struct MqttEgress {
+  uint8_t dirty[DEVICES];    // MqttKind bits
+  int cursor;                // next device a flush looks at
+  MqttMsg q[SLOTS];
+  uint32_t head, tail;       // tail - head = depth
+  uint32_t marked, flushed, published, dropped;
+  uint32_t failed;           // publishes the client refused; the message stays queued
+  uint32_t skipped;          // messages taken off unpublished: no topic (mqttTopic)
+};
+
+template <int DEVICES, int SLOTS>
+void egressInit(MqttEgress<DEVICES, SLOTS>& e) {
+  memset(e.dirty, 0, sizeof(e.dirty));
+  e.cursor = 0;
+  e.head = e.tail = 0;
+  e.marked = e.flushed = e.published = e.dropped = e.failed = e.skipped = 0;
+}
+
+template <int DEVICES, int SLOTS>
+void egressMark(MqttEgress<DEVICES, SLOTS>& e, int dev, MqttKind kind) {
+  e.dirty[dev] |= kind;
+  e.marked++;
+}
+
+template <int DEVICES, int SLOTS>
+uint32_t egressDepth(const MqttEgress<DEVICES, SLOTS>& e) {
+  return e.tail - e.head;
+}
+
+// dirty devices into the queue, at most SLOTS messages; build(dev, kind, msg) fills in
+// qos, payload and len and returns false for nothing to send. Returns messages queued
+template <int DEVICES, int SLOTS, class Build>
+int egressFlush(MqttEgress<DEVICES, SLOTS>& e, Build build) {
+  int n = 0;
+  for (int k = 0; k < DEVICES && n < SLOTS; k++) {
+    int dev = e.cursor;
+    e.cursor = (e.cursor + 1) % DEVICES;
+    for (uint8_t kind = MQTT_LEVEL; kind <= MQTT_ALARM && n < SLOTS; kind <<= 1) {
+      if (!(e.dirty[dev] & kind)) continue;
+      e.dirty[dev] &= ~kind;
+      if (egressDepth(e) == (uint32_t)SLOTS) {
+        const MqttMsg& old = e.q[e.head % SLOTS];
+        e.dirty[old.dev] |= old.kind;
+        e.head++;
+        e.dropped++;
+      }
+      MqttMsg& m = e.q[e.tail % SLOTS];
+      m.dev = dev;
+      m.kind = kind;
+      if (!build(dev, (MqttKind)kind, m)) continue;
+      e.tail++;
+      e.flushed++;
+      n++;
+    }
+  }
+  return n;
+}
+
+// oldest queued message, nullptr if none; egressPop once the client has taken it
+template <int DEVICES, int SLOTS>
+MqttMsg* egressFront(MqttEgress<DEVICES, SLOTS>& e) {
+  return e.head == e.tail ? nullptr : &e.q[e.head % SLOTS];
+}
+
+template <int DEVICES, int SLOTS>
+void egressPop(MqttEgress<DEVICES, SLOTS>& e) {
+  e.head++;
+  e.published++;
+}
+
+// the front message cannot go out at all; off the queue, not published
+template <int DEVICES, int SLOTS>
+void egressSkip(MqttEgress<DEVICES, SLOTS>& e) {
+  e.head++;
+  e.skipped++;
+}
+
+// <base>/<id>/level|alarm. id is the device name with what MQTT gives meaning to
+// ('/' levels, '+' '#' wildcards) and bytes outside printable ASCII as '_'; the MAC
+// without colons when there is no name. Returns the length, or -1 when the topic does not
+// fit in n (a base over MQTT_BASE_MAX; n of MQTT_TOPIC_MAX takes any name)
+inline int mqttTopic(char* out, size_t n, const char* base, const char* name, const uint8_t mac[6], uint8_t kind) {
+  char id[MQTT_ID_MAX + 1];
+  if (name[0]) {
+    size_t k = 0;
+    for (; name[k] && k < sizeof(id) - 1; k++) {
+      uint8_t c = (uint8_t)name[k];
+      id[k] = (c < 0x20 || c > 0x7E || c == '/' || c == '+' || c == '#') ? '_' : (char)c;
+    }
+    id[k] = 0;
+  } else {
+    snprintf(id, sizeof(id), "%02X%02X%02X%02X%02X%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+  }
+  int len = snprintf(out, n, "%s/%s/%s", base, id, kind == MQTT_LEVEL ? "level" : "alarm");
+  return len < 0 || (size_t)len >= n ? -1 : len;
+}
+
+inline void mqttSetLen(MqttMsg& m, int n) {
+  m.len = n < (int)sizeof(m.payload) ? n : sizeof(m.payload) - 1;
+}
+
+// {"percent","seq","sample_age_ms","rate_pph"}; percent < 0, sampleAgeMs < 0 and
+// !rateKnown are unknown and go out as null
+inline void mqttLevelPayload(MqttMsg& m, float percent, uint32_t seq, long sampleAgeMs, bool rateKnown, float ratePph) {
+  char pct[12], age[21], rate[12];   // age: any long
+  if (percent >= 0) snprintf(pct, sizeof(pct), "%.1f", percent); else strcpy(pct, "null");
+  if (sampleAgeMs >= 0) snprintf(age, sizeof(age), "%ld", sampleAgeMs); else strcpy(age, "null");
+  if (rateKnown) snprintf(rate, sizeof(rate), "%.1f", ratePph); else strcpy(rate, "null");
+  mqttSetLen(m, snprintf(m.payload, sizeof(m.payload), "{\"percent\":%s,\"seq\":%lu,\"sample_age_ms\":%s,\"rate_pph\":%s}",
+                         pct, (unsigned long)seq, age, rate));
+}
+
+// {"alarm" (AlarmFlag bits),"state","since_s"}
+inline void mqttAlarmPayload(MqttMsg& m, uint8_t alarm, const char* state, unsigned long sinceS) {
+  mqttSetLen(m, snprintf(m.payload, sizeof(m.payload), "{\"alarm\":%u,\"state\":\"%s\",\"since_s\":%lu}",
+                         alarm, state, sinceS));
+}
@@ -0,0 +1,29 @@
+/*
+  port.h
+  - The only platform dependency of the shared modules in common/
+  - Arduino targets: the core's millis()/micros()/delay(). That includes
+    the Linux build of whole firmwares (host/, started as a fleet by
+    tools/fleet_sim.py), whose Arduino.h runs a scaled real-time clock
+  - Anything else (tools/ sims of common/ code alone): a virtual clock that
+    only moves when delay()/delayMicroseconds()/port_advance_us() is called,
+    so a simulation of many sensors/receivers in one process is deterministic
+*/
+#pragma once
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+
+#else
+
+#include <stdint.h>
+
+inline uint64_t& port_virtual_us() { static uint64_t t = 0; return t; }
+inline void port_advance_us(uint64_t us) { port_virtual_us() += us; }
+
+inline unsigned long millis() { return (unsigned long)(port_virtual_us() / 1000u); }
+inline unsigned long micros() { return (unsigned long)port_virtual_us(); }
+inline void delay(unsigned long ms) { port_advance_us((uint64_t)ms * 1000u); }
+inline void delayMicroseconds(unsigned int us) { port_advance_us(us); }
+
+#endif
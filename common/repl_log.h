@@ -0,0 +1,181 @@
+/*
+  repl_log.h
+  - Replication between two sender-server instances: each keeps an
+    append-only ring of its own device-table changes (report and config
+    upserts), numbered from 1, and the other pulls it with
+    GET /api/replog?since=<last seq it applied>
+  - Only local changes are logged; what a peer applies is not, so nothing
+    echoes back. Both instances take reports and serve reads
+  - A peer that has fallen off the ring, has not pulled yet, or sees a new
+    epoch (the other rebooted) takes a snapshot instead: the whole table,
+    paged by slot (?snapshot=<slot>), then carries on from the seq the
+    first page reported. Records logged meanwhile are replayed; applying
+    a report is idempotent (newer sample only), so that is harmless
+  - Binary pages, packed like common/espnow_frame.h: a ReplPageHeader,
+    then count ReplRecords. In the ring timeMs is the origin's millis() of
+    the sample; on the wire it is the sample's age, so clocks never have to
+    agree
+  - ReplPeer is the pulling side's state; tools/repl_sim.cpp runs two
+    instances of it over local sockets
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "level_fixed.h"
+
+const uint8_t REPL_MAGIC = 0x52;      // 'R'
+const uint8_t REPL_VERSION = 1;
+const int REPL_PAGE = 32;             // records per response
+
+enum ReplType : uint8_t {
+  REPL_REPORT = 1,    // a reading: level, sensor seq, sample time, geometry as reported
+  REPL_CONFIG = 2,    // POST /api/device: name, geometry, alarm thresholds
+};
+
+enum ReplRecordFlag : uint8_t {
+  REPL_MAC = 1 << 0,        // mac is set
+  REPL_BACKFILL = 1 << 1,   // came out of a sensor's backlog (POST /api/report/batch)
+};
+
+enum ReplPageFlag : uint8_t {
+  REPL_PAGE_SNAPSHOT = 1 << 0,  // records are table state, not log entries
+  REPL_PAGE_RESET = 1 << 1,     // since is not in the ring any more: take a snapshot
+  REPL_PAGE_MORE = 1 << 2,      // more is waiting; pull again without a pause
+};
+
+struct __attribute__((packed)) ReplRecord {
+  uint32_t seq;
+  uint8_t type;               // ReplType
+  uint8_t flags;              // ReplRecordFlag bits
+  uint8_t mac[6];
+  char name[32];              // not terminated when full
+  uint32_t sensorSeq;         // REPL_REPORT
+  uint32_t timeMs;            // REPL_REPORT: sample time (ring) / age (wire)
+  uint16_t permille;          // REPL_REPORT, LEVEL_NO_ECHO = none
+  float totalHeightCm;
+  float sensorToMaxCm;
+  float alarmLowPct;          // REPL_CONFIG
+  float alarmHighPct;
+  uint16_t staleSec;
+};
+
+struct __attribute__((packed)) ReplPageHeader {
+  uint8_t magic;
+  uint8_t version;
+  uint8_t flags;              // ReplPageFlag bits
+  uint8_t count;
+  uint32_t epoch;             // the serving instance's boot id
+  uint32_t upto;              // seq the records bring the puller up to
+  int16_t cursor;             // snapshot: next slot, -1 = done
+};
+
+template <int N>
+struct ReplLog {
+  ReplRecord rec[N];
+  uint32_t next;              // seq of the next record
+  uint32_t epoch;
+};
+
+template <int N>
+void replInit(ReplLog<N>& l, uint32_t epoch) {
+  l.next = 1;
+  l.epoch = epoch ? epoch : 1;
+}
+
+// the new record, zeroed but for seq; overwrites the oldest once full
+template <int N>
+ReplRecord& replAppend(ReplLog<N>& l) {
+  ReplRecord& r = l.rec[l.next % N];
+  memset(&r, 0, sizeof(r));
+  r.seq = l.next++;
+  return r;
+}
+
+inline void replPageInit(ReplPageHeader& h, uint32_t epoch) {
+  h.magic = REPL_MAGIC;
+  h.version = REPL_VERSION;
+  h.flags = 0;
+  h.count = 0;
+  h.epoch = epoch;
+  h.upto = 0;
+  h.cursor = -1;
+}
+
+// records after since, at most max, into out with times turned into ages; since 0 or
+// one the ring has dropped (or one it never had) gives an empty REPL_PAGE_RESET page
+template <int N>
+int replCopySince(const ReplLog<N>& l, uint32_t since, ReplRecord* out, int max, uint32_t now, ReplPageHeader& h) {
+  replPageInit(h, l.epoch);
+  uint32_t oldest = l.next > (uint32_t)N ? l.next - N : 1;
+  if (since == 0 || since + 1 < oldest || since >= l.next) {
+    h.flags = REPL_PAGE_RESET;
+    h.upto = l.next - 1;
+    return 0;
+  }
+  int n = 0;
+  uint32_t s = since + 1;
+  for (; s < l.next && n < max; s++, n++) {
+    out[n] = l.rec[s % N];
+    if (out[n].type == REPL_REPORT) out[n].timeMs = now - out[n].timeMs;
+  }
+  if (s < l.next) h.flags |= REPL_PAGE_MORE;
+  h.count = n;
+  h.upto = s - 1;
+  return n;
+}
+
+/* pulling side */
+struct ReplPeer {
+  uint32_t epoch;             // of the peer, 0 = never heard from it
+  uint32_t since;             // last seq applied
+  int16_t cursor;             // snapshot in progress: next slot to ask for; -1 = none
+  uint32_t snapUpto;          // what the snapshot's first page said
+  bool more;                  // pull again now
+};
+
+inline void replPeerReset(ReplPeer& p) {
+  p.epoch = 0;
+  p.since = 0;
+  p.cursor = -1;
+  p.snapUpto = 0;
+  p.more = false;
+}
+
+// query for the next pull: "?since=N" or "?snapshot=slot"; a peer never heard from starts with a snapshot
+inline void replPeerQuery(const ReplPeer& p, char* out, int n) {
+  if (p.cursor >= 0 || p.epoch == 0) snprintf(out, n, "?snapshot=%d", p.cursor >= 0 ? p.cursor : 0);
+  else snprintf(out, n, "?since=%lu", (unsigned long)p.since);
+}
+
+inline bool replPageValid(const uint8_t* data, int len) {
+  const ReplPageHeader* h = (const ReplPageHeader*)data;
+  return len >= (int)sizeof(ReplPageHeader) && h->magic == REPL_MAGIC && h->version == REPL_VERSION
+         && len == (int)(sizeof(ReplPageHeader) + h->count * sizeof(ReplRecord));
+}
+
+// advances the state for a page; false if its records must not be applied
+// (a reset, or a log page from an epoch we have no snapshot of)
+inline bool replPeerOnPage(ReplPeer& p, const ReplPageHeader& h) {
+  if (h.flags & REPL_PAGE_SNAPSHOT) {
+    if (p.cursor <= 0) { p.snapUpto = h.upto; p.epoch = h.epoch; }
+    p.cursor = h.cursor;
+    if (p.cursor < 0) p.since = p.snapUpto;
+    p.more = true;
+    return true;
+  }
+  if ((h.flags & REPL_PAGE_RESET) || h.epoch != p.epoch) {
+    p.cursor = 0;
+    p.more = true;
+    return false;
+  }
+  p.since = h.upto;
+  p.more = (h.flags & REPL_PAGE_MORE) != 0;
+  return true;
+}
+
+// a slot is at most two records (config + report) and snapshot pages hold whole slots
+static_assert(REPL_PAGE % 2 == 0, "REPL_PAGE");
+static_assert(sizeof(ReplRecord) == 72, "ReplRecord layout");
+static_assert(sizeof(ReplPageHeader) == 14, "ReplPageHeader layout");
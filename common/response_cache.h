@@ -0,0 +1,123 @@
+/*
+  response_cache.h
+  - Serialized bodies of read endpoints, one per variant (path + query),
+    valid for one version and one epoch (the caller's: a second for bodies
+    that carry ages, any other value the body depends on, CACHE_TIMELESS):
+    N pollers asking for the same thing cost one serialization
+  - Every body gets an ETag hashed from its bytes (and a per-boot salt)
+    once, on store: equal bodies share it, different ones do not, however
+    they were keyed; If-None-Match is then a string compare, not a rebuild
+  - builtMs is the caller's clock when the body was built: ages in it are
+    as of then (the sender sends the difference as X-Age-Ms)
+  - Fixed slots plus a byte budget; on store, the variant's own slot
+    first, then a free slot, then the least recently used. Versions of
+    different variants count different things and are never compared
+  - Str is Arduino String on the sender, std::string in
+    tools/response_cache_bench.cpp
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <utility>
+
+const uint32_t CACHE_TIMELESS = 0xFFFFFFFFu;   // epoch for bodies without ages in them
+
+inline uint32_t cacheHash(const char* s, size_t n) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < n; i++) { h ^= (uint8_t)s[i]; h *= 16777619u; }
+  return h;
+}
+
+template <class Str>
+struct CachedBody {
+  bool used;
+  uint32_t keyHash;
+  Str key;
+  uint32_t version;
+  uint32_t epoch;       // second it was built in, or CACHE_TIMELESS
+  Str body;
+  char etag[12];        // "xxxxxxxx" with the quotes
+  uint32_t lastUse;
+  unsigned long builtMs;
+};
+
+template <class Str, int SLOTS>
+struct ResponseCache {
+  CachedBody<Str> slots[SLOTS];
+  size_t budget;        // bytes of bodies held at most
+  size_t bytes;
+  uint32_t tick;
+  uint32_t hits, misses;
+  uint32_t salt;        // differs per boot, so a client's ETag from before a restart never matches
+};
+
+template <class Str, int SLOTS>
+void cacheInit(ResponseCache<Str, SLOTS>& c, size_t budget, uint32_t salt) {
+  for (int i = 0; i < SLOTS; i++) c.slots[i].used = false;
+  c.budget = budget;
+  c.bytes = 0;
+  c.tick = 0;
+  c.hits = 0;
+  c.misses = 0;
+  c.salt = salt;
+}
+
+template <class Str, int SLOTS>
+CachedBody<Str>* cacheFind(ResponseCache<Str, SLOTS>& c, const Str& key, uint32_t version, uint32_t epoch) {
+  uint32_t h = cacheHash(key.c_str(), key.length());
+  for (int i = 0; i < SLOTS; i++) {
+    CachedBody<Str>& e = c.slots[i];
+    if (e.used && e.keyHash == h && e.version == version && e.epoch == epoch && e.key == key) {
+      e.lastUse = ++c.tick;
+      c.hits++;
+      return &e;
+    }
+  }
+  c.misses++;
+  return nullptr;
+}
+
+template <class Str, int SLOTS>
+void cacheDrop(ResponseCache<Str, SLOTS>& c, CachedBody<Str>& e) {
+  c.bytes -= e.body.length();
+  e.body = Str();
+  e.used = false;
+}
+
+// takes body (moved from); nullptr if it is bigger than the whole budget (body left alone)
+template <class Str, int SLOTS>
+CachedBody<Str>* cacheStore(ResponseCache<Str, SLOTS>& c, const Str& key, uint32_t version, uint32_t epoch, Str& body, unsigned long nowMs) {
+  if (body.length() > c.budget) return nullptr;
+  uint32_t h = cacheHash(key.c_str(), key.length());
+  int pick = -1;
+  for (int i = 0; i < SLOTS && pick < 0; i++)
+    if (c.slots[i].used && c.slots[i].keyHash == h && c.slots[i].key == key) pick = i;
+  for (int i = 0; i < SLOTS && pick < 0; i++)
+    if (!c.slots[i].used) pick = i;
+  if (pick < 0) {
+    pick = 0;
+    for (int i = 1; i < SLOTS; i++) if (c.slots[i].lastUse < c.slots[pick].lastUse) pick = i;
+  }
+  CachedBody<Str>& e = c.slots[pick];
+  if (e.used) cacheDrop(c, e);
+  // over budget: least recently used out until it fits
+  while (c.bytes + body.length() > c.budget) {
+    int lru = -1;
+    for (int i = 0; i < SLOTS; i++)
+      if (c.slots[i].used && (lru < 0 || c.slots[i].lastUse < c.slots[lru].lastUse)) lru = i;
+    cacheDrop(c, c.slots[lru]);
+  }
+  e.used = true;
+  e.keyHash = h;
+  e.key = key;
+  e.version = version;
+  e.epoch = epoch;
+  e.body = std::move(body);
+  uint32_t tag = cacheHash(e.body.c_str(), e.body.length()) ^ c.salt;
+  snprintf(e.etag, sizeof(e.etag), "\"%08lx\"", (unsigned long)tag);
+  e.lastUse = ++c.tick;
+  e.builtMs = nowMs;
+  c.bytes += e.body.length();
+  return &e;
+}
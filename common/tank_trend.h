@@ -0,0 +1,139 @@
+/*
+  tank_trend.h
+  - Per-tank incremental analytics, O(1) per reading, fixed memory, no history:
+    * exponentially weighted linear regression of level (%) over time
+      (time constant TREND_TAU_S) -> filtered level + fill/drain rate (%/s)
+    * time-to-empty / time-to-full from the filtered rate
+    * leak: CUSUM of slow drain beyond a slack rate, reset by any fill or fast
+      drain (normal use); accumulation resumes once the rate has settled
+    * stuck sensor: long run of identical readings away from 0/100 %, or a
+      long run of no-echo readings
+  - Readings must arrive in time order; older samples are ignored
+  - tools/tank_trend_sim.cpp runs fill, drain, leak and stuck traces
+    through trendUpdate and checks the rate, time-to-empty/full and flags
+*/
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+// tuning (rates in %/hour are easier to reason about than %/s)
+const float TREND_TAU_S = 900.0f;         // regression memory (older readings fade with e^-age/tau)
+const float TREND_FLAT_PPH = 0.5f;        // |rate| below this is "flat": no time-to-empty/full
+const float TREND_MAX_GAP_S = 1800.0f;    // longer gaps restart the filter
+const float LEAK_SLACK_PPH = 0.3f;        // drain rates below this are noise
+const float LEAK_USE_PPH = 20.0f;         // drain rates above this are someone using water
+const float LEAK_ALARM_PCT = 3.0f;        // slow drain accumulated beyond slack before flagging
+const float LEAK_JUMP_PCT = 1.5f;         // reading this far off the trend = level is changing fast
+const float LEAK_SETTLE_S = 3.0f * TREND_TAU_S;  // ignore the regression tail after use/fill
+const float STUCK_EPS_PCT = 0.05f;        // readings closer than this count as identical
+const uint16_t STUCK_REPORTS = 720;       // ~30 min at the 2.5 s report interval
+const uint16_t NOECHO_REPORTS = 24;       // ~1 min of timeouts
+
+enum TrendFlag : uint8_t { TREND_LEAK = 1 << 0, TREND_STUCK = 1 << 1 };
+
+struct TankTrend {
+  // weighted moments, time measured relative to the last reading (so <= 0)
+  float w;               // total weight
+  float meanT, meanZ;    // weighted means of time (s) and level (%)
+  float ctt, ctz;        // weighted central sums (t,t) and (t,z)
+  float level;           // regression level at the last reading, %
+  float rate;            // regression slope, %/s (filling > 0)
+  float lastRaw;         // previous reading, %
+  float leakCusum;       // accumulated slow drain beyond slack, % points
+  float settleS;         // seconds since the last fill or fast drain
+  unsigned long tMs;     // time of the last accepted reading
+  uint16_t sameCount;    // consecutive identical readings
+  uint16_t noEchoCount;  // consecutive readings with no level (percent < 0)
+  uint8_t flags;         // TrendFlag bits
+  bool valid;            // filter has been seeded
+};
+
+inline void trendReset(TankTrend& t) {
+  t.w = 0; t.meanT = 0; t.meanZ = 0; t.ctt = 0; t.ctz = 0;
+  t.level = 0; t.rate = 0; t.lastRaw = -1; t.leakCusum = 0; t.settleS = 0;
+  t.tMs = 0; t.sameCount = 0; t.noEchoCount = 0; t.flags = 0; t.valid = false;
+}
+
+// feed one reading taken at nowMs (percent < 0 = no echo)
+inline void trendUpdate(TankTrend& t, float percent, unsigned long nowMs) {
+  if (percent < 0) {
+    if (t.noEchoCount < 0xFFFF) t.noEchoCount++;
+    if (t.noEchoCount >= NOECHO_REPORTS) t.flags |= TREND_STUCK;
+    return;
+  }
+  // the echo is back: a stuck flag that came from the no-echo run goes with it
+  if (t.noEchoCount >= NOECHO_REPORTS && t.sameCount < STUCK_REPORTS) t.flags &= ~TREND_STUCK;
+  t.noEchoCount = 0;
+
+  long dtMs = (long)(nowMs - t.tMs);
+  if (t.valid && dtMs <= 0) return;
+  float dt = dtMs * 0.001f;
+  if (!t.valid || dt > TREND_MAX_GAP_S) {
+    t.w = 1; t.meanT = 0; t.meanZ = percent; t.ctt = 0; t.ctz = 0;
+    t.level = percent; t.rate = 0; t.lastRaw = percent; t.tMs = nowMs; t.leakCusum = 0;
+    t.settleS = 0; t.valid = true;
+    t.flags &= ~TREND_LEAK;   // a restarted filter has no drain evidence
+    return;
+  }
+
+  // residual against the trend before this reading is folded in
+  float resid = percent - (t.level + t.rate * dt);
+
+  // fade old readings, move the time origin to now, then add (0, percent)
+  float decay = expf(-dt / TREND_TAU_S);
+  t.w *= decay; t.ctt *= decay; t.ctz *= decay;
+  t.meanT -= dt;
+  t.w += 1.0f;
+  float dT = -t.meanT;
+  float dZ = percent - t.meanZ;
+  t.meanT += dT / t.w;
+  t.meanZ += dZ / t.w;
+  t.ctt += dT * (0.0f - t.meanT);
+  t.ctz += dT * (percent - t.meanZ);
+  t.rate = t.ctt > 1e-3f ? t.ctz / t.ctt : 0.0f;
+  t.level = t.meanZ - t.rate * t.meanT;
+  t.tMs = nowMs;
+
+  // leak CUSUM on the filtered drain rate
+  float drainPph = -t.rate * 3600.0f;
+  if (drainPph < -TREND_FLAT_PPH || drainPph > LEAK_USE_PPH || fabsf(resid) > LEAK_JUMP_PCT) {
+    t.leakCusum = 0;  // filling or in use
+    t.settleS = 0;
+  } else if (t.settleS < LEAK_SETTLE_S) {
+    t.settleS += dt;
+  } else {
+    t.leakCusum += (drainPph - LEAK_SLACK_PPH) * (dt / 3600.0f);
+    if (t.leakCusum < 0) t.leakCusum = 0;
+  }
+  if (t.leakCusum >= LEAK_ALARM_PCT) t.flags |= TREND_LEAK;
+  else if (t.leakCusum == 0) t.flags &= ~TREND_LEAK;
+
+  // stuck: the raw value never moves (readings clamped at 0/100 % are expected to)
+  float d = percent - t.lastRaw;
+  if (d < 0) d = -d;
+  if (d < STUCK_EPS_PCT) {
+    if (percent > 0.0f && percent < 100.0f && t.sameCount < 0xFFFF) t.sameCount++;
+  } else t.sameCount = 0;
+  t.lastRaw = percent;
+  if (t.sameCount >= STUCK_REPORTS) t.flags |= TREND_STUCK;
+  else if (t.sameCount == 0) t.flags &= ~TREND_STUCK;
+}
+
+inline float trendRatePph(const TankTrend& t) { return t.rate * 3600.0f; }
+
+inline bool trendIsFlat(const TankTrend& t) {
+  float pph = trendRatePph(t);
+  return !t.valid || (pph < TREND_FLAT_PPH && pph > -TREND_FLAT_PPH);
+}
+
+// seconds until empty (draining) or full (filling); -1 if flat / unknown
+inline long trendSecondsToEmpty(const TankTrend& t) {
+  if (trendIsFlat(t) || t.rate >= 0) return -1;
+  return (long)(t.level / -t.rate);
+}
+
+inline long trendSecondsToFull(const TankTrend& t) {
+  if (trendIsFlat(t) || t.rate <= 0) return -1;
+  return (long)((100.0f - t.level) / t.rate);
+}
@@ -1,9 +1,16 @@
 /*
   ESP8266 HTTP Sensor (complete)
   - Posts to Sender /api/report (includes MAC)
+  - Readings queue in a RAM backlog while the sender is unreachable and go up
+    in batches (/api/report/batch) once it is back; WiFi reconnects without
+    blocking loop()
   - Polls /api/config?name=... for updates
+  - On the router, fails over to ROUTER_SENDER_IP_ALT (the sender's replication
+    peer) after SENDER_FAILOVER_FAILS unanswered requests, and back the same way
   - Persist config (name, totalHeightCm, sensorToMaxCm) to EEPROM
   - Uses new HTTPClient API: http.begin(WiFiClient, url)
+  - USE_ESPNOW: reports go out as one ESP-NOW frame each instead (no association,
+    no HTTP); the sender's reply carries the config (common/espnow_frame.h)
   ⚡ ESP8266 (Tank Sensor) — HC-SR04 Wiring
 HC-SR04 Pin	ESP8266 (NodeMCU) Pin	Notes
 VCC	5V	Sensor requires 5V power
@@ -17,14 +24,34 @@ ESP8266 VCC	3.3V	(ESP board itself runs on 3.3V)
 #include <ESP8266HTTPClient.h>
 #include <ArduinoJson.h>
 #include <EEPROM.h>
+#include <espnow.h>
+#include "common/latency_hist.h"
+#include "common/level_fixed.h"
+#include "common/echo_gate.h"
+#include "common/espnow_frame.h"
+
+#define LOG_LEVEL LOG_LEVEL_INFO   // per-reading/per-POST lines are LOG_LEVEL_DEBUG
+#define LOG_SLOTS 16
+#define LOG_LINE_MAX 160
+#include "common/log_ring.h"
 
 /* ------------- USER CONFIG (edit per board) ------------- */
 char DEFAULT_NAME[] = "Tank-1";   // change per device: "Tank-1", "Tank-2", "Tank-3"
 const uint8_t TRIG_PIN = 14;      // D5 (GPIO14)
 const uint8_t ECHO_PIN = 12;      // D6 (GPIO12)
 
-const unsigned long REPORT_INTERVAL_MS = 2500;       // how often to POST sensor reading
+const unsigned long REPORT_INTERVAL_MS = 2500;       // how often to POST sensor reading (until the sender suggests one)
 const unsigned long CONFIG_POLL_INTERVAL_MS = 15000; // how often to poll config
+const unsigned long BENCH_LOG_INTERVAL_MS = 10000;   // one-line JSON report-path stats on Serial; 0 disables
+const int BACKLOG_SLOTS = 512;     // readings kept while the sender is unreachable (~21 min at 2.5 s); oldest dropped
+const int BATCH_MAX = 64;          // readings per /api/report/batch (sender's REPORT_BATCH_MAX)
+const unsigned long SENDER_AP_JOIN_MS = 5000;  // per join attempt, then the other network
+const unsigned long ROUTER_JOIN_MS = 8000;
+
+// ESP-NOW instead of WiFi + HTTP; the sensor stays on ESPNOW_CHANNEL, so the sender's
+// AP must be there too (it follows the router's channel when its STA is connected)
+const bool USE_ESPNOW = false;
+const uint8_t ESPNOW_MAX_MISSED = 3;  // replies missed in a row before broadcasting again
 
 // Sender AP
 const char* SENDER_AP_SSID = "Sender-Direct";
@@ -36,6 +63,9 @@ const bool TRY_ROUTER_FALLBACK = true;
 const char* ROUTER_SSID = "Airtel_7737476759";
 const char* ROUTER_PASS = "air49169";
 const IPAddress ROUTER_SENDER_IP(192,168,1,50); // Sender STA IP when on router
+const IPAddress ROUTER_SENDER_IP_ALT(0,0,0,0);  // its replication peer (sender-server REPL_PEER_IP); 0.0.0.0 = none
+const uint16_t SENDER_TIMEOUT_MS = 2000;        // per request; a dead sender costs this much
+const uint8_t SENDER_FAILOVER_FAILS = 2;        // unanswered requests in a row before trying the other sender
 /* ------------------------------------------------------- */
 
 #define EEPROM_SIZE 128
@@ -50,9 +80,51 @@ typedef struct {
 } persisted_config_t;
 
 persisted_config_t cfg;
+LevelScale tankScale;   // from cfg: echo us -> per mille, multiply-and-shift per reading
+EchoGeometry tankGeo;   // from cfg: echo window of the tank
+EchoGate gate;          // pulseIn timeout follows the last reading
 unsigned long lastReport = 0;
 unsigned long lastConfigPoll = 0;
 uint32_t seqno = 0;
+uint32_t bootId = 0;    // random per boot, never 0: seqno restarts with it (sender's reportSeen)
+unsigned long reportIntervalMs = REPORT_INTERVAL_MS;  // sender scales this by link quality
+
+// report-path bench: POST round trip per report, CPU cycles of the level kernel
+LatencyHist benchPostMs;
+LatencyHist benchKernelCycles;
+uint32_t benchPostFail = 0;
+unsigned long benchWindowStart = 0;
+
+// backlog: every reading goes through it, oldest first
+struct Sample {
+  uint32_t seq;
+  uint32_t tMs;           // millis() when taken
+  uint16_t permille;
+};
+Sample backlog[BACKLOG_SLOTS];
+int backlogHead = 0;      // oldest
+int backlogCount = 0;
+uint32_t backlogDropped = 0;
+unsigned long flushRetryMs = 0;  // last failed upload; 0 = none
+
+// WiFi join state: one attempt in flight, checked from loop()
+bool joinTryRouter = false;
+bool joinPending = false;
+bool wifiWasUp = false;
+unsigned long joinStartMs = 0;
+bool useAltSender = false;
+uint8_t senderFails = 0;
+
+// ESP-NOW: broadcast until the sender answers, then unicast to it
+uint8_t espNowPeer[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+bool espNowPeerKnown = false;
+uint8_t espNowMissed = 0;
+bool espNowAwaiting = false;      // a report is out, its reply not in yet
+uint32_t espNowSentSeq = 0;
+unsigned long espNowSentMs = 0;
+volatile bool espNowReplyReady = false;  // set by the receive callback, cleared by loop()
+EspNowConfig espNowReply;
+uint8_t espNowReplyMac[6];
 
 /* ---------------- EEPROM helpers ---------------- */
 void saveConfigToEEPROM() {
@@ -62,7 +134,7 @@ void saveConfigToEEPROM() {
   for (size_t i=0;i<sizeof(cfg);i++) EEPROM.write(EEPROM_ADDR + i, p[i]);
   EEPROM.commit();
   EEPROM.end();
-  Serial.println("Config saved to EEPROM");
+  LOGI("Config saved to EEPROM");
 }
 
 bool loadConfigFromEEPROM() {
@@ -78,65 +150,55 @@ bool loadConfigFromEEPROM() {
 }
 
 /* ---------------- HC-SR04 helpers ---------------- */
-float read_hcsr04_cm(unsigned long &duration_us) {
+const uint32_t ECHO_US_K = levelUsFactorUsPerCm(29.1f);   // 29.1 us per cm one way
+const uint32_t ECHO_TIMEOUT_MAX_US = 38000;               // ~6.5 m, the module's own limit
+const uint32_t GATE_MARGIN_US = levelUsForCm(8.0f, 1.0f / 29.1f);  // level change between reports, doubled per miss
+
+// echo time in us, 0 on timeout
+uint32_t read_hcsr04_us(uint32_t timeoutUs) {
   digitalWrite(TRIG_PIN, LOW);
   delayMicroseconds(2);
   digitalWrite(TRIG_PIN, HIGH);
   delayMicroseconds(10);
   digitalWrite(TRIG_PIN, LOW);
-  // 38ms timeout (~6.5m)
-  duration_us = pulseIn(ECHO_PIN, HIGH, 38000UL);
-  if (duration_us == 0) return -1.0f;
-  float cm = (duration_us / 2.0f) / 29.1f;
-  return cm;
+  return pulseIn(ECHO_PIN, HIGH, timeoutUs < ECHO_TIMEOUT_MAX_US ? timeoutUs : ECHO_TIMEOUT_MAX_US);
 }
 
-float compute_percent_from_distance(float measured_cm, float total_height_cm, float sensor_to_max_cm) {
-  if (measured_cm < 0) return -1.0f;
-  float d_max_to_surface = sensor_to_max_cm + measured_cm;
-  float filled = total_height_cm - d_max_to_surface;
-  if (filled < 0) filled = 0;
-  if (filled > total_height_cm) filled = total_height_cm;
-  return (filled / total_height_cm) * 100.0f;
+// the only float math: once per config load, not per reading
+void applyTankScale() {
+  float baseCm = cfg.totalHeightCm - cfg.sensorToMaxCm;
+  tankScale = levelScale(ECHO_US_K, cfg.totalHeightCm, baseCm);
+  tankGeo.nearUs = 0;
+  tankGeo.farUs = baseCm > 0 ? levelUsForCm(baseCm, 1.0f / 29.1f) : ECHO_TIMEOUT_MAX_US;
+  gateReset(gate);
 }
 
 /* ---------------- Network helpers ---------------- */
-bool connectToSenderAP(unsigned long timeoutMs=5000) {
-  Serial.printf("Connecting to Sender AP '%s' ...\n", SENDER_AP_SSID);
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(SENDER_AP_SSID, SENDER_AP_PASS);
-  unsigned long t0 = millis();
-  while (WiFi.status() != WL_CONNECTED && (millis() - t0) < timeoutMs) {
-    Serial.print('.');
-    delay(200);
-  }
-  Serial.println();
+// never blocks: starts a join, and if it has not come up within its time
+// tries the other network (sender AP first, router as fallback)
+void wifiTick() {
   if (WiFi.status() == WL_CONNECTED) {
-    Serial.printf("Connected to Sender AP. IP=%s  channel=%d\n", WiFi.localIP().toString().c_str(), WiFi.channel());
-    return true;
+    if (!wifiWasUp) LOGI("Connected to %s. IP=%s channel=%d", joinTryRouter ? "router" : "Sender AP",
+                         WiFi.localIP().toString().c_str(), WiFi.channel());
+    wifiWasUp = true;
+    joinPending = false;
+    return;
   }
-  Serial.println("Failed to join Sender AP");
-  WiFi.disconnect(true);
-  return false;
-}
-
-bool connectToRouter(unsigned long timeoutMs=8000) {
-  Serial.printf("Trying router '%s' ...\n", ROUTER_SSID);
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(ROUTER_SSID, ROUTER_PASS);
-  unsigned long t0 = millis();
-  while (WiFi.status() != WL_CONNECTED && (millis() - t0) < timeoutMs) {
-    Serial.print('.');
-    delay(250);
-  }
-  Serial.println();
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.printf("Connected to router. IP=%s channel=%d\n", WiFi.localIP().toString().c_str(), WiFi.channel());
-    return true;
+  if (wifiWasUp) LOGW("WiFi lost; readings queue until it is back");
+  wifiWasUp = false;
+  unsigned long now = millis();
+  if (joinPending && now - joinStartMs < (joinTryRouter ? ROUTER_JOIN_MS : SENDER_AP_JOIN_MS)) return;
+  if (joinPending) {
+    LOGW("%s join timed out", joinTryRouter ? "Router" : "Sender AP");
+    joinTryRouter = TRY_ROUTER_FALLBACK && !joinTryRouter;
+    WiFi.disconnect();
   }
-  Serial.println("Router connect failed");
-  WiFi.disconnect(true);
-  return false;
+  LOGI("Joining %s '%s' ...", joinTryRouter ? "router" : "Sender AP", joinTryRouter ? ROUTER_SSID : SENDER_AP_SSID);
+  WiFi.mode(WIFI_STA);
+  if (joinTryRouter) WiFi.begin(ROUTER_SSID, ROUTER_PASS);
+  else WiFi.begin(SENDER_AP_SSID, SENDER_AP_PASS);
+  joinPending = true;
+  joinStartMs = now;
 }
 
 /* ---------------- HTTP report / config ---------------- */
@@ -144,103 +206,264 @@ String getMacString() {
   return WiFi.macAddress(); // "AA:BB:CC:DD:EE:FF"
 }
 
-bool postReport(float percent) {
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("No WiFi connection for report");
-    return false;
-  }
-
-  String serverUrl;
+// the sender's address depends on which network we joined (and, on the router, which
+// of the pair answers; on its own AP a dead sender takes the AP with it and we rejoin)
+String senderUrl(const String& path) {
   IPAddress local = WiFi.localIP();
-  if (local[0] == 192 && local[1] == 168 && local[2] == 4) {
-    serverUrl = String("http://") + SENDER_AP_IP.toString() + "/api/report";
-  } else {
-    serverUrl = String("http://") + ROUTER_SENDER_IP.toString() + "/api/report";
-  }
+  bool onSenderAP = local[0] == 192 && local[1] == 168 && local[2] == 4;
+  IPAddress ip = onSenderAP ? SENDER_AP_IP : useAltSender ? ROUTER_SENDER_IP_ALT : ROUTER_SENDER_IP;
+  return String("http://") + ip.toString() + path;
+}
+
+// httpCode of a request to the sender; no answer at all SENDER_FAILOVER_FAILS times switches senders
+void senderAnswered(int httpCode) {
+  if (httpCode > 0) { senderFails = 0; return; }
+  if (ROUTER_SENDER_IP_ALT == IPAddress(0,0,0,0) || ++senderFails < SENDER_FAILOVER_FAILS) return;
+  senderFails = 0;
+  useAltSender = !useAltSender;
+  LOGW("Sender not answering; switching to %s", (useAltSender ? ROUTER_SENDER_IP_ALT : ROUTER_SENDER_IP).toString().c_str());
+}
 
+// true on 200/201; the round trip goes into the bench
+bool postJson(const String& url, const String& payload) {
   WiFiClient client;
   HTTPClient http;
-  http.begin(client, serverUrl);  // new API (ESP8266 core >=3.0)
+  http.begin(client, url);  // new API (ESP8266 core >=3.0)
+  http.setTimeout(SENDER_TIMEOUT_MS);
   http.addHeader("Content-Type", "application/json");
+  LOGD("POST %s -> %s", payload.c_str(), url.c_str());
+  unsigned long t0 = millis();
+  int httpCode = http.POST(payload);
+  benchPostMs.record(millis() - t0);
+  senderAnswered(httpCode);
+  if (httpCode > 0) {
+    String resp = http.getString();
+    LOGD("HTTP %d, resp: %s", httpCode, resp.c_str());
+    http.end();
+    return (httpCode == 200 || httpCode == 201);
+  } else {
+    LOGW("HTTP POST failed, error: %s", http.errorToString(httpCode).c_str());
+    http.end();
+    return false;
+  }
+}
 
+// age_ms: how long ago the reading was taken, so the sender can place it on its own clock
+bool postReport(const Sample& r) {
   StaticJsonDocument<256> doc;
   doc["name"] = cfg.name;
-  if (percent >= 0) doc["percent"] = percent;
-  doc["seq"] = seqno++;
+  if (r.permille != LEVEL_NO_ECHO) doc["percent"] = r.permille / 10.0f;
+  doc["seq"] = r.seq;
+  doc["boot"] = bootId;
+  doc["age_ms"] = millis() - r.tMs;
   doc["totalHeightCm"] = cfg.totalHeightCm;
   doc["sensorToMaxCm"] = cfg.sensorToMaxCm;
   doc["mac"] = getMacString();
+  doc["rssi"] = WiFi.RSSI();
+  String payload;
+  serializeJson(doc, payload);
+  return postJson(senderUrl("/api/report"), payload);
+}
 
+// the n oldest queued readings in one request: samples are [seq, age_ms, permille]
+bool postBatch(int n) {
+  DynamicJsonDocument doc(JSON_OBJECT_SIZE(7) + JSON_ARRAY_SIZE(BATCH_MAX) + BATCH_MAX * JSON_ARRAY_SIZE(3) + 64);
+  doc["name"] = cfg.name;
+  doc["totalHeightCm"] = cfg.totalHeightCm;
+  doc["sensorToMaxCm"] = cfg.sensorToMaxCm;
+  doc["mac"] = getMacString();
+  doc["rssi"] = WiFi.RSSI();
+  doc["boot"] = bootId;
+  JsonArray samples = doc.createNestedArray("samples");
+  unsigned long now = millis();
+  for (int i = 0; i < n; i++) {
+    const Sample& r = backlog[(backlogHead + i) % BACKLOG_SLOTS];
+    JsonArray a = samples.createNestedArray();
+    a.add(r.seq);
+    a.add(now - r.tMs);
+    a.add(r.permille);
+  }
   String payload;
   serializeJson(doc, payload);
+  return postJson(senderUrl("/api/report/batch"), payload);
+}
 
-  Serial.printf("POST %s -> %s\n", payload.c_str(), serverUrl.c_str());
-  int httpCode = http.POST(payload);
-  if (httpCode > 0) {
-    String resp = http.getString();
-    Serial.printf("HTTP %d, resp: %s\n", httpCode, resp.c_str());
-    http.end();
-    return (httpCode == 200 || httpCode == 201);
+void backlogPush(uint16_t permille, unsigned long sampleMs) {
+  if (backlogCount == BACKLOG_SLOTS) {
+    backlogHead = (backlogHead + 1) % BACKLOG_SLOTS;
+    backlogCount--;
+    backlogDropped++;
+  }
+  Sample& r = backlog[(backlogHead + backlogCount) % BACKLOG_SLOTS];
+  r.seq = seqno++;
+  r.tMs = sampleMs;
+  r.permille = permille;
+  backlogCount++;
+}
+
+// one request per call: the newest reading alone, or up to BATCH_MAX of the
+// backlog; after a failure wait a report interval before trying again
+void flushBacklog() {
+  if (backlogCount == 0 || WiFi.status() != WL_CONNECTED) return;
+  if (flushRetryMs != 0 && millis() - flushRetryMs < reportIntervalMs) return;
+  int n = backlogCount < BATCH_MAX ? backlogCount : BATCH_MAX;
+  bool ok = n == 1 ? postReport(backlog[backlogHead]) : postBatch(n);
+  if (ok) {
+    if (n > 1) LOGI("Uploaded %d queued readings, %d left", n, backlogCount - n);
+    backlogHead = (backlogHead + n) % BACKLOG_SLOTS;
+    backlogCount -= n;
+    flushRetryMs = 0;
   } else {
-    Serial.printf("HTTP POST failed, error: %s\n", http.errorToString(httpCode).c_str());
-    http.end();
-    return false;
+    LOGW("Report failed, %d readings queued", backlogCount);
+    benchPostFail++;
+    flushRetryMs = millis() | 1;
   }
 }
 
+// what the sender says about us, from /api/config or an ESP-NOW reply
+void applyServerConfig(const char* name, float th, float s2m, unsigned long interval) {
+  if (interval >= 500 && interval <= 60000 && interval != reportIntervalMs) {
+    LOGI("Report interval %lu -> %lu ms", reportIntervalMs, interval);
+    reportIntervalMs = interval;
+  }
+  bool changed = false;
+  if (strlen(name) && strcmp(name, cfg.name) != 0) {
+    strncpy(cfg.name, name, sizeof(cfg.name)-1);
+    cfg.name[sizeof(cfg.name)-1] = 0;
+    changed = true;
+  }
+  if (fabs(cfg.totalHeightCm - th) > 0.001) { cfg.totalHeightCm = th; changed = true; }
+  if (fabs(cfg.sensorToMaxCm - s2m) > 0.001) { cfg.sensorToMaxCm = s2m; changed = true; }
+  if (changed) {
+    applyTankScale();
+    saveConfigToEEPROM();
+    LOGI("Config updated from server");
+  } else LOGD("Config poll: no changes");
+}
+
 bool pollConfigFromServer() {
   if (WiFi.status() != WL_CONNECTED) return false;
-  String serverUrl;
-  IPAddress local = WiFi.localIP();
-  if (local[0] == 192 && local[1] == 168 && local[2] == 4) {
-    serverUrl = String("http://") + SENDER_AP_IP.toString() + "/api/config?name=" + String(cfg.name);
-  } else {
-    serverUrl = String("http://") + ROUTER_SENDER_IP.toString() + "/api/config?name=" + String(cfg.name);
-  }
+  String serverUrl = senderUrl(String("/api/config?name=") + cfg.name);
 
   WiFiClient client;
   HTTPClient http;
   http.begin(client, serverUrl);
+  http.setTimeout(SENDER_TIMEOUT_MS);
   int httpCode = http.GET();
+  senderAnswered(httpCode);
   if (httpCode == 200) {
     String body = http.getString();
     http.end();
     StaticJsonDocument<256> doc;
     auto err = deserializeJson(doc, body);
     if (!err) {
-      const char* name = doc["name"] | "";
-      float th = doc["totalHeightCm"] | cfg.totalHeightCm;
-      float s2m = doc["sensorToMaxCm"] | cfg.sensorToMaxCm;
-      bool changed = false;
-      if (strlen(name) && strcmp(name, cfg.name) != 0) {
-        strncpy(cfg.name, name, sizeof(cfg.name)-1);
-        cfg.name[sizeof(cfg.name)-1] = 0;
-        changed = true;
-      }
-      if (fabs(cfg.totalHeightCm - th) > 0.001) { cfg.totalHeightCm = th; changed = true; }
-      if (fabs(cfg.sensorToMaxCm - s2m) > 0.001) { cfg.sensorToMaxCm = s2m; changed = true; }
-      if (changed) {
-        saveConfigToEEPROM();
-        Serial.println("Config updated from server");
-      } else Serial.println("Config poll: no changes");
+      applyServerConfig(doc["name"] | "", doc["totalHeightCm"] | cfg.totalHeightCm,
+                        doc["sensorToMaxCm"] | cfg.sensorToMaxCm, doc["reportIntervalMs"] | reportIntervalMs);
       return true;
     } else {
-      Serial.printf("Config JSON parse err: %s\n", err.c_str());
+      LOGW("Config JSON parse err: %s", err.c_str());
       return false;
     }
   } else {
-    if (httpCode > 0) Serial.printf("Config poll HTTP %d\n", httpCode);
-    else Serial.printf("Config poll failed: %s\n", http.errorToString(httpCode).c_str());
+    if (httpCode > 0) LOGW("Config poll HTTP %d", httpCode);
+    else LOGW("Config poll failed: %s", http.errorToString(httpCode).c_str());
     http.end();
     return false;
   }
 }
 
+/* ---------------- ESP-NOW report / config ---------------- */
+// runs in the SDK's context; keeps the first reply until loop() has taken it
+void onEspNowRecv(u8* mac, u8* data, u8 len) {
+  if (espNowReplyReady || !espNowValid(data, len, ESPNOW_CONFIG, sizeof(EspNowConfig))) return;
+  memcpy(&espNowReply, data, sizeof(espNowReply));
+  memcpy(espNowReplyMac, mac, 6);
+  espNowReplyReady = true;
+}
+
+bool setupEspNow() {
+  WiFi.mode(WIFI_STA);
+  WiFi.disconnect();
+  wifi_set_channel(ESPNOW_CHANNEL);
+  if (esp_now_init() != 0) {
+    LOGE("ESP-NOW init failed");
+    return false;
+  }
+  esp_now_set_self_role(ESP_NOW_ROLE_COMBO);
+  esp_now_register_recv_cb(onEspNowRecv);
+  esp_now_add_peer(espNowPeer, ESP_NOW_ROLE_COMBO, ESPNOW_CHANNEL, NULL, 0);
+  LOGI("ESP-NOW on channel %u, broadcasting until the sender answers", ESPNOW_CHANNEL);
+  return true;
+}
+
+// one frame, no reply awaited here: espNowTick() matches it by seq
+bool sendReportEspNow(uint16_t permille, unsigned long sampleMs) {
+  if (espNowAwaiting) {
+    benchPostFail++;  // the previous one was never answered
+    if (++espNowMissed >= ESPNOW_MAX_MISSED && espNowPeerKnown) {
+      LOGW("Sender stopped answering; broadcasting again");
+      memset(espNowPeer, 0xFF, 6);
+      espNowPeerKnown = false;
+    }
+  }
+  EspNowReport f;
+  espNowHeader(f.hdr, ESPNOW_REPORT);
+  f.seq = seqno++;
+  f.ageMs = millis() - sampleMs;
+  f.permille = permille;
+  f.rssi = 0;             // not associated, nothing to report
+  f.totalHeightCm = cfg.totalHeightCm;
+  f.sensorToMaxCm = cfg.sensorToMaxCm;
+  memcpy(f.name, cfg.name, sizeof(f.name));
+  espNowSentSeq = f.seq;
+  espNowSentMs = millis();
+  espNowAwaiting = true;
+  return esp_now_send(espNowPeer, (u8*)&f, sizeof(f)) == 0;
+}
+
+void espNowTick() {
+  if (!espNowReplyReady) return;
+  if (espNowAwaiting && espNowReply.seq == espNowSentSeq) {
+    benchPostMs.record(millis() - espNowSentMs);
+    espNowAwaiting = false;
+    espNowMissed = 0;
+  }
+  if (!espNowPeerKnown) {
+    memcpy(espNowPeer, espNowReplyMac, 6);
+    if (!esp_now_is_peer_exist(espNowPeer)) esp_now_add_peer(espNowPeer, ESP_NOW_ROLE_COMBO, ESPNOW_CHANNEL, NULL, 0);
+    espNowPeerKnown = true;
+    LOGI("Sender found at %02X:%02X:%02X:%02X:%02X:%02X", espNowPeer[0], espNowPeer[1], espNowPeer[2],
+         espNowPeer[3], espNowPeer[4], espNowPeer[5]);
+  }
+  char name[sizeof(espNowReply.name) + 1];
+  memcpy(name, espNowReply.name, sizeof(espNowReply.name));
+  name[sizeof(espNowReply.name)] = 0;
+  applyServerConfig(name, espNowReply.totalHeightCm, espNowReply.sensorToMaxCm, espNowReply.reportIntervalMs);
+  espNowReplyReady = false;
+}
+
+void benchLogTick() {
+  if (BENCH_LOG_INTERVAL_MS == 0) return;
+  unsigned long now = millis();
+  if (now - benchWindowStart < BENCH_LOG_INTERVAL_MS) return;
+  LOGI("{\"bench\":\"sensor\",\"window_ms\":%lu,\"posts\":%u,\"fail\":%u,"
+                "\"post_p50_ms\":%u,\"post_p99_ms\":%u,\"post_p999_ms\":%u,\"level_cycles_max\":%u,"
+                "\"queued\":%d,\"dropped\":%u}",
+                now - benchWindowStart, benchPostMs.count(), benchPostFail,
+                benchPostMs.percentile(0.5f), benchPostMs.percentile(0.99f), benchPostMs.percentile(0.999f),
+                benchKernelCycles.max(), backlogCount, backlogDropped);
+  benchPostMs.reset();
+  benchKernelCycles.reset();
+  benchPostFail = 0;
+  benchWindowStart = now;
+}
+
 /* ---------------- setup / loop ---------------- */
 void setup() {
   Serial.begin(115200);
   delay(50);
-  Serial.println("\nESP8266 HTTP Sensor starting...");
+  LOGI("ESP8266 HTTP Sensor starting...");
+  do bootId = ESP.random(); while (bootId == 0);
 
   pinMode(TRIG_PIN, OUTPUT);
   pinMode(ECHO_PIN, INPUT);
@@ -252,55 +475,54 @@ void setup() {
     cfg.sensorToMaxCm = 2.0f;
     cfg.magic = CONFIG_MAGIC;
     saveConfigToEEPROM();
-    Serial.println("Wrote default config to EEPROM");
+    LOGI("Wrote default config to EEPROM");
   } else {
-    Serial.printf("Loaded config: name='%s' H=%.1f S2M=%.1f\n", cfg.name, cfg.totalHeightCm, cfg.sensorToMaxCm);
+    LOGI("Loaded config: name='%s' H=%.1f S2M=%.1f", cfg.name, cfg.totalHeightCm, cfg.sensorToMaxCm);
   }
+  applyTankScale();
 
-  // Try connect to Sender AP first
-  bool joinedAP = connectToSenderAP(5000);
-  if (!joinedAP && TRY_ROUTER_FALLBACK) {
-    bool joinedRouter = connectToRouter(8000);
-    if (!joinedRouter) {
-      Serial.println("No WiFi connection available. Will retry in loop.");
-    }
+  if (USE_ESPNOW) {
+    setupEspNow();
+    lastReport = millis();
+    return;
   }
 
+  // Sender AP first; loop() carries on with the join and falls back to the router
+  wifiTick();
+
   lastReport = millis();
   lastConfigPoll = millis();
 }
 
 void loop() {
-  // ensure wifi; try to connect if not connected
-  if (WiFi.status() != WL_CONNECTED) {
-    // try Sender AP briefly
-    if (!connectToSenderAP(3000)) {
-      if (TRY_ROUTER_FALLBACK) connectToRouter(5000);
-    }
-  }
+  if (!USE_ESPNOW) wifiTick();
 
   unsigned long now = millis();
 
-  if (now - lastReport >= REPORT_INTERVAL_MS) {
+  if (now - lastReport >= reportIntervalMs) {
     lastReport = now;
-    unsigned long dur;
-    float dcm = read_hcsr04_cm(dur);
-    float pct = -1;
-    if (dcm < 0) {
-      Serial.println("HC-SR04 timeout");
-    } else {
-      pct = compute_percent_from_distance(dcm, cfg.totalHeightCm, cfg.sensorToMaxCm);
-      Serial.printf("Measured %.2f cm => %.1f%% (raw %lu us)\n", dcm, pct, dur);
-    }
-    bool ok = postReport(pct);
-    if (!ok) Serial.println("Report failed");
+    uint32_t dur = read_hcsr04_us(gateTimeoutUs(gate, tankGeo, GATE_MARGIN_US));
+    gateOnPing(gate, dur);
+    gateOnReading(gate, dur);
+    unsigned long sampleMs = millis();
+    uint32_t c0 = ESP.getCycleCount();
+    uint16_t permille = levelPermille(tankScale, dur);
+    benchKernelCycles.record(ESP.getCycleCount() - c0);
+    if (permille == LEVEL_NO_ECHO) LOGW("HC-SR04 timeout");
+    else LOGD("Measured %lu/16 mm => %u per mille (raw %lu us)", (unsigned long)levelDistQ(tankScale, dur), permille, (unsigned long)dur);
+    if (!USE_ESPNOW) backlogPush(permille, sampleMs);
+    else if (!sendReportEspNow(permille, sampleMs)) { LOGW("Report failed"); benchPostFail++; }
   }
+  if (!USE_ESPNOW) flushBacklog();
 
-  if (now - lastConfigPoll >= CONFIG_POLL_INTERVAL_MS) {
+  if (USE_ESPNOW) espNowTick();  // config comes back with every reply
+  else if (now - lastConfigPoll >= CONFIG_POLL_INTERVAL_MS) {
     lastConfigPoll = now;
     bool ok = pollConfigFromServer();
-    if (!ok) Serial.println("Config poll failed or no change");
+    if (!ok) LOGD("Config poll failed or no change");
   }
 
+  benchLogTick();
+  logDrain(Serial); // deferred log output, only what the UART FIFO takes
   yield(); // allow background tasks
 }
@@ -0,0 +1,256 @@
+/*
+  Arduino.h (host)
+  - The Arduino core as far as the five firmwares use it, for Linux builds
+    (see host.cpp): String, Print/Stream, Serial on stdout, IPAddress,
+    millis()/delay() on the host clock, pins, random, ESP.*, and FreeRTOS
+    tasks on threads
+  - The build force-includes it like the IDE does (-include Arduino.h)
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <limits.h>
+#include <string>
+#include <algorithm>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define F(s) (s)
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define INPUT_PULLDOWN 3
+#define DEC 10
+#define HEX 16
+#define constrain(a, lo, hi) ((a) < (lo) ? (lo) : ((a) > (hi) ? (hi) : (a)))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+
+using std::min;
+using std::max;
+
+/* time: host.cpp's clock, HOST_CLOCK_SCALE times real time */
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+/* pins: outputs are ignored; pulseIn is the simulated HC-SR04 (host.cpp) */
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeoutUs = 1000000UL);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+char* dtostrf(double val, signed char width, unsigned char prec, char* out);
+
+class String {
+public:
+  String() {}
+  String(const char* c) : s_(c ? c : "") {}
+  String(const std::string& s) : s_(s) {}
+  String(char c) : s_(1, c) {}
+  String(int v, unsigned char base = 10) : s_(num((long)v, base)) {}
+  String(unsigned v, unsigned char base = 10) : s_(unum(v, base)) {}
+  String(long v, unsigned char base = 10) : s_(num(v, base)) {}
+  String(unsigned long v, unsigned char base = 10) : s_(unum(v, base)) {}
+  String(float v, unsigned char decimals = 2) : s_(fix(v, decimals)) {}
+  String(double v, unsigned char decimals = 2) : s_(fix(v, decimals)) {}
+
+  const char* c_str() const { return s_.c_str(); }
+  unsigned int length() const { return s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  bool reserve(unsigned int n) { s_.reserve(n); return true; }
+  char charAt(unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  char& operator[](unsigned int i) { return s_[i]; }
+
+  bool concat(const String& o) { s_ += o.s_; return true; }
+  bool concat(const char* c) { if (c) s_ += c; return true; }
+  bool concat(const char* c, unsigned int n) { if (c) s_.append(c, n); return true; }
+  bool concat(char c) { s_ += c; return true; }
+  bool concat(int v) { s_ += num(v, 10); return true; }
+  bool concat(unsigned v) { s_ += unum(v, 10); return true; }
+  bool concat(long v) { s_ += num(v, 10); return true; }
+  bool concat(unsigned long v) { s_ += unum(v, 10); return true; }
+  bool concat(float v) { s_ += fix(v, 2); return true; }
+  bool concat(double v) { s_ += fix(v, 2); return true; }
+  template <class T> String& operator+=(const T& v) { concat(v); return *this; }
+  template <class T> String operator+(const T& v) const { String r(*this); r.concat(v); return r; }
+  friend String operator+(const char* a, const String& b) { String r(a); r.concat(b); return r; }
+
+  bool equals(const String& o) const { return s_ == o.s_; }
+  bool equalsIgnoreCase(const String& o) const { return strcasecmp(c_str(), o.c_str()) == 0; }
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator==(const char* c) const { return s_ == (c ? c : ""); }
+  bool operator!=(const String& o) const { return s_ != o.s_; }
+  bool operator!=(const char* c) const { return !(*this == c); }
+  bool operator<(const String& o) const { return s_ < o.s_; }
+  int compareTo(const String& o) const { return s_.compare(o.s_); }
+  bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  bool endsWith(const String& p) const { return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0; }
+
+  int indexOf(char c, unsigned int from = 0) const { return pos(s_.find(c, from)); }
+  int indexOf(const String& t, unsigned int from = 0) const { return pos(s_.find(t.s_, from)); }
+  int lastIndexOf(char c) const { return pos(s_.rfind(c)); }
+  String substring(unsigned int from) const { return from < s_.size() ? String(s_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s_.size()) return String();
+    return String(s_.substr(from, std::min<size_t>(to, s_.size()) - from));
+  }
+  void replace(const String& a, const String& b) {
+    if (a.s_.empty()) return;
+    for (size_t p = s_.find(a.s_); p != std::string::npos; p = s_.find(a.s_, p + b.s_.size())) s_.replace(p, a.s_.size(), b.s_);
+  }
+  void remove(unsigned int index, unsigned int count = UINT_MAX) { if (index < s_.size()) s_.erase(index, count); }
+  void trim() {
+    size_t a = s_.find_first_not_of(" \t\r\n"), b = s_.find_last_not_of(" \t\r\n");
+    s_ = a == std::string::npos ? std::string() : s_.substr(a, b - a + 1);
+  }
+  void toLowerCase() { for (char& c : s_) c = tolower((unsigned char)c); }
+  void toUpperCase() { for (char& c : s_) c = toupper((unsigned char)c); }
+  long toInt() const { return atol(s_.c_str()); }
+  float toFloat() const { return (float)atof(s_.c_str()); }
+  double toDouble() const { return atof(s_.c_str()); }
+
+private:
+  std::string s_;
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+  static std::string unum(unsigned long v, unsigned char base) {
+    char b[34];
+    int i = sizeof(b) - 1;
+    b[i] = 0;
+    do { b[--i] = "0123456789abcdef"[v % base]; v /= base; } while (v && i > 0);
+    return b + i;
+  }
+  static std::string num(long v, unsigned char base) { return v < 0 && base == 10 ? "-" + unum(-(unsigned long)v, base) : unum((unsigned long)v, base); }
+  static std::string fix(double v, unsigned char decimals) { char b[48]; snprintf(b, sizeof(b), "%.*f", decimals, v); return b; }
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t n) { size_t k = 0; while (k < n && write(buf[k])) k++; return k; }
+  size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+  size_t write(const char* s, size_t n) { return write((const uint8_t*)s, n); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str(), s.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = DEC) { return print(String((long)v, base)); }
+  size_t print(unsigned v, int base = DEC) { return print(String((unsigned long)v, base)); }
+  size_t print(long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+  size_t println() { return write("\r\n"); }
+  template <class T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  size_t println(double v, int decimals) { size_t n = print(v, decimals); return n + println(); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long ms) { timeout_ = ms; }
+  unsigned long getTimeout() const { return timeout_; }
+  size_t readBytes(char* buf, size_t n);
+  size_t readBytes(uint8_t* buf, size_t n) { return readBytes((char*)buf, n); }
+  String readString();
+  String readStringUntil(char end);
+  bool find(const char* target) { return findUntil(target, nullptr); }
+  bool find(char c) { char t[2] = { c, 0 }; return find(t); }
+  bool findUntil(const char* target, const char* terminator);
+  long parseInt();
+
+protected:
+  unsigned long timeout_ = 1000;
+  int timedRead();
+  int timedPeek();
+};
+
+// Serial: stdout, unbuffered per write so several processes interleave by line
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  operator bool() const { return true; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+  size_t write(const uint8_t* b, size_t n) override { return fwrite(b, 1, n, stdout); }
+  using Print::write;
+  int availableForWrite() override { return 4096; }
+  void flush() override { fflush(stdout); }
+};
+extern HardwareSerial Serial;
+
+class IPAddress : public Print {
+public:
+  IPAddress() { b_[0] = b_[1] = b_[2] = b_[3] = 0; }
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { b_[0] = a; b_[1] = b; b_[2] = c; b_[3] = d; }
+  IPAddress(uint32_t v) { memcpy(b_, &v, 4); }   // network order, like the cores
+  IPAddress(const IPAddress& o) : Print() { memcpy(b_, o.b_, 4); }
+  IPAddress& operator=(const IPAddress& o) { memcpy(b_, o.b_, 4); return *this; }
+  operator uint32_t() const { uint32_t v; memcpy(&v, b_, 4); return v; }
+  bool operator==(const IPAddress& o) const { return memcmp(b_, o.b_, 4) == 0; }
+  bool operator!=(const IPAddress& o) const { return !(*this == o); }
+  uint8_t operator[](int i) const { return b_[i]; }
+  uint8_t& operator[](int i) { return b_[i]; }
+  bool fromString(const char* s) {
+    unsigned a, b, c, d;
+    if (!s || sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return false;
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+  bool fromString(const String& s) { return fromString(s.c_str()); }
+  String toString() const { char t[16]; snprintf(t, sizeof(t), "%u.%u.%u.%u", b_[0], b_[1], b_[2], b_[3]); return String(t); }
+  size_t write(uint8_t) override { return 0; }
+
+private:
+  uint8_t b_[4];
+};
+
+// ESP.*: heap figures are the process heap against the board's (HOST_HEAP_BYTES)
+struct EspClass {
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap() { return getFreeHeap(); }
+  uint32_t getHeapSize();
+  uint32_t getCycleCount();
+  uint32_t getChipId() { return 0; }
+  uint32_t random() { return esp_random(); }
+  void restart();
+  void deepSleep(uint64_t us);
+  bool rtcUserMemoryRead(uint32_t, uint32_t*, size_t) { return false; }
+  bool rtcUserMemoryWrite(uint32_t, uint32_t*, size_t) { return false; }
+};
+extern EspClass ESP;
+
+#include "freertos_host.h"
@@ -0,0 +1,25 @@
+/*
+  EEPROM.h (host)
+  - The ESP cores' emulated EEPROM: a RAM copy loaded by begin() and written
+    back by commit(), to HOST_EEPROM (default ./host-eeprom.bin)
+*/
+#pragma once
+
+#include "Arduino.h"
+#include <vector>
+
+class EEPROMClass {
+public:
+  void begin(size_t size);
+  uint8_t read(int addr) const { return addr >= 0 && addr < (int)data_.size() ? data_[addr] : 0; }
+  void write(int addr, uint8_t v) { if (addr >= 0 && addr < (int)data_.size() && data_[addr] != v) { data_[addr] = v; dirty_ = true; } }
+  bool commit();
+  bool end() { bool ok = commit(); data_.clear(); return ok; }
+  size_t length() const { return data_.size(); }
+  uint8_t* getDataPtr() { dirty_ = true; return data_.data(); }
+
+private:
+  std::vector<uint8_t> data_;
+  bool dirty_ = false;
+};
+extern EEPROMClass EEPROM;
@@ -0,0 +1,3 @@
+#pragma once
+// ESP8266 core name for the same stand-in (host)
+#include "HTTPClient.h"
@@ -0,0 +1,10 @@
+#pragma once
+// mDNS (host): names resolve through HOST_ROUTES instead
+#include "Arduino.h"
+
+class MDNSResponder {
+public:
+  bool begin(const char*) { return true; }
+  void addService(const char*, const char*, uint16_t) {}
+};
+extern MDNSResponder MDNS;
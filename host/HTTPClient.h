@@ -0,0 +1,76 @@
+/*
+  HTTPClient.h (host)
+  - The ESP32/ESP8266 cores' HTTPClient on a host WiFiClient: status line
+    and headers are read by GET()/POST(), the body stays on the socket for
+    getString()/getStream()
+  - Keep-alive as on the board: with setReuse(true) and HTTP/1.1, end()
+    discards only the body bytes that have already arrived and keeps the
+    socket, so a caller that stops reading early leaves the rest for the
+    next response
+  - Every request carries X-Host-IP: HOST_IP, which the host WebServer
+    reports as client().remoteIP()
+*/
+#pragma once
+
+#include "WiFi.h"
+#include <string>
+#include <vector>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NOT_MODIFIED 304
+
+class HTTPClient {
+public:
+  bool begin(WiFiClient& client, const String& url);
+  bool begin(WiFiClient& client, const char* host, uint16_t port, const char* uri = "/");
+  bool begin(const String& url) { return begin(own_, url); }
+  void end();
+
+  void setReuse(bool reuse) { reuse_ = reuse; }
+  void useHTTP10(bool http10 = true) { http10_ = http10; }
+  void setTimeout(uint16_t ms) { timeoutMs_ = ms; }
+  void setConnectTimeout(int32_t ms) { connectTimeoutMs_ = ms; }
+  void addHeader(const String& name, const String& value);
+  void collectHeaders(const char* names[], size_t count);
+  String header(const char* name);
+
+  int GET() { return sendRequest("GET", nullptr, 0); }
+  int POST(const String& body) { return sendRequest("POST", (const uint8_t*)body.c_str(), body.length()); }
+  int POST(const uint8_t* body, size_t len) { return sendRequest("POST", body, len); }
+  int sendRequest(const char* method, const uint8_t* body, size_t len);
+
+  int getSize() const { return size_; }
+  String getString();
+  WiFiClient& getStream() { return *client_; }
+  WiFiClient* getStreamPtr() { return client_; }
+  bool connected() { return client_ && client_->connected(); }
+  static String errorToString(int code);
+
+private:
+  WiFiClient own_;
+  WiFiClient* client_ = nullptr;
+  std::string host_, uri_;
+  uint16_t port_ = 80;
+  std::string connectedTo_;          // host:port the kept socket goes to
+  bool reuse_ = true, http10_ = false, canReuse_ = false, chunked_ = false;
+  uint16_t timeoutMs_ = 5000;
+  int32_t connectTimeoutMs_ = 5000;
+  int size_ = -1;
+  std::string extraHeaders_;
+  std::vector<std::string> collect_;
+  std::vector<std::pair<std::string, std::string>> headers_;
+
+  bool readLine(std::string& line);
+};
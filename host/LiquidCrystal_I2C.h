@@ -0,0 +1,10 @@
+#pragma once
+// LiquidCrystal_I2C (host): the panel is a HostLcd (host_lcd.h)
+#include "host_lcd.h"
+
+class LiquidCrystal_I2C : public HostLcd {
+public:
+  LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows) : HostLcd(cols, rows) { (void)addr; }
+  void init() { clear(); }
+  void begin(uint8_t cols, uint8_t rows) { size(cols, rows); clear(); }
+};
@@ -0,0 +1,47 @@
+/*
+  LittleFS.h (host)
+  - Files live under HOST_FS_DIR (default ./host-fs), one directory per
+    simulated board; begin(true) creates it
+*/
+#pragma once
+
+#include "Arduino.h"
+#include <memory>
+
+class File : public Stream {
+public:
+  File() {}
+  explicit File(FILE* f) : f_(f, fclose) {}
+  operator bool() const { return (bool)f_; }
+  size_t size();
+  void close() { f_.reset(); }
+  int available() override;
+  int read() override { return f_ ? fgetc(f_.get()) : -1; }
+  int peek() override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override { return f_ ? fwrite(buf, 1, n, f_.get()) : 0; }
+  using Print::write;
+  int availableForWrite() override { return f_ ? 4096 : 0; }
+  void flush() override { if (f_) fflush(f_.get()); }
+
+private:
+  std::shared_ptr<FILE> f_;
+};
+
+class FS {
+public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpen = 10, const char* label = nullptr);
+  void end() {}
+  bool format();
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  File open(const char* path, const char* mode = "r");
+  File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+
+private:
+  std::string dir_;
+  std::string path(const char* p) const { return dir_ + (p[0] == '/' ? "" : "/") + p; }
+};
+extern FS LittleFS;
@@ -0,0 +1,54 @@
+/*
+  LoRa.h (host)
+  - sandeepmistry's LoRa library over the host's LoRa air (host_radio.cpp).
+    A packet is heard by every other radio on the air once its airtime
+    (lora/lora_adr.h) has passed, if that radio was listening on the same
+    SF, was not transmitting itself, no other packet overlapped it, and it
+    arrives above the SF's demodulation floor
+  - endPacket() blocks for the airtime, as the library does
+*/
+#pragma once
+
+#include "Arduino.h"
+#include <vector>
+
+class LoRaClass : public Stream {
+public:
+  void setPins(int ss, int reset, int dio0) { (void)ss; (void)reset; (void)dio0; }
+  int begin(long frequency);
+  void end() {}
+  void setSpreadingFactor(int sf) { sf_ = sf; }
+  void setSignalBandwidth(long bw) { bw_ = bw; }
+  void setCodingRate4(int cr) { cr_ = cr; }
+  void setTxPower(int dbm, int outputPin = 1) { (void)outputPin; power_ = dbm; }
+  void setSyncWord(int) {}
+  void setPreambleLength(long) {}
+  void enableCrc() {}
+  void idle() {}
+  void sleep() {}
+  void receive(int size = 0) { (void)size; }
+
+  int beginPacket(int implicitHeader = 0) { (void)implicitHeader; out_.clear(); return 1; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int endPacket(bool async = false);
+
+  int parsePacket(int size = 0);
+  int available() override { return (int)(in_.size() - pos_); }
+  int read() override { return pos_ < in_.size() ? in_[pos_++] : -1; }
+  int peek() override { return pos_ < in_.size() ? in_[pos_] : -1; }
+  int packetRssi() const { return rssi_; }
+  float packetSnr() const { return snr_; }
+  long packetFrequencyError() const { return 0; }
+  int rssi();   // channel now: a packet on the air, else the noise floor
+
+private:
+  int sf_ = 7, cr_ = 5, power_ = 17;
+  long bw_ = 125000;
+  std::vector<uint8_t> out_, in_;
+  size_t pos_ = 0;
+  int rssi_ = 0;
+  float snr_ = 0;
+};
+extern LoRaClass LoRa;
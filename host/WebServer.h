@@ -0,0 +1,87 @@
+/*
+  WebServer.h (host)
+  - The ESP32 core's synchronous WebServer over a listening socket on
+    127.0.0.1: handleClient() accepts, reads, and runs at most one complete
+    request per call, like the board; HTTP/1.1 connections are kept alive
+  - The port is HOST_HTTP_PORT when set, else the one the sketch asks for
+  - client().remoteIP() is the caller's HOST_IP (the host HTTPClient sends
+    it as X-Host-IP), so every simulated board has its own address
+*/
+#pragma once
+
+#include "WiFi.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class WebServer {
+public:
+  typedef std::function<void()> THandlerFunction;
+
+  explicit WebServer(int port = 80) : port_(port) {}
+  ~WebServer();
+  void begin();
+  void begin(uint16_t port) { port_ = port; begin(); }
+  void close();
+  void handleClient();
+
+  void on(const String& uri, THandlerFunction fn) { on(uri, HTTP_ANY, fn); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn) { routes_.push_back({ uri.c_str(), method, fn }); }
+  void onNotFound(THandlerFunction fn) { notFound_ = fn; }
+  void collectHeaders(const char* names[], size_t count);
+
+  String uri() const { return String(uri_.c_str()); }
+  HTTPMethod method() const { return method_; }
+  WiFiClient client() { return client_; }
+
+  String arg(const String& name) const;
+  String arg(int i) const { return i >= 0 && i < (int)args_.size() ? String(args_[i].second.c_str()) : String(); }
+  String argName(int i) const { return i >= 0 && i < (int)args_.size() ? String(args_[i].first.c_str()) : String(); }
+  int args() const { return (int)args_.size(); }
+  bool hasArg(const String& name) const;
+  String header(const String& name) const;
+  bool hasHeader(const String& name) const;
+
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void setContentLength(size_t len) { contentLength_ = len; }
+  void send(int code, const char* type = nullptr, const String& content = String());
+  void send(int code, const String& type, const String& content) { send(code, type.c_str(), content); }
+  void send(int code, const char* type, const uint8_t* content, size_t len) { sendBody(code, type, (const char*)content, len); }
+  void send(int code, const char* type, const char* content, size_t len) { sendBody(code, type, content, len); }
+  void send_P(int code, PGM_P type, PGM_P content) { sendBody(code, type, content, content ? strlen(content) : 0); }
+  void send_P(int code, PGM_P type, PGM_P content, size_t len) { sendBody(code, type, content, len); }
+  void sendContent(const String& s) { sendContent(s.c_str(), s.length()); }
+  void sendContent(const char* data, size_t len);
+  void sendContent_P(PGM_P data, size_t len) { sendContent(data, len); }
+
+private:
+  struct Route { std::string uri; HTTPMethod method; THandlerFunction fn; };
+  struct Conn { WiFiClient client; std::string in; };
+  int port_;
+  int listenFd_ = -1;
+  std::vector<Route> routes_;
+  THandlerFunction notFound_;
+  std::vector<std::string> collect_;
+  std::vector<Conn> conns_;
+
+  // the request being handled
+  WiFiClient client_;
+  std::string uri_;
+  HTTPMethod method_ = HTTP_GET;
+  bool http10_ = false, keepAlive_ = true;
+  std::vector<std::pair<std::string, std::string>> args_, headers_;
+  std::string outHeaders_;
+  size_t contentLength_ = CONTENT_LENGTH_NOT_SET;
+  bool chunked_ = false, sent_ = false;
+
+  bool parse(Conn& c);
+  void dispatch();
+  void sendBody(int code, const char* type, const char* data, size_t len);
+  void writeHead(int code, const char* type, size_t len);
+  void parseArgs(const std::string& s);
+};
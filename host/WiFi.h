@@ -0,0 +1,99 @@
+/*
+  WiFi.h (host)
+  - WiFiClient is a TCP socket on 127.0.0.1; the address it dials goes
+    through the host's address book (HOST_ROUTES, see host.cpp), so a sketch
+    that calls 192.168.4.1:80 reaches whichever local port plays that board
+  - WiFiClass: associates on begin()/softAP() after HOST_WIFI_JOIN_MS; the
+    station's IP and MAC come from HOST_IP and HOST_MAC
+*/
+#pragma once
+
+#include "Arduino.h"
+#include <memory>
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+struct HostSocket;
+
+class WiFiClient : public Stream {
+public:
+  WiFiClient();
+  // dials host (dotted IP or name) through HOST_ROUTES; 1 on success
+  int connect(const char* host, uint16_t port, int32_t timeoutMs);
+  int connect(const char* host, uint16_t port) { return connect(host, port, 3000); }
+  int connect(IPAddress ip, uint16_t port) { return connect(ip.toString().c_str(), port); }
+  uint8_t connected();
+  operator bool() { return connected(); }
+  void stop();
+  IPAddress remoteIP() const;
+
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t n);
+  int peek() override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int availableForWrite() override { return 4096; }
+  void flush() override {}
+
+  // host side: wrap an accepted connection (WebServer)
+  static WiFiClient adopt(int fd, IPAddress remote);
+  void setRemoteIP(IPAddress remote);
+  int fd() const;
+  bool sameSocket(const WiFiClient& o) const { return sock_ == o.sock_; }
+
+private:
+  std::shared_ptr<HostSocket> sock_;
+  bool fill(int waitMs);
+};
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) { mode_ = m; return true; }
+  bool mode(int m) { return mode((wifi_mode_t)m); }
+  wifi_mode_t getMode() const { return mode_; }
+  wl_status_t begin(const char* ssid, const char* pass = nullptr, int32_t channel = 0, const uint8_t* bssid = nullptr, bool connect = true);
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  bool disconnect(bool wifioff = false, bool eraseap = false);
+  bool reconnect();
+  void setAutoReconnect(bool) {}
+  void persistent(bool) {}
+  void setSleep(bool) {}
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+  bool softAP(const char* ssid, const char* pass = nullptr, int channel = 1, int hidden = 0, int maxConn = 4);
+  bool softAPConfig(IPAddress local, IPAddress gateway, IPAddress subnet);
+  IPAddress softAPIP();
+  int softAPgetStationNum() { return 0; }
+  IPAddress localIP();
+  String macAddress();
+  uint8_t* macAddress(uint8_t* mac);
+  String softAPmacAddress();
+  String SSID() { return String(ssid_.c_str()); }
+  int8_t RSSI();
+  int32_t channel() { return channel_; }
+  int scanNetworks(bool = false, bool = false) { return 0; }
+  void scanDelete() {}
+  void setChannel(int32_t ch) { channel_ = ch; }   // host side: espnow.h's wifi_set_channel()
+
+private:
+  wifi_mode_t mode_ = WIFI_OFF;
+  std::string ssid_;
+  unsigned long joinAt_ = 0;
+  bool joining_ = false;
+  int32_t channel_ = 1;
+  IPAddress staIp_, apIp_;
+  bool staIpSet_ = false, apIpSet_ = false;
+};
+extern WiFiClass WiFi;
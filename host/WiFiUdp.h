@@ -0,0 +1,38 @@
+/*
+  WiFiUdp.h (host)
+  - WiFiUDP on 127.0.0.1: begin(port) binds that port (HOST_UDP_PORT
+    overrides it), packets to a board address go through HOST_ROUTES
+*/
+#pragma once
+
+#include "WiFi.h"
+#include <vector>
+
+class WiFiUDP : public Stream {
+public:
+  ~WiFiUDP() { stop(); }
+  uint8_t begin(uint16_t port);
+  void stop();
+  int parsePacket();
+  int available() override { return (int)(in_.size() - pos_); }
+  int read() override { return pos_ < in_.size() ? in_[pos_++] : -1; }
+  int read(uint8_t* buf, size_t n);
+  int read(char* buf, size_t n) { return read((uint8_t*)buf, n); }
+  int peek() override { return pos_ < in_.size() ? in_[pos_] : -1; }
+  IPAddress remoteIP() const { return remoteIp_; }
+  uint16_t remotePort() const { return remotePort_; }
+  int beginPacket(IPAddress ip, uint16_t port);
+  int beginPacket(const char* host, uint16_t port);
+  size_t write(uint8_t c) override { out_.push_back(c); return 1; }
+  size_t write(const uint8_t* buf, size_t n) override { out_.insert(out_.end(), buf, buf + n); return n; }
+  using Print::write;
+  int endPacket();
+
+private:
+  int fd_ = -1;
+  std::vector<uint8_t> in_, out_;
+  size_t pos_ = 0;
+  IPAddress remoteIp_;
+  uint16_t remotePort_ = 0;
+  int outPort_ = -1;
+};
@@ -0,0 +1,28 @@
+#pragma once
+// esp_wifi (host): the softAP's station list is empty; stations are the boards that call in
+#include "Arduino.h"
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL (-1)
+#define ESP_WIFI_MAX_CONN_NUM 10
+
+typedef enum { WIFI_IF_STA = 0, WIFI_IF_AP = 1 } wifi_interface_t;
+
+typedef struct {
+  uint8_t mac[6];
+  int8_t rssi;
+} wifi_sta_info_t;
+
+typedef struct {
+  wifi_sta_info_t sta[ESP_WIFI_MAX_CONN_NUM];
+  int num;
+} wifi_sta_list_t;
+
+inline esp_err_t esp_wifi_ap_get_sta_list(wifi_sta_list_t* list) {
+  list->num = 0;
+  return ESP_OK;
+}
+
+typedef const char* esp_event_base_t;
+#define ESP_EVENT_ANY_ID (-1)
@@ -0,0 +1,23 @@
+/*
+  espnow.h (host)
+  - The ESP8266 SDK's ESP-NOW API on the same air as esp_now.h; 0 is success
+*/
+#pragma once
+
+#include "Arduino.h"
+
+typedef uint8_t u8;
+typedef enum { ESP_NOW_ROLE_IDLE = 0, ESP_NOW_ROLE_CONTROLLER, ESP_NOW_ROLE_SLAVE, ESP_NOW_ROLE_COMBO, ESP_NOW_ROLE_MAX } esp_now_role;
+typedef void (*esp_now_recv_cb_t)(u8* mac, u8* data, u8 len);
+typedef void (*esp_now_send_cb_t)(u8* mac, u8 status);
+
+int esp_now_init();
+int esp_now_deinit();
+int esp_now_set_self_role(u8 role);
+int esp_now_register_recv_cb(esp_now_recv_cb_t cb);
+int esp_now_register_send_cb(esp_now_send_cb_t cb);
+int esp_now_add_peer(u8* mac, u8 role, u8 channel, u8* key, u8 keyLen);
+int esp_now_del_peer(u8* mac);
+int esp_now_is_peer_exist(u8* mac);
+int esp_now_send(u8* mac, u8* data, int len);
+bool wifi_set_channel(uint8_t channel);
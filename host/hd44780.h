@@ -0,0 +1,3 @@
+#pragma once
+// hd44780 library (host): the i/o classes are HostLcd panels (host_lcd.h)
+#include "host_lcd.h"
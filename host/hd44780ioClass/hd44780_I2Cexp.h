@@ -0,0 +1,8 @@
+#pragma once
+// hd44780_I2Cexp (host): begin() returns 0 (found the backpack), like the library
+#include "../hd44780.h"
+
+class hd44780_I2Cexp : public HostLcd {
+public:
+  int begin(uint8_t cols, uint8_t rows) { size(cols, rows); clear(); return 0; }
+};
@@ -0,0 +1,498 @@
+/*
+  host.cpp
+  - Linux build of the firmwares: the Arduino core, FreeRTOS, storage and
+    main() for the stand-ins in host/ (networking in host_net.cpp, LoRa in
+    host_radio.cpp). A sketch compiles unchanged; each build is one board,
+    and boards talk over 127.0.0.1, so a sender plus N sensors and
+    receivers is N + 2 processes (tools/fleet_sim.py starts a fleet)
+  - Build (ArduinoJson is the library the sketches use, header only):
+      H="host/host.cpp host/host_net.cpp host/host_radio.cpp"
+      FLAGS="-std=gnu++17 -O2 -pthread -DARDUINO -include Arduino.h -Ihost -I$ARDUINOJSON/src"
+      g++ $FLAGS -DESP32 -x c++ sender-server.cpp -x none $H -o /tmp/host-sender
+      g++ $FLAGS -DESP8266 -x c++ esp8266.cpp -x none $H -o /tmp/host-sensor
+      g++ $FLAGS -DESP32 -x c++ ESP32-reciever-display.cpp -x none $H -o /tmp/host-receiver
+      g++ $FLAGS -DESP32 -x c++ lora/sender.c -x none $H -o /tmp/host-lora-sender
+      g++ $FLAGS -DESP32 -x c++ lora/reciever.c -x none $H -o /tmp/host-lora-receiver
+      g++ $FLAGS -DESP32 -x c++ lora/relay.c -x none $H -o /tmp/host-lora-relay
+  - Clock: millis()/micros() run HOST_CLOCK_SCALE (default 1) times real
+    time from process start; delay() sleeps the matching real time, so a
+    fleet can run an hour of sketch time in minutes if the CPU keeps up
+  - Environment, per process:
+      HOST_IP, HOST_MAC          this board's station address (default 127.0.0.1, from the pid)
+      HOST_AP_IP                 softAP address (default 192.168.4.1)
+      HOST_HTTP_PORT             port the WebServer listens on (default the sketch's)
+      HOST_ROUTES                board address -> local port, "ip[:port]=port,..."
+      HOST_WIFI_JOIN_MS          association time after WiFi.begin() (default 300)
+      HOST_RSSI                  WiFi.RSSI() (default -55)
+      HOST_FS_DIR, HOST_EEPROM   LittleFS directory, EEPROM image
+      HOST_HEAP_BYTES            the board's heap for ESP.getFreeHeap() (ESP32 327680, ESP8266 81920)
+      HOST_LOOP_US               real sleep after each loop() (default 1000; the board spins)
+      HOST_RUN_MS                exit after this much sketch time, printing a host line
+      HOST_LCD=1                 print the LCD panel when it changes
+      HC-SR04 (pulseIn):
+      HOST_LEVEL_CM              sensor-to-water distance at start (default 40)
+      HOST_LEVEL_RATE_CM_H       change per hour, + = draining (default 0); bounces
+                                 between HOST_LEVEL_MIN_CM and HOST_LEVEL_MAX_CM (5, 75)
+      HOST_ECHO_NOISE_CM         gaussian noise per reading (default 0.3)
+      HOST_ECHO_LOSS_PCT         pings with no echo (default 0)
+      HOST_ECHO_LEADIN_US        trigger to echo rise (default 450)
+      LoRa / ESP-NOW: see host_radio.cpp and host_net.cpp
+  - At exit (HOST_RUN_MS, SIGINT/SIGTERM) one JSON line: sketch time, CPU
+    time, peak RSS and the lowest ESP.getFreeHeap() seen
+*/
+
+#include "Arduino.h"
+#include "host.h"
+#include "EEPROM.h"
+#include "LittleFS.h"
+#include "Wire.h"
+#include "SPI.h"
+#include "ESPmDNS.h"
+#include "host_lcd.h"
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <malloc.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+void setup();
+void loop();
+
+HardwareSerial Serial;
+EspClass ESP;
+EEPROMClass EEPROM;
+FS LittleFS;
+TwoWire Wire;
+SPIClass SPI;
+MDNSResponder MDNS;
+
+/* ---------------- environment ---------------- */
+const char* hostEnv(const char* name, const char* dflt) {
+  const char* v = getenv(name);
+  return v && *v ? v : dflt;
+}
+
+long hostEnvLong(const char* name, long dflt) {
+  const char* v = getenv(name);
+  return v && *v ? strtol(v, nullptr, 0) : dflt;
+}
+
+double hostEnvDouble(const char* name, double dflt) {
+  const char* v = getenv(name);
+  return v && *v ? atof(v) : dflt;
+}
+
+const char* hostIp() { return hostEnv("HOST_IP", "127.0.0.1"); }
+
+void hostMac(uint8_t mac[6]) {
+  unsigned b[6];
+  const char* s = getenv("HOST_MAC");
+  if (s && sscanf(s, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) == 6) {
+    for (int i = 0; i < 6; i++) mac[i] = (uint8_t)b[i];
+    return;
+  }
+  uint32_t pid = (uint32_t)getpid();
+  const uint8_t made[6] = { 0x02, 0x48, (uint8_t)(pid >> 24), (uint8_t)(pid >> 16), (uint8_t)(pid >> 8), (uint8_t)pid };
+  memcpy(mac, made, 6);
+}
+
+/* ---------------- clock ---------------- */
+uint64_t hostRealUs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+static const uint64_t startUs = hostRealUs();
+
+double hostScale() {
+  static const double s = hostEnvDouble("HOST_CLOCK_SCALE", 1.0) > 0 ? hostEnvDouble("HOST_CLOCK_SCALE", 1.0) : 1.0;
+  return s;
+}
+
+static uint64_t virtualUs() { return (uint64_t)((hostRealUs() - startUs) * hostScale()); }
+
+unsigned long millis() { return (unsigned long)(virtualUs() / 1000u); }
+unsigned long micros() { return (unsigned long)virtualUs(); }
+
+void hostSleepVirtualUs(uint64_t us) {
+  if (us) std::this_thread::sleep_for(std::chrono::microseconds((uint64_t)(us / hostScale())));
+}
+
+long hostRealMs(unsigned long virtualMs) { return (long)(virtualMs / hostScale()); }
+
+void delay(unsigned long ms) { hostSleepVirtualUs((uint64_t)ms * 1000u); }
+void delayMicroseconds(unsigned int us) { hostSleepVirtualUs(us); }
+void yield() { std::this_thread::yield(); }
+
+/* ---------------- random ---------------- */
+static std::mt19937& rng() {
+  static std::mt19937 r((uint32_t)(hostRealUs() ^ (uint64_t)getpid() << 16));
+  return r;
+}
+long random(long hi) { return hi > 0 ? (long)(rng()() % (uint32_t)hi) : 0; }
+long random(long lo, long hi) { return hi > lo ? lo + random(hi - lo) : lo; }
+void randomSeed(unsigned long seed) { rng().seed((uint32_t)seed); }
+uint32_t esp_random() { return rng()(); }
+
+char* dtostrf(double val, signed char width, unsigned char prec, char* out) {
+  sprintf(out, "%*.*f", width, prec, val);
+  return out;
+}
+
+/* ---------------- pins and the HC-SR04 ---------------- */
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return LOW; }
+int analogRead(uint8_t) { return 0; }
+
+// sensor-to-water distance now: a ramp that bounces between min and max
+static double tankDistanceCm() {
+  static const double start = hostEnvDouble("HOST_LEVEL_CM", 40);
+  static const double rate = hostEnvDouble("HOST_LEVEL_RATE_CM_H", 0);
+  static const double lo = hostEnvDouble("HOST_LEVEL_MIN_CM", 5), hi = hostEnvDouble("HOST_LEVEL_MAX_CM", 75);
+  double span = hi - lo;
+  if (rate == 0 || span <= 0) return start;
+  double d = start - lo + rate * millis() / 3600000.0;
+  d = fmod(d, 2 * span);
+  if (d < 0) d += 2 * span;
+  return lo + (d <= span ? d : 2 * span - d);
+}
+
+unsigned long pulseIn(uint8_t, uint8_t, unsigned long timeoutUs) {
+  static const double noise = hostEnvDouble("HOST_ECHO_NOISE_CM", 0.3);
+  static const double lossPct = hostEnvDouble("HOST_ECHO_LOSS_PCT", 0);
+  static const unsigned long leadIn = (unsigned long)hostEnvLong("HOST_ECHO_LEADIN_US", 450);
+  std::normal_distribution<double> n(0, noise > 0 ? noise : 1e-9);
+  double cm = tankDistanceCm() + n(rng());
+  unsigned long echo = (unsigned long)(cm * 2 / 0.0343);
+  bool lost = lossPct > 0 && random(10000) < (long)(lossPct * 100);
+  // the timeout runs from the call: the lead-in counts against it
+  if (lost || leadIn + echo > timeoutUs) {
+    hostSleepVirtualUs(timeoutUs);
+    return 0;
+  }
+  hostSleepVirtualUs(leadIn + echo);
+  return echo;
+}
+
+/* ---------------- Print / Stream ---------------- */
+size_t Print::printf(const char* fmt, ...) {
+  char small[256];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(small, sizeof(small), fmt, ap);
+  va_end(ap);
+  if (n < 0) return 0;
+  if (n < (int)sizeof(small)) return write((const uint8_t*)small, n);
+  std::string big(n + 1, 0);
+  va_start(ap, fmt);
+  vsnprintf(&big[0], n + 1, fmt, ap);
+  va_end(ap);
+  return write((const uint8_t*)big.data(), n);
+}
+
+int Stream::timedRead() {
+  unsigned long t0 = millis();
+  do {
+    int c = read();
+    if (c >= 0) return c;
+    delay(1);
+  } while (millis() - t0 < timeout_);
+  return -1;
+}
+
+int Stream::timedPeek() {
+  unsigned long t0 = millis();
+  do {
+    int c = peek();
+    if (c >= 0) return c;
+    delay(1);
+  } while (millis() - t0 < timeout_);
+  return -1;
+}
+
+size_t Stream::readBytes(char* buf, size_t n) {
+  size_t k = 0;
+  while (k < n) {
+    int c = timedRead();
+    if (c < 0) break;
+    buf[k++] = (char)c;
+  }
+  return k;
+}
+
+String Stream::readString() {
+  String s;
+  for (int c = timedRead(); c >= 0; c = timedRead()) s += (char)c;
+  return s;
+}
+
+String Stream::readStringUntil(char end) {
+  String s;
+  for (int c = timedRead(); c >= 0 && c != end; c = timedRead()) s += (char)c;
+  return s;
+}
+
+bool Stream::findUntil(const char* target, const char* terminator) {
+  size_t tl = strlen(target), ml = terminator ? strlen(terminator) : 0, ti = 0, mi = 0;
+  if (tl == 0) return true;
+  for (int c = timedRead(); c >= 0; c = timedRead()) {
+    ti = c == target[ti] ? ti + 1 : (c == target[0] ? 1 : 0);
+    if (ti == tl) return true;
+    if (ml) {
+      mi = c == terminator[mi] ? mi + 1 : (c == terminator[0] ? 1 : 0);
+      if (mi == ml) return false;
+    }
+  }
+  return false;
+}
+
+long Stream::parseInt() {
+  int c = timedPeek();
+  while (c >= 0 && c != '-' && (c < '0' || c > '9')) { read(); c = timedPeek(); }
+  bool neg = c == '-';
+  if (neg) { read(); c = timedPeek(); }
+  long v = 0;
+  while (c >= '0' && c <= '9') { v = v * 10 + (c - '0'); read(); c = timedPeek(); }
+  return neg ? -v : v;
+}
+
+/* ---------------- ESP ---------------- */
+static uint32_t minFreeHeap = UINT32_MAX;
+
+uint32_t EspClass::getHeapSize() {
+#if defined(ESP8266)
+  return (uint32_t)hostEnvLong("HOST_HEAP_BYTES", 81920);
+#else
+  return (uint32_t)hostEnvLong("HOST_HEAP_BYTES", 327680);
+#endif
+}
+
+// the board's heap less what this process has allocated since main() started
+static size_t heapBase = 0;
+uint32_t EspClass::getFreeHeap() {
+  struct mallinfo2 mi = mallinfo2();
+  size_t used = mi.uordblks > heapBase ? mi.uordblks - heapBase : 0;
+  uint32_t size = getHeapSize();
+  uint32_t free = used < size ? (uint32_t)(size - used) : 0;
+  if (free < minFreeHeap) minFreeHeap = free;
+  return free;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  getFreeHeap();
+  return minFreeHeap;
+}
+
+uint32_t EspClass::getCycleCount() {
+#if defined(ESP8266)
+  return (uint32_t)(micros() * 80ull);
+#else
+  return (uint32_t)(micros() * 240ull);
+#endif
+}
+
+static void hostExit(int code);
+void EspClass::restart() { hostExit(0); }
+void EspClass::deepSleep(uint64_t us) { hostSleepVirtualUs(us); hostExit(0); }
+
+/* ---------------- FreeRTOS ---------------- */
+static std::mutex criticalMu;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+  std::thread t(fn, arg);
+  if (handle) *handle = (TaskHandle_t)(uintptr_t)t.native_handle();
+  t.detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t prio, TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+BaseType_t xPortGetCoreID() { return 1; }
+
+void vTaskDelayUntil(TickType_t* previous, TickType_t period) {
+  TickType_t due = *previous + period;
+  TickType_t now = xTaskGetTickCount();
+  if ((int32_t)(due - now) > 0) delay(due - now);
+  *previous = due;
+}
+
+void portENTER_CRITICAL(portMUX_TYPE*) { criticalMu.lock(); }
+void portEXIT_CRITICAL(portMUX_TYPE*) { criticalMu.unlock(); }
+
+/* ---------------- EEPROM, LittleFS ---------------- */
+void EEPROMClass::begin(size_t size) {
+  data_.assign(size, 0xFF);   // erased flash
+  FILE* f = fopen(hostEnv("HOST_EEPROM", "host-eeprom.bin"), "rb");
+  if (f) {
+    size_t n = fread(data_.data(), 1, size, f);
+    (void)n;
+    fclose(f);
+  }
+  dirty_ = false;
+}
+
+bool EEPROMClass::commit() {
+  if (!dirty_ || data_.empty()) return true;
+  FILE* f = fopen(hostEnv("HOST_EEPROM", "host-eeprom.bin"), "wb");
+  if (!f) return false;
+  bool ok = fwrite(data_.data(), 1, data_.size(), f) == data_.size();
+  fclose(f);
+  dirty_ = !ok;
+  return ok;
+}
+
+size_t File::size() {
+  if (!f_) return 0;
+  struct stat st;
+  return fstat(fileno(f_.get()), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+int File::available() {
+  if (!f_) return 0;
+  long pos = ftell(f_.get());
+  long n = (long)size() - pos;
+  return n > 0 ? (int)n : 0;
+}
+
+int File::peek() {
+  if (!f_) return -1;
+  int c = fgetc(f_.get());
+  if (c >= 0) ungetc(c, f_.get());
+  return c;
+}
+
+bool FS::begin(bool formatOnFail, const char*, uint8_t, const char*) {
+  dir_ = hostEnv("HOST_FS_DIR", "host-fs");
+  struct stat st;
+  if (stat(dir_.c_str(), &st) == 0) return S_ISDIR(st.st_mode);
+  return formatOnFail && mkdir(dir_.c_str(), 0755) == 0;
+}
+
+bool FS::format() {
+  std::string cmd = "rm -rf '" + dir_ + "' && mkdir -p '" + dir_ + "'";
+  return system(cmd.c_str()) == 0;
+}
+
+bool FS::exists(const char* p) {
+  struct stat st;
+  return stat(path(p).c_str(), &st) == 0;
+}
+
+File FS::open(const char* p, const char* mode) {
+  std::string m = mode[0] == 'r' ? "rb" : mode[0] == 'a' ? "ab" : "wb";
+  FILE* f = fopen(path(p).c_str(), m.c_str());
+  return f ? File(f) : File();
+}
+
+bool FS::remove(const char* p) { return ::remove(path(p).c_str()) == 0; }
+bool FS::rename(const char* from, const char* to) { return ::rename(path(from).c_str(), path(to).c_str()) == 0; }
+
+/* ---------------- LCD ---------------- */
+static std::vector<HostLcd*>& panels() {
+  static std::vector<HostLcd*> p;
+  return p;
+}
+
+HostLcd::HostLcd(uint8_t cols, uint8_t rows) {
+  size(cols, rows);
+  panels().push_back(this);
+}
+
+HostLcd::~HostLcd() { panels().erase(std::remove(panels().begin(), panels().end(), this), panels().end()); }
+
+void HostLcd::size(uint8_t cols, uint8_t rows) {
+  cols_ = cols;
+  rows_ = rows;
+  text_.assign(rows, std::string(cols, ' '));
+  col_ = row_ = 0;
+}
+
+void HostLcd::clear() {
+  for (auto& r : text_) r.assign(cols_, ' ');
+  col_ = row_ = 0;
+  writes_++;
+  changed_ = true;
+}
+
+void HostLcd::setCursor(uint8_t col, uint8_t row) {
+  col_ = col;
+  row_ = row < rows_ ? row : rows_ - 1;
+  writes_++;
+}
+
+// characters past the last column go to DDRAM that is not shown
+size_t HostLcd::write(uint8_t c) {
+  writes_++;
+  if (row_ < rows_ && col_ < cols_ && text_[row_][col_] != (char)c) {
+    text_[row_][col_] = (char)c;
+    changed_ = true;
+  }
+  col_++;
+  return 1;
+}
+
+void hostLcdPoll() {
+  static const bool show = hostEnvLong("HOST_LCD", 0) != 0;
+  for (HostLcd* p : panels()) {
+    if (!p->takeChanged() || !show) continue;
+    printf("+--------------------+ %s t=%lu writes=%lu\n", hostIp(), millis(), p->writes());
+    for (int r = 0; r < 4; r++) printf("|%-20.20s|\n", p->row(r).c_str());
+    printf("+--------------------+\n");
+  }
+}
+
+/* ---------------- main ---------------- */
+static volatile sig_atomic_t stopSignal = 0;
+static void onSignal(int) { stopSignal = 1; }
+
+// peak RSS of this image: VmHWM starts over at exec, ru_maxrss would include the launcher
+static long peakRssKb() {
+  long kb = -1;
+  FILE* f = fopen("/proc/self/status", "r");
+  if (!f) return kb;
+  char line[128];
+  while (fgets(line, sizeof(line), f))
+    if (sscanf(line, "VmHWM: %ld", &kb) == 1) break;
+  fclose(f);
+  return kb;
+}
+
+static void hostExit(int code) {
+  rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  double cpuS = ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+  fflush(stdout);
+  printf("{\"host\":\"exit\",\"ip\":\"%s\",\"sketch_ms\":%lu,\"cpu_s\":%.3f,\"max_rss_kb\":%ld,\"min_free_heap\":%lu,\"heap_size\":%lu}\n",
+         hostIp(), millis(), cpuS, peakRssKb(), (unsigned long)ESP.getMinFreeHeap(), (unsigned long)ESP.getHeapSize());
+  fflush(stdout);
+  _exit(code);
+}
+
+int main() {
+  setvbuf(stdout, nullptr, _IOLBF, 1 << 16);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+  heapBase = mallinfo2().uordblks;
+  const long loopUs = hostEnvLong("HOST_LOOP_US", 1000);
+  const long runMs = hostEnvLong("HOST_RUN_MS", 0);
+  setup();
+  while (!stopSignal && (runMs <= 0 || millis() < (unsigned long)runMs)) {
+    loop();
+    hostLcdPoll();
+    ESP.getFreeHeap();
+    if (loopUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(loopUs));
+  }
+  hostExit(0);
+}
@@ -0,0 +1,43 @@
+/*
+  host.h
+  - What the host stand-ins share with each other (not for sketches):
+    environment, the clock, the address book
+*/
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// HOST_* environment variables, with a default
+const char* hostEnv(const char* name, const char* dflt);
+long hostEnvLong(const char* name, long dflt);
+double hostEnvDouble(const char* name, double dflt);
+
+// the sketch's clock runs HOST_CLOCK_SCALE times real time; these convert
+uint64_t hostRealUs();                      // monotonic, shared by all processes on the machine
+double hostScale();
+void hostSleepVirtualUs(uint64_t us);       // sleep for this much sketch time
+long hostRealMs(unsigned long virtualMs);   // a sketch timeout as a real one
+
+// where a board address lands on this machine: the local port that plays
+// host:port (HOST_ROUTES="192.168.4.1=18080,192.168.1.50:80=18080"), or -1
+// if nothing answers there
+int hostRoute(const std::string& host, uint16_t port);
+
+// this board's identity
+const char* hostIp();                       // HOST_IP
+void hostMac(uint8_t mac[6]);               // HOST_MAC, or one made from the pid
+
+// UDP "air" shared by the ESP-NOW and LoRa stand-ins: a socket on the first
+// free port of [base, base + span), frames go to every other port of the range
+struct HostAir {
+  int fd = -1;
+  int port = 0;
+  int base = 0, span = 0;
+  bool open(int base, int span);
+  void broadcast(const void* data, int len);
+  int receive(void* buf, int cap);           // non-blocking; 0 = nothing
+};
+
+// called once per loop() by main(): LCD stand-ins print their panel if it changed
+void hostLcdPoll();
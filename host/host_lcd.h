@@ -0,0 +1,38 @@
+/*
+  host_lcd.h (host)
+  - A character LCD kept in memory, for the LiquidCrystal_I2C and
+    hd44780_I2Cexp stand-ins: cursor, DDRAM as rows of text, and a count of
+    the writes that reached it (what lcd_shadow.h saves)
+  - With HOST_LCD=1, main() prints the panel after any loop() that changed it
+*/
+#pragma once
+
+#include "Arduino.h"
+#include <string>
+#include <vector>
+
+class HostLcd : public Print {
+public:
+  HostLcd(uint8_t cols = 20, uint8_t rows = 4);
+  ~HostLcd();
+  void size(uint8_t cols, uint8_t rows);
+  void clear();
+  void home() { setCursor(0, 0); }
+  void setCursor(uint8_t col, uint8_t row);
+  void backlight() {}
+  void noBacklight() {}
+  void display() {}
+  void noDisplay() {}
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  const std::string& row(int r) const { return text_[r]; }
+  unsigned long writes() const { return writes_; }
+  bool takeChanged() { bool c = changed_; changed_ = false; return c; }
+
+private:
+  uint8_t cols_, rows_, col_ = 0, row_ = 0;
+  std::vector<std::string> text_;
+  unsigned long writes_ = 0;
+  bool changed_ = false;
+};
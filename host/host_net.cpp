@@ -0,0 +1,887 @@
+/*
+  host_net.cpp
+  - WiFi, HTTP, UDP and ESP-NOW for the host build (see host.cpp). All of
+    it is loopback: board addresses are mapped to local ports by
+    HOST_ROUTES, and ESP-NOW is a UDP "air" every board on the machine
+    shares (ports HOST_ESPNOW_PORT .. +63, default 47000)
+  - Timeouts the sketch passes are sketch time, converted to real time with
+    HOST_CLOCK_SCALE
+*/
+
+#include "Arduino.h"
+#include "host.h"
+#include "WiFi.h"
+#include "WiFiUdp.h"
+#include "WebServer.h"
+#include "HTTPClient.h"
+#include "mqtt_client.h"
+#if defined(ESP8266)
+#include "espnow.h"
+#else
+#include "esp_now.h"
+#endif
+#include <mutex>
+#include <set>
+#include <thread>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiClass WiFi;
+
+static sockaddr_in loopback(int port) {
+  sockaddr_in a;
+  memset(&a, 0, sizeof(a));
+  a.sin_family = AF_INET;
+  a.sin_port = htons((uint16_t)port);
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  return a;
+}
+
+static int realWaitMs(unsigned long sketchMs) {
+  long ms = hostRealMs(sketchMs);
+  return ms > 0 ? (int)ms : (sketchMs ? 1 : 0);
+}
+
+/* ---------------- address book ---------------- */
+int hostRoute(const std::string& host, uint16_t port) {
+  if (host == "127.0.0.1" || host == "localhost") return port;
+  std::string key = host + ":" + std::to_string(port);
+  std::string routes = hostEnv("HOST_ROUTES", "");
+  int hostOnly = -1;
+  size_t at = 0;
+  while (at < routes.size()) {
+    size_t end = routes.find(',', at);
+    if (end == std::string::npos) end = routes.size();
+    std::string entry = routes.substr(at, end - at);
+    size_t eq = entry.find('=');
+    if (eq != std::string::npos) {
+      std::string from = entry.substr(0, eq);
+      int to = atoi(entry.c_str() + eq + 1);
+      if (from == key) return to;
+      if (from == host) hostOnly = to;
+    }
+    at = end + 1;
+  }
+  return hostOnly;
+}
+
+/* ---------------- air ---------------- */
+bool HostAir::open(int b, int n) {
+  base = b;
+  span = n;
+  for (int p = base; p < base + span; p++) {
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in a = loopback(p);
+    if (bind(s, (sockaddr*)&a, sizeof(a)) == 0) {
+      fcntl(s, F_SETFL, O_NONBLOCK);
+      fd = s;
+      port = p;
+      return true;
+    }
+    ::close(s);
+  }
+  return false;
+}
+
+void HostAir::broadcast(const void* data, int len) {
+  for (int p = base; p < base + span; p++) {
+    if (p == port) continue;
+    sockaddr_in a = loopback(p);
+    sendto(fd, data, len, 0, (sockaddr*)&a, sizeof(a));
+  }
+}
+
+int HostAir::receive(void* buf, int cap) {
+  int n = (int)recv(fd, buf, cap, MSG_DONTWAIT);
+  return n > 0 ? n : 0;
+}
+
+/* ---------------- WiFiClient ---------------- */
+struct HostSocket {
+  int fd = -1;
+  IPAddress remote;
+  std::string in;
+  size_t pos = 0;
+  bool eof = false;
+  ~HostSocket() { close(); }
+  void close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+  }
+};
+
+WiFiClient::WiFiClient() {}
+
+WiFiClient WiFiClient::adopt(int fd, IPAddress remote) {
+  WiFiClient c;
+  c.sock_ = std::make_shared<HostSocket>();
+  c.sock_->fd = fd;
+  c.sock_->remote = remote;
+  return c;
+}
+
+void WiFiClient::setRemoteIP(IPAddress remote) { if (sock_) sock_->remote = remote; }
+int WiFiClient::fd() const { return sock_ ? sock_->fd : -1; }
+IPAddress WiFiClient::remoteIP() const { return sock_ ? sock_->remote : IPAddress(); }
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  stop();
+  int local = hostRoute(host, port);
+  if (local < 0) {
+    // nothing plays that address: a dead host, the SYN times out
+    hostSleepVirtualUs((uint64_t)timeoutMs * 1000u);
+    return 0;
+  }
+  int s = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  fcntl(s, F_SETFL, O_NONBLOCK);
+  sockaddr_in a = loopback(local);
+  int r = ::connect(s, (sockaddr*)&a, sizeof(a));
+  if (r != 0 && errno == EINPROGRESS) {
+    pollfd p = { s, POLLOUT, 0 };
+    int err = 0;
+    socklen_t el = sizeof(err);
+    if (poll(&p, 1, realWaitMs(timeoutMs)) == 1 && getsockopt(s, SOL_SOCKET, SO_ERROR, &err, &el) == 0 && err == 0) r = 0;
+  }
+  if (r != 0) {
+    ::close(s);
+    return 0;
+  }
+  fcntl(s, F_SETFL, 0);
+  IPAddress ip;
+  ip.fromString(host);
+  *this = adopt(s, ip);
+  return 1;
+}
+
+bool WiFiClient::fill(int waitMs) {
+  if (!sock_ || sock_->fd < 0 || sock_->eof) return false;
+  if (sock_->pos == sock_->in.size()) {
+    sock_->in.clear();
+    sock_->pos = 0;
+  }
+  if (waitMs > 0) {
+    pollfd p = { sock_->fd, POLLIN, 0 };
+    if (poll(&p, 1, waitMs) <= 0) return false;
+  }
+  char buf[4096];
+  ssize_t n = recv(sock_->fd, buf, sizeof(buf), MSG_DONTWAIT);
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    sock_->eof = true;
+    return false;
+  }
+  if (n < 0) return false;
+  sock_->in.append(buf, n);
+  return true;
+}
+
+uint8_t WiFiClient::connected() {
+  if (!sock_ || sock_->fd < 0) return 0;
+  if (sock_->pos < sock_->in.size()) return 1;
+  fill(0);
+  return sock_->pos < sock_->in.size() || !sock_->eof;
+}
+
+void WiFiClient::stop() {
+  if (sock_) sock_->close();
+  sock_.reset();
+}
+
+int WiFiClient::available() {
+  if (!sock_) return 0;
+  while (fill(0)) {}
+  return (int)(sock_->in.size() - sock_->pos);
+}
+
+int WiFiClient::read() {
+  if (!sock_) return -1;
+  if (sock_->pos == sock_->in.size()) fill(0);
+  return sock_->pos < sock_->in.size() ? (uint8_t)sock_->in[sock_->pos++] : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t n) {
+  if (!sock_) return -1;
+  if (sock_->pos == sock_->in.size()) fill(0);
+  size_t k = std::min(n, sock_->in.size() - sock_->pos);
+  memcpy(buf, sock_->in.data() + sock_->pos, k);
+  sock_->pos += k;
+  return (int)k;
+}
+
+int WiFiClient::peek() {
+  if (!sock_) return -1;
+  if (sock_->pos == sock_->in.size()) fill(0);
+  return sock_->pos < sock_->in.size() ? (uint8_t)sock_->in[sock_->pos] : -1;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t n) {
+  if (!sock_ || sock_->fd < 0) return 0;
+  size_t k = 0;
+  while (k < n) {
+    ssize_t w = send(sock_->fd, buf + k, n - k, MSG_NOSIGNAL);
+    if (w <= 0) break;
+    k += w;
+  }
+  return k;
+}
+
+/* ---------------- WiFiClass ---------------- */
+wl_status_t WiFiClass::begin(const char* ssid, const char*, int32_t channel, const uint8_t*, bool connect) {
+  ssid_ = ssid ? ssid : "";
+  if (channel) channel_ = channel;
+  if (mode_ == WIFI_OFF || mode_ == WIFI_AP) mode_ = mode_ == WIFI_AP ? WIFI_AP_STA : WIFI_STA;
+  joining_ = connect;
+  joinAt_ = millis() + hostEnvLong("HOST_WIFI_JOIN_MS", 300);
+  return status();
+}
+
+wl_status_t WiFiClass::status() {
+  if (!joining_ || ssid_.empty()) return WL_DISCONNECTED;
+  return (long)(millis() - joinAt_) >= 0 ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool) {
+  joining_ = false;
+  if (wifioff) mode_ = WIFI_OFF;
+  return true;
+}
+
+bool WiFiClass::reconnect() {
+  if (ssid_.empty()) return false;
+  joining_ = true;
+  joinAt_ = millis() + hostEnvLong("HOST_WIFI_JOIN_MS", 300);
+  return true;
+}
+
+bool WiFiClass::config(IPAddress local, IPAddress, IPAddress, IPAddress, IPAddress) {
+  staIp_ = local;
+  staIpSet_ = (uint32_t)local != 0;
+  return true;
+}
+
+bool WiFiClass::softAP(const char* ssid, const char*, int channel, int, int) {
+  if (!ssid || !*ssid) return false;
+  mode_ = mode_ == WIFI_STA || mode_ == WIFI_AP_STA ? WIFI_AP_STA : WIFI_AP;
+  channel_ = channel;
+  return true;
+}
+
+bool WiFiClass::softAPConfig(IPAddress local, IPAddress, IPAddress) {
+  apIp_ = local;
+  apIpSet_ = true;
+  return true;
+}
+
+IPAddress WiFiClass::softAPIP() {
+  if (apIpSet_) return apIp_;
+  IPAddress ip;
+  ip.fromString(hostEnv("HOST_AP_IP", "192.168.4.1"));
+  return ip;
+}
+
+IPAddress WiFiClass::localIP() {
+  if (status() != WL_CONNECTED) return IPAddress();
+  if (staIpSet_) return staIp_;
+  IPAddress ip;
+  ip.fromString(hostIp());
+  return ip;
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+  hostMac(mac);
+  return mac;
+}
+
+String WiFiClass::macAddress() {
+  uint8_t m[6];
+  char s[18];
+  hostMac(m);
+  snprintf(s, sizeof(s), "%02X:%02X:%02X:%02X:%02X:%02X", m[0], m[1], m[2], m[3], m[4], m[5]);
+  return String(s);
+}
+
+String WiFiClass::softAPmacAddress() {
+  uint8_t m[6];
+  char s[18];
+  hostMac(m);
+  m[5]++;   // the cores derive the AP's MAC from the station's
+  snprintf(s, sizeof(s), "%02X:%02X:%02X:%02X:%02X:%02X", m[0], m[1], m[2], m[3], m[4], m[5]);
+  return String(s);
+}
+
+int8_t WiFiClass::RSSI() { return status() == WL_CONNECTED ? (int8_t)hostEnvLong("HOST_RSSI", -55) : 0; }
+
+/* ---------------- WiFiUDP ---------------- */
+uint8_t WiFiUDP::begin(uint16_t port) {
+  stop();
+  int p = (int)hostEnvLong("HOST_UDP_PORT", port);
+  fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in a = loopback(p);
+  if (bind(fd_, (sockaddr*)&a, sizeof(a)) != 0) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+void WiFiUDP::stop() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+}
+
+int WiFiUDP::parsePacket() {
+  in_.clear();
+  pos_ = 0;
+  if (fd_ < 0) return 0;
+  uint8_t buf[1500];
+  sockaddr_in from;
+  socklen_t fl = sizeof(from);
+  ssize_t n = recvfrom(fd_, buf, sizeof(buf), MSG_DONTWAIT, (sockaddr*)&from, &fl);
+  if (n <= 0) return 0;
+  in_.assign(buf, buf + n);
+  remoteIp_ = IPAddress(127, 0, 0, 1);
+  remotePort_ = ntohs(from.sin_port);
+  return (int)n;
+}
+
+int WiFiUDP::read(uint8_t* buf, size_t n) {
+  size_t k = std::min(n, in_.size() - pos_);
+  memcpy(buf, in_.data() + pos_, k);
+  pos_ += k;
+  return (int)k;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) { return beginPacket(ip.toString().c_str(), port); }
+
+int WiFiUDP::beginPacket(const char* host, uint16_t port) {
+  out_.clear();
+  outPort_ = hostRoute(host, port);
+  return 1;   // UDP: an address nobody plays just loses the datagram
+}
+
+int WiFiUDP::endPacket() {
+  if (outPort_ < 0) return 1;
+  if (fd_ < 0) fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in a = loopback(outPort_);
+  return sendto(fd_, out_.data(), out_.size(), 0, (sockaddr*)&a, sizeof(a)) == (ssize_t)out_.size();
+}
+
+/* ---------------- WebServer ---------------- */
+static std::string lower(std::string s) {
+  for (char& c : s) c = tolower((unsigned char)c);
+  return s;
+}
+
+static std::string urlDecode(const std::string& s) {
+  std::string out;
+  for (size_t i = 0; i < s.size(); i++) {
+    if (s[i] == '+') out += ' ';
+    else if (s[i] == '%' && i + 2 < s.size()) {
+      out += (char)strtol(s.substr(i + 1, 2).c_str(), nullptr, 16);
+      i += 2;
+    } else out += s[i];
+  }
+  return out;
+}
+
+static const char* reason(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+WebServer::~WebServer() { close(); }
+
+void WebServer::begin() {
+  close();
+  int port = (int)hostEnvLong("HOST_HTTP_PORT", port_);
+  listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in a = loopback(port);
+  if (bind(listenFd_, (sockaddr*)&a, sizeof(a)) != 0 || listen(listenFd_, 64) != 0) {
+    fprintf(stderr, "host: WebServer cannot listen on %d: %s\n", port, strerror(errno));
+    ::close(listenFd_);
+    listenFd_ = -1;
+    return;
+  }
+  fcntl(listenFd_, F_SETFL, O_NONBLOCK);
+}
+
+void WebServer::close() {
+  if (listenFd_ >= 0) ::close(listenFd_);
+  listenFd_ = -1;
+  conns_.clear();
+}
+
+void WebServer::collectHeaders(const char* names[], size_t count) {
+  collect_.clear();
+  for (size_t i = 0; i < count; i++) collect_.push_back(lower(names[i]));
+}
+
+void WebServer::handleClient() {
+  if (listenFd_ < 0) return;
+  for (;;) {
+    int fd = accept(listenFd_, nullptr, nullptr);
+    if (fd < 0) break;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    conns_.push_back({ WiFiClient::adopt(fd, IPAddress(127, 0, 0, 1)), std::string() });
+  }
+  // one request per call, taken round robin so a busy keep-alive client
+  // does not starve the others
+  static size_t next = 0;
+  for (size_t k = 0; k < conns_.size(); k++) {
+    size_t i = (next + k) % conns_.size();
+    Conn& c = conns_[i];
+    char buf[4096];
+    while (c.client.available()) {
+      int n = c.client.read((uint8_t*)buf, sizeof(buf));
+      if (n <= 0) break;
+      c.in.append(buf, n);
+    }
+    if (parse(c)) {
+      next = i + 1;
+      dispatch();
+      if (!keepAlive_) c.client.stop();
+      client_ = WiFiClient();
+      break;
+    }
+  }
+  conns_.erase(std::remove_if(conns_.begin(), conns_.end(), [](Conn& c) { return !c.client.connected() && c.in.empty(); }),
+               conns_.end());
+}
+
+bool WebServer::parse(Conn& c) {
+  size_t headEnd = c.in.find("\r\n\r\n");
+  if (headEnd == std::string::npos) return false;
+  std::string head = c.in.substr(0, headEnd);
+  std::vector<std::pair<std::string, std::string>> headers;
+  size_t contentLength = 0;
+  size_t lineEnd = head.find("\r\n");
+  std::string requestLine = head.substr(0, lineEnd);
+  size_t at = lineEnd == std::string::npos ? head.size() : lineEnd + 2;
+  while (at < head.size()) {
+    size_t e = head.find("\r\n", at);
+    if (e == std::string::npos) e = head.size();
+    std::string line = head.substr(at, e - at);
+    size_t colon = line.find(':');
+    if (colon != std::string::npos) {
+      std::string v = line.substr(colon + 1);
+      v.erase(0, v.find_first_not_of(' '));
+      headers.push_back({ lower(line.substr(0, colon)), v });
+      if (headers.back().first == "content-length") contentLength = strtoul(v.c_str(), nullptr, 10);
+    }
+    at = e + 2;
+  }
+  if (c.in.size() < headEnd + 4 + contentLength) return false;   // body still arriving
+  std::string body = c.in.substr(headEnd + 4, contentLength);
+  c.in.erase(0, headEnd + 4 + contentLength);
+
+  char method[16] = "", target[1024] = "", version[16] = "";
+  sscanf(requestLine.c_str(), "%15s %1023s %15s", method, target, version);
+  std::string m = method;
+  method_ = m == "GET" ? HTTP_GET : m == "POST" ? HTTP_POST : m == "PUT" ? HTTP_PUT : m == "DELETE" ? HTTP_DELETE
+          : m == "PATCH" ? HTTP_PATCH : m == "HEAD" ? HTTP_HEAD : m == "OPTIONS" ? HTTP_OPTIONS : HTTP_ANY;
+  std::string t = target;
+  size_t q = t.find('?');
+  uri_ = urlDecode(t.substr(0, q));
+  args_.clear();
+  if (q != std::string::npos) parseArgs(t.substr(q + 1));
+  headers_ = headers;
+  http10_ = strcmp(version, "HTTP/1.0") == 0;
+  std::string conn = lower(header("Connection").c_str());
+  keepAlive_ = http10_ ? conn == "keep-alive" : conn != "close";
+  std::string type;
+  for (auto& h : headers) if (h.first == "content-type") type = lower(h.second);
+  if (!body.empty()) {
+    if (type.find("application/x-www-form-urlencoded") != std::string::npos) parseArgs(body);
+    else args_.push_back({ "plain", body });
+  }
+  client_ = c.client;
+  IPAddress remote(127, 0, 0, 1);
+  for (auto& h : headers) if (h.first == "x-host-ip") remote.fromString(h.second.c_str());
+  client_.setRemoteIP(remote);
+  outHeaders_.clear();
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+  chunked_ = sent_ = false;
+  return true;
+}
+
+void WebServer::parseArgs(const std::string& s) {
+  size_t at = 0;
+  while (at <= s.size()) {
+    size_t e = s.find('&', at);
+    if (e == std::string::npos) e = s.size();
+    std::string kv = s.substr(at, e - at);
+    if (!kv.empty()) {
+      size_t eq = kv.find('=');
+      args_.push_back({ urlDecode(kv.substr(0, eq)), eq == std::string::npos ? std::string() : urlDecode(kv.substr(eq + 1)) });
+    }
+    at = e + 1;
+  }
+}
+
+void WebServer::dispatch() {
+  for (auto& r : routes_) {
+    if (r.uri == uri_ && (r.method == HTTP_ANY || r.method == method_)) {
+      r.fn();
+      return;
+    }
+  }
+  if (notFound_) notFound_();
+  else send(404, "text/plain", "Not found");
+}
+
+String WebServer::arg(const String& name) const {
+  for (auto& a : args_) if (a.first == name.c_str()) return String(a.second.c_str());
+  return String();
+}
+
+bool WebServer::hasArg(const String& name) const {
+  for (auto& a : args_) if (a.first == name.c_str()) return true;
+  return false;
+}
+
+// like the board, only headers named in collectHeaders() are kept
+String WebServer::header(const String& name) const {
+  std::string n = lower(name.c_str());
+  bool wanted = n == "connection" || std::find(collect_.begin(), collect_.end(), n) != collect_.end();
+  if (!wanted) return String();
+  for (auto& h : headers_) if (h.first == n) return String(h.second.c_str());
+  return String();
+}
+
+bool WebServer::hasHeader(const String& name) const { return header(name).length() > 0; }
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+  std::string line = std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+  outHeaders_ = first ? line + outHeaders_ : outHeaders_ + line;
+}
+
+void WebServer::writeHead(int code, const char* type, size_t len) {
+  std::string h = "HTTP/1.1 " + std::to_string(code) + " " + reason(code) + "\r\n";
+  if (type && *type) h += std::string("Content-Type: ") + type + "\r\n";
+  if (len == CONTENT_LENGTH_UNKNOWN) {
+    if (http10_) keepAlive_ = false;
+    else { h += "Transfer-Encoding: chunked\r\n"; chunked_ = true; }
+  } else {
+    h += "Content-Length: " + std::to_string(len) + "\r\n";
+  }
+  h += outHeaders_;
+  h += keepAlive_ ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+  client_.write((const uint8_t*)h.data(), h.size());
+  outHeaders_.clear();
+  sent_ = true;
+}
+
+void WebServer::send(int code, const char* type, const String& content) {
+  sendBody(code, type, content.c_str(), content.length());
+}
+
+void WebServer::sendBody(int code, const char* type, const char* data, size_t len) {
+  if (contentLength_ == CONTENT_LENGTH_UNKNOWN) {
+    writeHead(code, type, CONTENT_LENGTH_UNKNOWN);
+    if (len) sendContent(data, len);
+  } else {
+    writeHead(code, type, contentLength_ != CONTENT_LENGTH_NOT_SET ? contentLength_ : len);
+    if (method_ != HTTP_HEAD && len) client_.write((const uint8_t*)data, len);
+  }
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+}
+
+void WebServer::sendContent(const char* data, size_t len) {
+  if (!chunked_) {
+    client_.write((const uint8_t*)data, len);
+    return;
+  }
+  char size[16];
+  int n = snprintf(size, sizeof(size), "%zx\r\n", len);
+  client_.write((const uint8_t*)size, n);
+  if (len) client_.write((const uint8_t*)data, len);
+  client_.write((const uint8_t*)"\r\n", 2);
+  if (len == 0) chunked_ = false;   // the empty chunk ends the response
+}
+
+/* ---------------- HTTPClient ---------------- */
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+  std::string u = url.c_str();
+  if (u.compare(0, 7, "http://") != 0) return false;
+  u = u.substr(7);
+  size_t slash = u.find('/');
+  std::string hostPort = u.substr(0, slash);
+  std::string uri = slash == std::string::npos ? "/" : u.substr(slash);
+  size_t colon = hostPort.find(':');
+  uint16_t port = colon == std::string::npos ? 80 : (uint16_t)atoi(hostPort.c_str() + colon + 1);
+  return begin(client, hostPort.substr(0, colon).c_str(), port, uri.c_str());
+}
+
+bool HTTPClient::begin(WiFiClient& client, const char* host, uint16_t port, const char* uri) {
+  if (client_ && client_ != &client) client_->stop();
+  client_ = &client;
+  host_ = host;
+  port_ = port;
+  uri_ = uri;
+  extraHeaders_.clear();
+  headers_.clear();
+  size_ = -1;
+  return true;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+  extraHeaders_ += std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+}
+
+void HTTPClient::collectHeaders(const char* names[], size_t count) {
+  collect_.clear();
+  for (size_t i = 0; i < count; i++) collect_.push_back(lower(names[i]));
+}
+
+String HTTPClient::header(const char* name) {
+  std::string n = lower(name);
+  for (auto& h : headers_) if (h.first == n) return String(h.second.c_str());
+  return String();
+}
+
+bool HTTPClient::readLine(std::string& line) {
+  line.clear();
+  unsigned long t0 = millis();
+  for (;;) {
+    int c = client_->read();
+    if (c < 0) {
+      if (!client_->connected() || millis() - t0 >= timeoutMs_) return false;
+      pollfd p = { client_->fd(), POLLIN, 0 };
+      poll(&p, 1, 1);
+      continue;
+    }
+    if (c == '\n') return true;
+    if (c != '\r') line += (char)c;
+  }
+}
+
+int HTTPClient::sendRequest(const char* method, const uint8_t* body, size_t len) {
+  if (!client_) return HTTPC_ERROR_NOT_CONNECTED;
+  std::string target = host_ + ":" + std::to_string(port_);
+  if (!(canReuse_ && connectedTo_ == target && client_->connected())) {
+    client_->stop();
+    if (!client_->connect(host_.c_str(), port_, connectTimeoutMs_)) return HTTPC_ERROR_CONNECTION_REFUSED;
+    connectedTo_ = target;
+  }
+  std::string req = std::string(method) + " " + uri_ + (http10_ ? " HTTP/1.0\r\n" : " HTTP/1.1\r\n");
+  req += "Host: " + host_ + "\r\nUser-Agent: ESP32HTTPClient\r\n";
+  req += reuse_ && !http10_ ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+  req += std::string("X-Host-IP: ") + hostIp() + "\r\n";
+  req += extraHeaders_;
+  if (body || strcmp(method, "POST") == 0) req += "Content-Length: " + std::to_string(len) + "\r\n";
+  req += "\r\n";
+  if (client_->write((const uint8_t*)req.data(), req.size()) != req.size()) return HTTPC_ERROR_SEND_HEADER_FAILED;
+  if (len && client_->write(body, len) != len) return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+
+  std::string line;
+  if (!readLine(line)) {
+    client_->stop();
+    canReuse_ = false;
+    return client_->connected() ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+  }
+  int code = 0;
+  if (sscanf(line.c_str(), "HTTP/%*s %d", &code) != 1) {
+    client_->stop();
+    canReuse_ = false;
+    return HTTPC_ERROR_NO_HTTP_SERVER;
+  }
+  size_ = -1;
+  chunked_ = false;
+  canReuse_ = reuse_ && !http10_;
+  headers_.clear();
+  while (readLine(line) && !line.empty()) {
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    std::string name = lower(line.substr(0, colon)), v = line.substr(colon + 1);
+    v.erase(0, v.find_first_not_of(' '));
+    if (name == "content-length") size_ = atoi(v.c_str());
+    else if (name == "transfer-encoding" && lower(v) == "chunked") chunked_ = true;
+    else if (name == "connection" && lower(v) == "close") canReuse_ = false;
+    if (std::find(collect_.begin(), collect_.end(), name) != collect_.end()) headers_.push_back({ name, v });
+  }
+  return code;
+}
+
+String HTTPClient::getString() {
+  std::string out;
+  char buf[1024];
+  if (chunked_) {
+    std::string line;
+    while (readLine(line)) {
+      long n = strtol(line.c_str(), nullptr, 16);
+      if (n <= 0) { readLine(line); break; }
+      while (n > 0) {
+        client_->setTimeout(timeoutMs_);
+        size_t k = client_->readBytes(buf, std::min<long>(n, sizeof(buf)));
+        if (k == 0) return String(out);
+        out.append(buf, k);
+        n -= k;
+      }
+      readLine(line);
+    }
+  } else {
+    client_->setTimeout(timeoutMs_);
+    long left = size_ >= 0 ? size_ : LONG_MAX;
+    while (left > 0) {
+      size_t k = client_->readBytes(buf, std::min<long>(left, sizeof(buf)));
+      if (k == 0) break;
+      out.append(buf, k);
+      left -= k;
+    }
+    if (size_ < 0) canReuse_ = false;   // read to close
+  }
+  return String(out);
+}
+
+// as in the cores: bytes already here are dropped, the rest stays on a kept socket
+void HTTPClient::end() {
+  if (!client_) return;
+  if (canReuse_ && client_->connected()) {
+    while (client_->available() > 0) client_->read();
+  } else {
+    client_->stop();
+    canReuse_ = false;
+  }
+}
+
+String HTTPClient::errorToString(int code) {
+  switch (code) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+    case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+    case HTTPC_ERROR_NO_STREAM: return "no stream";
+    case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+    case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+    case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+    case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+    case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+    default: return String();
+  }
+}
+
+/* ---------------- ESP-NOW ---------------- */
+// on the air: dst MAC, src MAC, WiFi channel, payload
+static HostAir espNowAir;
+static std::mutex espNowMu;
+static std::set<uint64_t> espNowPeers;
+static void (*espNowRecv)(const uint8_t* mac, const uint8_t* data, int len);
+
+static uint64_t macKey(const uint8_t* m) {
+  uint64_t k = 0;
+  for (int i = 0; i < 6; i++) k = k << 8 | m[i];
+  return k;
+}
+
+static int espNowStart() {
+  if (espNowAir.fd >= 0) return 0;
+  if (!espNowAir.open((int)hostEnvLong("HOST_ESPNOW_PORT", 47000), 64)) return -1;
+  std::thread([] {
+    uint8_t self[6], buf[13 + 250];
+    hostMac(self);
+    for (;;) {
+      pollfd p = { espNowAir.fd, POLLIN, 0 };
+      if (poll(&p, 1, 50) <= 0) continue;
+      int n = espNowAir.receive(buf, sizeof(buf));
+      if (n <= 13 || buf[12] != (uint8_t)WiFi.channel()) continue;
+      static const uint8_t bcast[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+      if (memcmp(buf, self, 6) != 0 && memcmp(buf, bcast, 6) != 0) continue;
+      if (espNowRecv) espNowRecv(buf + 6, buf + 13, n - 13);
+    }
+  }).detach();
+  return 0;
+}
+
+static int espNowTransmit(const uint8_t* mac, const uint8_t* data, size_t len) {
+  if (espNowAir.fd < 0) return -1;
+  if (len > 250) return -2;
+  {
+    std::lock_guard<std::mutex> g(espNowMu);
+    if (!espNowPeers.count(macKey(mac))) return -3;
+  }
+  uint8_t frame[13 + 250];
+  memcpy(frame, mac, 6);
+  hostMac(frame + 6);
+  frame[12] = (uint8_t)WiFi.channel();
+  memcpy(frame + 13, data, len);
+  espNowAir.broadcast(frame, 13 + (int)len);
+  return 0;
+}
+
+static void espNowPeer(const uint8_t* mac, bool add) {
+  std::lock_guard<std::mutex> g(espNowMu);
+  if (add) espNowPeers.insert(macKey(mac));
+  else espNowPeers.erase(macKey(mac));
+}
+
+static bool espNowHasPeer(const uint8_t* mac) {
+  std::lock_guard<std::mutex> g(espNowMu);
+  return espNowPeers.count(macKey(mac)) != 0;
+}
+
+#if defined(ESP8266)
+static esp_now_recv_cb_t espNowUserCb;
+int esp_now_init() { return espNowStart(); }
+int esp_now_deinit() { return 0; }
+int esp_now_set_self_role(u8) { return 0; }
+int esp_now_register_recv_cb(esp_now_recv_cb_t cb) {
+  espNowUserCb = cb;
+  espNowRecv = [](const uint8_t* mac, const uint8_t* data, int len) { espNowUserCb((u8*)mac, (u8*)data, (u8)len); };
+  return 0;
+}
+int esp_now_register_send_cb(esp_now_send_cb_t) { return 0; }
+int esp_now_add_peer(u8* mac, u8, u8, u8*, u8) { espNowPeer(mac, true); return 0; }
+int esp_now_del_peer(u8* mac) { espNowPeer(mac, false); return 0; }
+int esp_now_is_peer_exist(u8* mac) { return espNowHasPeer(mac); }
+int esp_now_send(u8* mac, u8* data, int len) { return espNowTransmit(mac, data, len) == 0 ? 0 : -1; }
+bool wifi_set_channel(uint8_t channel) { WiFi.setChannel(channel); return true; }
+#else
+esp_err_t esp_now_init() { return espNowStart() == 0 ? ESP_OK : ESP_FAIL; }
+esp_err_t esp_now_deinit() { return ESP_OK; }
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) { espNowRecv = cb; return ESP_OK; }
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t) { return ESP_OK; }
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t* peer) {
+  if (espNowHasPeer(peer->peer_addr)) return ESP_ERR_ESPNOW_EXIST;
+  espNowPeer(peer->peer_addr, true);
+  return ESP_OK;
+}
+esp_err_t esp_now_del_peer(const uint8_t* mac) { espNowPeer(mac, false); return ESP_OK; }
+bool esp_now_is_peer_exist(const uint8_t* mac) { return espNowHasPeer(mac); }
+esp_err_t esp_now_send(const uint8_t* mac, const uint8_t* data, size_t len) {
+  int r = espNowTransmit(mac, data, len);
+  return r == 0 ? ESP_OK : r == -1 ? ESP_ERR_ESPNOW_NOT_INIT : ESP_ERR_ESPNOW_ARG;
+}
+#endif
+
+/* ---------------- esp-mqtt: no broker ---------------- */
+struct esp_mqtt_client { int unused; };
+static esp_mqtt_client mqttOnly;
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t*) { return &mqttOnly; }
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t, esp_mqtt_event_id_t, esp_event_handler_t, void*) { return ESP_OK; }
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t) { return ESP_OK; }
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t) { return ESP_OK; }
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t, const char*, const char*, int, int, int) { return -1; }
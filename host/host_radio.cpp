@@ -0,0 +1,146 @@
+/*
+  host_radio.cpp
+  - The LoRa air for the host build (see host.cpp): every radio binds a
+    port in HOST_LORA_PORT .. +31 (default 47100) and a transmission is
+    sent to all of them when it starts, stamped with its start on the
+    shared monotonic clock, its airtime (lora/lora_adr.h), SF and power
+  - A receiver keeps what it heard for a few seconds and hands a packet to
+    parsePacket() once its airtime is over, unless:
+      it was on another SF, or was transmitting at any point of it
+      another packet on the same SF overlapped it and was not 6 dB weaker (capture)
+      its SNR is under the SF's demodulation floor (loraSnrFloorDb)
+      HOST_LORA_LOSS_PCT says so
+  - Link budget: rssi = txPower - HOST_LORA_LOSS_DB (path loss from this
+    radio to the other side, default 55) of both ends, over a -117 dBm
+    noise floor, with HOST_LORA_FADE_DB of gaussian fading per packet
+*/
+
+#include "Arduino.h"
+#include "host.h"
+#include "LoRa.h"
+#include "../lora/lora_adr.h"
+#include <chrono>
+#include <deque>
+#include <random>
+#include <thread>
+
+LoRaClass LoRa;
+
+namespace {
+
+const float NOISE_FLOOR_DBM = -117.0f;   // 125 kHz, 6 dB NF
+const uint32_t AIR_MAGIC = 0x4C6F5261;   // 'LoRa'
+
+#pragma pack(push, 1)
+struct AirHeader {
+  uint32_t magic;
+  uint64_t startUs;    // real, hostRealUs()
+  uint32_t airUs;      // real
+  uint8_t sf;
+  int8_t power;
+  float lossDb;        // the transmitter's share of the path loss
+};
+#pragma pack(pop)
+
+struct Heard {
+  uint64_t startUs, endUs;
+  uint8_t sf;
+  float rssi;
+  std::vector<uint8_t> payload;
+  bool done = false;
+};
+
+HostAir air;
+std::deque<Heard> heard;
+std::deque<std::pair<uint64_t, uint64_t>> ownTx;   // our own transmissions, real us
+std::mt19937 fadeRng(12345);
+
+float lossDb() {
+  static const float l = (float)hostEnvDouble("HOST_LORA_LOSS_DB", 55);
+  return l;
+}
+
+void drain() {
+  uint8_t buf[sizeof(AirHeader) + 256];
+  for (int n; (n = air.receive(buf, sizeof(buf))) > 0;) {
+    if (n < (int)sizeof(AirHeader)) continue;
+    AirHeader h;
+    memcpy(&h, buf, sizeof(h));
+    if (h.magic != AIR_MAGIC) continue;
+    static const float fade = (float)hostEnvDouble("HOST_LORA_FADE_DB", 0);
+    std::normal_distribution<float> f(0, fade > 0 ? fade : 1e-6f);
+    Heard p;
+    p.startUs = h.startUs;
+    p.endUs = h.startUs + h.airUs;
+    p.sf = h.sf;
+    p.rssi = h.power - h.lossDb - lossDb() + f(fadeRng);
+    p.payload.assign(buf + sizeof(h), buf + n);
+    heard.push_back(p);
+  }
+  // history is only needed for overlap checks
+  uint64_t now = hostRealUs();
+  while (!heard.empty() && heard.front().done && heard.front().endUs + 5000000 < now) heard.pop_front();
+  while (!ownTx.empty() && ownTx.front().second + 5000000 < now) ownTx.pop_front();
+}
+
+bool overlaps(uint64_t a0, uint64_t a1, uint64_t b0, uint64_t b1) { return a0 < b1 && b0 < a1; }
+
+bool receivable(const Heard& p, int sf) {
+  if (p.sf != sf) return false;
+  for (auto& t : ownTx) if (overlaps(p.startUs, p.endUs, t.first, t.second)) return false;
+  for (auto& o : heard)
+    if (&o != &p && o.sf == p.sf && overlaps(p.startUs, p.endUs, o.startUs, o.endUs) && o.rssi > p.rssi - 6) return false;
+  if (p.rssi - NOISE_FLOOR_DBM < loraSnrFloorDb(p.sf)) return false;
+  static const double lossPct = hostEnvDouble("HOST_LORA_LOSS_PCT", 0);
+  return !(lossPct > 0 && random(10000) < (long)(lossPct * 100));
+}
+
+}  // namespace
+
+int LoRaClass::begin(long) {
+  return air.open((int)hostEnvLong("HOST_LORA_PORT", 47100), 32) ? 1 : 0;
+}
+
+size_t LoRaClass::write(const uint8_t* buf, size_t n) {
+  size_t k = std::min(n, (size_t)255 - out_.size());
+  out_.insert(out_.end(), buf, buf + k);
+  return k;
+}
+
+int LoRaClass::endPacket(bool) {
+  uint32_t airUs = (uint32_t)(loraAirtimeUs((uint8_t)sf_, bw_, (uint8_t)cr_, (int)out_.size()) / hostScale());
+  AirHeader h = { AIR_MAGIC, hostRealUs(), airUs, (uint8_t)sf_, (int8_t)power_, lossDb() };
+  uint8_t frame[sizeof(AirHeader) + 256];
+  memcpy(frame, &h, sizeof(h));
+  memcpy(frame + sizeof(h), out_.data(), out_.size());
+  air.broadcast(frame, (int)(sizeof(h) + out_.size()));
+  ownTx.push_back({ h.startUs, h.startUs + airUs });
+  std::this_thread::sleep_for(std::chrono::microseconds(airUs));
+  out_.clear();
+  return 1;
+}
+
+int LoRaClass::parsePacket(int) {
+  drain();
+  uint64_t now = hostRealUs();
+  for (auto& p : heard) {
+    if (p.done || p.endUs > now) continue;
+    p.done = true;
+    if (!receivable(p, sf_)) continue;
+    in_ = p.payload;
+    pos_ = 0;
+    rssi_ = (int)lroundf(p.rssi);
+    snr_ = roundf((p.rssi - NOISE_FLOOR_DBM) * 4) / 4;
+    return (int)in_.size();
+  }
+  return 0;
+}
+
+int LoRaClass::rssi() {
+  drain();
+  uint64_t now = hostRealUs();
+  float best = NOISE_FLOOR_DBM;
+  for (auto& p : heard)
+    if (p.startUs <= now && now < p.endUs && p.rssi > best) best = p.rssi;
+  return (int)lroundf(best);
+}
@@ -0,0 +1,38 @@
+/*
+  mqtt_client.h (host)
+  - esp-mqtt with no broker: the client starts, never connects, and
+    publish() returns -1 (tools/mqtt_egress_bench.cpp covers the egress
+    queue on its own)
+*/
+#pragma once
+
+#include "esp_wifi.h"
+
+typedef struct esp_mqtt_client* esp_mqtt_client_handle_t;
+
+typedef enum {
+  MQTT_EVENT_ANY = -1,
+  MQTT_EVENT_ERROR = 0,
+  MQTT_EVENT_CONNECTED,
+  MQTT_EVENT_DISCONNECTED,
+  MQTT_EVENT_SUBSCRIBED,
+  MQTT_EVENT_UNSUBSCRIBED,
+  MQTT_EVENT_PUBLISHED,
+  MQTT_EVENT_DATA,
+} esp_mqtt_event_id_t;
+
+typedef struct {
+  const char* uri;
+  const char* client_id;
+  const char* username;
+  const char* password;
+  int keepalive;
+} esp_mqtt_client_config_t;
+
+typedef void (*esp_event_handler_t)(void* arg, esp_event_base_t base, int32_t id, void* data);
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t* cfg);
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t c, esp_mqtt_event_id_t id, esp_event_handler_t fn, void* arg);
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t c);
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t c);
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t c, const char* topic, const char* data, int len, int qos, int retain);
@@ -0,0 +1,79 @@
+/*
+  lora_adr.h
+  - Adaptive data rate for the sender -> receiver LoRa link
+  - Receiver: adrDecide() spends SNR margin above the SF's demodulation
+    floor (minus an installation margin) on a lower SF first (shorter time
+    on air), then on less TX power; a deficit is made up with power first,
+    then a higher SF. The result goes back in the downlink window
+  - Sender: AdrSender counts uplinks without any downlink. After
+    ADR_ACK_LIMIT it asks for an answer (LORA_FLAG_ADR_ACK_REQ); after
+    ADR_ACK_DELAY more it falls back to LORA_SF_FALLBACK at full power.
+    The receiver falls back to the same SF when it hears nothing, so the
+    two always meet again
+  - loraAirtimeUs(): SX127x time on air (Semtech AN1200.13)
+*/
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+const uint8_t ADR_SF_MIN = 7;
+const uint8_t ADR_SF_MAX = 12;
+const uint8_t LORA_SF_FALLBACK = 12;   // boot and rendezvous SF: slowest, hears everything
+const int8_t ADR_POWER_MIN = 2;        // dBm (SX1278 PA_BOOST)
+const int8_t ADR_POWER_MAX = 17;
+const int8_t ADR_POWER_STEP = 3;
+const float ADR_MARGIN_DB = 10.0f;     // kept above the floor for fading
+const float ADR_STEP_DB = 3.0f;        // margin per SF or power step
+const uint8_t ADR_HOLDOFF = 8;         // uplinks measured at new settings before deciding again
+const uint8_t ADR_ACK_LIMIT = 16;      // silent uplinks before the sender asks for a downlink
+const uint8_t ADR_ACK_DELAY = 4;       // further silent uplinks before it falls back
+
+inline float loraSnrFloorDb(uint8_t sf) { return -7.5f - 2.5f * (sf - 7); }
+
+// new sf/power for a link currently at (sf, power) measuring snrDb
+inline void adrDecide(float snrDb, uint8_t& sf, int8_t& power) {
+  int steps = (int)floorf((snrDb - loraSnrFloorDb(sf) - ADR_MARGIN_DB) / ADR_STEP_DB);
+  while (steps > 0 && sf > ADR_SF_MIN) { sf--; steps--; }
+  while (steps > 0 && power - ADR_POWER_STEP >= ADR_POWER_MIN) { power -= ADR_POWER_STEP; steps--; }
+  while (steps < 0 && power + ADR_POWER_STEP <= ADR_POWER_MAX) { power += ADR_POWER_STEP; steps++; }
+  while (steps < 0 && sf < ADR_SF_MAX) { sf++; steps++; }
+}
+
+struct AdrSender {
+  uint8_t sf;
+  int8_t power;
+  uint8_t silent;     // uplinks since the last downlink
+};
+
+inline void adrInit(AdrSender& a) { a.sf = LORA_SF_FALLBACK; a.power = ADR_POWER_MAX; a.silent = 0; }
+
+inline bool adrWantAck(const AdrSender& a) { return a.silent >= ADR_ACK_LIMIT; }
+
+inline void adrOnDownlink(AdrSender& a, uint8_t sf, int8_t power) {
+  a.silent = 0;
+  if (sf >= ADR_SF_MIN && sf <= ADR_SF_MAX) a.sf = sf;
+  if (power >= ADR_POWER_MIN && power <= ADR_POWER_MAX) a.power = power;
+}
+
+// no downlink after an uplink; true if the settings changed (fell back)
+inline bool adrOnSilence(AdrSender& a) {
+  if (a.silent < 255) a.silent++;
+  if (a.silent < ADR_ACK_LIMIT + ADR_ACK_DELAY) return false;
+  bool changed = a.sf != LORA_SF_FALLBACK || a.power != ADR_POWER_MAX;
+  a.sf = LORA_SF_FALLBACK;
+  a.power = ADR_POWER_MAX;
+  a.silent = ADR_ACK_LIMIT;  // keep asking until someone answers
+  return changed;
+}
+
+// time on air of one explicit-header, CRC-on packet, in us
+inline uint32_t loraAirtimeUs(uint8_t sf, long bwHz, uint8_t cr, int payloadLen, int preamble = 8) {
+  float tSym = (float)(1ul << sf) * 1e6f / (float)bwHz;
+  int de = tSym > 16000.0f ? 1 : 0;  // low data rate optimize (SF11/12 at 125 kHz)
+  int num = 8 * payloadLen - 4 * sf + 28 + 16;
+  int den = 4 * (sf - 2 * de);
+  int n = num > 0 ? (num + den - 1) / den : 0;
+  float symbols = preamble + 4.25f + 8 + n * cr;
+  return (uint32_t)(symbols * tSym);
+}
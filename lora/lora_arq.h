@@ -0,0 +1,28 @@
+/*
+  lora_arq.h
+  - Acknowledged uplinks: the sender sets LORA_FLAG_ACK_REQ and the
+    receiver's downlink (lora_adr.h's window) doubles as the ACK for the
+    seq it echoes
+  - Lost ACK -> retransmit the same frame (same seq, receiver dedups) after
+    a randomized, exponentially growing backoff, at most ARQ_MAX_RETRIES
+  - Airtime aware: a retry is only sent if it (backoff + time on air +
+    ACK window) finishes before the next reading is due; otherwise the
+    next frame supersedes the lost one and the retry is skipped
+*/
+#pragma once
+
+#include <stdint.h>
+
+const uint8_t ARQ_MAX_RETRIES = 3;
+const unsigned long ARQ_BACKOFF_MS = 200;   // first retry waits 100..300 ms, then doubles
+
+// wait before retry number attempt+1 (attempt 0 = the first transmission failed); r is any random value
+inline unsigned long arqBackoffMs(uint8_t attempt, uint32_t r) {
+  unsigned long span = ARQ_BACKOFF_MS << attempt;
+  return span / 2 + r % span;
+}
+
+// true if a retry costing costMs, started after backoffMs, ends before nextDueMs
+inline bool arqRetryFits(unsigned long nowMs, unsigned long nextDueMs, unsigned long backoffMs, unsigned long costMs) {
+  return (long)(nextDueMs - (nowMs + backoffMs + costMs)) > 0;
+}
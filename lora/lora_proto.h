@@ -0,0 +1,77 @@
+/*
+  lora_proto.h
+  - Over-the-air frames shared by lora/sender.c, lora/relay.c and lora/reciever.c
+  - Every frame starts with LoraHeader: magic + version reject foreign or
+    stale-format packets, nodeId tells senders apart, seq (16-bit, wraps)
+    lets the receiver count lost frames
+  - Uplink (sender -> receiver): header + tank readings; sf/txPower are the
+    settings the frame was sent with
+  - Downlink (receiver -> sender, LORA_FLAG_DOWNLINK): header only, sent in
+    the window after an uplink; seq echoes that uplink (= ACK), sf/txPower
+    are the settings the sender should use from its next uplink on
+  - Relayed (lora/relay.c, LORA_FLAG_AGGREGATE): header of the relay's own
+    uplink, a count, then one LoraAggEntry per forwarded origin frame:
+    its node, seq, hop count and readings in per mille. Names (16 bytes a
+    tank, most of a full frame) only ride along when the entry has
+    LORA_AGG_NAMES set, so one packet carries up to LORA_AGG_MAX origins
+  - Packed so both ends agree on the layout byte for byte
+*/
+#pragma once
+
+#include <stdint.h>
+
+const uint8_t LORA_MAGIC = 0x57;    // 'W'
+const uint8_t LORA_VERSION = 2;
+const int LORA_TANKS = 6;
+
+// radio settings both ends share; SF and TX power are adapted at run time (lora_adr.h)
+const long LORA_BW_HZ = 125000;
+const uint8_t LORA_CR = 5;          // coding rate 4/5
+
+enum LoraFlag : uint8_t {
+  LORA_FLAG_DOWNLINK = 1 << 0,
+  LORA_FLAG_ADR_ACK_REQ = 1 << 1,   // uplink: sender has heard nothing for a while, please answer
+  LORA_FLAG_ACK_REQ = 1 << 2,       // uplink: acknowledged mode, answer this seq (lora_arq.h)
+  LORA_FLAG_AGGREGATE = 1 << 3,     // uplink from a relay: LoraAggEntry list instead of TankData
+};
+
+struct __attribute__((packed)) LoraHeader {
+  uint8_t magic;
+  uint8_t version;
+  uint8_t nodeId;
+  uint8_t flags;      // LoraFlag bits
+  uint16_t seq;
+  uint8_t sf;         // spreading factor 7..12
+  int8_t txPower;     // dBm
+};
+
+const int LORA_NAME_LEN = 16;
+
+struct __attribute__((packed)) TankData { char name[LORA_NAME_LEN]; float levelPercent; };
+
+struct __attribute__((packed)) StructMessage {
+  LoraHeader hdr;
+  TankData tanks[LORA_TANKS];
+};
+
+const int LORA_MAX_PAYLOAD = 255;   // SX127x FIFO
+const uint16_t LORA_NO_ECHO = 0xFFFF;
+const uint8_t LORA_AGG_NAMES = 0x80;   // in LoraAggEntry::hops: LORA_TANKS names follow the entry
+const uint8_t LORA_AGG_HOPS = 0x7F;
+
+struct __attribute__((packed)) LoraAggEntry {
+  uint8_t origin;     // sensor node id
+  uint8_t hops;       // relays passed so far | LORA_AGG_NAMES
+  uint16_t seq;       // the sensor's own seq
+  uint16_t permille[LORA_TANKS];   // LORA_NO_ECHO for a failed reading
+};
+
+const int LORA_AGG_MAX = (LORA_MAX_PAYLOAD - (int)sizeof(LoraHeader) - 1) / (int)sizeof(LoraAggEntry);
+
+inline uint16_t loraPermille(float percent) {
+  if (percent < 0) return LORA_NO_ECHO;
+  if (percent > 100.0f) percent = 100.0f;
+  return (uint16_t)(percent * 10.0f + 0.5f);
+}
+
+inline float loraPercent(uint16_t permille) { return permille == LORA_NO_ECHO ? -1.0f : permille / 10.0f; }
@@ -0,0 +1,109 @@
+/*
+  lora_relay.h
+  - Forwarding rules of lora/relay.c, free of radio calls so
+    tools/relay_sim.cpp runs the same code
+  - RelayDedup: the last RELAY_DEDUP (origin, seq) pairs taken in; a
+    reading heard twice (a retransmit, or through two relays) goes out once
+  - RelayAgg: the aggregate being built this relay cycle (lora_proto.h
+    layout). A newer reading from an origin already in it replaces the old
+    one in place: only the latest level matters
+  - relayBackoffMs(): random wait between closing a cycle and sending, drawn
+    again while the channel is busy, so relays whose cycles line up don't
+    collide every time
+*/
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "lora_proto.h"
+
+const uint8_t RELAY_MAX_HOPS = 3;              // relays a reading may pass on its way to the receiver
+const int RELAY_DEDUP = 64;
+const unsigned long RELAY_CYCLE_MS = 4000;     // one aggregate per cycle; sensors report every ~4.4 s
+const unsigned long RELAY_BACKOFF_MS = 400;    // then 0..this of random backoff
+const unsigned long RELAY_NAMES_MS = 600000;   // repeat an origin's tank names this often
+
+struct RelayDedup {
+  uint8_t origin[RELAY_DEDUP];
+  uint16_t seq[RELAY_DEDUP];
+  uint8_t next;
+  uint8_t count;
+};
+
+inline void relayDedupReset(RelayDedup& d) { d.next = 0; d.count = 0; }
+
+// true if (origin, seq) was seen before; remembers it otherwise
+inline bool relaySeen(RelayDedup& d, uint8_t origin, uint16_t seq) {
+  for (int i = 0; i < d.count; i++) if (d.origin[i] == origin && d.seq[i] == seq) return true;
+  d.origin[d.next] = origin;
+  d.seq[d.next] = seq;
+  d.next = (d.next + 1) % RELAY_DEDUP;
+  if (d.count < RELAY_DEDUP) d.count++;
+  return false;
+}
+
+inline unsigned long relayBackoffMs(uint32_t r) { return r % (RELAY_BACKOFF_MS + 1); }
+
+struct RelayAgg {
+  uint8_t buf[LORA_MAX_PAYLOAD];
+  int len;
+};
+
+const int AGG_FIRST = sizeof(LoraHeader) + 1;   // after the header and the count byte
+const int AGG_NAMES_LEN = LORA_TANKS * LORA_NAME_LEN;
+
+inline LoraHeader& aggHeader(RelayAgg& a) { return *(LoraHeader*)a.buf; }
+inline uint8_t aggCount(const RelayAgg& a) { return a.buf[sizeof(LoraHeader)]; }
+
+inline void aggReset(RelayAgg& a, uint8_t relayId) {
+  LoraHeader& h = aggHeader(a);
+  h.magic = LORA_MAGIC;
+  h.version = LORA_VERSION;
+  h.nodeId = relayId;
+  h.flags = LORA_FLAG_AGGREGATE;
+  h.seq = 0;
+  h.sf = 0;
+  h.txPower = 0;
+  a.buf[sizeof(LoraHeader)] = 0;
+  a.len = AGG_FIRST;
+}
+
+// walk a received aggregate: start at AGG_FIRST; returns the offset of the
+// next entry, -1 at the end or on a truncated frame. names = LORA_TANKS
+// names of LORA_NAME_LEN bytes, or nullptr
+inline int aggNext(const uint8_t* buf, int len, int off, LoraAggEntry& e, const char*& names) {
+  if (off + (int)sizeof(e) > len) return -1;
+  memcpy(&e, buf + off, sizeof(e));
+  off += sizeof(e);
+  names = nullptr;
+  if (e.hops & LORA_AGG_NAMES) {
+    if (off + AGG_NAMES_LEN > len) return -1;
+    names = (const char*)buf + off;
+    off += AGG_NAMES_LEN;
+  }
+  return off;
+}
+
+// add (or supersede) an origin's reading; names may be nullptr. false if
+// the frame is full. namesIn tells whether the names are in the frame now
+inline bool aggAdd(RelayAgg& a, LoraAggEntry e, const char* names, bool* namesIn = nullptr) {
+  e.hops = (e.hops & LORA_AGG_HOPS) | (names ? LORA_AGG_NAMES : 0);
+  LoraAggEntry old;
+  const char* oldNames;
+  for (int off = AGG_FIRST, next; (next = aggNext(a.buf, a.len, off, old, oldNames)) > 0; off = next) {
+    if (old.origin != e.origin) continue;
+    if (namesIn) *namesIn = oldNames != nullptr;
+    if ((uint16_t)(e.seq - old.seq) >= 0x8000) return true;  // what we hold is newer
+    e.hops = (e.hops & LORA_AGG_HOPS) | (old.hops & LORA_AGG_NAMES);  // keep the entry's layout
+    memcpy(a.buf + off, &e, sizeof(e));
+    return true;
+  }
+  int need = sizeof(e) + (names ? AGG_NAMES_LEN : 0);
+  if (a.len + need > LORA_MAX_PAYLOAD || aggCount(a) == 255) return false;
+  memcpy(a.buf + a.len, &e, sizeof(e));
+  if (names) memcpy(a.buf + a.len + sizeof(e), names, AGG_NAMES_LEN);
+  a.len += need;
+  a.buf[sizeof(LoraHeader)]++;
+  if (namesIn) *namesIn = names != nullptr;
+  return true;
+}
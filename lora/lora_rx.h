@@ -0,0 +1,184 @@
+/*
+  lora_rx.h
+  - Receiving end of a LoRa hop, shared by lora/reciever.c and lora/relay.c:
+    per-sender link stats (RSSI/SNR, loss from seq gaps), dedup by
+    (node, seq), the ADR decision and its answer (= ACK) in the sender's
+    downlink window
+  - One radio listens on one SF (radioSf); answers move it to what the
+    sender was told, rxTick() returns it to LORA_SF_FALLBACK when nothing
+    has been heard for RX_FALLBACK_MS
+  - Nodes whose readings also arrive through a relay (rxAcceptRelayed) are
+    not answered when heard directly: the relay serving them does that, two
+    answers in the same window would collide
+*/
+#pragma once
+
+#include <LoRa.h>
+#include "../common/link_stats.h"
+#include "../common/log_ring.h"
+#include "lora_proto.h"
+#include "lora_adr.h"
+
+const int MAX_NODES = 24;                     // senders tracked (direct and relayed)
+const unsigned long ADR_REPLY_DELAY_MS = 20;  // let the sender turn its radio to RX
+const unsigned long RX_FALLBACK_MS = 60000;   // nothing heard this long: back to the rendezvous SF
+const unsigned long NODE_ACTIVE_MS = 60000;   // nodes heard within this share the radio's SF
+
+// Per-sender link quality and ADR state
+struct Node {
+  bool used;
+  uint8_t id;
+  LinkStats link;
+  uint8_t sf;          // settings of its last uplink
+  int8_t power;
+  uint8_t holdoff;     // uplinks to measure before the next ADR decision
+  uint8_t cmdSf;       // what the last answer told it (repeated when a retransmit shows the ACK was lost)
+  int8_t cmdPower;
+  uint8_t hops;        // relays its last reading passed (0 = heard directly)
+  unsigned long lastHeardMs;   // last direct uplink
+  unsigned long viaRelayMs;    // last reading through a relay (0 = never)
+};
+
+struct LoraRx {
+  Node nodes[MAX_NODES];
+  uint8_t radioSf;
+  unsigned long lastUplinkMs;
+};
+
+inline void rxInit(LoraRx& r) {
+  for (int i = 0; i < MAX_NODES; i++) r.nodes[i].used = false;
+  r.radioSf = LORA_SF_FALLBACK;
+  r.lastUplinkMs = 0;
+}
+
+inline Node* rxFindNode(LoraRx& r, uint8_t id) {
+  for (int i = 0; i < MAX_NODES; i++) if (r.nodes[i].used && r.nodes[i].id == id) return &r.nodes[i];
+  return nullptr;
+}
+
+inline Node* rxNodeFor(LoraRx& r, uint8_t id) {
+  Node* n = rxFindNode(r, id);
+  if (n) return n;
+  for (int i = 0; i < MAX_NODES && !n; i++) if (!r.nodes[i].used) n = &r.nodes[i];
+  if (!n) return nullptr;
+  n->used = true;
+  n->id = id;
+  linkReset(n->link);
+  n->sf = r.radioSf;
+  n->power = ADR_POWER_MAX;
+  n->holdoff = ADR_HOLDOFF;
+  n->cmdSf = r.radioSf;
+  n->cmdPower = ADR_POWER_MAX;
+  n->hops = 0;
+  n->lastHeardMs = 0;
+  n->viaRelayMs = 0;
+  return n;
+}
+
+inline bool rxViaRelay(const Node& n, unsigned long now) { return n.viaRelayMs && now - n.viaRelayMs < NODE_ACTIVE_MS; }
+
+inline int rxActiveNodes(const LoraRx& r, unsigned long now) {
+  int c = 0;
+  for (int i = 0; i < MAX_NODES; i++) if (r.nodes[i].used && now - r.nodes[i].lastHeardMs < NODE_ACTIVE_MS) c++;
+  return c;
+}
+
+inline void rxSetSf(LoraRx& r, uint8_t sf) {
+  if (sf == r.radioSf) return;
+  r.radioSf = sf;
+  LoRa.setSpreadingFactor(sf);
+}
+
+// back on our SF after the radio was used for something else (a relay's own uplink)
+inline void rxListen(const LoraRx& r) { LoRa.setSpreadingFactor(r.radioSf); }
+
+// answer in the sender's receive window: header only, sf/txPower = what to use next
+inline void rxSendDownlink(const Node& n, uint16_t seq, uint8_t sf, int8_t power) {
+  LoraHeader d;
+  d.magic = LORA_MAGIC;
+  d.version = LORA_VERSION;
+  d.nodeId = n.id;
+  d.flags = LORA_FLAG_DOWNLINK;
+  d.seq = seq;
+  d.sf = sf;
+  d.txPower = power;
+  delay(ADR_REPLY_DELAY_MS);
+  LoRa.setTxPower(ADR_POWER_MAX);
+  LoRa.beginPacket();
+  LoRa.write((uint8_t*)&d, sizeof(d));
+  LoRa.endPacket();
+}
+
+// after each new uplink: ADR decision, then answer (= ACK) if there is a
+// change to send or the sender asked for one
+inline void rxAnswer(LoraRx& r, Node& n, const LoraHeader& h, unsigned long now) {
+  bool reply = h.flags & (LORA_FLAG_ADR_ACK_REQ | LORA_FLAG_ACK_REQ);
+  uint8_t sf = h.sf;
+  int8_t power = h.txPower;
+  if (n.holdoff) n.holdoff--;
+  else if (n.link.haveSnr) {
+    adrDecide(n.link.snr, sf, power);
+    if (rxActiveNodes(r, now) > 1) sf = h.sf;  // several senders share our one SF; only power is per node
+    if (sf != h.sf || power != h.txPower) {
+      reply = true;
+      n.holdoff = ADR_HOLDOFF;
+      n.link.haveSnr = false;  // measure afresh at the new settings
+      LOGI("ADR node %u: snr %.1f dB, SF%u %d dBm -> SF%u %d dBm", n.id, n.link.snr, h.sf, h.txPower, sf, power);
+    }
+  }
+  n.cmdSf = sf;
+  n.cmdPower = power;
+  if (!reply) return;
+  rxSendDownlink(n, h.seq, sf, power);
+  rxSetSf(r, sf);
+}
+
+// seq already had from this node (retransmit whose ACK was lost, or a stale one)
+inline bool rxDuplicate(const Node& n, uint16_t seq) {
+  if (!n.link.haveSeq) return false;
+  uint16_t gap = seq - (uint16_t)n.link.lastSeq;
+  return gap == 0 || gap >= 0x8000;
+}
+
+// a direct uplink: link stats, ADR and the answer; the node if the frame is
+// new, nullptr for a duplicate (ACKed again) or a full node table
+inline Node* rxAccept(LoraRx& r, const LoraHeader& h, int rssi, float snr, unsigned long now) {
+  r.lastUplinkMs = now;
+  Node* n = rxNodeFor(r, h.nodeId);
+  if (!n) return nullptr;
+  bool relayed = rxViaRelay(*n, now);
+  if (rxDuplicate(*n, h.seq)) {
+    LOGD("LoRa dup node=%u seq=%u", h.nodeId, h.seq);
+    if ((h.flags & LORA_FLAG_ACK_REQ) && !relayed) rxSendDownlink(*n, h.seq, n->cmdSf, n->cmdPower);
+    return nullptr;
+  }
+  linkOnFrame(n->link, h.seq, now, 0xFFFF);
+  linkOnRssi(n->link, rssi);
+  linkOnSnr(n->link, snr);
+  n->sf = h.sf;
+  n->power = h.txPower;
+  n->hops = 0;
+  n->lastHeardMs = now;
+  if (!relayed) rxAnswer(r, *n, h, now);
+  return n;
+}
+
+// a reading forwarded by a relay: end-to-end loss from the origin's seq;
+// nullptr if already had (heard directly or through another relay)
+inline Node* rxAcceptRelayed(LoraRx& r, const LoraAggEntry& e, unsigned long now) {
+  Node* n = rxNodeFor(r, e.origin);
+  if (!n) return nullptr;
+  n->viaRelayMs = now;
+  if (rxDuplicate(*n, e.seq)) return nullptr;
+  linkOnFrame(n->link, e.seq, now, 0xFFFF);
+  n->hops = e.hops & LORA_AGG_HOPS;
+  return n;
+}
+
+// senders fall back to the rendezvous SF when they stop hearing us; meet them there
+inline void rxTick(LoraRx& r, unsigned long now) {
+  if (r.radioSf != LORA_SF_FALLBACK && now - r.lastUplinkMs > RX_FALLBACK_MS) {
+    LOGW("No uplink for %lus, back to SF%u", (now - r.lastUplinkMs) / 1000, LORA_SF_FALLBACK);
+    rxSetSf(r, LORA_SF_FALLBACK);
+  }
+}
@@ -0,0 +1,94 @@
+/*
+  lora_tx.h
+  - Sending end of a LoRa hop, shared by lora/sender.c and lora/relay.c:
+    SF / TX power as the receiver's downlinks set them (lora_adr.h), the
+    downlink window after every uplink, ACK-mode retries (lora_arq.h)
+  - A frame is any buffer that starts with a LoraHeader; magic, version,
+    nodeId and seq are the caller's, flags (ACK bits), sf and txPower are
+    filled in per transmission
+  - The radio is set to this link's SF / power before every uplink, so a
+    relay can listen to its children on another SF in between
+*/
+#pragma once
+
+#include <LoRa.h>
+#include "../common/log_ring.h"
+#include "lora_proto.h"
+#include "lora_adr.h"
+#include "lora_arq.h"
+
+const unsigned long RX_WINDOW_SLACK_MS = 100;  // downlink window = airtime of a header + this
+
+struct LoraTx {
+  AdrSender adr;   // SF / TX power, set by the receiver's downlinks
+  uint16_t seq;
+};
+
+inline void txInit(LoraTx& t) {
+  adrInit(t.adr);
+  t.seq = 0;
+}
+
+inline void txApplyRadioSettings(const LoraTx& t) {
+  LoRa.setSpreadingFactor(t.adr.sf);
+  LoRa.setTxPower(t.adr.power);
+}
+
+inline unsigned long txWindowMs(const LoraTx& t) {
+  return RX_WINDOW_SLACK_MS + loraAirtimeUs(t.adr.sf, LORA_BW_HZ, LORA_CR, sizeof(LoraHeader)) / 1000;
+}
+
+// listen right after an uplink for the receiver's answer
+inline bool txReceiveDownlink(LoraTx& t, uint8_t nodeId, uint16_t seq) {
+  unsigned long windowMs = txWindowMs(t);
+  unsigned long t0 = millis();
+  while (millis() - t0 < windowMs) {
+    int n = LoRa.parsePacket();
+    if (n <= 0) { delay(1); continue; }
+    LoraHeader d;
+    if (n != (int)sizeof(d)) { while (LoRa.available()) LoRa.read(); continue; }
+    LoRa.readBytes((uint8_t*)&d, sizeof(d));
+    if (d.magic != LORA_MAGIC || d.version != LORA_VERSION || !(d.flags & LORA_FLAG_DOWNLINK)) continue;
+    if (d.nodeId != nodeId || d.seq != seq) continue;
+    if (d.sf != t.adr.sf || d.txPower != t.adr.power) LOGI("ADR: SF%u %d dBm -> SF%u %d dBm", t.adr.sf, t.adr.power, d.sf, d.txPower);
+    adrOnDownlink(t.adr, d.sf, d.txPower);
+    return true;
+  }
+  return false;
+}
+
+// one uplink + its downlink window; true if the receiver answered
+inline bool txSendOnce(LoraTx& t, uint8_t* frame, int len, bool ackMode) {
+  LoraHeader* h = (LoraHeader*)frame;
+  h->flags = (h->flags & ~(LORA_FLAG_ADR_ACK_REQ | LORA_FLAG_ACK_REQ)) |
+             (adrWantAck(t.adr) ? LORA_FLAG_ADR_ACK_REQ : 0) | (ackMode ? LORA_FLAG_ACK_REQ : 0);
+  h->sf = t.adr.sf;
+  h->txPower = t.adr.power;
+  txApplyRadioSettings(t);
+  LoRa.beginPacket();
+  LoRa.write(frame, len);
+  LoRa.endPacket(); // returns when the packet is out
+  LOGI("Packet %u sent via LoRa (SF%u, %lu ms on air)", (unsigned)h->seq, t.adr.sf,
+       (unsigned long)(loraAirtimeUs(t.adr.sf, LORA_BW_HZ, LORA_CR, len) / 1000));
+
+  bool answered = txReceiveDownlink(t, h->nodeId, h->seq);
+  if (!answered && adrOnSilence(t.adr)) LOGW("ADR: no downlink for %u uplinks, back to SF%u", t.adr.silent, t.adr.sf);
+  return answered;
+}
+
+// send; in ACK mode retry the same seq with backoff while a retry still
+// finishes before nextDueMs (after that the next frame supersedes this one)
+inline void txSendReliable(LoraTx& t, uint8_t* frame, int len, bool ackMode, unsigned long nextDueMs) {
+  uint16_t seq = ((LoraHeader*)frame)->seq;
+  for (uint8_t attempt = 0; ; ++attempt) {
+    if (txSendOnce(t, frame, len, ackMode) || !ackMode) return;
+    if (attempt >= ARQ_MAX_RETRIES) { LOGW("Packet %u: no ACK after %u tries", (unsigned)seq, attempt + 1); return; }
+    unsigned long backoff = arqBackoffMs(attempt, esp_random());
+    unsigned long cost = loraAirtimeUs(t.adr.sf, LORA_BW_HZ, LORA_CR, len) / 1000 + txWindowMs(t);
+    if (!arqRetryFits(millis(), nextDueMs, backoff, cost)) {
+      LOGD("Packet %u: retry skipped, next reading due first", (unsigned)seq);
+      return;
+    }
+    delay(backoff);
+  }
+}
@@ -4,8 +4,16 @@
 #include <hd44780.h>
 #include <hd44780ioClass/hd44780_I2Cexp.h>
 #include <WiFi.h>  // only used to read MAC address
+#include "../common/lcd_shadow.h"
+
+#define LOG_LEVEL LOG_LEVEL_INFO   // per-packet/per-tank lines are LOG_LEVEL_DEBUG
+#include "../common/log_ring.h"
+#include "lora_proto.h"
+#include "lora_rx.h"
+#include "lora_relay.h"
 
 hd44780_I2Cexp lcd;
+LcdShadow<hd44780_I2Cexp> screen(lcd); // pages are drawn here; flush() sends only changed cells
 
 const long LORA_FREQ = 433E6;   // SX1278 = 433 MHz
 const int ssPin    = 5;         // NSS / CS
@@ -14,49 +22,46 @@ const int dio0Pin  = 26;        // DIO0
 const int LORA_LED = 2;         // ESP32 onboard LED (GPIO2)
 
 // Config
-const int NUM_TANKS = 6;
+const int NUM_TANKS = LORA_TANKS;
+const int NUM_SLOTS = MAX_NODES * NUM_TANKS;   // slot = node index * NUM_TANKS + tank
+static_assert(NUM_SLOTS <= 255, "slot numbers are printed as uint8_t; \"Tank 255 (empty)\" fills an LCD line");
 const unsigned long PAGE_DELAY_MS = 3000;
 const unsigned long STALE_MS = 8000;
 const unsigned long RECENT_MS = 1000;
 
 // Tank storage
 struct Slot { char name[16]; float levelPercent; unsigned long lastUpdate; };
-Slot slots[NUM_TANKS];
+Slot slots[NUM_SLOTS];
 volatile bool anyDataReceived = false;
 unsigned long lastPageMs = 0;
 int currentPage = 0;
 
-// Packet struct (must match sender)
-struct TankData { char name[16]; float levelPercent; };
-struct StructMessage { TankData tanks[NUM_TANKS]; };
+LoraRx rx;   // per-sender link stats, ADR, the radio's SF
 
 // --- Helpers ---
 void initSlots() {
-  for (int i = 0; i < NUM_TANKS; i++) {
+  for (int i = 0; i < NUM_SLOTS; i++) {
     slots[i].name[0] = 0;
     slots[i].levelPercent = -1;
     slots[i].lastUpdate = 0;
   }
+  rxInit(rx);
 }
 void safePrintLine(int row, const char* txt) {
-  lcd.setCursor(0, row);
-  char buf[21]; memset(buf,' ',20); buf[20] = 0;
-  int len = strlen(txt); if (len > 20) len = 20;
-  memcpy(buf, txt, len);
-  lcd.print(buf);
+  screen.printLine(row, txt);
 }
 void showNoDataInfo() {
-  lcd.clear();
+  screen.clear();
   safePrintLine(0, "No Data");
   safePrintLine(1, WiFi.macAddress().c_str());
   char l2[21]; snprintf(l2,sizeof(l2),"LoRa %.0f MHz", (double)LORA_FREQ/1e6);
   safePrintLine(2, l2);
   safePrintLine(3, "Waiting for LoRa...");
+  screen.flush();
 }
-void showTankPage(int idx) {
-  lcd.clear();
+void drawTankPage(int idx) {
   if (slots[idx].name[0] == '\0') {
-    char s[21]; snprintf(s,sizeof(s),"Tank %d (empty)", idx+1);
+    char s[21]; snprintf(s,sizeof(s),"Tank %u (empty)", (uint8_t)(idx+1));
     safePrintLine(0,s);
     safePrintLine(1,"No data received");
     safePrintLine(2,"");
@@ -78,7 +83,17 @@ void showTankPage(int idx) {
   else dtostrf(slots[idx].levelPercent,5,1,pct);
   snprintf(line1,sizeof(line1),"Level: %s %%", pct);
   safePrintLine(1, line1);
-  safePrintLine(2,"");
+  // link: RSSI, SNR, recent loss, sender's SF; relayed: hops and end-to-end loss
+  const Node& n = rx.nodes[idx / NUM_TANKS];
+  char line2[21];
+  if (n.hops) {
+    snprintf(line2, sizeof(line2), "via %u relay%s L%d%%", n.hops, n.hops > 1 ? "s" : "", (int)lroundf(n.link.lossPct));
+    safePrintLine(2, line2);
+  } else if (n.link.haveRssi) {
+    snprintf(line2, sizeof(line2), "%ddBm %.1fdB L%d%% SF%u", (int)lroundf(n.link.rssi), n.link.snr,
+             (int)lroundf(n.link.lossPct), n.sf);
+    safePrintLine(2, line2);
+  } else safePrintLine(2,"");
   char line3[21];
   if (age <= RECENT_MS) snprintf(line3,sizeof(line3),"Updated: <1s ago");
   else {
@@ -88,30 +103,82 @@ void showTankPage(int idx) {
   }
   safePrintLine(3, line3);
 }
+// next slot that has had data (pages skip the empty node x tank slots)
+int nextPage(int idx) {
+  for (int i = 1; i <= NUM_SLOTS; i++) {
+    int p = (idx + i) % NUM_SLOTS;
+    if (slots[p].lastUpdate) return p;
+  }
+  return idx;
+}
+void showTankPage(int idx) {
+  screen.clear();
+  drawTankPage(idx);
+  screen.flush();
+}
 
 // --- LoRa receive ---
+void storeReading(const Node* node, int tank, const char* name, float percent, unsigned long now) {
+  Slot& slot = slots[(node - rx.nodes) * NUM_TANKS + tank];
+  if (name) {
+    strncpy(slot.name, name, sizeof(slot.name));
+    slot.name[sizeof(slot.name)-1]=0;
+  } else if (!slot.name[0]) snprintf(slot.name, sizeof(slot.name), "Node %u T%u", node->id, (uint8_t)(tank + 1));
+  slot.levelPercent = percent;
+  slot.lastUpdate = now;
+  LOGD(" %d) %s = %.1f%%", tank+1, slot.name, slot.levelPercent);
+}
+
 void onLoRaReceivePacket() {
   int packetSize = LoRa.parsePacket();
   if (packetSize <= 0) return;
-  if (packetSize != sizeof(StructMessage)) {
-    Serial.printf("LoRa pkt size mismatch %d != %d\n", packetSize, (int)sizeof(StructMessage));
+  if (packetSize < (int)sizeof(LoraHeader) || packetSize > LORA_MAX_PAYLOAD) {
+    LOGW("LoRa pkt size %d", packetSize);
     while (LoRa.available()) LoRa.read();
     return;
   }
-  StructMessage msg;
-  int idx = 0;
-  uint8_t *buf = (uint8_t*)&msg;
-  while (LoRa.available() && idx < (int)sizeof(msg)) buf[idx++] = (uint8_t)LoRa.read();
-  if (idx != (int)sizeof(msg)) { Serial.println("Read size mismatch"); return; }
+  uint8_t buf[LORA_MAX_PAYLOAD];
+  int len = LoRa.readBytes(buf, packetSize);
+  LoraHeader h;
+  memcpy(&h, buf, sizeof(h));
+  if (h.magic != LORA_MAGIC || h.version != LORA_VERSION) {
+    LOGW("LoRa pkt bad magic/version %02X/%u", h.magic, h.version);
+    return;
+  }
+  if (h.flags & LORA_FLAG_DOWNLINK) return;  // another receiver's answer
+  bool aggregate = h.flags & LORA_FLAG_AGGREGATE;
+  if (!aggregate && len != (int)sizeof(StructMessage)) {
+    LOGW("LoRa pkt size mismatch %d != %d", len, (int)sizeof(StructMessage));
+    return;
+  }
+  int rssi = LoRa.packetRssi();
+  float snr = LoRa.packetSnr();
   unsigned long now = millis();
-  Serial.println("LoRa packet received:");
-  for (int i=0; i<NUM_TANKS; i++) {
-    msg.tanks[i].name[15]=0;
-    strncpy(slots[i].name, msg.tanks[i].name, sizeof(slots[i].name));
-    slots[i].name[sizeof(slots[i].name)-1]=0;
-    slots[i].levelPercent = msg.tanks[i].levelPercent;
-    slots[i].lastUpdate = now;
-    Serial.printf(" %d) %s = %.1f%%\n", i+1, slots[i].name, slots[i].levelPercent);
+  // link stats, ADR and the ACK for whoever sent it (a sensor or a relay); nullptr = duplicate
+  Node* node = rxAccept(rx, h, rssi, snr, now);
+  if (!node) return;
+  LOGD("LoRa packet node=%u seq=%u rssi=%d snr=%.1f:", h.nodeId, h.seq, rssi, snr);
+  if (!aggregate) {
+    StructMessage msg;
+    memcpy(&msg, buf, sizeof(msg));
+    for (int i=0; i<NUM_TANKS; i++) {
+      msg.tanks[i].name[LORA_NAME_LEN-1]=0;
+      storeReading(node, i, msg.tanks[i].name, msg.tanks[i].levelPercent, now);
+    }
+  } else {
+    // a relay's aggregate: readings of the sensors behind it
+    LoraAggEntry e;
+    const char* names;
+    for (int off = AGG_FIRST; (off = aggNext(buf, len, off, e, names)) > 0; ) {
+      Node* origin = rxAcceptRelayed(rx, e, now);
+      if (!origin) continue;
+      LOGD(" origin=%u seq=%u hops=%u", e.origin, e.seq, e.hops & LORA_AGG_HOPS);
+      for (int i = 0; i < NUM_TANKS; i++) {
+        char name[LORA_NAME_LEN];
+        if (names) { memcpy(name, names + i * LORA_NAME_LEN, LORA_NAME_LEN); name[LORA_NAME_LEN-1] = 0; }
+        storeReading(origin, i, names ? name : nullptr, loraPercent(e.permille[i]), now);
+      }
+    }
   }
   anyDataReceived = true;
   // Blink LED on packet received
@@ -123,7 +190,8 @@ void onLoRaReceivePacket() {
 void setup() {
   Serial.begin(115200);
   while(!Serial) delay(10);
-  Serial.println("SX1278 Receiver starting...");
+  logStartDrainTask();
+  LOGI("SX1278 Receiver starting...");
 
   pinMode(LORA_LED, OUTPUT);
 
@@ -131,18 +199,22 @@ void setup() {
   lcd.begin(20,4);
   lcd.backlight();
   lcd.clear();
+  screen.cleared();
 
   initSlots();
 
   // SPI and LoRa init
   SPI.begin(18, 19, 23);
   LoRa.setPins(ssPin, resetPin, dio0Pin);
-  Serial.printf("Init LoRa at %.0f MHz\n", (double)LORA_FREQ/1e6);
+  LOGI("Init LoRa at %.0f MHz", (double)LORA_FREQ/1e6);
   if (!LoRa.begin(LORA_FREQ)) {
-    Serial.println("LoRa init failed - check wiring/freq");
+    LOGE("LoRa init failed - check wiring/freq");
     while(true) delay(1000);
   }
-  Serial.println("LoRa ready (SX1278)");
+  LoRa.setSignalBandwidth(LORA_BW_HZ);
+  LoRa.setCodingRate4(LORA_CR);
+  LoRa.setSpreadingFactor(rx.radioSf);
+  LOGI("LoRa ready (SX1278) SF%u", rx.radioSf);
 
   showNoDataInfo();
   lastPageMs = millis();
@@ -152,6 +224,8 @@ void loop() {
   onLoRaReceivePacket();
   unsigned long now = millis();
 
+  rxTick(rx, now);
+
   if (!anyDataReceived) {
     static unsigned long lastRefresh=0;
     if (now - lastRefresh > 1000) { showNoDataInfo(); lastRefresh = now; }
@@ -159,8 +233,7 @@ void loop() {
   }
 
   if (now - lastPageMs >= PAGE_DELAY_MS) {
-    currentPage++;
-    if (currentPage >= NUM_TANKS) currentPage = 0;
+    currentPage = nextPage(currentPage);
     showTankPage(currentPage);
     lastPageMs = now;
   } else {
@@ -0,0 +1,190 @@
+/* Relay for SX1278 (433 MHz) - extends lora/reciever.c's reach by one hop
+   - Towards its children (sensors or further relays) it is a receiver
+     (lora_rx.h): link stats, dedup, ADR and ACK in their downlink window
+   - Towards its parent (the receiver or a relay closer to it) it is a
+     sender (lora_tx.h): its own node id and seq, ADR, ACK mode
+   - Readings heard in one cycle go up as one aggregate (lora_relay.h):
+     per mille instead of floats, names only every RELAY_NAMES_MS; sent
+     after a random backoff, postponed while the channel is busy
+   - Requires "LoRa" library by Sandeep Mistry, wiring as lora/sender.c
+*/
+
+#include <SPI.h>
+#include <LoRa.h>
+
+#define LOG_LEVEL LOG_LEVEL_INFO   // per-frame lines are LOG_LEVEL_DEBUG
+#include "../common/log_ring.h"
+#include "lora_proto.h"
+#include "lora_rx.h"
+#include "lora_tx.h"
+#include "lora_relay.h"
+
+// ----- LoRa hardware pins (change if your wiring differs) -----
+const long LORA_FREQ = 433E6;   // SX1278 typical frequency
+const int ssPin = 5;            // NSS / CS
+const int resetPin = 14;        // RST
+const int dio0Pin = 26;         // DIO0
+const int LORA_LED = 2;
+
+const uint8_t RELAY_ID = 100;                   // node id towards the parent; unique like any sender's
+const uint8_t RELAY_CHILDREN[] = { 2, 3, 4 };   // senders / relays served here; others belong to someone else
+const bool ACK_MODE = true;                     // ask the parent for an ACK per aggregate and retry
+const int RELAY_BUSY_DBM = -105;                // carrier sense: channel RSSI above this = someone is sending
+const int MAX_ORIGINS = 32;
+
+LoraRx rx;        // children side
+LoraTx tx;        // parent side
+RelayDedup dedup;
+RelayAgg agg;
+unsigned long cycleStartMs = 0;   // first reading of the pending aggregate
+unsigned long sendAtMs = 0;       // cycle end + backoff
+
+// tank names per origin, forwarded every RELAY_NAMES_MS
+struct Origin {
+  uint8_t id;
+  bool haveNames;
+  unsigned long namesSentMs;   // 0 = not yet
+  char names[AGG_NAMES_LEN];
+};
+Origin origins[MAX_ORIGINS];
+int originCount = 0;
+
+bool isChild(uint8_t id) {
+  for (uint8_t c : RELAY_CHILDREN) if (c == id) return true;
+  return false;
+}
+
+Origin* originFor(uint8_t id) {
+  for (int i = 0; i < originCount; i++) if (origins[i].id == id) return &origins[i];
+  if (originCount == MAX_ORIGINS) return nullptr;
+  Origin& o = origins[originCount++];
+  o.id = id;
+  o.haveNames = false;
+  o.namesSentMs = 0;
+  return &o;
+}
+
+// ----- parent side -----
+void forward() {
+  LoraHeader& h = aggHeader(agg);
+  h.seq = tx.seq++;
+  LOGI("Relay: %u readings in one frame (%d bytes)", aggCount(agg), agg.len);
+  txSendReliable(tx, agg.buf, agg.len, ACK_MODE, millis() + RELAY_CYCLE_MS);
+  rxListen(rx);
+  aggReset(agg, RELAY_ID);
+}
+
+void startCycle(unsigned long now) {
+  cycleStartMs = now;
+  sendAtMs = now + RELAY_CYCLE_MS + relayBackoffMs(esp_random());
+}
+
+void queueReading(LoraAggEntry e, unsigned long now) {
+  if (relaySeen(dedup, e.origin, e.seq)) { LOGD("Relay dup origin=%u seq=%u", e.origin, e.seq); return; }
+  Origin* o = originFor(e.origin);
+  const char* names = nullptr;
+  if (o && o->haveNames && (!o->namesSentMs || now - o->namesSentMs >= RELAY_NAMES_MS)) names = o->names;
+  bool namesIn = false;
+  if (!aggCount(agg)) startCycle(now);
+  if (!aggAdd(agg, e, names, &namesIn)) {
+    forward();   // full: send what we have now
+    startCycle(now);
+    aggAdd(agg, e, names, &namesIn);
+  }
+  if (namesIn && o) o->namesSentMs = now | 1;
+}
+
+// ----- children side -----
+void onPacket(int packetSize) {
+  uint8_t buf[LORA_MAX_PAYLOAD];
+  if (packetSize < (int)sizeof(LoraHeader) || packetSize > LORA_MAX_PAYLOAD) {
+    while (LoRa.available()) LoRa.read();
+    return;
+  }
+  int len = LoRa.readBytes(buf, packetSize);
+  LoraHeader h;
+  memcpy(&h, buf, sizeof(h));
+  if (h.magic != LORA_MAGIC || h.version != LORA_VERSION || (h.flags & LORA_FLAG_DOWNLINK)) return;
+  if (!isChild(h.nodeId)) return;   // our parent, a sibling's sensor, ...
+  bool aggregate = h.flags & LORA_FLAG_AGGREGATE;
+  if (!aggregate && len != (int)sizeof(StructMessage)) { LOGW("LoRa pkt size mismatch %d", len); return; }
+
+  unsigned long now = millis();
+  if (!rxAccept(rx, h, LoRa.packetRssi(), LoRa.packetSnr(), now)) return;
+  digitalWrite(LORA_LED, HIGH);
+
+  if (!aggregate) {
+    StructMessage msg;
+    memcpy(&msg, buf, sizeof(msg));
+    LoraAggEntry e;
+    e.origin = h.nodeId;
+    e.hops = 1;
+    e.seq = h.seq;
+    Origin* o = originFor(h.nodeId);
+    for (int i = 0; i < LORA_TANKS; i++) {
+      e.permille[i] = loraPermille(msg.tanks[i].levelPercent);
+      if (!o) continue;
+      msg.tanks[i].name[LORA_NAME_LEN - 1] = 0;
+      if (strncmp(o->names + i * LORA_NAME_LEN, msg.tanks[i].name, LORA_NAME_LEN)) o->namesSentMs = 0;  // renamed: send soon
+      memcpy(o->names + i * LORA_NAME_LEN, msg.tanks[i].name, LORA_NAME_LEN);
+    }
+    if (o) o->haveNames = true;
+    LOGD("Relay: node=%u seq=%u", h.nodeId, h.seq);
+    queueReading(e, now);
+  } else {
+    // a child relay's aggregate: one more hop for each of its readings
+    LoraAggEntry e;
+    const char* names;
+    for (int off = AGG_FIRST; (off = aggNext(buf, len, off, e, names)) > 0; ) {
+      uint8_t hops = e.hops & LORA_AGG_HOPS;
+      if (hops >= RELAY_MAX_HOPS) { LOGW("Relay: origin %u over %u hops, dropped", e.origin, RELAY_MAX_HOPS); continue; }
+      e.hops = hops + 1;
+      Origin* o = names ? originFor(e.origin) : nullptr;
+      if (o) {
+        if (!o->haveNames || memcmp(o->names, names, AGG_NAMES_LEN)) o->namesSentMs = 0;
+        memcpy(o->names, names, AGG_NAMES_LEN);
+        o->haveNames = true;
+      }
+      queueReading(e, now);
+    }
+  }
+  digitalWrite(LORA_LED, LOW);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) delay(10);
+  logStartDrainTask();
+  LOGI("SX1278 Relay %u starting...", RELAY_ID);
+  pinMode(LORA_LED, OUTPUT);
+
+  SPI.begin(18, 19, 23); // SCK, MISO, MOSI
+  LoRa.setPins(ssPin, resetPin, dio0Pin);
+  LOGI("Init LoRa at %.0f MHz ...", (double)LORA_FREQ/1e6);
+  if (!LoRa.begin(LORA_FREQ)) {
+    LOGE("LoRa init failed - check wiring and freq (SX1278 433MHz).");
+    while (true) delay(1000);
+  }
+  LoRa.setSignalBandwidth(LORA_BW_HZ);
+  LoRa.setCodingRate4(LORA_CR);
+  rxInit(rx);
+  txInit(tx);
+  relayDedupReset(dedup);
+  aggReset(agg, RELAY_ID);
+  rxListen(rx);
+  LOGI("LoRa ready, children on SF%u, parent on SF%u", rx.radioSf, tx.adr.sf);
+}
+
+void loop() {
+  int n = LoRa.parsePacket();
+  if (n > 0) onPacket(n);
+  unsigned long now = millis();
+  rxTick(rx, now);
+
+  if (aggCount(agg) && (long)(now - sendAtMs) >= 0) {
+    // someone on the air: back off again rather than collide with them
+    if (LoRa.rssi() > RELAY_BUSY_DBM) { sendAtMs = now + relayBackoffMs(esp_random()); return; }
+    LOGD("Relay: cycle of %lu ms", now - cycleStartMs);
+    forward();
+  }
+}
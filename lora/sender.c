@@ -6,18 +6,32 @@
 #include <SPI.h>
 #include <LoRa.h>
 
+#define LOG_LEVEL LOG_LEVEL_INFO   // per-tank lines are LOG_LEVEL_DEBUG
+#include "../common/log_ring.h"
+#include "lora_proto.h"
+#include "lora_tx.h"
+#include "../common/level_fixed.h"
+#include "../common/echo_gate.h"
+
 // ----- LoRa hardware pins (change if your wiring differs) -----
 const long LORA_FREQ = 433E6;   // SX1278 typical frequency
 const int ssPin = 5;            // NSS / CS
 const int resetPin = 14;        // RST
 const int dio0Pin = 26;         // DIO0
+const uint8_t NODE_ID = 1;      // unique per sender sharing a receiver
+const bool ACK_MODE = true;                    // ask for an ACK per frame and retry (lora_arq.h)
+const unsigned long IDLE_MS = 2000;            // between the end of one send and the next sensor sweep
 
 // ----- Sensor pins & config (unchanged) -----
 #define TRIG_PIN 4
 const int echoPins[6] = {16, 17, 18, 19, 21, 22};
 
+constexpr float SOUND_SPEED = 0.0343f;        // cm/us
+constexpr float MAX_MEASURE_DIST_CM = 400.0f;
+constexpr uint32_t ECHO_US_K = levelUsFactorCmPerUs(SOUND_SPEED);
+
 struct TankCfg { const char* name; float tankHeight; float offsetFull; };
-TankCfg tankCfg[6] = {
+constexpr TankCfg tankCfg[6] = {
   {"Tank A", 90.0f, 5.0f},
   {"Tank B",125.0f, 3.0f},
   {"Tank C",110.0f, 2.0f},
@@ -26,114 +40,134 @@ TankCfg tankCfg[6] = {
   {"Tank F",175.0f, 2.5f}
 };
 
-// ----- Packet struct -----
-struct TankData { char name[16]; float levelPercent; };
-struct StructMessage { TankData tanks[6]; };
+// echo us -> per mille factors, folded at compile time
+constexpr LevelScale scaleFor(const TankCfg& t) { return levelScale(ECHO_US_K, t.tankHeight, t.tankHeight + t.offsetFull); }
+constexpr LevelScale tankScale[6] = {
+  scaleFor(tankCfg[0]), scaleFor(tankCfg[1]), scaleFor(tankCfg[2]),
+  scaleFor(tankCfg[3]), scaleFor(tankCfg[4]), scaleFor(tankCfg[5])
+};
+
+// where an echo can come from: the surface at full .. the bottom
+constexpr EchoGeometry geometryFor(const TankCfg& t) {
+  return { levelUsForCm(t.offsetFull, SOUND_SPEED), levelUsForCm(t.tankHeight + t.offsetFull, SOUND_SPEED) };
+}
+constexpr EchoGeometry tankGeo[6] = {
+  geometryFor(tankCfg[0]), geometryFor(tankCfg[1]), geometryFor(tankCfg[2]),
+  geometryFor(tankCfg[3]), geometryFor(tankCfg[4]), geometryFor(tankCfg[5])
+};
+EchoGate gate[6];     // per tank, centred on its last reading
+
+LoraTx tx;   // seq, SF / TX power (set by the receiver's downlinks)
 
 // ----- Ultrasonic read stuff (same optimized functions) -----
+// everything in echo us: gates and the median need no conversion at all
 const unsigned int TRIG_PULSE_US = 10;
 const int SAMPLES = 5;
-const unsigned long SAMPLE_DELAY_MS = 60;
-const unsigned long SENSOR_GAP_MS = 100;
-const float SOUND_SPEED = 0.0343f;
-const float MAX_MEASURE_DIST_CM = 400.0f;
-
-unsigned long timeoutForDistanceCm(float maxDistCm) {
-  unsigned long t = (unsigned long)((2.0f * maxDistCm) / SOUND_SPEED);
-  if (t < 30000ul) return 30000ul;
-  if (t > 300000ul) return 300000ul;
-  return t;
-}
-int medianInt(int arr[], int n) {
+constexpr uint32_t ECHO_MIN_US = levelUsForCm(2.0f, SOUND_SPEED);
+constexpr uint32_t ECHO_MAX_US = levelUsForCm(MAX_MEASURE_DIST_CM + 50.0f, SOUND_SPEED);
+constexpr uint32_t GATE_MARGIN_US = levelUsForCm(8.0f, SOUND_SPEED);  // level change between sweeps, doubled per miss
+const uint32_t PING_MISS = 0xFFFFFFFFu;     // sorts after every echo in the median
+
+uint32_t medianUs(uint32_t arr[], int n) {
   for (int i = 1; i < n; ++i) {
-    int key = arr[i]; int j = i - 1;
+    uint32_t key = arr[i]; int j = i - 1;
     while (j >= 0 && arr[j] > key) { arr[j+1] = arr[j]; --j; }
     arr[j+1] = key;
   }
   return arr[n/2];
 }
-float measureOnce(int echoPin, unsigned long timeout_us) {
+// one ping; echo time in us, 0 for none or out of range
+uint32_t measureOnceUs(int echoPin, uint32_t timeoutUs) {
   digitalWrite(TRIG_PIN, LOW);
   delayMicroseconds(2);
   digitalWrite(TRIG_PIN, HIGH);
   delayMicroseconds(TRIG_PULSE_US);
   digitalWrite(TRIG_PIN, LOW);
 
-  unsigned long duration = pulseIn(echoPin, HIGH, timeout_us);
-  if (duration == 0) return -1.0f;
-  float distance = (duration * SOUND_SPEED) / 2.0f;
-  if (distance < 2.0f || distance > (MAX_MEASURE_DIST_CM + 50.0f)) return -1.0f;
-  return distance;
+  uint32_t duration = pulseIn(echoPin, HIGH, timeoutUs);
+  if (duration < ECHO_MIN_US || duration > ECHO_MAX_US) return 0;
+  return duration;
 }
-float readDistanceOptimized(int echoPin, float maxDistanceCm = MAX_MEASURE_DIST_CM) {
-  unsigned long timeout_us = timeoutForDistanceCm(maxDistanceCm);
-  int results[SAMPLES];
+// median of SAMPLES pings, each timed out by the tank's gate (misses count as
+// the far end); 0 = no valid echo
+uint32_t readEchoUs(int tank) {
+  uint32_t results[SAMPLES];
   for (int s = 0; s < SAMPLES; ++s) {
-    float d = measureOnce(echoPin, timeout_us);
-    results[s] = (d < 0) ? (int)(maxDistanceCm * 10.0f) : (int)(d * 10.0f);
-    delay(SAMPLE_DELAY_MS);
+    uint32_t timeoutUs = gateTimeoutUs(gate[tank], tankGeo[tank], GATE_MARGIN_US);
+    uint32_t us = measureOnceUs(echoPins[tank], timeoutUs);
+    gateOnPing(gate[tank], us);
+    results[s] = us ? us : PING_MISS;
+    delay(gateDelayMs(gate[tank], timeoutUs));
   }
-  int med = medianInt(results, SAMPLES);
-  float medianCm = ((float)med) / 10.0f;
-  if (med >= (int)(maxDistanceCm * 10.0f)) return -1.0f;
-  return medianCm;
-}
-float calcLevelPercent(float measuredDist, float tankHeight, float offsetFull) {
-  if (measuredDist < 0) return -1.0f;
-  float waterHeight = tankHeight - (measuredDist - offsetFull);
-  waterHeight = constrain(waterHeight, 0.0f, tankHeight);
-  float pct = (waterHeight / tankHeight) * 100.0f;
-  return constrain(pct, 0.0f, 100.0f);
+  uint32_t med = medianUs(results, SAMPLES);
+  if (med == PING_MISS) med = 0;
+  gateOnReading(gate[tank], med);
+  return med;
 }
 
 // ----- setup & loop -----
 void setup() {
   Serial.begin(115200);
   while (!Serial) delay(10);
-  Serial.println("\nSX1278 Sender starting...");
+  logStartDrainTask();
+  LOGI("SX1278 Sender starting...");
 
   pinMode(TRIG_PIN, OUTPUT);
-  for (int i = 0; i < 6; ++i) pinMode(echoPins[i], INPUT_PULLDOWN);
+  for (int i = 0; i < 6; ++i) {
+    pinMode(echoPins[i], INPUT_PULLDOWN);
+    gateReset(gate[i]);
+  }
 
   // SPI begin (HSPI default pins)
   SPI.begin(18, 19, 23); // SCK, MISO, MOSI
   LoRa.setPins(ssPin, resetPin, dio0Pin);
 
-  Serial.printf("Init LoRa at %.0f MHz ...\n", (double)LORA_FREQ/1e6);
+  LOGI("Init LoRa at %.0f MHz ...", (double)LORA_FREQ/1e6);
   if (!LoRa.begin(LORA_FREQ)) {
-    Serial.println("LoRa init failed - check wiring and freq (SX1278 433MHz).");
+    LOGE("LoRa init failed - check wiring and freq (SX1278 433MHz).");
     while (true) delay(1000);
   }
 
-  // Optional tuning (example): increase range by higher SF and narrow BW (slower)
-  // LoRa.setSpreadingFactor(10);      // 7..12 (higher = longer range, slower)
-  // LoRa.setSignalBandwidth(125E3);   // 7.8k..500k
-  // LoRa.setCodingRate4(5);           // 5..8 (lower = more robust)
-  // LoRa.setTxPower(17);              // 2..20 dBm depending on module
+  // BW/CR fixed on both ends; SF and power start at the rendezvous setting and
+  // are then set by the receiver (ADR)
+  LoRa.setSignalBandwidth(LORA_BW_HZ);
+  LoRa.setCodingRate4(LORA_CR);
+  txInit(tx);
+  txApplyRadioSettings(tx);
 
-  Serial.println("LoRa ready (SX1278 433MHz)");
+  LOGI("LoRa ready (SX1278 433MHz) SF%u %d dBm", tx.adr.sf, tx.adr.power);
 }
 
 void loop() {
+  unsigned long sweepStart = millis();
   StructMessage msg;
+  msg.hdr.magic = LORA_MAGIC;
+  msg.hdr.version = LORA_VERSION;
+  msg.hdr.nodeId = NODE_ID;
+  msg.hdr.flags = 0;
+  msg.hdr.seq = tx.seq++;
 
   for (int i = 0; i < 6; ++i) {
-    float dist = readDistanceOptimized(echoPins[i], MAX_MEASURE_DIST_CM);
-    float pct = calcLevelPercent(dist, tankCfg[i].tankHeight, tankCfg[i].offsetFull);
+    uint32_t us = readEchoUs(i);
+    uint16_t permille = levelPermille(tankScale[i], us);
     strncpy(msg.tanks[i].name, tankCfg[i].name, sizeof(msg.tanks[i].name));
     msg.tanks[i].name[sizeof(msg.tanks[i].name)-1] = '\0';
-    msg.tanks[i].levelPercent = pct;
-    if (dist < 0) Serial.printf("%s: No echo -> %.1f\n", msg.tanks[i].name, pct);
-    else Serial.printf("%s: Dist=%.1f cm => %.1f%%\n", msg.tanks[i].name, dist, pct);
-    delay(SENSOR_GAP_MS);
+    msg.tanks[i].levelPercent = loraPercent(permille);   // the frame still carries float percent
+    if (!us) LOGD("%s: No echo", msg.tanks[i].name);
+    else LOGD("%s: Dist=%lu/16 mm => %u per mille", msg.tanks[i].name, (unsigned long)levelDistQ(tankScale[i], us), permille);
+    // the shared trigger also pinged the next tank's sensor; let it finish
+    if (i < 5) {
+      const EchoGate& next = gate[i + 1];
+      delay(gateDelayMs(next, gateTimeoutUs(next, tankGeo[i + 1], GATE_MARGIN_US)));
+    }
   }
 
-  // Send the whole struct as one LoRa packet
-  Serial.println("Sending LoRa packet...");
-  LoRa.beginPacket();
-  LoRa.write((uint8_t*)&msg, sizeof(msg));
-  LoRa.endPacket(); // non-blocking
-  Serial.println("Packet sent via LoRa");
+  // Send the whole struct as one LoRa packet; retries use the idle time, keeping the cadence
+  unsigned long sendStart = millis();
+  unsigned long nextDueMs = sendStart + IDLE_MS + (sendStart - sweepStart);
+  LOGD("Sending LoRa packet...");
+  txSendReliable(tx, (uint8_t*)&msg, sizeof(msg), ACK_MODE, nextDueMs);
 
-  delay(2000); // adjust as needed
+  long left = (long)(sendStart + IDLE_MS - millis());
+  if (left > 0) delay(left);
 }
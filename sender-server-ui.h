@@ -0,0 +1,247 @@
+/*
+  sender-server-ui.h  (generated by tools/embed_web_ui.py - do not edit)
+  - source: web/index.html (9992 bytes raw, 3778 bytes gzip)
+*/
+#pragma once
+
+const char INDEX_HTML_ETAG[] = "\"2196a3a08c089042\"";
+const size_t INDEX_HTML_GZ_LEN = 3778;
+const uint8_t INDEX_HTML_GZ[] PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0x9d,0x5a,0xdb,0x52,0xdb,0x48,
+  0x1a,0xbe,0xe7,0x29,0x3a,0x64,0x12,0x49,0x13,0x9f,0x20,0x33,0x53,0x53,0x16,0x76,
+  0x0a,0x48,0x52,0x61,0x37,0x24,0xd9,0x98,0x9d,0x1b,0x8a,0x4a,0x64,0xa9,0x8d,0x34,
+  0xc8,0x92,0x46,0xdd,0x06,0x3c,0x8e,0x5f,0x63,0x1f,0x64,0xaf,0xf7,0x69,0xf6,0x49,
+  0xf6,0xfb,0xff,0xd6,0xd1,0x80,0xc9,0x6c,0x51,0x65,0xcb,0xdd,0xff,0xf9,0xdc,0x2d,
+  0x0e,0x9e,0x04,0xa9,0xaf,0x97,0x99,0x14,0xa1,0x9e,0xc7,0xe3,0x83,0xe2,0x53,0x7a,
+  0xc1,0xf8,0x60,0x2e,0xb5,0x27,0xfc,0xd0,0xcb,0x95,0xd4,0xa3,0xdd,0x85,0x9e,0x75,
+  0x7f,0xdd,0x1d,0x1f,0xe8,0x48,0xc7,0x72,0x3c,0x91,0x49,0x20,0x73,0x71,0xea,0x25,
+  0xde,0xa5,0xcc,0x0f,0xfa,0x66,0x75,0xc7,0xe0,0x24,0xde,0x5c,0x8e,0x76,0xaf,0x23,
+  0x79,0x93,0xa5,0xb9,0xde,0x15,0x7e,0x9a,0x68,0x99,0x80,0xc6,0x4d,0x14,0xe8,0x70,
+  0x14,0xc8,0xeb,0xc8,0x97,0x5d,0xfe,0xd1,0x89,0x92,0x48,0x47,0x5e,0xdc,0x55,0xbe,
+  0x17,0xcb,0xd1,0x1e,0x18,0x28,0xbd,0x24,0x52,0xd3,0x34,0x58,0xae,0x66,0xc0,0xec,
+  0xce,0xbc,0x79,0x14,0x2f,0x87,0x6a,0xa9,0xb4,0x9c,0x77,0x17,0x91,0x3b,0xf7,0xf2,
+  0xcb,0x28,0x19,0xee,0xed,0x67,0xb7,0x6b,0xed,0x4d,0x63,0xb9,0x62,0x5a,0xc3,0xbd,
+  0xc1,0xe0,0x99,0x3b,0x4d,0x73,0x48,0xd6,0xf5,0xd3,0x38,0xf6,0x32,0x25,0x87,0xe5,
+  0xc3,0x1a,0xcc,0x74,0xb0,0x2a,0xb6,0xa7,0xa9,0xd6,0xe9,0x7c,0xb8,0x97,0xdd,0x0a,
+  0x95,0xc6,0x51,0x20,0x9e,0xfa,0xbe,0xef,0x66,0x5e,0x10,0x44,0xc9,0xe5,0xf0,0x17,
+  0x22,0x1c,0xae,0xa6,0x9e,0x7f,0x75,0x99,0xa7,0x8b,0x24,0x18,0x3e,0x95,0x52,0xae,
+  0xa3,0x24,0x5b,0xe8,0x36,0xaf,0xdb,0xae,0x8a,0xfe,0x24,0x94,0x8a,0xee,0xed,0x7a,
+  0xe7,0xa9,0xf2,0x73,0x70,0x95,0xf9,0x2a,0x94,0xd1,0x65,0xa8,0x87,0xd0,0xcd,0xb7,
+  0x81,0x71,0x1d,0x8a,0xae,0xd8,0xdb,0x1f,0x64,0xb7,0x8e,0x3b,0x8f,0x92,0x6e,0xb1,
+  0xbd,0x3f,0xc0,0x8a,0x9b,0x5e,0xcb,0x7c,0x16,0xa7,0x37,0xdd,0xe5,0xd0,0x5b,0xe8,
+  0x74,0xbd,0xa3,0xc9,0x0d,0x02,0x72,0x64,0xa9,0x82,0x91,0xd2,0x64,0xa8,0x74,0xe4,
+  0x5f,0x2d,0x5d,0x9d,0x66,0xc3,0x81,0xeb,0x2f,0x72,0x95,0xe6,0xc3,0x2c,0x8d,0x60,
+  0xdd,0xdc,0x5d,0x28,0xb0,0x57,0x32,0x96,0xbe,0x1e,0x26,0x69,0x22,0xdd,0x9b,0x30,
+  0xd2,0xb2,0xab,0x32,0xcf,0x97,0x58,0xb8,0xc9,0xbd,0x6c,0x5d,0x52,0xec,0x01,0x51,
+  0xcb,0xa0,0xa5,0x60,0x10,0x48,0xb0,0x24,0xab,0x0b,0x98,0xa9,0x92,0x0c,0x82,0xc5,
+  0x51,0x22,0xbb,0xcd,0x85,0xbb,0x94,0x2b,0xe1,0x87,0x61,0x04,0x42,0xc9,0x5a,0xe7,
+  0xbd,0x8c,0x58,0x05,0xab,0xd2,0xa6,0x83,0xc2,0x33,0x78,0x28,0x68,0x15,0x5a,0x06,
+  0x3d,0x2f,0xf6,0xf2,0xf9,0x0a,0x8e,0x82,0x3a,0x4f,0xa7,0x83,0x81,0xcb,0x6e,0xbf,
+  0x31,0x50,0xbf,0x0c,0x06,0xeb,0x9d,0xde,0x3c,0x0d,0x10,0x24,0x24,0x6f,0x90,0xa7,
+  0x59,0x6d,0x91,0x59,0x74,0x2b,0x03,0x37,0x4a,0x10,0xa2,0xc4,0xa1,0xd6,0x27,0xbf,
+  0x9c,0x7a,0xf6,0xa0,0xc3,0x7f,0xbd,0x9f,0x7e,0x76,0xdc,0x20,0x52,0x59,0xec,0x2d,
+  0x8d,0x6d,0xbc,0x38,0xba,0x4c,0xba,0xd0,0x62,0xae,0x86,0xbe,0x64,0xfb,0xfd,0xbe,
+  0x80,0x75,0x67,0xcb,0x6e,0x11,0xac,0xe5,0x72,0x29,0x3e,0x05,0x9b,0xfb,0x67,0x37,
+  0x42,0xd8,0xdf,0xc2,0xf9,0xa5,0x48,0x2d,0x13,0xce,0x66,0xb3,0x1a,0x1e,0x31,0x54,
+  0xc6,0x62,0xee,0x05,0xd1,0x42,0x0d,0x7f,0xc5,0xca,0xdc,0xbb,0x35,0x81,0x3f,0xfc,
+  0xd9,0x98,0xb2,0x0a,0xa6,0xf5,0xce,0x41,0xdf,0x84,0xfe,0x41,0xdf,0xe4,0x1f,0xf9,
+  0x02,0x29,0x15,0xee,0x97,0xd9,0xf6,0x9a,0x13,0xa7,0x4e,0x3a,0xec,0xec,0x1c,0x04,
+  0xd1,0xb5,0x60,0xbc,0xd1,0x6e,0xa9,0xe2,0x2c,0x96,0xb7,0xee,0xa5,0x97,0x31,0xc7,
+  0xbb,0xaa,0xee,0x8e,0x77,0x84,0x20,0xbc,0xf1,0xe1,0xa7,0xa1,0x38,0x98,0x16,0xe4,
+  0xbb,0xaf,0xa3,0x1c,0xc1,0x73,0xd0,0x9f,0x8e,0xc5,0xf3,0x64,0xaa,0x32,0x57,0x4c,
+  0xce,0x0e,0xc5,0x09,0xc3,0x88,0x28,0x18,0xed,0x2a,0xed,0x45,0xd9,0xee,0xb8,0xd7,
+  0xeb,0x11,0xd0,0x41,0x9f,0x48,0x14,0xa4,0x4a,0x11,0x88,0xf5,0x90,0xb2,0xb8,0xda,
+  0xe4,0xa4,0x61,0xf4,0x59,0x14,0x13,0x77,0x01,0x19,0x7d,0x19,0xa6,0x31,0x78,0x8e,
+  0x76,0xdf,0xf2,0x22,0x97,0x0c,0xd1,0x17,0xa7,0x87,0xc7,0xf8,0x3c,0xf9,0xb4,0x5b,
+  0xd2,0xab,0xed,0xb5,0x4f,0xf6,0x32,0xa2,0x23,0xf2,0x12,0xa6,0xe8,0xc3,0xee,0x9a,
+  0x98,0xd1,0x0a,0x6f,0x4d,0x17,0xc8,0x6b,0xb3,0x99,0xcb,0x59,0x2e,0x55,0x78,0xa4,
+  0x93,0xdd,0xf1,0x67,0xf3,0x0c,0xb1,0x79,0x7f,0x13,0x34,0x91,0x37,0x0c,0xf6,0x41,
+  0xde,0x14,0x46,0xae,0x21,0x0b,0x4d,0x58,0x49,0x36,0x42,0x91,0xdb,0x54,0x0a,0xa9,
+  0xf6,0xf0,0xa2,0x9e,0xc6,0xf4,0xdb,0xf8,0x4d,0xe7,0xbc,0x46,0x3f,0x48,0x36,0x9d,
+  0xd3,0x47,0xb1,0xc5,0x3e,0xc5,0xcf,0xf2,0x9b,0x28,0x94,0xc6,0xaa,0x79,0x70,0x68,
+  0x1d,0x15,0xc1,0x8e,0xfa,0x19,0x7b,0x4a,0x15,0xab,0x55,0x0e,0x54,0x5e,0x6c,0x6d,
+  0xf3,0x2a,0xd6,0xc3,0x97,0x35,0xa1,0x33,0xaa,0xcd,0xbb,0xe3,0x37,0x41,0xa4,0x2b,
+  0xed,0xc2,0x97,0x05,0x60,0xec,0x4d,0x65,0x3c,0x86,0xdd,0x0f,0xfa,0xe6,0xb1,0xe1,
+  0xb0,0xf9,0x97,0xb9,0xe7,0x6f,0xf8,0xeb,0xf0,0x70,0x78,0x74,0x34,0x44,0x08,0xec,
+  0xb6,0x08,0x7c,0x80,0xff,0xee,0xa5,0x40,0x8e,0xdd,0x20,0x71,0xe6,0x25,0x57,0xdd,
+  0xbd,0x12,0xff,0x91,0xf8,0x85,0x05,0xef,0x0b,0x2f,0xc3,0xe9,0x2c,0xd5,0x5e,0x2c,
+  0xde,0x71,0xa1,0x10,0xb6,0x3f,0x77,0xee,0x15,0x41,0x13,0xd4,0xbb,0x5d,0x41,0x6d,
+  0x0e,0xbe,0x5e,0xcc,0xa7,0x14,0x85,0x68,0x26,0xd9,0x68,0x77,0xd0,0xab,0x82,0x75,
+  0x0b,0x1f,0x24,0x08,0x2a,0x66,0x77,0x7c,0xea,0xdd,0x3e,0xcc,0x46,0xed,0xcf,0x1f,
+  0xe7,0x51,0xa6,0xc5,0x16,0xc5,0x37,0x0b,0x11,0x2d,0x76,0x91,0xa1,0x55,0x46,0x9b,
+  0xf6,0xd7,0xa5,0x2e,0x60,0x0c,0xd4,0x88,0xe4,0xf9,0xc4,0xbb,0x86,0xaf,0xe9,0xb3,
+  0x0a,0xe1,0xd6,0xfe,0x71,0x9c,0x2a,0x00,0xf0,0x57,0x0d,0x51,0x65,0x6b,0x11,0xec,
+  0x65,0x40,0x22,0xd8,0xa3,0x4c,0x8f,0x77,0xfa,0x7d,0x91,0xa7,0x37,0x4a,0x78,0xb9,
+  0x14,0x57,0x72,0x29,0x03,0x31,0x5d,0x72,0xb2,0xda,0xa9,0xc9,0x5d,0xa7,0x23,0x32,
+  0x4f,0xfb,0x21,0x76,0x7c,0x19,0xc7,0xb4,0x4d,0xdf,0x1d,0xe1,0x25,0x81,0x48,0x93,
+  0x18,0x4d,0x25,0x94,0xe2,0x3a,0x52,0x11,0x02,0x9e,0xc8,0xa1,0x0a,0x2b,0x61,0x67,
+  0xf1,0x42,0x89,0x8f,0xbf,0xbd,0xf9,0x3c,0x39,0x3e,0xfc,0xe0,0x30,0xf9,0x28,0x61,
+  0xd0,0xd7,0x1f,0x4f,0x5d,0x41,0x6d,0x8a,0x29,0x98,0xd2,0x21,0xf2,0x45,0x02,0x44,
+  0xde,0x9f,0x49,0xc3,0x2d,0x8e,0x94,0xde,0x81,0xa9,0x94,0xae,0xe8,0x88,0x91,0xd8,
+  0x1b,0xb8,0xc5,0xe2,0xe1,0xfb,0xc3,0xcf,0xa7,0x5f,0x8e,0x4e,0xce,0x26,0x58,0x3e,
+  0x3f,0xdf,0xeb,0x58,0xe8,0x52,0xd6,0x45,0xe7,0x7c,0xbf,0x63,0x85,0x88,0x1b,0x7a,
+  0xfc,0xa9,0x63,0xa1,0xb4,0xc5,0xd2,0xba,0xb8,0x28,0xd1,0xe0,0x41,0xc0,0x5f,0x8b,
+  0xd1,0x98,0x3e,0x46,0xf8,0x0d,0xa5,0x5e,0x09,0xcb,0x12,0x43,0x31,0xd1,0x39,0x2a,
+  0xbc,0x7d,0xed,0x94,0xc0,0xc7,0x1f,0xdf,0x33,0x75,0x18,0xf0,0xdc,0x42,0xca,0x58,
+  0x1d,0x61,0xc1,0x38,0xf8,0x0a,0x88,0x40,0xd0,0xc3,0x9a,0xf8,0xf6,0x0d,0xd8,0x17,
+  0x1d,0x86,0x89,0x32,0x02,0x39,0xf9,0x54,0x43,0x44,0x59,0x0b,0x20,0x57,0x2a,0x22,
+  0x90,0xcf,0x93,0xc9,0x49,0x09,0x04,0x91,0xec,0xa0,0x47,0x3b,0x4e,0x01,0x45,0x86,
+  0x27,0xa8,0x0f,0xe6,0xbb,0x20,0xc5,0xa5,0xb4,0x49,0x2c,0x93,0x39,0x15,0x7e,0x82,
+  0xfc,0x54,0x3d,0x16,0xc0,0xc5,0x5e,0x53,0xc5,0x6e,0x97,0x94,0xac,0xb6,0x7a,0x3a,
+  0x7d,0x4b,0x4d,0xd6,0xde,0x73,0xc4,0x0b,0x61,0x3d,0x2b,0xa9,0xa2,0x05,0x7d,0x51,
+  0x12,0x06,0x08,0x14,0x51,0x3e,0xbc,0x94,0xb6,0x72,0xda,0xb2,0x36,0x40,0x4a,0x91,
+  0x73,0x4f,0xcb,0x2f,0x59,0x16,0xb2,0x72,0x78,0x16,0xcf,0xfa,0xe1,0x86,0x82,0x05,
+  0x44,0x89,0xc1,0xc3,0x01,0x73,0x28,0x1e,0x18,0xb6,0x76,0x6b,0xcf,0xc4,0x86,0x3d,
+  0x35,0x0a,0x31,0xb8,0x78,0x2e,0xa6,0xe7,0x83,0x0b,0x07,0x86,0xcf,0xcc,0xc6,0xf4,
+  0x7c,0x0f,0x3f,0x7f,0xc7,0xac,0x64,0x5b,0xc2,0x2a,0x69,0x23,0x09,0xd4,0x97,0xcc,
+  0x67,0xd3,0xbc,0xc7,0xb3,0x78,0xd6,0x96,0xa5,0xdc,0x2f,0xe1,0x4d,0x25,0xe1,0x72,
+  0x73,0xcc,0x32,0xbd,0xe3,0x72,0xd0,0x46,0x6a,0x01,0x95,0x98,0x8a,0x2b,0xc8,0x59,
+  0x8a,0x0a,0x62,0x30,0x27,0xfb,0xa7,0xf7,0xe0,0xb6,0xc0,0x08,0x17,0x01,0x89,0x64,
+  0xa1,0x80,0xe7,0x56,0xd1,0x29,0x32,0xa1,0x53,0xa7,0x86,0xa4,0xb2,0xce,0x75,0xde,
+  0xe4,0x59,0x6e,0x46,0x3c,0xa9,0x24,0x01,0x31,0x6a,0x86,0x86,0x25,0x3c,0x75,0xa5,
+  0xc4,0x8c,0xd2,0x35,0xd5,0x21,0xe2,0x57,0xc8,0x58,0xc9,0x22,0x80,0x5f,0xbf,0xf9,
+  0xed,0xe4,0xf8,0xcd,0xe4,0xcb,0x3f,0x3f,0xbf,0x47,0x1c,0x5b,0x7d,0x2f,0x8b,0xfa,
+  0x66,0x4a,0x57,0xaf,0x66,0x91,0x8c,0x03,0x35,0xb2,0xe0,0x7c,0x8a,0x73,0x36,0xa9,
+  0x4f,0x12,0xfb,0x6c,0x61,0x63,0xd2,0x8e,0x85,0x64,0x88,0xa5,0x16,0x05,0x16,0x65,
+  0xc3,0x45,0x07,0x55,0xe0,0xef,0x72,0x89,0x67,0xf4,0x57,0x4c,0x2d,0x99,0x8d,0x2a,
+  0x41,0xa7,0x02,0xde,0x35,0xf0,0xa4,0xc6,0x71,0x1a,0x0b,0x13,0x7e,0x46,0x2d,0xcc,
+  0x21,0x94,0xc2,0xa5,0xae,0x67,0xf2,0x56,0x93,0x54,0x96,0xc1,0x60,0x55,0x3f,0x66,
+  0x32,0xc1,0xda,0xcc,0x8b,0x49,0x4d,0x32,0x41,0xc1,0x08,0x44,0x0c,0x18,0xca,0xd5,
+  0x3b,0x2c,0x6c,0xd4,0x01,0x68,0x80,0x45,0xd6,0x63,0x86,0x51,0xee,0x84,0xa6,0xb9,
+  0x5a,0x1b,0x64,0x01,0xf8,0x98,0x80,0xab,0x92,0x9b,0xeb,0x5e,0x43,0x05,0x17,0xb5,
+  0x1b,0x2e,0x41,0x15,0x14,0xdd,0x31,0xa4,0xc1,0x04,0x82,0x32,0x84,0xa6,0x3f,0x2e,
+  0x10,0xca,0x01,0x01,0x48,0x38,0x5b,0x2d,0xe6,0x94,0x43,0x97,0x52,0xbf,0x89,0x25,
+  0x3d,0x1e,0x2d,0x4f,0x02,0xdb,0x2a,0x61,0x6a,0x36,0x7a,0xda,0x84,0xff,0x63,0x21,
+  0xf3,0xe5,0x84,0x87,0xf9,0x34,0xb7,0xad,0xa7,0x98,0x2f,0x04,0xcf,0x0c,0x35,0x02,
+  0x06,0xcd,0xb3,0x34,0x03,0x12,0x1e,0x3e,0xa7,0x37,0x36,0x57,0xe0,0xe0,0x28,0xd5,
+  0x8d,0x25,0x17,0x03,0x7d,0xcf,0xcb,0x60,0xac,0xc0,0x36,0xf0,0x25,0x10,0xb6,0x0a,
+  0x3a,0x50,0xe4,0xe3,0x8c,0x78,0xb7,0x4a,0x95,0xcd,0xc5,0x65,0x48,0x5e,0xb7,0x9b,
+  0x25,0xc5,0x01,0xe2,0x6c,0x91,0xf8,0x34,0x7c,0x57,0x6c,0x56,0xa2,0xd0,0xa1,0xa5,
+  0xb3,0x8f,0x48,0xd4,0xb2,0x50,0xdb,0xb6,0x34,0x29,0x0b,0x90,0x1e,0x8f,0x2b,0x54,
+  0xb2,0xc8,0xa9,0x20,0x61,0xf1,0x6a,0x94,0x24,0x32,0x7f,0x77,0x76,0x4a,0xfe,0xf9,
+  0x7a,0xa0,0xd1,0x46,0xd2,0x98,0xa6,0xba,0xd1,0x0f,0x2b,0x76,0x57,0x2c,0x93,0x4b,
+  0x1d,0x42,0x9c,0xbd,0x35,0xcd,0x4d,0xc1,0xf8,0xab,0x8b,0x50,0xd7,0x8b,0x1c,0xed,
+  0x20,0x77,0xc5,0xba,0x96,0x6a,0xee,0x5d,0xc9,0xff,0x43,0xac,0x2f,0xd7,0x26,0x2c,
+  0x39,0x47,0x6c,0x0a,0x21,0x9f,0xe3,0x07,0x5f,0x07,0xa2,0x21,0x02,0x16,0x5e,0xbc,
+  0x70,0x08,0xc3,0x18,0xf6,0x38,0x8c,0xe2,0xc0,0x7e,0x90,0x7c,0x40,0x26,0x2b,0x05,
+  0x09,0xb6,0x09,0x12,0x58,0x15,0xe0,0x74,0x0b,0x9c,0x69,0xd9,0x04,0x3b,0xed,0x69,
+  0xa4,0xc6,0xb1,0x19,0x13,0xc8,0x98,0x34,0xe1,0x91,0x35,0x83,0x96,0x68,0x53,0xa3,
+  0x5f,0x73,0x49,0x07,0xce,0x86,0xf5,0xb8,0x23,0xc7,0xa6,0x69,0x2b,0x71,0x13,0x62,
+  0x3a,0x10,0x44,0x9d,0xce,0xff,0xc9,0x25,0x02,0x9c,0x5a,0xb3,0x4e,0x17,0xd4,0x73,
+  0x9b,0x01,0x80,0x26,0x4c,0xb6,0xd6,0xa8,0x48,0x41,0x87,0x62,0x09,0x56,0xff,0x3e,
+  0x03,0x56,0xde,0x29,0x12,0xf2,0xdc,0xbf,0x38,0xdf,0xbf,0xb0,0x49,0xb2,0x68,0x26,
+  0x6c,0xf6,0x08,0xd6,0xc4,0x13,0xe4,0xa4,0x26,0xf0,0x6a,0x05,0xbf,0x4d,0x20,0x91,
+  0xac,0x58,0xd8,0x30,0x03,0x36,0xd7,0xf8,0xab,0x00,0xaa,0xcc,0xbf,0x68,0x85,0x5e,
+  0xd9,0x2a,0x5e,0x95,0x19,0x8f,0xa6,0x67,0x99,0x58,0x04,0x94,0x66,0x43,0xa1,0x48,
+  0xe4,0xe5,0x63,0xe0,0x69,0x0f,0xa7,0xcc,0xde,0x15,0x17,0x1a,0x7c,0x92,0xd9,0x6a,
+  0x53,0xf8,0xf3,0xcc,0xf6,0x50,0xf1,0xa0,0x3f,0x89,0xef,0x55,0x1d,0x15,0x69,0x33,
+  0x2d,0x7f,0x38,0xa5,0xd1,0xbd,0x46,0xc3,0xb5,0xa7,0x8d,0x1f,0x03,0x48,0x81,0x46,
+  0x3b,0x14,0xdd,0xbd,0xca,0x43,0x36,0x0d,0x95,0xe9,0x8c,0x91,0xe0,0x65,0xc5,0xe3,
+  0x87,0x05,0x60,0x0f,0x0d,0x8a,0xae,0x4d,0x8e,0xd3,0x79,0x06,0xff,0xc0,0xd3,0x40,
+  0xf4,0x44,0x17,0x52,0x88,0x1f,0xcb,0x52,0xda,0xca,0x8d,0x5c,0x4e,0x17,0x50,0xe6,
+  0x37,0x14,0x61,0xe4,0x07,0x3a,0x93,0xf1,0x01,0xe5,0x7f,0x5d,0x6c,0xd1,0xc1,0xde,
+  0xa7,0x37,0x32,0x3f,0x86,0xbe,0x54,0x43,0x44,0x59,0xb4,0x67,0xe0,0x59,0x14,0xf8,
+  0xb2,0xeb,0x72,0xd5,0x68,0x57,0x88,0x36,0x3a,0x12,0xdb,0x8f,0x17,0x81,0x54,0xf6,
+  0xcc,0xe1,0xc2,0xd2,0x98,0x86,0x1e,0x07,0x2d,0xc7,0xa2,0xd6,0x1e,0x69,0x59,0x8a,
+  0xa1,0x62,0x7c,0x19,0x21,0xc9,0xec,0x45,0x3b,0x71,0x58,0x62,0xbe,0xe5,0xb0,0x8d,
+  0x57,0xb8,0xc4,0x93,0x8b,0xce,0x0b,0x10,0xea,0x4e,0xd5,0xb3,0xc3,0x04,0x1e,0xac,
+  0xd6,0x7c,0xcc,0x64,0x19,0x92,0xaa,0x1d,0x31,0x83,0xa2,0x28,0x91,0x5b,0x4a,0x81,
+  0x8a,0xa5,0x57,0xe2,0xeb,0x0f,0xab,0xf6,0xda,0xba,0x84,0xf9,0x0a,0xf9,0xb1,0xdb,
+  0xa0,0xb0,0x16,0x70,0xef,0x1d,0xf8,0xaf,0xee,0x4e,0x33,0xc2,0x32,0x2f,0x42,0xfe,
+  0x37,0xbc,0x96,0xb4,0xc5,0x28,0x6d,0xf0,0x84,0x5b,0xdf,0xf3,0xe7,0x22,0xa9,0x93,
+  0x2c,0xcb,0xd3,0x29,0x05,0x7d,0x55,0x1b,0xdd,0x3a,0x77,0x79,0xcf,0x34,0x66,0xf4,
+  0xc0,0x0e,0x59,0x1b,0x59,0x30,0xed,0xd1,0xa5,0x4a,0xae,0x8f,0x24,0xd2,0x59,0x96,
+  0x40,0x65,0xf3,0x28,0xdb,0x2b,0x2f,0x93,0xbd,0x8e,0xe8,0x06,0x04,0x61,0x79,0x1c,
+  0x47,0x30,0xdb,0x67,0xf4,0x2d,0xf8,0xd3,0xdc,0xf3,0x90,0x07,0x5f,0xbe,0x74,0x0b,
+  0xd8,0x5c,0xce,0xd3,0x6b,0xf2,0x18,0xc2,0xb2,0x0a,0x3f,0xca,0x32,0x50,0x3b,0xf5,
+  0x74,0x88,0xe8,0xb8,0xb5,0x07,0x1d,0xf3,0x3c,0x8b,0x53,0xb4,0xbf,0xb2,0x59,0xf6,
+  0xcc,0x03,0x75,0xbd,0xbe,0xb0,0x59,0x02,0x26,0x8d,0x80,0xe8,0xd6,0x87,0x08,0xb7,
+  0x22,0x4b,0x69,0x5c,0x51,0xc5,0x94,0x92,0x14,0x54,0x7d,0x19,0xc5,0xf6,0x7d,0x54,
+  0x5f,0x54,0xbd,0x1b,0x95,0x82,0xf4,0x30,0x53,0x9c,0x73,0x87,0xdd,0x8b,0x36,0x3b,
+  0xd3,0x5a,0x9b,0xc5,0x82,0xcf,0x75,0xa5,0xfe,0xa3,0x42,0xc1,0x1f,0x8d,0xd5,0x30,
+  0x44,0x67,0xb7,0x56,0x81,0x07,0x6b,0x6e,0xc1,0xb3,0x13,0x68,0x46,0x6a,0x38,0x77,
+  0x91,0xab,0xee,0xad,0x8a,0x71,0x4a,0xd4,0x85,0x37,0x2a,0x79,0xa2,0x96,0xa2,0xf8,
+  0x12,0x05,0x3c,0x51,0xd5,0x25,0xf8,0x5e,0xb6,0x50,0xa1,0xcd,0x7d,0xdf,0x66,0xaf,
+  0x47,0x45,0x02,0x18,0x92,0x37,0x1e,0x97,0x51,0x1a,0x78,0x26,0x52,0x13,0x9c,0xc2,
+  0x6c,0xa1,0xa8,0xc2,0xb4,0x39,0x19,0xf0,0xf3,0xab,0x0e,0x6a,0xe6,0x05,0x45,0x30,
+  0x8d,0x4a,0x8e,0x89,0x41,0x22,0xd2,0x0b,0x3d,0x65,0x5f,0x39,0x14,0x85,0xb4,0xd3,
+  0x0b,0x30,0xcf,0x68,0x89,0x15,0xd7,0x50,0x33,0x72,0xe8,0xbc,0x88,0x05,0x12,0x3c,
+  0xcb,0xe5,0xb5,0x99,0x5f,0x60,0xd0,0xef,0x54,0x69,0xc5,0xc7,0x69,0x23,0x4c,0x50,
+  0xa4,0x04,0x54,0x42,0x37,0x32,0x75,0x5a,0x9d,0x47,0xb0,0x22,0xe3,0xb2,0xec,0x86,
+  0x13,0x0f,0x05,0x2c,0xd6,0x25,0x29,0xe9,0x98,0x1d,0x96,0x1d,0x12,0x71,0xbb,0x01,
+  0x40,0x21,0x67,0x8a,0xb9,0x8f,0x9c,0xdf,0x48,0x1f,0x46,0x55,0x84,0x4a,0xea,0x17,
+  0x2a,0x88,0xbb,0x1d,0xb1,0x41,0x98,0x94,0xeb,0x25,0x28,0x1f,0x13,0x1c,0x82,0x69,
+  0x02,0xe7,0xd6,0x06,0x66,0x9b,0xc9,0x46,0xb8,0x9b,0xc0,0x05,0x9d,0xc2,0x40,0x68,
+  0xda,0xf8,0xb9,0x6e,0x7b,0x02,0x12,0xc3,0x09,0x2c,0x32,0xcf,0x27,0x55,0xaa,0x95,
+  0x85,0x21,0xa1,0xaa,0xf0,0xc4,0x48,0x1e,0xfd,0x29,0x49,0xcb,0xbb,0xa1,0xbb,0x31,
+  0x53,0x7c,0x48,0xcb,0xb2,0x65,0xb9,0x0f,0x06,0x7a,0x71,0xe9,0x49,0xf0,0xbf,0x50,
+  0x78,0xb2,0x64,0x74,0xbe,0x30,0x7a,0x6f,0xe3,0xf1,0x5d,0x42,0x7c,0x1f,0x6b,0xe6,
+  0xdb,0x6a,0x76,0x74,0xad,0x79,0x46,0xe7,0x26,0x1a,0x06,0x5b,0xbd,0xcf,0x2d,0xcb,
+  0x69,0xbb,0x8b,0x1b,0x94,0x77,0x38,0x42,0xd5,0xe3,0x63,0xb8,0x6d,0x90,0xa7,0x6b,
+  0x3d,0xaa,0x97,0x61,0x6b,0x80,0x25,0x51,0xcc,0x21,0x23,0xcd,0xdf,0x78,0x7e,0x68,
+  0x8e,0x18,0xd5,0xc4,0x13,0x6e,0x1b,0x03,0x43,0x2e,0xbf,0x61,0x35,0x6f,0xf8,0x7c,
+  0x3a,0xa2,0xe3,0x09,0x2f,0xb7,0x2d,0xe3,0xe3,0x58,0x4b,0x23,0x7a,0x75,0x8c,0x1a,
+  0x19,0x50,0x1a,0x2b,0xca,0xa3,0xd4,0x18,0x43,0x05,0x86,0x1c,0xf1,0xdf,0x7f,0xfd,
+  0x9b,0x67,0x1c,0x3c,0xfc,0xc7,0x72,0x78,0xda,0x29,0x66,0xad,0x4d,0x6c,0x87,0x18,
+  0xb5,0xc6,0x74,0xf3,0xbe,0xc0,0x22,0x3d,0x5b,0x73,0x64,0x48,0xf6,0xab,0xe7,0xdb,
+  0xef,0x52,0x6c,0xc3,0xb7,0x87,0x6c,0x79,0xf5,0x00,0xed,0xda,0x35,0xb0,0xc5,0x84,
+  0xfa,0x39,0xec,0x51,0xcc,0x58,0x2d,0xb1,0xa9,0xe9,0xd7,0xcb,0x85,0xde,0x4e,0xe3,
+  0x3c,0x49,0x03,0x15,0x87,0x64,0xfb,0xc8,0x49,0xc3,0x22,0x2f,0xaf,0x1a,0x1b,0xa0,
+  0xe6,0x36,0x8f,0xa2,0x04,0xd4,0x0c,0x0d,0xb7,0x1d,0x5b,0x1c,0x43,0x9e,0x5a,0x26,
+  0xbe,0xa8,0xc4,0xe5,0xfb,0xa9,0x89,0xf6,0xf4,0x42,0x51,0x28,0xe9,0x7c,0xb9,0xe2,
+  0xf3,0xee,0xc8,0xbb,0xf1,0x70,0x60,0xe7,0x6d,0xdb,0xea,0x2b,0x86,0xa0,0x49,0x28,
+  0x94,0x89,0x9d,0x8f,0xc6,0x79,0xef,0x77,0x95,0x26,0x36,0x1d,0x1a,0x1e,0x3e,0x3d,
+  0xd2,0x3d,0xfc,0xc6,0x3c,0x82,0x94,0xd6,0xde,0x97,0x62,0x5e,0xa2,0x77,0x1c,0x96,
+  0xbb,0xf6,0xa9,0x18,0xd9,0xd2,0x59,0x7d,0x3f,0xa5,0x91,0x25,0xf3,0x1c,0xa8,0xeb,
+  0x4d,0x7d,0xe2,0xd4,0xe4,0x04,0x29,0xd2,0x38,0xe5,0x1b,0x6d,0xec,0xa6,0x52,0x8d,
+  0xcb,0x04,0xc7,0x29,0xb4,0x71,0xef,0x5c,0x05,0x94,0xb3,0x0e,0x5d,0x27,0xf0,0x10,
+  0x79,0x6e,0x1a,0x52,0x80,0x5e,0x13,0x50,0x3f,0xba,0x63,0xe2,0x4a,0x1b,0x78,0xd9,
+  0x7e,0x52,0x5d,0x03,0x38,0x1c,0x7c,0x29,0x4a,0x01,0x24,0xc7,0xb4,0x20,0x1d,0x9e,
+  0xff,0xeb,0xc0,0x49,0x01,0x44,0x27,0x23,0xdb,0x9c,0x4e,0x2a,0xc4,0x91,0xce,0x17,
+  0xd2,0x2d,0x2f,0x0f,0x46,0x3c,0xd1,0x9b,0x38,0xc6,0x80,0xfa,0x76,0xf4,0xa0,0xcd,
+  0xf8,0x56,0xbc,0x3e,0xab,0xd1,0xe4,0xbb,0x15,0x9a,0x6f,0xe9,0x2a,0xf0,0x70,0x2b,
+  0xac,0xb9,0x3b,0xaa,0xa1,0xd5,0x56,0x68,0xb5,0x3f,0xaf,0x41,0x03,0xd3,0xed,0xd0,
+  0x54,0xca,0xb3,0x04,0x9b,0xdc,0xb4,0x37,0x68,0x8e,0x84,0x37,0xf1,0x1e,0x91,0x91,
+  0x57,0xac,0x64,0xef,0xda,0x8b,0x17,0x72,0xc4,0x23,0xf9,0xb7,0x6f,0x54,0xb5,0x58,
+  0x9b,0x6a,0x99,0x7e,0x99,0xf5,0xb0,0x5e,0x6c,0xdd,0x6f,0x99,0x5d,0x55,0xef,0xb6,
+  0x6e,0xb0,0xcc,0x2e,0x73,0x0a,0x22,0x45,0x9e,0x24,0x29,0x9f,0x3c,0x61,0x86,0x5b,
+  0x02,0xbc,0x7e,0x6d,0xd1,0x8e,0xcd,0xc6,0x2b,0x0c,0x2a,0xf6,0x94,0xb7,0xab,0x36,
+  0xf9,0x11,0x5f,0x09,0xb9,0x4d,0xed,0x36,0xd5,0x6a,0xa9,0xd3,0x92,0x9e,0x7e,0xfc,
+  0x65,0x99,0xea,0x77,0x46,0x24,0xd2,0x23,0xf8,0xe5,0x3b,0x1d,0x90,0x30,0xed,0xab,
+  0xb8,0xf9,0x1f,0x59,0x74,0xcb,0x4f,0xb2,0x48,0x7d,0x16,0xcd,0x65,0xba,0xc0,0xc1,
+  0xc5,0x19,0x8d,0x8d,0xdc,0x33,0xd0,0x44,0x15,0xe9,0xec,0xfd,0x3c,0x68,0xd7,0x44,
+  0x9f,0x6e,0xf1,0x4f,0x89,0xb0,0xdd,0x8a,0xec,0xc2,0x08,0x65,0x68,0x1b,0xbf,0xff,
+  0xbf,0x92,0x99,0x62,0x22,0xee,0x54,0x04,0xe5,0x5d,0xd7,0xbc,0xab,0xc4,0x79,0x34,
+  0x6f,0x8c,0xad,0x7b,0x38,0xc4,0xce,0xed,0x56,0x12,0x3d,0x9e,0x43,0xf7,0xa2,0x9a,
+  0x70,0x1c,0x65,0xf4,0x6f,0x0a,0x6f,0x51,0xa5,0xb4,0xfd,0x1d,0xf9,0x65,0x28,0x39,
+  0xdf,0xbe,0x0d,0xaa,0x4c,0xdb,0x9f,0x7f,0x27,0x0d,0xce,0xba,0x26,0x01,0x2a,0x47,
+  0xfc,0x0e,0x64,0x85,0xb3,0x38,0x3a,0x14,0xdf,0xc7,0xa3,0x7c,0xfd,0xb1,0x88,0x72,
+  0x49,0xd3,0x81,0x39,0xc7,0xbb,0xeb,0xf2,0x30,0xe6,0x2d,0xa9,0x9a,0x8e,0x56,0x7c,
+  0xc5,0x46,0x1f,0x9d,0x56,0x4e,0x0d,0xcd,0xaf,0x4e,0x2b,0x95,0x86,0x60,0xbb,0x66,
+  0x5e,0xb0,0xa2,0x53,0xd2,0xa0,0x3c,0x1a,0x71,0x2e,0x15,0x97,0x95,0x72,0xb3,0xc1,
+  0xd4,0x57,0xb9,0x56,0x67,0x35,0x97,0x3a,0x4c,0x83,0xa1,0xf5,0xe9,0xe3,0xe4,0xcc,
+  0xea,0xd0,0xec,0x22,0x73,0x35,0x5c,0x59,0x45,0x3b,0xee,0x9e,0x2d,0x33,0x69,0x0d,
+  0x2d,0xb4,0x61,0x1c,0xab,0x3d,0xf2,0x72,0x9f,0xea,0xb7,0xb5,0xee,0xd0,0xdd,0xe3,
+  0xf0,0x6f,0x93,0x8f,0x1f,0x7a,0xe6,0xfa,0x21,0x9a,0x2d,0xed,0x42,0x06,0x67,0xed,
+  0x18,0x1b,0x80,0x79,0x2f,0xbd,0xaa,0xac,0x40,0xef,0xa0,0xc4,0xcc,0x8b,0xe2,0x0d,
+  0x1b,0x34,0x62,0xd6,0x2d,0xda,0x0a,0x45,0xd7,0xc3,0x16,0xe7,0x77,0x55,0x30,0x39,
+  0x26,0xbd,0x37,0xd7,0x58,0x7e,0x1f,0x29,0x48,0x2b,0x73,0x1c,0xcc,0x21,0xe6,0x95,
+  0xd5,0x69,0xd0,0xdc,0xd6,0x36,0xf9,0xdd,0xd8,0x56,0x3a,0x55,0x48,0x6f,0x23,0x53,
+  0xbf,0x57,0xde,0x4a,0x8b,0x4d,0xb3,0x85,0x8c,0x79,0xe7,0xbc,0x95,0x04,0x55,0x80,
+  0xaa,0x7b,0xf1,0xfd,0x11,0x66,0xf9,0x47,0x46,0xd1,0x2d,0xe4,0xe4,0x9d,0x21,0x14,
+  0xb9,0xe4,0xe5,0x97,0x34,0x64,0x92,0x01,0x55,0x35,0xa5,0xf1,0x05,0x5c,0x48,0xa7,
+  0x85,0xf6,0x20,0xea,0x54,0x53,0xd8,0xc6,0x3a,0x4f,0x81,0x7c,0xd9,0xfc,0x18,0x77,
+  0x22,0x5d,0xb1,0x6d,0xdc,0xa9,0x39,0x75,0x9f,0xbe,0x77,0xdb,0x70,0x78,0x50,0x79,
+  0x73,0x1d,0x75,0xaf,0xfa,0xfc,0x8e,0xb6,0x16,0xa0,0xf5,0x52,0xa1,0x62,0xc5,0xe9,
+  0xec,0x8a,0x7b,0x2e,0x05,0xf8,0x0a,0x73,0x73,0x16,0x29,0xde,0x76,0xf0,0x19,0xe2,
+  0x1f,0x0b,0xb9,0xe0,0xbe,0x66,0xaa,0xee,0x4e,0x45,0xe3,0xae,0x28,0x66,0x8b,0x3d,
+  0x5b,0x5b,0xe3,0x49,0x83,0x8a,0x39,0x0d,0x35,0x89,0x9a,0x21,0x85,0x8a,0x09,0xfc,
+  0x73,0x98,0x44,0x73,0x4e,0xcb,0xb7,0x39,0xaa,0x86,0x5d,0x52,0xb9,0x4f,0x8c,0xc6,
+  0xf9,0xc6,0x0c,0x44,0x10,0xf9,0x26,0x4a,0x82,0xf4,0xe6,0x1e,0xb9,0x10,0xcf,0x38,
+  0x0f,0x5a,0x1d,0x83,0x04,0xc8,0xf6,0xb0,0xdb,0x9a,0x65,0xeb,0x9c,0x85,0x6b,0x4e,
+  0xe8,0xff,0x49,0x60,0x3b,0x6e,0x56,0xab,0x87,0x00,0xd7,0x9d,0xfd,0xc1,0x60,0xe0,
+  0xfc,0x85,0x16,0xf4,0x60,0x18,0xd9,0xf2,0x5a,0x33,0x2b,0x14,0x1c,0x3c,0x96,0xee,
+  0x8b,0x02,0x1c,0x02,0x36,0xa9,0x6c,0x94,0x1a,0xb2,0xc0,0x41,0xbf,0x7c,0xa3,0x7d,
+  0xd0,0x2f,0xfe,0x05,0x83,0xff,0xe3,0x6d,0xe7,0x7f,0xec,0x5b,0x74,0xff,0x08,0x27,
+  0x00,0x00,
+};
@@ -4,6 +4,13 @@
   - HTTP API for sensors and web UI
   - Persist device configs to LittleFS
   - No WebSockets; clients poll API
+  - /api/metrics: Prometheus counters/histograms for handlers, loop time, heap
+  - Logging is level-gated and deferred (common/log_ring.h), drained from loop()
+  - Web UI lives in web/index.html; run tools/embed_web_ui.py after editing it
+  - USE_REPLICATION: two instances pull each other's table changes
+    (common/repl_log.h); sensors report to either, both serve reads
+  - USE_MQTT: level and alarm changes go out to a broker, coalesced per
+    MQTT_INTERVAL_MS and retained (common/mqtt_egress.h)
 */
 
 #include <WiFi.h>
@@ -12,6 +19,24 @@
 #include <LittleFS.h>
 #include <esp_wifi.h>
 #include <ESPmDNS.h>
+#include <esp_now.h>
+#include <WiFiUdp.h>
+#include <HTTPClient.h>
+#include <mqtt_client.h>
+#include <atomic>
+#include "sender-server-ui.h"
+#include "common/latency_hist.h"
+#include "common/tank_trend.h"
+#include "common/alarm_rules.h"
+#include "common/link_stats.h"
+#include "common/espnow_frame.h"
+#include "common/response_cache.h"
+#include "common/repl_log.h"
+#include "common/mqtt_egress.h"
+
+#define LOG_LEVEL LOG_LEVEL_INFO   // per-report lines are LOG_LEVEL_DEBUG
+#define LOG_LINE_MAX 160
+#include "common/log_ring.h"
 
 /* ---------------- CONFIG ---------------- */
 const char* AP_SSID = "Sender-Direct";
@@ -32,8 +57,60 @@ IPAddress STA_DNS2(8,8,4,4);
 
 const int HTTP_PORT = 80;
 const char* DEVICES_FILE = "/devices.json";
+const char* DEVICES_TMP_FILE = "/devices.json.tmp";   // written first, renamed over DEVICES_FILE
+const char* DEVICES_BAD_FILE = "/devices.json.bad";   // a file that failed to load is kept here
 const int MAX_DEVICES = 128;
 const unsigned long ACTIVE_THRESHOLD_SEC = 15; // for receiver display to consider active
+// alarm defaults for devices without their own thresholds (POST /api/device to change)
+const AlarmConfig ALARM_DEFAULTS = { 15.0f, 95.0f, 60 };  // low %, high %, stale s
+const float ALARM_HYST_PCT = 2.0f;            // level must come back this far to clear
+// sensors ask /api/config for their report interval; link quality scales it
+const unsigned long SENSOR_REPORT_BASE_MS = 2500;
+const unsigned long SENSOR_REPORT_MIN_MS = 1000;
+const unsigned long SENSOR_REPORT_MAX_MS = 20000;
+const unsigned long SWEEP_MS = 1000;          // AP station refresh + staleness check interval
+const unsigned long BENCH_LOG_INTERVAL_MS = 10000; // one-line JSON ingest stats on Serial; 0 disables
+const int RESPONSE_CACHE_SLOTS = 8;           // serialized read bodies kept (/api/devices variants, /status, /api/config)
+const size_t RESPONSE_CACHE_BYTES = 48 * 1024;
+const int REPORT_BATCH_MAX = 64;              // samples per POST /api/report/batch (esp8266.cpp BATCH_MAX)
+const size_t REPORT_BATCH_JSON = JSON_OBJECT_SIZE(6) + JSON_ARRAY_SIZE(REPORT_BATCH_MAX)
+                                 + REPORT_BATCH_MAX * JSON_ARRAY_SIZE(3) + 128;
+// devices.json with every slot used: 7 members each, mac and name copied on save
+// (loading parses the buffer in place, so the same size holds the file)
+const size_t DEVICES_JSON = JSON_OBJECT_SIZE(1) + JSON_ARRAY_SIZE(MAX_DEVICES)
+                            + MAX_DEVICES * (JSON_OBJECT_SIZE(7) + 18 + 32);
+// connectionless reports (common/espnow_frame.h); sensors must sit on the AP's channel,
+// which follows the router's once the STA is connected. Off like esp8266.cpp's
+// USE_ESPNOW; turn both on together
+const bool USE_ESPNOW = false;
+// the same frames over UDP for host tools (tools/report_bench.py): an open port with
+// no auth, so bench builds only (-DESPNOW_UDP_STANDIN; tools/fleet_sim.py sets it)
+#ifdef ESPNOW_UDP_STANDIN
+const uint16_t ESPNOW_UDP_PORT = ESPNOW_STANDIN_PORT;
+#else
+const uint16_t ESPNOW_UDP_PORT = 0;                   // 0 disables
+#endif
+// replication pair: the peer runs this same sketch with STA_LOCAL_IP and REPL_PEER_IP swapped
+// (sensors: esp8266.cpp ROUTER_SENDER_IP / ROUTER_SENDER_IP_ALT)
+const bool USE_REPLICATION = false;
+IPAddress REPL_PEER_IP(192,168,1,51);
+const int REPL_LOG_ENTRIES = 256;             // ~20 s of 32 sensors at 2.5 s; a peer away longer takes a snapshot
+const unsigned long REPL_PULL_MS = 500;       // replication lag is about half this
+const unsigned long REPL_RETRY_MS = 2000;     // while the peer does not answer
+const uint16_t REPL_TIMEOUT_MS = 100;         // connect, headers and body each: loop() waits at most 3x this per pull
+// MQTT egress: retained <MQTT_BASE>/<name or MAC>/level and .../alarm, at most one of each
+// per device per interval; levels from this instance's own reports only (a replication peer
+// publishes its own)
+const bool USE_MQTT = false;
+const char* MQTT_URI = "mqtt://192.168.1.10:1883";
+const char* MQTT_BASE = "tanks";               // at most MQTT_BASE_MAX chars
+const unsigned long MQTT_INTERVAL_MS = 1000;
+const int MQTT_QUEUE = 128;                   // flushed messages waiting for the client (most per flush); oldest dropped
+const uint8_t MQTT_LEVEL_QOS = 0;
+const uint8_t MQTT_ALARM_QOS = 1;
+const int MQTT_INFLIGHT_MAX = 8;              // QoS 1 messages not yet acknowledged
+const int MQTT_PUBLISH_PER_LOOP = 16;
+const unsigned long MQTT_RESYNC_MIN_MS = 60000; // a flapping broker gets every device republished at most this often
 /* ---------------------------------------- */
 
 WebServer server(HTTP_PORT);
@@ -43,27 +120,109 @@ struct Device {
   bool macKnown;
   uint8_t mac[6];
   IPAddress ip;
-  int8_t rssi;
+  LinkStats link;           // RSSI (AP side + sensor side), loss from seq gaps, jitter
   char name[32];
   float percent;
   float totalHeightCm;
   float sensorToMaxCm;
   unsigned long lastSeen;
+  uint32_t seq;            // sensor sequence number of the last report
+  uint32_t boot;           // the sensor's boot id with it (0 = not given); seq restarts with it
+  unsigned long sampleMs;  // when that reading was taken, on our clock (0 = unknown)
+  TankTrend trend;         // rate / time-to-empty / anomaly state, fed by every report
+  uint32_t configVersion;  // configStamp at the last change of name or geometry; keys cached /api/config
+  AlarmConfig alarmCfg;    // persisted thresholds
+  AlarmRule alarmRule;     // alarmCfg compiled; the only thing evaluated per report
+  uint8_t alarm;           // AlarmFlag bits
+  unsigned long alarmSinceMs; // last change of alarm
 };
 
 Device devices[MAX_DEVICES];
+uint32_t alarmVersion = 0;  // bumped on every alarm change; "version" in /api/alarms
+uint32_t tableVersion = 0;  // bumped on every change to devices[]
+uint32_t listVersion = 0;   // devices added or edited, alarms raised or cleared; keys cached /api/devices
+uint32_t configStamp = 0;   // source of Device::configVersion; global so a reused slot never repeats one
+ResponseCache<String, RESPONSE_CACHE_SLOTS> responseCache;
+ReplLog<REPL_LOG_ENTRIES> replLog;  // this instance's own changes, pulled by the peer
+MqttEgress<MAX_DEVICES, MQTT_QUEUE> mqttOut;
+
+void mqttMark(int idx, MqttKind kind) {
+  if (USE_MQTT) egressMark(mqttOut, idx, kind);
+}
+
+// what GET /api/config returns for the slot changed
+void configTouched(int idx) {
+  devices[idx].configVersion = ++configStamp;
+}
+
+/* metrics: per-handler call counts + latency histograms (us), exported on /api/metrics */
+enum MetricId { M_REPORT, M_REPORT_BATCH, M_ESPNOW_REPORT, M_GET_DEVICES, M_SAVE_DEVICE, M_SAVE_FS, M_REFRESH_STATIONS, M_REPLOG, M_REPL_PULL, M_COUNT };
+const char* const METRIC_NAMES[M_COUNT] = { "report", "report_batch", "espnow_report", "get_devices", "save_device", "save_fs", "refresh_stations", "replog", "repl_pull" };
+
+struct HandlerMetric {
+  uint32_t calls;
+  LatencyHist us;
+};
+HandlerMetric handlerMetrics[M_COUNT];
+LatencyHist loopUs;
+
+// times the enclosing scope, early returns included
+struct ScopedMetric {
+  MetricId id;
+  unsigned long t0;
+  explicit ScopedMetric(MetricId m) : id(m), t0(micros()) {}
+  ~ScopedMetric() {
+    handlerMetrics[id].calls++;
+    handlerMetrics[id].us.record(micros() - t0);
+  }
+};
+
+/* alarms: rules are compiled when the config changes, evaluated on ingest + by a staleness sweep */
+void setAlarmConfig(int i, const AlarmConfig& c) {
+  devices[i].alarmCfg = c;
+  devices[i].alarmRule = alarmCompile(c, ALARM_HYST_PCT);
+}
+
+void alarmFlagsToString(uint8_t a, char* out, size_t n) {
+  snprintf(out, n, "%s%s%s%s", a ? "" : "ok", (a & ALARM_LOW) ? "low " : "",
+           (a & ALARM_HIGH) ? "high " : "", (a & ALARM_STALE) ? "stale " : "");
+}
+
+void setAlarm(int i, uint8_t a) {
+  if (a == devices[i].alarm) return;
+  char was[24], now[24];
+  alarmFlagsToString(devices[i].alarm, was, sizeof(was));
+  alarmFlagsToString(a, now, sizeof(now));
+  LOGW("Alarm %s: %s-> %s", devices[i].name[0] ? devices[i].name : "(unnamed)", was, now);
+  devices[i].alarm = a;
+  devices[i].alarmSinceMs = millis();
+  alarmVersion++;
+  tableVersion++;
+  listVersion++;
+  mqttMark(i, MQTT_ALARM);
+}
+
+void alarmSweep() {
+  unsigned long now = millis();
+  for (int i=0;i<MAX_DEVICES;i++) {
+    if (!devices[i].used || devices[i].lastSeen == 0) continue;
+    setAlarm(i, alarmOnSweep(devices[i].alarmRule, devices[i].alarm, now - devices[i].lastSeen));
+  }
+}
 
 /* LittleFS helpers */
 bool initFileSystem() {
   if (!LittleFS.begin(true)) {
-    Serial.println("LittleFS begin failed!");
+    LOGE("LittleFS begin failed!");
     return false;
   }
   return true;
 }
 
 bool saveDevicesToFS() {
-  StaticJsonDocument<16384> doc;
+  ScopedMetric metric(M_SAVE_FS);
+  DynamicJsonDocument doc(DEVICES_JSON);
+  if (doc.capacity() == 0) { LOGE("No memory for devices.json; not saved"); return false; }
   JsonArray arr = doc.createNestedArray("devices");
   for (int i=0;i<MAX_DEVICES;i++){
     if (!devices[i].used) continue;
@@ -78,31 +237,49 @@ bool saveDevicesToFS() {
     o["name"] = devices[i].name[0] ? devices[i].name : nullptr;
     o["totalHeightCm"] = devices[i].totalHeightCm;
     o["sensorToMaxCm"] = devices[i].sensorToMaxCm;
+    o["alarmLowPct"] = devices[i].alarmCfg.lowPct;
+    o["alarmHighPct"] = devices[i].alarmCfg.highPct;
+    o["staleSec"] = devices[i].alarmCfg.staleSec;
   }
-  File f = LittleFS.open(DEVICES_FILE, "w");
-  if (!f) { Serial.println("Failed open devices file for write"); return false; }
-  if (serializeJsonPretty(doc, f) == 0) { Serial.println("Failed writing JSON"); f.close(); return false; }
+  // a short document would drop devices from the file; keep the last good one instead
+  if (doc.overflowed()) { LOGE("devices.json over %u B; not saved", (unsigned)DEVICES_JSON); return false; }
+  File f = LittleFS.open(DEVICES_TMP_FILE, "w");
+  if (!f) { LOGE("Failed open devices file for write"); return false; }
+  size_t want = measureJsonPretty(doc);
+  size_t wrote = serializeJsonPretty(doc, f);
   f.close();
-  Serial.println("Saved devices to LittleFS");
+  if (wrote != want) {
+    LOGE("Failed writing JSON (%u of %u B)", (unsigned)wrote, (unsigned)want);
+    LittleFS.remove(DEVICES_TMP_FILE);
+    return false;
+  }
+  if (!LittleFS.rename(DEVICES_TMP_FILE, DEVICES_FILE)) { LOGE("Failed replacing devices file"); return false; }
+  LOGI("Saved devices to LittleFS");
   return true;
 }
 
 bool loadDevicesFromFS() {
   if (!LittleFS.exists(DEVICES_FILE)) {
-    Serial.println("devices.json not found; starting fresh");
+    LOGI("devices.json not found; starting fresh");
     return false;
   }
   File f = LittleFS.open(DEVICES_FILE, "r");
-  if (!f) { Serial.println("Failed to open devices file"); return false; }
+  if (!f) { LOGE("Failed to open devices file"); return false; }
   size_t sz = f.size();
   std::unique_ptr<char[]> buf(new char[sz+1]);
   f.readBytes(buf.get(), sz);
   buf[sz] = 0;
   f.close();
 
-  StaticJsonDocument<16384> doc;
+  DynamicJsonDocument doc(DEVICES_JSON);
   auto err = deserializeJson(doc, buf.get());
-  if (err) { Serial.printf("Failed parse devices.json: %s\n", err.c_str()); return false; }
+  if (err) {
+    // set it aside: the next save would otherwise replace it with an empty table
+    LOGE("Failed parse devices.json: %s; kept as %s", err.c_str(), DEVICES_BAD_FILE);
+    LittleFS.remove(DEVICES_BAD_FILE);
+    LittleFS.rename(DEVICES_FILE, DEVICES_BAD_FILE);
+    return false;
+  }
 
   for (int i=0;i<MAX_DEVICES;i++) devices[i].used = false;
 
@@ -127,14 +304,24 @@ bool loadDevicesFromFS() {
       strncpy(devices[idx].name, name, sizeof(devices[idx].name)-1);
       devices[idx].totalHeightCm = o["totalHeightCm"] | 0.0f;
       devices[idx].sensorToMaxCm = o["sensorToMaxCm"] | 0.0f;
+      AlarmConfig ac;
+      ac.lowPct = o["alarmLowPct"] | ALARM_DEFAULTS.lowPct;
+      ac.highPct = o["alarmHighPct"] | ALARM_DEFAULTS.highPct;
+      ac.staleSec = o["staleSec"] | ALARM_DEFAULTS.staleSec;
+      setAlarmConfig(idx, ac);
       devices[idx].percent = -1;
       devices[idx].ip = IPAddress(0,0,0,0);
-      devices[idx].rssi = 0;
+      linkReset(devices[idx].link);
       devices[idx].lastSeen = 0;
+      devices[idx].seq = 0;
+      devices[idx].sampleMs = 0;
+      trendReset(devices[idx].trend);
+      devices[idx].alarm = 0;
+      devices[idx].alarmSinceMs = 0;
       idx++;
     }
   }
-  Serial.println("Loaded devices from LittleFS");
+  LOGI("Loaded devices from LittleFS");
   return true;
 }
 
@@ -167,122 +354,656 @@ int findFreeSlot() {
   return -1;
 }
 
-/* try to refresh AP station list so we at least mark 'lastSeen' for connected AP clients */
+/* AP stations -> device slots, kept across sweeps so only joins/leaves touch the table */
+struct StationSlot {
+  uint8_t mac[6];
+  int slot;
+};
+StationSlot stations[ESP_WIFI_MAX_CONN_NUM];
+int stationCount = 0;
+
+// diff the AP's station list against the previous one; only new stations
+// are looked up (or given a slot), then every mapped slot is marked seen
 void refreshConnectedStations() {
+  ScopedMetric metric(M_REFRESH_STATIONS);
   wifi_sta_list_t sta_list;
   memset(&sta_list, 0, sizeof(sta_list));
   esp_err_t r = esp_wifi_ap_get_sta_list(&sta_list);
   if (r != ESP_OK) return;
   unsigned long now = millis();
+  StationSlot next[ESP_WIFI_MAX_CONN_NUM];
+  int n = 0;
   for (int i=0;i<sta_list.num;i++) {
     wifi_sta_info_t s = sta_list.sta[i];
-    int idx = findDeviceByMAC(s.mac);
+    int idx = -1;
+    for (int k=0;k<stationCount;k++) {
+      if (memcmp(stations[k].mac, s.mac, 6) == 0) { idx = stations[k].slot; break; }
+    }
     if (idx == -1) {
-      idx = findFreeSlot();
-      if (idx == -1) continue;
-      devices[idx].used = true;
-      devices[idx].macKnown = true;
-      memcpy(devices[idx].mac, s.mac, 6);
-      devices[idx].name[0]=0;
-      devices[idx].percent = -1;
-      devices[idx].totalHeightCm = 0;
-      devices[idx].sensorToMaxCm = 0;
-      devices[idx].ip = IPAddress(0,0,0,0);
-      devices[idx].rssi = 0;
+      idx = findDeviceByMAC(s.mac);
+      if (idx == -1) {
+        idx = findFreeSlot();
+        if (idx == -1) continue;
+        devices[idx].used = true;
+        devices[idx].macKnown = true;
+        memcpy(devices[idx].mac, s.mac, 6);
+        devices[idx].name[0]=0;
+        devices[idx].percent = -1;
+        devices[idx].totalHeightCm = 0;
+        devices[idx].sensorToMaxCm = 0;
+        devices[idx].ip = IPAddress(0,0,0,0);
+        linkReset(devices[idx].link);
+        devices[idx].seq = 0;
+        devices[idx].sampleMs = 0;
+        trendReset(devices[idx].trend);
+        setAlarmConfig(idx, ALARM_DEFAULTS);
+        devices[idx].alarm = 0;
+        devices[idx].alarmSinceMs = 0;
+        configTouched(idx);
+        listVersion++;
+      }
+      LOGD("Station joined: %s -> slot %d", macToString(s.mac).c_str(), idx);
     }
+    memcpy(next[n].mac, s.mac, 6);
+    next[n].slot = idx;
+    n++;
     devices[idx].lastSeen = now;
+    linkOnRssi(devices[idx].link, s.rssi);  // as the AP hears the sensor
   }
+  memcpy(stations, next, sizeof(StationSlot) * n);
+  if (n || stationCount) tableVersion++;  // lastSeen / RSSI moved
+  stationCount = n;
+}
+
+/* ingest bench: reports/s and handleReport service time, logged as one JSON line */
+LatencyHist benchReportUs;
+unsigned long benchWindowStart = 0;
+
+void benchLogTick() {
+  if (BENCH_LOG_INTERVAL_MS == 0) return;
+  unsigned long now = millis();
+  if (now - benchWindowStart < BENCH_LOG_INTERVAL_MS) return;
+  unsigned long window = now - benchWindowStart;
+  LOGI("{\"bench\":\"ingest\",\"window_ms\":%lu,\"reports\":%u,\"rps\":%.2f,"
+                "\"p50_us\":%u,\"p99_us\":%u,\"p999_us\":%u,\"max_us\":%u}",
+                window, benchReportUs.count(), benchReportUs.count() * 1000.0f / window,
+                benchReportUs.percentile(0.5f), benchReportUs.percentile(0.99f),
+                benchReportUs.percentile(0.999f), benchReportUs.max());
+  benchReportUs.reset();
+  benchWindowStart = now;
+}
+
+unsigned long sensorReportIntervalMs(int i) {
+  return linkSuggestIntervalMs(devices[i].link, SENSOR_REPORT_BASE_MS, SENSOR_REPORT_MIN_MS, SENSOR_REPORT_MAX_MS);
+}
+
+/* report ingest: the one device-table update path, fed by POST /api/report and ESP-NOW */
+struct SensorReport {
+  const char* name;         // "" = not given
+  float percent;
+  float totalHeightCm;
+  float sensorToMaxCm;
+  const uint8_t* mac;       // nullptr = not given
+  uint32_t seq;
+  uint32_t boot;            // sensor boot id, 0 = not given (ESP-NOW, peer records)
+  unsigned long ageMs;      // how long before sending the sensor took the reading
+  int rssi;                 // the sensor's view of its AP / the sender, 0 = unknown
+};
+
+// slot by MAC, then name, then a free one; -1 if the table is full
+int reportSlot(const SensorReport& r) {
+  int idx = -1;
+  if (r.mac) {
+    idx = findDeviceByMAC(r.mac);
+    if (idx == -1) {
+      int free = findFreeSlot();
+      if (free != -1) {
+        idx = free;
+        devices[idx].used = true;
+        devices[idx].macKnown = true;
+        memcpy(devices[idx].mac, r.mac, 6);
+        listVersion++;
+      }
+    }
+  }
+
+  if (idx == -1 && strlen(r.name)) idx = findDeviceByName(r.name);
+  if (idx == -1) {
+    idx = findFreeSlot();
+    if (idx == -1) return -1;
+    devices[idx].used = true;
+    devices[idx].macKnown = false;
+    memset(devices[idx].mac,0,6);
+    listVersion++;
+  }
+
+  if (r.mac && !(devices[idx].macKnown && memcmp(devices[idx].mac, r.mac, 6) == 0)) {
+    devices[idx].macKnown = true;
+    memcpy(devices[idx].mac, r.mac, 6);
+    listVersion++;
+  }
+  if (strlen(r.name) && strncmp(devices[idx].name, r.name, sizeof(devices[idx].name)-1) != 0) {
+    strncpy(devices[idx].name, r.name, sizeof(devices[idx].name)-1);
+    configTouched(idx);
+    listVersion++;
+  }
+  return idx;
+}
+
+// backfill: a reading from a sensor's backlog; its sample time stands in for the
+// arrival time so a burst of them does not read as jitter
+void applyReading(int idx, const SensorReport& r, bool backfill) {
+  if (devices[idx].totalHeightCm != r.totalHeightCm || devices[idx].sensorToMaxCm != r.sensorToMaxCm) configTouched(idx);
+  devices[idx].percent = r.percent;
+  devices[idx].totalHeightCm = r.totalHeightCm;
+  devices[idx].sensorToMaxCm = r.sensorToMaxCm;
+  devices[idx].lastSeen = millis();
+  devices[idx].seq = r.seq;
+  devices[idx].boot = r.boot;
+  devices[idx].sampleMs = devices[idx].lastSeen - r.ageMs;
+  if (devices[idx].sampleMs == 0) devices[idx].sampleMs = 1;
+  trendUpdate(devices[idx].trend, r.percent, devices[idx].sampleMs);
+  setAlarm(idx, alarmOnReport(devices[idx].alarmRule, devices[idx].alarm, r.percent));
+  linkOnFrame(devices[idx].link, r.seq, backfill ? devices[idx].sampleMs : devices[idx].lastSeen);
+  if (r.rssi < 0) linkOnRssi(devices[idx].link, r.rssi);
+  tableVersion++;
+}
+
+/* replication log: local changes only; what the peer sends is applied without logging */
+void replFill(ReplRecord& e, int idx, ReplType type) {
+  e.type = type;
+  if (devices[idx].macKnown) { e.flags |= REPL_MAC; memcpy(e.mac, devices[idx].mac, 6); }
+  strncpy(e.name, devices[idx].name, sizeof(e.name)-1);
+  e.name[sizeof(e.name)-1] = 0;
+  e.totalHeightCm = devices[idx].totalHeightCm;
+  e.sensorToMaxCm = devices[idx].sensorToMaxCm;
+}
+
+void replLogReport(int idx, bool backfill) {
+  if (!USE_REPLICATION) return;
+  ReplRecord& e = replAppend(replLog);
+  replFill(e, idx, REPL_REPORT);
+  if (backfill) e.flags |= REPL_BACKFILL;
+  e.sensorSeq = devices[idx].seq;
+  e.timeMs = devices[idx].sampleMs;
+  e.permille = devices[idx].percent < 0 ? LEVEL_NO_ECHO : (uint16_t)lroundf(devices[idx].percent * 10.0f);
+}
+
+void replLogConfig(int idx) {
+  if (!USE_REPLICATION) return;
+  ReplRecord& e = replAppend(replLog);
+  replFill(e, idx, REPL_CONFIG);
+  e.alarmLowPct = devices[idx].alarmCfg.lowPct;
+  e.alarmHighPct = devices[idx].alarmCfg.highPct;
+  e.staleSec = devices[idx].alarmCfg.staleSec;
+}
+
+// a reading the device already has (a report or batch resent after a lost reply): the
+// same sensor boot and a seq at or up to LINK_RESYNC_GAP behind the last one applied,
+// wrap-safe. Another boot id restarts the window, so a sensor that rebooted and starts
+// over at seq 0 is not mistaken for a resend; without one (0) nothing counts as seen.
+// Not the sample time: that is now - age_ms, which moves with the transit time
+bool reportSeen(int idx, uint32_t boot, uint32_t seq) {
+  const Device& d = devices[idx];
+  return boot != 0 && d.boot == boot && d.sampleMs != 0 && d.seq - seq < LINK_RESYNC_GAP;
+}
+
+int applyReport(const SensorReport& r) {
+  int idx = reportSlot(r);
+  if (idx != -1 && !reportSeen(idx, r.boot, r.seq)) {
+    applyReading(idx, r, false);
+    replLogReport(idx, false);
+    mqttMark(idx, MQTT_LEVEL);
+  }
+  return idx;
 }
 
 /* HTTP handlers */
 
-// POST /api/report  { name, percent, totalHeightCm, sensorToMaxCm, mac (optional) }
+// POST /api/report  { name, percent, totalHeightCm, sensorToMaxCm, mac (optional), seq, boot, age_ms, rssi (optional) }
+// age_ms: how long before sending the sensor took the reading; rssi: the sensor's view of its AP;
+// boot: random per sensor boot, so a resent report is told from a restarted seq (reportSeen)
 void handleReport() {
+  ScopedMetric metric(M_REPORT);
   if (server.method() != HTTP_POST) { server.send(405); return; }
+  unsigned long t0 = micros();
   String body = server.arg("plain");
   if (body.length() == 0) { server.send(400, "text/plain", "empty"); return; }
   StaticJsonDocument<512> doc;
   auto err = deserializeJson(doc, body);
   if (err) { server.send(400, "text/plain", "json"); return; }
-  const char* name = doc["name"] | "";
-  float percent = doc["percent"] | -1.0f;
-  float totalH = doc["totalHeightCm"] | 0.0f;
-  float s2m = doc["sensorToMaxCm"] | 0.0f;
-  const char* macs = doc["mac"] | "";
+  SensorReport r;
+  r.name = doc["name"] | "";
+  r.percent = doc["percent"] | -1.0f;
+  r.totalHeightCm = doc["totalHeightCm"] | 0.0f;
+  r.sensorToMaxCm = doc["sensorToMaxCm"] | 0.0f;
+  r.mac = nullptr;
+  r.seq = doc["seq"] | 0u;
+  r.boot = doc["boot"] | 0u;
+  r.ageMs = doc["age_ms"] | 0UL;
+  r.rssi = doc["rssi"] | 0;
 
-  int idx = -1;
+  const char* macs = doc["mac"] | "";
   uint8_t macBuf[6] = {0};
   if (macs && strlen(macs) >= 17) {
     unsigned int b[6];
     if (sscanf(macs, "%02X:%02X:%02X:%02X:%02X:%02X",
                &b[0],&b[1],&b[2],&b[3],&b[4],&b[5])==6) {
       for (int k=0;k<6;k++) macBuf[k] = (uint8_t)b[k];
-      idx = findDeviceByMAC(macBuf);
-      if (idx == -1) {
-        int free = findFreeSlot();
-        if (free != -1) {
-          idx = free;
-          devices[idx].used = true;
-          devices[idx].macKnown = true;
-          memcpy(devices[idx].mac, macBuf, 6);
-        }
-      }
+      r.mac = macBuf;
     }
   }
 
-  if (idx == -1 && name && strlen(name)) idx = findDeviceByName(name);
-  if (idx == -1) {
-    idx = findFreeSlot();
-    if (idx == -1) { server.send(500, "application/json", "{\"ok\":false,\"msg\":\"table-full\"}"); return; }
-    devices[idx].used = true;
-    devices[idx].macKnown = false;
-    memset(devices[idx].mac,0,6);
-  }
-
-  if (macs && strlen(macs) >= 17) {
-    devices[idx].macKnown = true;
-    memcpy(devices[idx].mac, macBuf, 6);
-  }
-  if (name && strlen(name)) strncpy(devices[idx].name, name, sizeof(devices[idx].name)-1);
-  devices[idx].percent = percent;
-  devices[idx].totalHeightCm = totalH;
-  devices[idx].sensorToMaxCm = s2m;
-  devices[idx].lastSeen = millis();
+  int idx = applyReport(r);
+  if (idx == -1) { server.send(500, "application/json", "{\"ok\":false,\"msg\":\"table-full\"}"); return; }
   devices[idx].ip = server.client().remoteIP();
 
-  Serial.printf("Report: idx=%d name=%s mac=%s ip=%s pct=%.1f\n", idx, devices[idx].name,
+  LOGD("Report: idx=%d name=%s mac=%s ip=%s pct=%.1f", idx, devices[idx].name,
                 devices[idx].macKnown?macToString(devices[idx].mac).c_str():"unknown",
                 devices[idx].ip.toString().c_str(),
                 devices[idx].percent);
 
   server.send(200, "application/json", "{\"ok\":true}");
+  benchReportUs.record(micros() - t0);
 }
 
-// GET /api/devices
-void handleGetDevices() {
-  refreshConnectedStations();
-  StaticJsonDocument<16384> arrdoc;
-  JsonArray arr = arrdoc.to<JsonArray>();
-  unsigned long now = millis();
-  for (int i=0;i<MAX_DEVICES;i++) {
-    if (!devices[i].used) continue;
-    JsonObject o = arr.createNestedObject();
+// POST /api/report/batch  { name, totalHeightCm, sensorToMaxCm, mac, rssi, boot, samples: [[seq, age_ms, permille], ...] }
+// a sensor's backlog after an outage; applied in seq order, readings the device already
+// has (reportSeen) are skipped
+struct BatchSample {
+  uint32_t seq;
+  unsigned long ageMs;
+  uint16_t permille;      // LEVEL_NO_ECHO = no echo
+};
+
+void handleReportBatch() {
+  ScopedMetric metric(M_REPORT_BATCH);
+  unsigned long t0 = micros();
+  String body = server.arg("plain");
+  if (body.length() == 0) { server.send(400, "text/plain", "empty"); return; }
+  DynamicJsonDocument doc(REPORT_BATCH_JSON);
+  auto err = deserializeJson(doc, body);
+  if (err) { server.send(400, "text/plain", "json"); return; }
+  JsonArray arr = doc["samples"];
+  if (arr.isNull() || arr.size() == 0 || arr.size() > REPORT_BATCH_MAX) { server.send(400, "text/plain", "samples"); return; }
+
+  BatchSample samples[REPORT_BATCH_MAX];
+  int n = 0;
+  for (JsonVariant v : arr) {
+    JsonArray a = v.as<JsonArray>();
+    BatchSample b = { a[0] | 0u, a[1] | 0UL, a[2] | LEVEL_NO_ECHO };
+    int k = n++;
+    while (k > 0 && (int32_t)(samples[k-1].seq - b.seq) > 0) { samples[k] = samples[k-1]; k--; }
+    samples[k] = b;
+  }
+
+  SensorReport r;
+  r.name = doc["name"] | "";
+  r.totalHeightCm = doc["totalHeightCm"] | 0.0f;
+  r.sensorToMaxCm = doc["sensorToMaxCm"] | 0.0f;
+  r.mac = nullptr;
+  r.rssi = 0;
+  r.boot = doc["boot"] | 0u;
+  const char* macs = doc["mac"] | "";
+  uint8_t macBuf[6] = {0};
+  unsigned int b[6];
+  if (strlen(macs) >= 17 && sscanf(macs, "%02X:%02X:%02X:%02X:%02X:%02X", &b[0],&b[1],&b[2],&b[3],&b[4],&b[5])==6) {
+    for (int k=0;k<6;k++) macBuf[k] = (uint8_t)b[k];
+    r.mac = macBuf;
+  }
+  int idx = reportSlot(r);
+  if (idx == -1) { server.send(500, "application/json", "{\"ok\":false,\"msg\":\"table-full\"}"); return; }
+
+  int applied = 0;
+  for (int i = 0; i < n; i++) {
+    if (reportSeen(idx, r.boot, samples[i].seq)) continue;
+    r.seq = samples[i].seq;
+    r.ageMs = samples[i].ageMs;
+    r.percent = samples[i].permille == LEVEL_NO_ECHO ? -1.0f : samples[i].permille / 10.0f;
+    if (i == n - 1) r.rssi = doc["rssi"] | 0;   // only the newest reading says anything about the link now
+    applyReading(idx, r, i < n - 1);
+    replLogReport(idx, i < n - 1);
+    applied++;
+  }
+  IPAddress ip = server.client().remoteIP();
+  if (ip != devices[idx].ip) { devices[idx].ip = ip; tableVersion++; }
+  if (applied) mqttMark(idx, MQTT_LEVEL);   // applyReading bumped tableVersion
+  LOGD("Batch: idx=%d name=%s samples=%d applied=%d", idx, devices[idx].name, n, applied);
+
+  char out[64];
+  snprintf(out, sizeof(out), "{\"ok\":true,\"applied\":%d,\"skipped\":%d}", applied, n - applied);
+  server.send(200, "application/json", out);
+  benchReportUs.record(micros() - t0);
+}
+
+/* ESP-NOW ingest: the receive callback runs in the WiFi task and only queues the frame
+   (single producer, single consumer); loop() applies it and answers with the sensor's config */
+const uint32_t ESPNOW_QUEUE = 16;   // power of two
+
+struct EspNowRx {
+  uint8_t mac[6];
+  uint8_t len;
+  uint8_t data[sizeof(EspNowReport)];
+};
+EspNowRx espNowQueue[ESPNOW_QUEUE];
+std::atomic<uint32_t> espNowHead(0);    // written by the callback
+std::atomic<uint32_t> espNowTail(0);    // written by loop()
+std::atomic<uint32_t> espNowDropped(0); // queue full or wrong size
+WiFiUDP espNowUdp;
+
+void onEspNowRecv(const uint8_t* mac, const uint8_t* data, int len) {
+  uint32_t head = espNowHead.load(std::memory_order_relaxed);
+  if (len != (int)sizeof(EspNowReport) || head - espNowTail.load(std::memory_order_acquire) >= ESPNOW_QUEUE) {
+    espNowDropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  EspNowRx& e = espNowQueue[head & (ESPNOW_QUEUE - 1)];
+  memcpy(e.mac, mac, 6);
+  memcpy(e.data, data, len);
+  e.len = len;
+  espNowHead.store(head + 1, std::memory_order_release);
+}
+
+// frame -> applyReport -> reply; the reply is filled in reply, false if there is none
+bool espNowIngest(const uint8_t mac[6], const uint8_t* data, int len, EspNowConfig& reply) {
+  ScopedMetric metric(M_ESPNOW_REPORT);
+  unsigned long t0 = micros();
+  if (!espNowValid(data, len, ESPNOW_REPORT, sizeof(EspNowReport))) return false;
+  const EspNowReport* f = (const EspNowReport*)data;
+  char name[sizeof(f->name) + 1];
+  memcpy(name, f->name, sizeof(f->name));
+  name[sizeof(f->name)] = 0;
+  SensorReport r;
+  r.name = name;
+  r.percent = f->permille == LEVEL_NO_ECHO ? -1.0f : f->permille / 10.0f;
+  r.totalHeightCm = f->totalHeightCm;
+  r.sensorToMaxCm = f->sensorToMaxCm;
+  r.mac = mac;
+  r.seq = f->seq;
+  r.boot = 0;
+  r.ageMs = f->ageMs;
+  r.rssi = f->rssi;
+  int idx = applyReport(r);
+  if (idx == -1) return false;
+  LOGD("ESP-NOW report: idx=%d name=%s mac=%s pct=%.1f", idx, devices[idx].name,
+                macToString(mac).c_str(), devices[idx].percent);
+
+  espNowHeader(reply.hdr, ESPNOW_CONFIG);
+  reply.seq = f->seq;
+  reply.reportIntervalMs = sensorReportIntervalMs(idx);
+  reply.totalHeightCm = devices[idx].totalHeightCm;
+  reply.sensorToMaxCm = devices[idx].sensorToMaxCm;
+  strncpy(reply.name, devices[idx].name, sizeof(reply.name)-1);
+  reply.name[sizeof(reply.name)-1] = 0;
+  benchReportUs.record(micros() - t0);
+  return true;
+}
+
+void espNowTick() {
+  EspNowConfig reply;
+  uint32_t tail = espNowTail.load(std::memory_order_relaxed);
+  while (tail != espNowHead.load(std::memory_order_acquire)) {
+    const EspNowRx& e = espNowQueue[tail & (ESPNOW_QUEUE - 1)];
+    if (espNowIngest(e.mac, e.data, e.len, reply)) {
+      if (!esp_now_is_peer_exist(e.mac)) {
+        esp_now_peer_info_t peer;
+        memset(&peer, 0, sizeof(peer));
+        memcpy(peer.peer_addr, e.mac, 6);
+        peer.channel = 0;           // whatever the AP is on
+        peer.ifidx = WIFI_IF_AP;
+        if (esp_now_add_peer(&peer) != ESP_OK) LOGW("ESP-NOW add peer %s failed", macToString(e.mac).c_str());
+      }
+      esp_now_send(e.mac, (const uint8_t*)&reply, sizeof(reply));
+    }
+    espNowTail.store(++tail, std::memory_order_release);
+  }
+
+  // host stand-in: 6-byte MAC + frame in, config frame back to the datagram's source
+  if (ESPNOW_UDP_PORT == 0) return;
+  uint8_t buf[6 + sizeof(EspNowReport)];
+  for (int n = 0; n < (int)ESPNOW_QUEUE && espNowUdp.parsePacket() > 0; n++) {
+    int len = espNowUdp.read(buf, sizeof(buf));
+    if (len <= 6 || !espNowIngest(buf, buf + 6, len - 6, reply)) continue;
+    espNowUdp.beginPacket(espNowUdp.remoteIP(), espNowUdp.remotePort());
+    espNowUdp.write((const uint8_t*)&reply, sizeof(reply));
+    espNowUdp.endPacket();
+  }
+}
+
+/* read endpoints answer from responseCache; a miss serializes once for every poller */
+// path + query, as the client sent them
+String requestVariant() {
+  String v = server.uri();
+  for (int i = 0; i < server.args(); i++) {
+    if (server.argName(i) == "plain") continue;
+    v += v.indexOf('?') < 0 ? '?' : '&';
+    v += server.argName(i);
+    v += '=';
+    v += server.arg(i);
+  }
+  return v;
+}
+
+// 304 if the client already has this body; X-Age-Ms is how long ago it was built,
+// which a client adds to the ages in it
+void sendCached(const CachedBody<String>& c, const char* type) {
+  server.sendHeader("ETag", c.etag);
+  server.sendHeader("Cache-Control", "no-cache");
+  server.sendHeader("X-Age-Ms", String(millis() - c.builtMs));
+  if (server.header("If-None-Match") == c.etag) { server.send(304); return; }
+  server.send(200, type, c.body);
+}
+
+// stores and sends body; bodies over the whole budget go out uncached
+void storeAndSend(const String& variant, uint32_t version, uint32_t epoch, String& body) {
+  CachedBody<String>* c = cacheStore(responseCache, variant, version, epoch, body, millis());
+  if (c) sendCached(*c, "application/json");
+  else server.send(200, "application/json", body);
+}
+
+/* /api/devices query: ?active=1&fields=name,percent&sort=-age&limit=4 */
+enum DeviceField : uint32_t {
+  F_MAC = 1<<0, F_IP = 1<<1, F_RSSI = 1<<2, F_NAME = 1<<3,
+  F_PERCENT = 1<<4, F_AGE = 1<<5, F_TOTALH = 1<<6, F_S2M = 1<<7,
+  F_SEQ = 1<<8, F_SAMPLE_AGE = 1<<9,
+  F_RATE = 1<<10, F_TTE = 1<<11, F_TTF = 1<<12, F_ANOMALY = 1<<13,
+  F_ALARM = 1<<14, F_LOSS = 1<<15, F_JITTER = 1<<16, F_INTERVAL = 1<<17,
+  F_ALL = 0xFFFFFFFF
+};
+const char* const DEVICE_FIELD_NAMES[] = {
+  "mac", "ip", "rssi", "name", "percent", "age_seconds", "totalHeightCm", "sensorToMaxCm",
+  "seq", "sample_age_ms",
+  "rate_pph", "tte_s", "ttf_s", "anomaly",
+  "alarm", "loss_pct", "jitter_ms", "report_interval_ms"
+};
+const int DEVICE_FIELD_COUNT = sizeof(DEVICE_FIELD_NAMES) / sizeof(DEVICE_FIELD_NAMES[0]);
+// one /api/devices row with every field: mac, ip and name are copied into the document
+const size_t DEVICE_ROW_JSON = JSON_OBJECT_SIZE(DEVICE_FIELD_COUNT) + 18 + 16 + 32;
+
+enum DeviceSort { SORT_NONE, SORT_NAME, SORT_PERCENT, SORT_AGE, SORT_ALARM };
+
+// "name,percent" -> F_NAME|F_PERCENT; unknown names are ignored
+uint32_t parseFieldMask(const String& list) {
+  uint32_t mask = 0;
+  int start = 0;
+  while (start <= (int)list.length()) {
+    int comma = list.indexOf(',', start);
+    if (comma < 0) comma = list.length();
+    String tok = list.substring(start, comma);
+    for (int f=0; f<DEVICE_FIELD_COUNT; f++) {
+      if (tok == DEVICE_FIELD_NAMES[f]) { mask |= 1ul << f; break; }
+    }
+    start = comma + 1;
+  }
+  return mask ? mask : (uint32_t)F_ALL;
+}
+
+// age in ms; never-seen devices sort as the oldest
+unsigned long deviceAgeMs(int i, unsigned long now) {
+  return devices[i].lastSeen == 0 ? ULONG_MAX : now - devices[i].lastSeen;
+}
+
+bool deviceIsActive(int i, unsigned long now) {
+  return devices[i].lastSeen != 0 && deviceAgeMs(i, now) / 1000UL <= ACTIVE_THRESHOLD_SEC;
+}
+
+// ascending order for the given sort; unknown percent goes last, devices in alarm go first
+int compareDevices(int a, int b, DeviceSort sort, unsigned long now) {
+  switch (sort) {
+    case SORT_NAME: return strcmp(devices[a].name, devices[b].name);
+    case SORT_PERCENT: {
+      float pa = devices[a].percent, pb = devices[b].percent;
+      if ((pa < 0) != (pb < 0)) return pa < 0 ? 1 : -1;
+      return pa < pb ? -1 : (pa > pb ? 1 : 0);
+    }
+    case SORT_AGE: {
+      unsigned long aa = deviceAgeMs(a, now), ab = deviceAgeMs(b, now);
+      return aa < ab ? -1 : (aa > ab ? 1 : 0);
+    }
+    case SORT_ALARM: return (devices[b].alarm != 0) - (devices[a].alarm != 0);   // ties keep slot order
+    default: return a - b;
+  }
+}
+
+void writeDeviceJson(JsonObject o, int i, uint32_t fields, unsigned long now) {
+  if (fields & F_MAC) {
     if (devices[i].macKnown) o["mac"] = macToString(devices[i].mac);
     else o["mac"] = nullptr;
-    o["ip"] = devices[i].ip.toString();
-    o["rssi"] = devices[i].rssi;
-    o["name"] = devices[i].name[0] ? devices[i].name : nullptr;
+  }
+  if (fields & F_IP) o["ip"] = devices[i].ip.toString();
+  const LinkStats& l = devices[i].link;
+  if (fields & F_RSSI) {
+    if (l.haveRssi) o["rssi"] = (int)lroundf(l.rssi); else o["rssi"] = nullptr;
+  }
+  if (fields & F_NAME) o["name"] = devices[i].name[0] ? devices[i].name : nullptr;
+  if (fields & F_PERCENT) {
     if (devices[i].percent >= 0) o["percent"] = devices[i].percent; else o["percent"] = nullptr;
+  }
+  if (fields & F_AGE) {
     if (devices[i].lastSeen==0) o["age_seconds"] = nullptr; else o["age_seconds"] = (now - devices[i].lastSeen) / 1000UL;
-    o["totalHeightCm"] = devices[i].totalHeightCm;
-    o["sensorToMaxCm"] = devices[i].sensorToMaxCm;
   }
-  String out; serializeJson(arr, out);
-  server.send(200, "application/json", out);
+  if (fields & F_TOTALH) o["totalHeightCm"] = devices[i].totalHeightCm;
+  if (fields & F_S2M) o["sensorToMaxCm"] = devices[i].sensorToMaxCm;
+  if (fields & F_SEQ) o["seq"] = devices[i].seq;
+  if (fields & F_SAMPLE_AGE) {
+    if (devices[i].sampleMs == 0) o["sample_age_ms"] = nullptr; else o["sample_age_ms"] = now - devices[i].sampleMs;
+  }
+  const TankTrend& t = devices[i].trend;
+  if (fields & F_RATE) {
+    if (t.valid) o["rate_pph"] = roundf(trendRatePph(t) * 10.0f) / 10.0f; else o["rate_pph"] = nullptr;
+  }
+  if (fields & F_TTE) {
+    long s = trendSecondsToEmpty(t);
+    if (s < 0) o["tte_s"] = nullptr; else o["tte_s"] = s;
+  }
+  if (fields & F_TTF) {
+    long s = trendSecondsToFull(t);
+    if (s < 0) o["ttf_s"] = nullptr; else o["ttf_s"] = s;
+  }
+  if (fields & F_ANOMALY) o["anomaly"] = t.flags;  // TrendFlag bits: 1 leak, 2 stuck sensor
+  if (fields & F_ALARM) o["alarm"] = devices[i].alarm;  // AlarmFlag bits: 1 low, 2 high, 4 stale
+  if (fields & F_LOSS) o["loss_pct"] = roundf(l.lossPct * 10.0f) / 10.0f;
+  if (fields & F_JITTER) o["jitter_ms"] = (long)lroundf(l.jitterMs);
+  if (fields & F_INTERVAL) o["report_interval_ms"] = sensorReportIntervalMs(i);
+}
+
+// GET /api/devices[?active=1[&alarmed=1]][&fields=a,b][&sort=[-]name|percent|age|alarm][&limit=N]
+// alarmed=1 with active=1 also lists inactive devices that are in alarm (e.g. stale);
+// sort=alarm puts those in alarm first, so a limit cuts the quiet ones
+// cached per query for the list version and the second. Not for tableVersion: with 32
+// sensors every 2.5 s it moves ~13 times a second and no body would be served twice,
+// so the second is the bound on how far readings lag (age_seconds' own resolution);
+// added/edited devices and alarms show at once. Ages are as of the build and the
+// X-Age-Ms header says how long ago that was, for ms fields (sample_age_ms); the
+// second is not in the ETag, which is the body's hash, so a rebuild that comes out
+// the same still earns a 304
+void handleGetDevices() {
+  ScopedMetric metric(M_GET_DEVICES);
+  unsigned long now = millis();
+  String variant = requestVariant();
+  CachedBody<String>* cached = cacheFind(responseCache, variant, listVersion, now / 1000UL);
+  if (cached) { sendCached(*cached, "application/json"); return; }
+
+  bool activeOnly = server.hasArg("active") && server.arg("active") == "1";
+  bool withAlarmed = server.hasArg("alarmed") && server.arg("alarmed") == "1";
+  uint32_t fields = server.hasArg("fields") ? parseFieldMask(server.arg("fields")) : (uint32_t)F_ALL;
+  int limit = server.hasArg("limit") ? server.arg("limit").toInt() : MAX_DEVICES;
+  if (limit <= 0 || limit > MAX_DEVICES) limit = MAX_DEVICES;
+  DeviceSort sort = SORT_NONE;
+  bool descending = false;
+  if (server.hasArg("sort")) {
+    String key = server.arg("sort");
+    if (key.startsWith("-")) { descending = true; key = key.substring(1); }
+    if (key == "name") sort = SORT_NAME;
+    else if (key == "percent") sort = SORT_PERCENT;
+    else if (key == "age") sort = SORT_AGE;
+    else if (key == "alarm") sort = SORT_ALARM;
+  }
+
+  // collect matching slots, then insertion-sort the (small) index list
+  int order[MAX_DEVICES];
+  int n = 0;
+  for (int i=0;i<MAX_DEVICES;i++) {
+    if (!devices[i].used) continue;
+    if (activeOnly && !deviceIsActive(i, now) && !(withAlarmed && devices[i].alarm)) continue;
+    order[n++] = i;
+  }
+  if (sort != SORT_NONE) {
+    for (int k=1;k<n;k++) {
+      int key = order[k]; int j = k - 1;
+      while (j >= 0) {
+        int c = compareDevices(order[j], key, sort, now);
+        if (descending ? c >= 0 : c <= 0) break;
+        order[j+1] = order[j]; --j;
+      }
+      order[j+1] = key;
+    }
+  }
+  if (n > limit) n = limit;
+
+  // one row at a time through a row-sized document, so the body is bounded by the
+  // String (cached anyway) and not by a document sized for the whole fleet
+  StaticJsonDocument<DEVICE_ROW_JSON> rowdoc;
+  String out, row;
+  out.reserve(n * 96 + 2);
+  out += '[';
+  for (int k=0;k<n;k++) {
+    rowdoc.clear();
+    writeDeviceJson(rowdoc.to<JsonObject>(), order[k], fields, now);
+    if (rowdoc.overflowed()) {
+      LOGE("/api/devices row over %u B", (unsigned)DEVICE_ROW_JSON);
+      server.send(500, "application/json", "{\"ok\":false,\"msg\":\"row-overflow\"}");
+      return;
+    }
+    row = "";
+    serializeJson(rowdoc, row);
+    if (k) out += ',';
+    out += row;
+  }
+  out += ']';
+  storeAndSend(variant, listVersion, now / 1000UL, out);
 }
 
-// POST /api/device (save config) { name, totalHeightCm, sensorToMaxCm, mac (optional) }
+// name, geometry and alarm thresholds of a slot, from POST /api/device or the peer
+void applyDeviceConfig(int idx, const char* name, float totalH, float s2m, const AlarmConfig& ac) {
+  strncpy(devices[idx].name, name, sizeof(devices[idx].name)-1);
+  // new geometry rescales percent; history in the old scale would read as a jump
+  if (devices[idx].totalHeightCm != totalH || devices[idx].sensorToMaxCm != s2m) trendReset(devices[idx].trend);
+  devices[idx].totalHeightCm = totalH;
+  devices[idx].sensorToMaxCm = s2m;
+  setAlarmConfig(idx, ac);
+  // re-evaluate so a changed threshold shows without waiting for the next report
+  uint8_t stale = devices[idx].alarm & ALARM_STALE;
+  setAlarm(idx, alarmOnReport(devices[idx].alarmRule, devices[idx].alarm, devices[idx].percent) | stale);
+  configTouched(idx);
+  tableVersion++;
+  listVersion++;
+}
+
+// POST /api/device (save config) { name, totalHeightCm, sensorToMaxCm, mac (optional),
+//   alarmLowPct, alarmHighPct, staleSec (optional; omitted = keep) }
 void handleSaveDevice() {
+  ScopedMetric metric(M_SAVE_DEVICE);
   if (server.method() != HTTP_POST) { server.send(405); return; }
   String body = server.arg("plain");
   if (body.length() == 0) { server.send(400, "text/plain", "empty"); return; }
@@ -327,95 +1048,418 @@ void handleSaveDevice() {
     devices[idx].macKnown = true;
     memcpy(devices[idx].mac, macBuf, 6);
   }
-  strncpy(devices[idx].name, name, sizeof(devices[idx].name)-1);
-  devices[idx].totalHeightCm = totalH;
-  devices[idx].sensorToMaxCm = s2m;
+  AlarmConfig ac = devices[idx].alarmCfg;
+  ac.lowPct = doc["alarmLowPct"] | ac.lowPct;
+  ac.highPct = doc["alarmHighPct"] | ac.highPct;
+  ac.staleSec = doc["staleSec"] | ac.staleSec;
+  applyDeviceConfig(idx, name, totalH, s2m, ac);
+  replLogConfig(idx);
   saveDevicesToFS();
 
-  Serial.printf("Saved device idx=%d name=%s mac=%s\n", idx, devices[idx].name, devices[idx].macKnown?macToString(devices[idx].mac).c_str():"unknown");
+  LOGI("Saved device idx=%d name=%s mac=%s", idx, devices[idx].name, devices[idx].macKnown?macToString(devices[idx].mac).c_str():"unknown");
 
   server.send(200, "application/json", "{\"ok\":true}");
 }
 
-// GET /api/config?name=...
+// GET /api/config?name=...  (cached per name for the device's config version and its
+// report interval, which moves in a few steps with the link; readings do not touch it)
 void handleGetConfig() {
   if (!server.hasArg("name")) { server.send(400, "text/plain", "name required"); return; }
   String name = server.arg("name");
   int idx = findDeviceByName(name.c_str());
   if (idx == -1) { server.send(404, "application/json", "{\"ok\":false,\"msg\":\"unknown\"}"); return; }
+  String variant = requestVariant();
+  uint32_t interval = sensorReportIntervalMs(idx);
+  CachedBody<String>* cached = cacheFind(responseCache, variant, devices[idx].configVersion, interval);
+  if (cached) { sendCached(*cached, "application/json"); return; }
   StaticJsonDocument<256> d;
   d["name"] = devices[idx].name;
   d["totalHeightCm"] = devices[idx].totalHeightCm;
   d["sensorToMaxCm"] = devices[idx].sensorToMaxCm;
+  d["reportIntervalMs"] = interval;
   String out; serializeJson(d, out);
-  server.send(200, "application/json", out);
+  storeAndSend(variant, devices[idx].configVersion, interval, out);
+}
+
+/* replication: serve our log to the peer, pull and apply the peer's (common/repl_log.h) */
+ReplPeer replPeer;
+bool replPeerUp = false;
+uint32_t replApplied = 0;     // peer records applied
+unsigned long replLastPull = 0;
+uint8_t replBuf[sizeof(ReplPageHeader) + REPL_PAGE * sizeof(ReplRecord)];  // one page, either direction
+
+// table state from slot on, config + last reading per device, whole slots per page
+int replSnapshotPage(int slot, ReplRecord* out, ReplPageHeader& h, unsigned long now) {
+  replPageInit(h, replLog.epoch);
+  h.flags = REPL_PAGE_SNAPSHOT;
+  h.upto = replLog.next - 1;
+  int n = 0;
+  for (; slot >= 0 && slot < MAX_DEVICES && n + 2 <= REPL_PAGE; slot++) {
+    if (!devices[slot].used) continue;
+    ReplRecord& c = out[n++];
+    memset(&c, 0, sizeof(c));
+    replFill(c, slot, REPL_CONFIG);
+    c.seq = h.upto;
+    c.alarmLowPct = devices[slot].alarmCfg.lowPct;
+    c.alarmHighPct = devices[slot].alarmCfg.highPct;
+    c.staleSec = devices[slot].alarmCfg.staleSec;
+    if (devices[slot].sampleMs == 0) continue;
+    ReplRecord& r = out[n++];
+    memset(&r, 0, sizeof(r));
+    replFill(r, slot, REPL_REPORT);
+    r.seq = h.upto;
+    r.sensorSeq = devices[slot].seq;
+    r.timeMs = now - devices[slot].sampleMs;
+    r.permille = devices[slot].percent < 0 ? LEVEL_NO_ECHO : (uint16_t)lroundf(devices[slot].percent * 10.0f);
+  }
+  h.count = n;
+  h.cursor = slot < MAX_DEVICES ? slot : -1;
+  return n;
+}
+
+// GET /api/replog?since=N  or  ?snapshot=slot   (application/octet-stream, one page)
+void handleReplog() {
+  ScopedMetric metric(M_REPLOG);
+  ReplPageHeader& h = *(ReplPageHeader*)replBuf;
+  ReplRecord* recs = (ReplRecord*)(replBuf + sizeof(ReplPageHeader));
+  unsigned long now = millis();
+  int n;
+  if (server.hasArg("snapshot")) n = replSnapshotPage(server.arg("snapshot").toInt(), recs, h, now);
+  else n = replCopySince(replLog, strtoul(server.arg("since").c_str(), nullptr, 10), recs, REPL_PAGE, now, h);
+  // replBuf is RAM: send(), not send_P(), which reads flash through pgm_read on the ESP8266
+  server.send(200, "application/octet-stream", (const char*)replBuf, sizeof(ReplPageHeader) + n * sizeof(ReplRecord));
+}
+
+// a peer record into the table; reports only if newer than what we have
+// (the sensor may have reported here too); returns true for a config change
+bool replApply(const ReplRecord& e, unsigned long now) {
+  char name[sizeof(e.name) + 1];
+  memcpy(name, e.name, sizeof(e.name));
+  name[sizeof(e.name)] = 0;
+  SensorReport r;
+  r.name = name;
+  r.mac = (e.flags & REPL_MAC) ? e.mac : nullptr;
+  r.totalHeightCm = e.totalHeightCm;
+  r.sensorToMaxCm = e.sensorToMaxCm;
+  if (!r.mac && !name[0]) return false;   // nothing to find the slot by
+  int idx = reportSlot(r);
+  if (idx == -1) return false;
+  if (e.type == REPL_CONFIG) {
+    AlarmConfig ac = { e.alarmLowPct, e.alarmHighPct, e.staleSec };
+    applyDeviceConfig(idx, name, e.totalHeightCm, e.sensorToMaxCm, ac);
+    return true;
+  }
+  unsigned long sampleMs = now - e.timeMs;
+  if (devices[idx].sampleMs != 0 && (long)(sampleMs - devices[idx].sampleMs) <= 0) return false;
+  r.percent = e.permille == LEVEL_NO_ECHO ? -1.0f : e.permille / 10.0f;
+  r.seq = e.sensorSeq;
+  r.boot = 0;
+  r.ageMs = e.timeMs;
+  r.rssi = 0;
+  applyReading(idx, r, (e.flags & REPL_BACKFILL) != 0);
+  replApplied++;
+  return false;
 }
 
+// one pull per call, every REPL_PULL_MS (at once while the peer has more)
+void replTick() {
+  if (!USE_REPLICATION || WiFi.status() != WL_CONNECTED) return;
+  unsigned long now = millis();
+  unsigned long wait = !replPeerUp ? REPL_RETRY_MS : replPeer.more ? 0 : REPL_PULL_MS;
+  if (now - replLastPull < wait) return;
+  replLastPull = now;
+  ScopedMetric metric(M_REPL_PULL);
+
+  char query[32];
+  replPeerQuery(replPeer, query, sizeof(query));
+  WiFiClient client;
+  HTTPClient http;
+  http.setConnectTimeout(REPL_TIMEOUT_MS);
+  http.setTimeout(REPL_TIMEOUT_MS);
+  http.begin(client, String("http://") + REPL_PEER_IP.toString() + "/api/replog" + query);
+  int code = http.GET();
+  int len = -1;
+  if (code == 200) {
+    int size = http.getSize();
+    // readBytes waits on Stream's own timeout (1 s by default), not the HTTPClient's;
+    // through Stream& since the core's WiFiClient::setTimeout may take seconds
+    Stream& body = http.getStream();
+    body.setTimeout(REPL_TIMEOUT_MS);
+    if (size > 0 && size <= (int)sizeof(replBuf)) len = body.readBytes(replBuf, size);
+  }
+  http.end();
+  if (!replPageValid(replBuf, len)) {
+    if (replPeerUp) LOGW("Replication peer %s not answering (%d)", REPL_PEER_IP.toString().c_str(), code);
+    replPeerUp = false;
+    return;
+  }
+  if (!replPeerUp) LOGI("Replication peer %s up, %s", REPL_PEER_IP.toString().c_str(), query);
+  replPeerUp = true;
+
+  const ReplPageHeader& h = *(const ReplPageHeader*)replBuf;
+  if (!replPeerOnPage(replPeer, h)) {
+    LOGI("Replication: taking a snapshot of the peer (epoch %lu)", (unsigned long)h.epoch);
+    return;
+  }
+  const ReplRecord* recs = (const ReplRecord*)(replBuf + sizeof(ReplPageHeader));
+  bool configChanged = false;
+  now = millis();
+  for (int i = 0; i < h.count; i++) configChanged |= replApply(recs[i], now);
+  if (configChanged) saveDevicesToFS();
+  if (h.count) LOGD("Replication: %d records, up to %lu", h.count, (unsigned long)replPeer.since);
+}
+
+/* MQTT egress: esp-mqtt runs its own task; this side only flushes and hands messages over */
+esp_mqtt_client_handle_t mqttClient = nullptr;
+std::atomic<bool> mqttConnected(false);
+std::atomic<int> mqttInflight(0);   // QoS 1 publishes not yet acknowledged
+std::atomic<bool> mqttResync(false); // (re)connected: publish every device once, in case the broker lost its retained set
+unsigned long mqttLastFlush = 0;
+unsigned long mqttLastResync = 0;
+bool mqttResynced = false;          // mqttLastResync is set
+
+// runs in the MQTT task
+void onMqttEvent(void* arg, esp_event_base_t base, int32_t id, void* data) {
+  (void)arg;
+  (void)base;
+  (void)data;
+  switch ((esp_mqtt_event_id_t)id) {
+    case MQTT_EVENT_CONNECTED: mqttConnected = true; mqttInflight = 0; mqttResync = true; break;
+    case MQTT_EVENT_DISCONNECTED: mqttConnected = false; break;
+    case MQTT_EVENT_PUBLISHED: if (mqttInflight > 0) mqttInflight--; break;
+    default: break;
+  }
+}
+
+// payload of one message, from the device as it is now
+bool mqttBuild(int idx, MqttKind kind, MqttMsg& m) {
+  if (!devices[idx].used) return false;
+  unsigned long now = millis();
+  if (kind == MQTT_LEVEL) {
+    const Device& d = devices[idx];
+    mqttLevelPayload(m, d.percent, d.seq, d.sampleMs ? (long)(now - d.sampleMs) : -1L, d.trend.valid, trendRatePph(d.trend));
+    m.qos = MQTT_LEVEL_QOS;
+  } else {
+    char state[24];
+    alarmFlagsToString(devices[idx].alarm, state, sizeof(state));
+    mqttAlarmPayload(m, devices[idx].alarm, state, (now - devices[idx].alarmSinceMs) / 1000UL);
+    m.qos = MQTT_ALARM_QOS;
+  }
+  return true;
+}
+
+// flush every MQTT_INTERVAL_MS while connected, then hand over what the client takes
+void mqttTick() {
+  if (!USE_MQTT || !mqttConnected) return;
+  unsigned long now = millis();
+  // a connection that drops during the republish would otherwise start it over on every
+  // reconnect; a deferred resync stays pending, and changes still go out as dirty bits
+  if (mqttResync && (!mqttResynced || now - mqttLastResync >= MQTT_RESYNC_MIN_MS)) {
+    mqttResync = false;
+    mqttResynced = true;
+    mqttLastResync = now;
+    for (int i = 0; i < MAX_DEVICES; i++) if (devices[i].used) mqttMark(i, (MqttKind)(MQTT_LEVEL | MQTT_ALARM));
+  }
+  if (now - mqttLastFlush >= MQTT_INTERVAL_MS) {
+    mqttLastFlush = now;
+    egressFlush(mqttOut, mqttBuild);
+  }
+  char topic[MQTT_TOPIC_MAX];
+  for (int k = 0; k < MQTT_PUBLISH_PER_LOOP; k++) {
+    MqttMsg* m = egressFront(mqttOut);
+    if (!m) break;
+    if (m->qos && mqttInflight >= MQTT_INFLIGHT_MAX) break;
+    // only an MQTT_BASE over MQTT_BASE_MAX; counted, not published under a cut-off topic
+    if (mqttTopic(topic, sizeof(topic), MQTT_BASE, devices[m->dev].name, devices[m->dev].mac, m->kind) < 0) { egressSkip(mqttOut); continue; }
+    // refused (outbox full, socket down): stays at the front for the next loop
+    if (esp_mqtt_client_publish(mqttClient, topic, m->payload, m->len, m->qos, 1) < 0) { mqttOut.failed++; break; }
+    if (m->qos) mqttInflight++;
+    egressPop(mqttOut);
+  }
+}
+
+void setupMqtt() {
+  egressInit(mqttOut);
+  esp_mqtt_client_config_t cfg;
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.uri = MQTT_URI;
+  cfg.client_id = "sender";
+  mqttClient = esp_mqtt_client_init(&cfg);
+  if (!mqttClient || esp_mqtt_client_register_event(mqttClient, (esp_mqtt_event_id_t)ESP_EVENT_ANY_ID, onMqttEvent, nullptr) != ESP_OK
+      || esp_mqtt_client_start(mqttClient) != ESP_OK) {
+    LOGE("MQTT client start failed");
+    return;
+  }
+  LOGI("MQTT publishing to %s as %s/...", MQTT_URI, MQTT_BASE);
+}
+
+// /status only changes with WiFi state; its version is bumped when that does
+uint32_t statusVersion = 0;
+bool statusStaConnected = false;
+uint32_t statusStaIP = 0;
+
 void handleStatus() {
+  bool staConnected = (WiFi.status() == WL_CONNECTED);
+  uint32_t staIP = staConnected ? (uint32_t)WiFi.localIP() : 0;
+  if (staConnected != statusStaConnected || staIP != statusStaIP) {
+    statusStaConnected = staConnected;
+    statusStaIP = staIP;
+    statusVersion++;
+  }
+  String variant = server.uri();
+  CachedBody<String>* cached = cacheFind(responseCache, variant, statusVersion, CACHE_TIMELESS);
+  if (cached) { sendCached(*cached, "application/json"); return; }
   StaticJsonDocument<256> s;
   s["ok"] = true;
   s["ap_ssid"] = AP_SSID;
   s["ap_ip"] = WiFi.softAPIP().toString();
-  s["sta_connected"] = (WiFi.status() == WL_CONNECTED);
-  s["sta_ip"] = (WiFi.status() == WL_CONNECTED) ? WiFi.localIP().toString() : String("");
+  s["sta_connected"] = staConnected;
+  s["sta_ip"] = staConnected ? WiFi.localIP().toString() : String("");
   String out; serializeJson(s, out);
-  server.send(200, "application/json", out);
+  storeAndSend(variant, statusVersion, CACHE_TIMELESS, out);
+}
+
+// Prometheus histogram with cumulative buckets at powers of two (le = 2^k - 1).
+// All 25 edges go out every scrape, even empty ones: the bucket set of a
+// series must not change between scrapes or histogram_quantile() breaks
+void appendHistogram(String& out, const char* metric, const char* handler, const LatencyHist& h) {
+  char line[128];
+  uint32_t cum = 0;
+  int b = 0;
+  for (int k = 1; k <= 25; ++k) {
+    uint32_t edge = 1u << k;
+    while (b < LatencyHist::BUCKETS && LatencyHist::lowerBound(b) < edge) cum += h.bucketCount(b++);
+    snprintf(line, sizeof(line), "%s_bucket{handler=\"%s\",le=\"%lu\"} %lu\n",
+             metric, handler, (unsigned long)(edge - 1), (unsigned long)cum);
+    out += line;
+  }
+  snprintf(line, sizeof(line), "%s_bucket{handler=\"%s\",le=\"+Inf\"} %lu\n%s_sum{handler=\"%s\"} %llu\n%s_count{handler=\"%s\"} %lu\n",
+           metric, handler, (unsigned long)h.count(), metric, handler, (unsigned long long)h.sum(),
+           metric, handler, (unsigned long)h.count());
+  out += line;
 }
 
-/* simple web UI with modal editor (replace if you have your own UI) */
+// GET /api/metrics (Prometheus text exposition)
+void handleMetrics() {
+  String out;
+  out.reserve(24576);   // 10 histograms x 28 lines
+  char line[256];       // two series with TYPE lines, at any counter value
+  out += "# TYPE sender_handler_calls_total counter\n";
+  for (int m = 0; m < M_COUNT; ++m) {
+    snprintf(line, sizeof(line), "sender_handler_calls_total{handler=\"%s\"} %lu\n", METRIC_NAMES[m], (unsigned long)handlerMetrics[m].calls);
+    out += line;
+  }
+  out += "# TYPE sender_handler_duration_us histogram\n";
+  for (int m = 0; m < M_COUNT; ++m) appendHistogram(out, "sender_handler_duration_us", METRIC_NAMES[m], handlerMetrics[m].us);
+  out += "# TYPE sender_loop_duration_us histogram\n";
+  appendHistogram(out, "sender_loop_duration_us", "loop", loopUs);
+
+  int used = 0;
+  for (int i=0;i<MAX_DEVICES;i++) if (devices[i].used) used++;
+  snprintf(line, sizeof(line),
+           "# TYPE sender_heap_free_bytes gauge\nsender_heap_free_bytes %lu\n"
+           "# TYPE sender_heap_min_free_bytes gauge\nsender_heap_min_free_bytes %lu\n",
+           (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMinFreeHeap());
+  out += line;
+  snprintf(line, sizeof(line),
+           "# TYPE sender_heap_max_alloc_bytes gauge\nsender_heap_max_alloc_bytes %lu\n"
+           "# TYPE sender_devices gauge\nsender_devices %d\n",
+           (unsigned long)ESP.getMaxAllocHeap(), used);
+  out += line;
+  snprintf(line, sizeof(line),
+           "# TYPE sender_log_dropped_total counter\nsender_log_dropped_total %lu\n"
+           "# TYPE sender_uptime_seconds gauge\nsender_uptime_seconds %lu\n",
+           (unsigned long)logRing().dropped.load(), millis() / 1000UL);
+  out += line;
+  snprintf(line, sizeof(line),
+           "# TYPE sender_response_cache_hits_total counter\nsender_response_cache_hits_total %lu\n"
+           "# TYPE sender_response_cache_misses_total counter\nsender_response_cache_misses_total %lu\n",
+           (unsigned long)responseCache.hits, (unsigned long)responseCache.misses);
+  out += line;
+  if (USE_REPLICATION) {
+    snprintf(line, sizeof(line),
+             "# TYPE sender_repl_peer_up gauge\nsender_repl_peer_up %d\n"
+             "# TYPE sender_repl_applied_total counter\nsender_repl_applied_total %lu\n",
+             replPeerUp ? 1 : 0, (unsigned long)replApplied);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE sender_repl_log_seq gauge\nsender_repl_log_seq %lu\n"
+             "# TYPE sender_repl_peer_seq gauge\nsender_repl_peer_seq %lu\n",
+             (unsigned long)(replLog.next - 1), (unsigned long)replPeer.since);
+    out += line;
+  }
+  if (USE_MQTT) {
+    snprintf(line, sizeof(line),
+             "# TYPE sender_mqtt_connected gauge\nsender_mqtt_connected %d\n"
+             "# TYPE sender_mqtt_queue_depth gauge\nsender_mqtt_queue_depth %lu\n",
+             mqttConnected ? 1 : 0, (unsigned long)egressDepth(mqttOut));
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE sender_mqtt_changes_total counter\nsender_mqtt_changes_total %lu\n"
+             "# TYPE sender_mqtt_published_total counter\nsender_mqtt_published_total %lu\n",
+             (unsigned long)mqttOut.marked, (unsigned long)mqttOut.published);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE sender_mqtt_dropped_total counter\nsender_mqtt_dropped_total %lu\n",
+             (unsigned long)mqttOut.dropped);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE sender_mqtt_publish_failed_total counter\nsender_mqtt_publish_failed_total %lu\n",
+             (unsigned long)mqttOut.failed);
+    out += line;
+    snprintf(line, sizeof(line),
+             "# TYPE sender_mqtt_skipped_total counter\nsender_mqtt_skipped_total %lu\n",
+             (unsigned long)mqttOut.skipped);
+    out += line;
+  }
+  server.send(200, "text/plain; version=0.0.4", out);
+}
+
+// GET /api/alarms: devices currently in alarm, cached like /api/devices on listVersion
+// (names, MACs and alarm bits are all it holds), so a poll with If-None-Match costs a
+// 304 until one of those changes. since_s is as of the build, X-Age-Ms ago; levels
+// are in /api/devices
+void handleAlarms() {
+  String variant = "/api/alarms";
+  CachedBody<String>* cached = cacheFind(responseCache, variant, listVersion, CACHE_TIMELESS);
+  if (cached) { sendCached(*cached, "application/json"); return; }
+  unsigned long now = millis();
+  DynamicJsonDocument doc(256 + MAX_DEVICES * (JSON_OBJECT_SIZE(4) + 64));  // + name/mac copies
+  doc["version"] = alarmVersion;
+  JsonArray arr = doc.createNestedArray("alarms");
+  for (int i=0;i<MAX_DEVICES;i++) {
+    if (!devices[i].used || !devices[i].alarm) continue;
+    JsonObject o = arr.createNestedObject();
+    o["name"] = devices[i].name[0] ? devices[i].name : nullptr;
+    if (devices[i].macKnown) o["mac"] = macToString(devices[i].mac); else o["mac"] = nullptr;
+    o["alarm"] = devices[i].alarm;
+    o["since_s"] = (now - devices[i].alarmSinceMs) / 1000UL;
+  }
+  String out; serializeJson(doc, out);
+  storeAndSend(variant, listVersion, CACHE_TIMELESS, out);
+}
+
+/* web UI: web/index.html, gzip-compressed at build time into sender-server-ui.h */
+const char* HTTP_COLLECT_HEADERS[] = { "If-None-Match" };
+
 void handleRoot() {
-  const char* html = R"rawliteral(
-<!doctype html><html><head><meta charset="utf-8"><title>Sender Manager</title>
-<meta name="viewport" content="width=device-width,initial-scale=1"><style>
-body{font-family:system-ui;margin:12px}table{width:100%;border-collapse:collapse}th,td{border-bottom:1px solid #ccc;padding:6px}th{background:#eee}input{width:100%;box-sizing:border-box}
-.modal-backdrop{position:fixed;inset:0;background:rgba(0,0,0,0.45);display:none;align-items:center;justify-content:center;padding:12px;z-index:10}
-.modal{background:#fff;padding:16px;border-radius:8px;max-width:520px;width:100%}
-</style></head><body>
-<h2>Sender Device Manager</h2>
-<div style="display:flex;gap:8px;align-items:center">
-  <div>AP: <b>Sender-Direct</b> &nbsp; STA IP: <b id="staip">...</b></div>
-  <div style="flex:1"></div>
-  <button id="refreshBtn">Refresh</button>
-  <button id="newBtn">New Device</button>
-</div>
-<table id="tbl"><thead><tr><th>MAC</th><th>IP</th><th>RSSI</th><th>Name</th><th>Percent</th><th>Age(s)</th><th>H (cm)</th><th>S2M (cm)</th><th>Actions</th></tr></thead><tbody></tbody></table>
-
-<div id="modalBackdrop" class="modal-backdrop">
-  <div class="modal">
-    <h3 id="modalTitle">Edit Device</h3>
-    <label>MAC</label><input id="m_mac" placeholder="AA:BB:...">
-    <label>Name</label><input id="m_name" placeholder="Tank-1">
-    <div style="display:flex;gap:8px"><div style="flex:1"><label>Total Height (cm)</label><input id="m_totalH" type="number" step="0.1"></div><div style="flex:1"><label>Sensor->Max (cm)</label><input id="m_s2m" type="number" step="0.1"></div></div>
-    <div style="display:flex;justify-content:flex-end;gap:8px;margin-top:8px"><button id="mSave">Save</button><button id="mClose">Close</button></div>
-  </div>
-</div>
-
-<script>
-let devices = [];
-let modalOpen = false;
-let editIndex = -1;
-async function fetchStatus(){ try{let s=await fetch('/status').then(r=>r.json()); document.getElementById('staip').innerText = s.sta_ip || 'none';}catch(e){document.getElementById('staip').innerText='err';}}
-async function load(){ if(modalOpen){ try{devices = await (await fetch('/api/devices')).json(); renderTable(false);}catch(e){} return;} try{devices = await (await fetch('/api/devices')).json(); renderTable(true);}catch(e){console.error(e);} }
-function renderTable(updateInputs){ const tb=document.querySelector('#tbl tbody'); tb.innerHTML=''; if(!devices || devices.length==0){tb.innerHTML='<tr><td colspan=9>No devices</td></tr>';return;} devices.forEach((x,i)=>{ const mac=x.mac||''; const ip=x.ip||''; const rssi=x.rssi||''; const name=x.name||''; const pct=(x.percent==null)?'--':(parseFloat(x.percent).toFixed(1)+'%'); const age=x.age_seconds||''; const h=x.totalHeightCm||''; const s2m=x.sensorToMaxCm||''; tb.innerHTML+=`<tr><td>${mac}</td><td>${ip}</td><td>${rssi}</td><td>${escapeHtml(name)}</td><td>${pct}</td><td>${age}</td><td>${h}</td><td>${s2m}</td><td><button onclick="openEdit(${i})">Edit</button></td></tr>`; }); }
-function escapeHtml(s){ if(!s) return ''; return s.replaceAll('&','&amp;').replaceAll('<','&lt;').replaceAll('>','&gt;'); }
-function openEdit(index){ modalOpen=true; editIndex=index; const macF=document.getElementById('m_mac'); const nameF=document.getElementById('m_name'); const hF=document.getElementById('m_totalH'); const sF=document.getElementById('m_s2m'); if(index>=0 && devices[index]){ const d=devices[index]; macF.value=d.mac||''; nameF.value=d.name||''; hF.value=d.totalHeightCm||''; sF.value=d.sensorToMaxCm||''; macF.disabled = !!d.mac; document.getElementById('modalTitle').innerText='Edit Device'; }else{ macF.disabled=false; macF.value=''; nameF.value=''; hF.value=''; sF.value=''; document.getElementById('modalTitle').innerText='New Device'; } document.getElementById('modalBackdrop').style.display='flex'; setTimeout(()=>nameF.focus(),150); }
-function closeModal(){ modalOpen=false; editIndex=-1; document.getElementById('modalBackdrop').style.display='none'; }
-async function saveModal(){ const mac=document.getElementById('m_mac').value.trim(); const name=document.getElementById('m_name').value.trim(); const totalH=parseFloat(document.getElementById('m_totalH').value)||0; const s2m=parseFloat(document.getElementById('m_s2m').value)||0; if(!name){alert('Name required');return;} const payload={name:name,totalHeightCm:totalH,sensorToMaxCm:s2m}; if(mac) payload.mac=mac; const res=await fetch('/api/device',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify(payload)}); if(!res.ok){alert('Save failed');return;} closeModal(); load(); }
-document.getElementById('mClose').addEventListener('click', closeModal); document.getElementById('mSave').addEventListener('click', saveModal); document.getElementById('refreshBtn').addEventListener('click', load); document.getElementById('newBtn').addEventListener('click', ()=>openEdit(-1));
-fetchStatus(); load(); setInterval(()=>{ fetchStatus(); load(); },2000); document.getElementById('modalBackdrop').addEventListener('click',(evt)=>{ if(evt.target.id==='modalBackdrop') closeModal(); });
-</script>
-</body></html>
-  )rawliteral";
-  server.send(200, "text/html", html);
+  server.sendHeader("ETag", INDEX_HTML_ETAG);
+  server.sendHeader("Cache-Control", "no-cache");
+  if (server.header("If-None-Match") == INDEX_HTML_ETAG) { server.send(304); return; }
+  server.sendHeader("Content-Encoding", "gzip");
+  server.send_P(200, "text/html", (PGM_P)INDEX_HTML_GZ, INDEX_HTML_GZ_LEN);
 }
 
 /* setup & loop */
 void setup() {
   Serial.begin(115200);
   delay(50);
-  Serial.println("\nSender ESP32 HTTP starting...");
+  LOGI("Sender ESP32 HTTP starting...");
 
-  if (!initFileSystem()) Serial.println("LittleFS init failed");
+  cacheInit(responseCache, RESPONSE_CACHE_BYTES, esp_random());
+  replInit(replLog, esp_random());   // a new epoch per boot: the peer snapshots us again
+  replPeerReset(replPeer);
+  if (!initFileSystem()) LOGE("LittleFS init failed");
   loadDevicesFromFS();
 
   for (int i=0;i<MAX_DEVICES;i++) {
@@ -425,60 +1469,89 @@ void setup() {
       devices[i].macKnown = false;
       memset(devices[i].mac,0,6);
       devices[i].ip = IPAddress(0,0,0,0);
-      devices[i].rssi = 0;
+      linkReset(devices[i].link);
       devices[i].name[0] = 0;
       devices[i].percent = -1;
       devices[i].totalHeightCm = 0;
       devices[i].sensorToMaxCm = 0;
       devices[i].lastSeen = 0;
+      devices[i].seq = 0;
+      devices[i].sampleMs = 0;
+      trendReset(devices[i].trend);
+      setAlarmConfig(i, ALARM_DEFAULTS);
+      devices[i].alarm = 0;
+      devices[i].alarmSinceMs = 0;
     }
   }
 
   WiFi.mode(WIFI_AP_STA);
   bool apok = WiFi.softAP(AP_SSID, AP_PASS, AP_CHANNEL, false);
-  if (!apok) Serial.println("softAP start failed");
+  if (!apok) LOGE("softAP start failed");
   else {
     WiFi.softAPConfig(AP_IP, AP_IP, AP_NETMASK);
-    Serial.printf("SoftAP started SSID='%s' IP=%s channel=%u\n", AP_SSID, WiFi.softAPIP().toString().c_str(), AP_CHANNEL);
+    LOGI("SoftAP started SSID='%s' IP=%s channel=%u", AP_SSID, WiFi.softAPIP().toString().c_str(), AP_CHANNEL);
   }
 
   if (trySTA) {
     if (useStaticIP) {
       if (!WiFi.config(STA_LOCAL_IP, STA_GATEWAY, STA_SUBNET, STA_DNS1, STA_DNS2)) {
-        Serial.println("STA static IP config failed; will attempt DHCP");
-      } else Serial.printf("Configured STA static IP: %s\n", STA_LOCAL_IP.toString().c_str());
+        LOGW("STA static IP config failed; will attempt DHCP");
+      } else LOGI("Configured STA static IP: %s", STA_LOCAL_IP.toString().c_str());
     }
     WiFi.begin(STA_SSID, STA_PASS);
-    Serial.printf("Attempting STA connect to '%s' ...\n", STA_SSID);
+    LOGI("Attempting STA connect to '%s' ...", STA_SSID);
     unsigned long t0 = millis();
-    while (WiFi.status() != WL_CONNECTED && (millis() - t0) < 10000) { Serial.print('.'); delay(300); }
-    Serial.println();
-    if (WiFi.status() == WL_CONNECTED) Serial.printf("STA connected. IP=%s\n", WiFi.localIP().toString().c_str());
-    else Serial.println("STA not connected (AP still up)");
+    logFlush(Serial);
+    while (WiFi.status() != WL_CONNECTED && (millis() - t0) < 10000) delay(300);
+    if (WiFi.status() == WL_CONNECTED) LOGI("STA connected. IP=%s", WiFi.localIP().toString().c_str());
+    else LOGW("STA not connected (AP still up)");
   }
 
-  if (MDNS.begin("sender")) Serial.println("mDNS responder started: http://sender.local/");
-  else Serial.println("mDNS start failed (ok if unsupported)");
+  if (MDNS.begin("sender")) LOGI("mDNS responder started: http://sender.local/");
+  else LOGW("mDNS start failed (ok if unsupported)");
 
+  server.collectHeaders(HTTP_COLLECT_HEADERS, 1);
   server.on("/", HTTP_GET, handleRoot);
   server.on("/status", HTTP_GET, handleStatus);
   server.on("/api/devices", HTTP_GET, handleGetDevices);
   server.on("/api/report", HTTP_POST, handleReport);
+  server.on("/api/report/batch", HTTP_POST, handleReportBatch);
   server.on("/api/device", HTTP_POST, handleSaveDevice);
   server.on("/api/config", HTTP_GET, handleGetConfig);
+  server.on("/api/metrics", HTTP_GET, handleMetrics);
+  server.on("/api/alarms", HTTP_GET, handleAlarms);
+  server.on("/api/replog", HTTP_GET, handleReplog);
   server.begin();
-  Serial.printf("HTTP server started (port %d)\n", HTTP_PORT);
-  Serial.printf("AP URL: http://%s/\n", WiFi.softAPIP().toString().c_str());
-  if (WiFi.status() == WL_CONNECTED) Serial.printf("STA URL: http://%s/\n", WiFi.localIP().toString().c_str());
+  LOGI("HTTP server started (port %d)", HTTP_PORT);
+  if (USE_ESPNOW) {
+    if (esp_now_init() == ESP_OK && esp_now_register_recv_cb(onEspNowRecv) == ESP_OK) LOGI("ESP-NOW reports on channel %d", WiFi.channel());
+    else LOGE("ESP-NOW init failed");
+  }
+  if (USE_MQTT) setupMqtt();
+  if (ESPNOW_UDP_PORT) {
+    espNowUdp.begin(ESPNOW_UDP_PORT);
+    LOGI("ESP-NOW stand-in on UDP %u", ESPNOW_UDP_PORT);
+  }
+  LOGI("AP URL: http://%s/", WiFi.softAPIP().toString().c_str());
+  if (WiFi.status() == WL_CONNECTED) LOGI("STA URL: http://%s/", WiFi.localIP().toString().c_str());
+  logFlush(Serial);
 }
 
 void loop() {
+  unsigned long t0 = micros();
   server.handleClient();
-  // refresh AP-connected stations list occasionally to update lastSeen
-  static unsigned long lastRefresh = 0;
-  if (millis() - lastRefresh > 3000) {
-    lastRefresh = millis();
+  // the only place stations and staleness are updated; request handlers just read
+  static unsigned long lastSweep = 0;
+  if (millis() - lastSweep >= SWEEP_MS) {
+    lastSweep = millis();
     refreshConnectedStations();
+    alarmSweep();
   }
+  espNowTick();
+  replTick();
+  mqttTick();
+  benchLogTick();
+  logDrain(Serial); // deferred log output, only as much as the UART FIFO takes
+  loopUs.record(micros() - t0);
   delay(10);
 }
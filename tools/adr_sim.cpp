@@ -0,0 +1,92 @@
+/*
+  adr_sim.cpp
+  - Host simulation of the LoRa ADR loop (lora/lora_adr.h) over a simple
+    channel: slow shadowing (AR(1), 2 dB), per-packet noise (1.5 dB), SNR
+    readings clipped at +10 dB like the SX127x, a deep obstruction partway
+    through and its removal later
+  - Sender and receiver follow the same rules as lora/sender.c and
+    lora/reciever.c: downlink window after each uplink, ACK request and
+    fallback on silence, receiver rendezvous on LORA_SF_FALLBACK
+  - Prints delivery ratio, mean time on air, SF and power per window
+      g++ -std=c++11 -O2 -Wall -Wextra tools/adr_sim.cpp -o /tmp/adr_sim && /tmp/adr_sim
+*/
+
+#include <stdio.h>
+#include <random>
+#include "../common/link_stats.h"
+#include "../lora/lora_adr.h"
+#include "../lora/lora_proto.h"
+
+const int UPLINKS = 3000;
+const int WINDOW = 250;
+const unsigned long SENSE_MS = 4400;        // sensor sweep + loop delay of lora/sender.c
+const unsigned long RX_FALLBACK_MS = 60000; // as lora/reciever.c
+
+// SNR at the receiver with the sender at full power, before noise
+float channelBase(int i) {
+  if (i >= 1200 && i < 2100) return -12.0f;  // obstruction
+  return 6.0f;
+}
+
+int main() {
+  std::mt19937 rng(42);
+  std::normal_distribution<float> shadowStep(0.0f, 2.0f * 0.3122f);  // stationary sigma 2 dB at rho 0.95
+  std::normal_distribution<float> noise(0.0f, 1.5f);
+  float shadow = 0;
+
+  AdrSender tx;
+  adrInit(tx);
+  uint8_t radioSf = LORA_SF_FALLBACK;
+  LinkStats link;
+  linkReset(link);
+  uint8_t holdoff = ADR_HOLDOFF;
+  unsigned long now = 0, lastUplinkMs = 0;
+
+  int delivered = 0, sfSum = 0, powerSum = 0;
+  double airMs = 0;
+  printf("uplinks    delivery  airtime_ms  mean_sf  mean_dbm  channel_db\n");
+  for (int i = 0; i < UPLINKS; ++i) {
+    shadow = 0.95f * shadow + shadowStep(rng);
+    float base = channelBase(i) + shadow;
+    uint32_t upUs = loraAirtimeUs(tx.sf, LORA_BW_HZ, LORA_CR, sizeof(StructMessage));
+    airMs += upUs / 1000.0;
+    sfSum += tx.sf;
+    powerSum += tx.power;
+
+    float snrUp = base + (tx.power - ADR_POWER_MAX) + noise(rng);
+    bool heard = tx.sf == radioSf && snrUp > loraSnrFloorDb(tx.sf);
+    bool answered = false;
+    if (heard) {
+      delivered++;
+      lastUplinkMs = now;
+      linkOnFrame(link, (uint32_t)i, now, 0xFFFF);
+      linkOnSnr(link, snrUp > 10.0f ? 10.0f : snrUp);
+      bool reply = adrWantAck(tx);
+      uint8_t sf = tx.sf;
+      int8_t power = tx.power;
+      if (holdoff) holdoff--;
+      else if (link.haveSnr) {
+        adrDecide(link.snr, sf, power);
+        if (sf != tx.sf || power != tx.power) { reply = true; holdoff = ADR_HOLDOFF; link.haveSnr = false; }
+      }
+      if (reply) {
+        // downlink at the receiver's full power, on the SF it heard
+        float snrDown = base + noise(rng);
+        airMs += loraAirtimeUs(tx.sf, LORA_BW_HZ, LORA_CR, sizeof(LoraHeader)) / 1000.0;
+        if (snrDown > loraSnrFloorDb(tx.sf)) { adrOnDownlink(tx, sf, power); answered = true; }
+        radioSf = sf;
+      }
+    }
+    if (!answered) adrOnSilence(tx);
+
+    now += SENSE_MS + upUs / 1000 + 100;
+    if (radioSf != LORA_SF_FALLBACK && now - lastUplinkMs > RX_FALLBACK_MS) radioSf = LORA_SF_FALLBACK;
+
+    if ((i + 1) % WINDOW == 0) {
+      printf("%4d-%-4d  %6.1f%%  %10.0f  %7.2f  %8.1f  %10.1f\n", i + 1 - WINDOW, i + 1,
+             100.0 * delivered / WINDOW, airMs / WINDOW, (double)sfSum / WINDOW, (double)powerSum / WINDOW, channelBase(i));
+      delivered = 0; sfSum = 0; powerSum = 0; airMs = 0;
+    }
+  }
+  return 0;
+}
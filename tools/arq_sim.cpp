@@ -0,0 +1,94 @@
+/*
+  arq_sim.cpp
+  - Host loss-injection run of the LoRa ACK/retry rules (lora/lora_arq.h)
+    with the timing of lora/sender.c: 2.4 s sensor sweep, then send, ACK
+    window and retries inside the 2 s idle time
+  - Independent uplink/downlink loss at several rates plus a bursty
+    channel (Gilbert-Elliott), fixed SF, with and without ACK mode
+  - Reports delivery ratio, reading-to-receiver latency (p50/p99) and
+    airtime overhead versus one uplink per reading
+      g++ -std=c++11 -O2 -Wall -Wextra tools/arq_sim.cpp -o /tmp/arq_sim && /tmp/arq_sim
+*/
+
+#include <stdio.h>
+#include <random>
+#include "../common/latency_hist.h"
+#include "../lora/lora_adr.h"
+#include "../lora/lora_arq.h"
+#include "../lora/lora_proto.h"
+
+const int FRAMES = 20000;
+const unsigned long SWEEP_MS = 2400;
+const unsigned long IDLE_MS = 2000;
+const unsigned long REPLY_DELAY_MS = 20;
+const unsigned long RX_WINDOW_SLACK_MS = 100;
+
+struct Channel {
+  float pGood, pBad;       // loss probability per state
+  float toBad, toGood;     // per-packet state transition probability
+  bool bad;
+};
+
+bool lost(Channel& c, std::mt19937& rng) {
+  std::uniform_real_distribution<float> u(0.0f, 1.0f);
+  if (c.bad ? u(rng) < c.toGood : u(rng) < c.toBad) c.bad = !c.bad;
+  return u(rng) < (c.bad ? c.pBad : c.pGood);
+}
+
+void run(const char* name, Channel ch, uint8_t sf, bool ackMode) {
+  std::mt19937 rng(7);
+  LatencyHist latency;
+  unsigned long upMs = loraAirtimeUs(sf, LORA_BW_HZ, LORA_CR, sizeof(StructMessage)) / 1000;
+  unsigned long dnMs = loraAirtimeUs(sf, LORA_BW_HZ, LORA_CR, sizeof(LoraHeader)) / 1000;
+  unsigned long windowMs = RX_WINDOW_SLACK_MS + dnMs;
+  unsigned long t = 0;
+  double airMs = 0;
+  int delivered = 0, sends = 0;
+
+  for (int f = 0; f < FRAMES; ++f) {
+    t += SWEEP_MS;
+    unsigned long readingMs = t, sendStart = t;
+    unsigned long nextDueMs = sendStart + IDLE_MS + SWEEP_MS;
+    bool have = false;
+    for (uint8_t attempt = 0; ; ++attempt) {
+      sends++;
+      t += upMs;
+      airMs += upMs;
+      bool upOk = !lost(ch, rng);
+      if (upOk && !have) { have = true; delivered++; latency.record(t - readingMs); }
+      bool acked = false;
+      if (ackMode && upOk) {
+        airMs += dnMs;  // receiver answers every copy it hears
+        acked = !lost(ch, rng);
+      }
+      t += acked ? REPLY_DELAY_MS + dnMs : (ackMode ? windowMs : 0);
+      if (!ackMode || acked || attempt >= ARQ_MAX_RETRIES) break;
+      unsigned long backoff = arqBackoffMs(attempt, rng());
+      if (!arqRetryFits(t, nextDueMs, backoff, upMs + windowMs)) break;
+      t += backoff;
+    }
+    if ((long)(sendStart + IDLE_MS - t) > 0) t = sendStart + IDLE_MS;
+  }
+  printf("%-14s SF%-2u %-4s  delivery %6.2f%%  latency p50 %5lu ms  p99 %5lu ms  tx/reading %.2f  airtime +%5.1f%%\n",
+         name, sf, ackMode ? "ack" : "off", 100.0 * delivered / FRAMES,
+         (unsigned long)latency.percentile(0.5f), (unsigned long)latency.percentile(0.99f),
+         (double)sends / FRAMES, 100.0 * (airMs / ((double)FRAMES * upMs) - 1.0));
+}
+
+int main() {
+  const float rates[] = { 0.0f, 0.1f, 0.3f, 0.5f };
+  const uint8_t sfs[] = { 7, 10 };
+  for (uint8_t sf : sfs) {
+    for (float p : rates) {
+      char name[24];
+      snprintf(name, sizeof(name), "loss %2.0f%%", p * 100);
+      Channel ch = { p, p, 0.0f, 1.0f, false };
+      run(name, ch, sf, false);
+      run(name, ch, sf, true);
+    }
+    Channel burst = { 0.02f, 0.8f, 0.05f, 0.3f, false };  // ~16 % of packets in bad runs of ~3
+    run("bursty", burst, sf, false);
+    run("bursty", burst, sf, true);
+  }
+  return 0;
+}
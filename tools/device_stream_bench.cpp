@@ -0,0 +1,198 @@
+/*
+  device_stream_bench.cpp
+  - Host check of common/device_stream.h, the ESP32 receiver's /api/devices
+    parser, on recorded bodies: the receiver's own query (fields=...),
+    the full rows the web UI gets, nulls, escapes, \u names, pretty
+    printing, a nested value, an empty list, an error object and a body cut
+    off mid-row. Every body is also fed in 1..64-byte chunks, as the socket
+    hands it over. Fails (exit 1) on any mismatch
+  - Then parse time and memory at 4, 128 and 1024 devices (bodies built in
+    writeDeviceJson's shape), reading all rows and stopping at the
+    receiver's MAX_CACHE (32). Memory is the parser state plus the read
+    buffer; the getString() + 16 KB document path it replaced held the
+    whole body and the document
+      g++ -std=c++11 -O2 -Wall -Wextra tools/device_stream_bench.cpp -o /tmp/device_stream_bench && /tmp/device_stream_bench
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "../common/device_stream.h"
+
+const int MAX_CACHE = 32;          // ESP32-reciever-display.cpp
+const int READ_BUF = 128;          // netPoll's chunk
+const int OLD_DOC = 16384;         // StaticJsonDocument<16384> before
+int failures = 0;
+
+struct Parsed {
+  std::vector<DeviceRow> rows;
+  DeviceStreamEvent last;
+  uint32_t bytes;
+};
+
+// feed body in chunks of `chunk` bytes (0 = all at once), stop after maxRows
+Parsed parse(const std::string& body, size_t chunk = 0, int maxRows = 1 << 30) {
+  Parsed p;
+  p.last = DS_NONE;
+  DeviceStream ds;
+  deviceStreamInit(ds);
+  size_t off = 0;
+  while (off < body.size() && (int)p.rows.size() < maxRows && p.last != DS_END && p.last != DS_ERROR) {
+    size_t n = chunk ? std::min(chunk, body.size() - off) : body.size() - off;
+    for (size_t k = 0; k < n && (int)p.rows.size() < maxRows; k++) {
+      DeviceStreamEvent ev = deviceStreamFeed(ds, body[off + k]);
+      if (ev == DS_ROW) p.rows.push_back(ds.row);
+      if (ev != DS_NONE) p.last = ev;
+      if (ev == DS_END || ev == DS_ERROR) break;
+    }
+    off += n;
+  }
+  p.bytes = ds.bytes;
+  return p;
+}
+
+void check(bool ok, const char* what, const char* body) {
+  if (ok) return;
+  failures++;
+  printf("FAIL %s: %.60s\n", what, body);
+}
+
+struct Expect {
+  uint16_t has;
+  const char* name;
+  const char* mac;
+  float percent;
+  long ageSec;
+  uint32_t seq;
+  long sampleAgeMs;
+  float ratePph;
+  uint8_t anomaly, alarm;
+};
+
+bool same(const DeviceRow& r, const Expect& e) {
+  if (r.has != e.has) return false;
+  if ((e.has & DR_NAME) && strcmp(r.name, e.name)) return false;
+  if ((e.has & DR_MAC) && strcmp(r.mac, e.mac)) return false;
+  if ((e.has & DR_PERCENT) && fabsf(r.percent - e.percent) > 1e-4f) return false;
+  if ((e.has & DR_AGE) && r.ageSec != e.ageSec) return false;
+  if ((e.has & DR_SEQ) && r.seq != e.seq) return false;
+  if ((e.has & DR_SAMPLE_AGE) && r.sampleAgeMs != e.sampleAgeMs) return false;
+  if ((e.has & DR_RATE) && fabsf(r.ratePph - e.ratePph) > 1e-4f) return false;
+  if ((e.has & DR_ANOMALY) && r.anomaly != e.anomaly) return false;
+  if ((e.has & DR_ALARM) && r.alarm != e.alarm) return false;
+  return true;
+}
+
+struct Case {
+  const char* what;
+  const char* body;
+  DeviceStreamEvent last;
+  std::vector<Expect> rows;
+};
+
+const uint16_t RX_ALL = DR_NAME | DR_MAC | DR_PERCENT | DR_AGE | DR_SEQ | DR_SAMPLE_AGE | DR_RATE | DR_ANOMALY | DR_ALARM;
+
+std::vector<Case> recorded() {
+  return {
+    { "empty list", "[]", DS_END, {} },
+    { "receiver query",
+      "[{\"mac\":\"5C:CF:7F:1A:2B:3C\",\"name\":\"Roof tank\",\"percent\":62.5,\"age_seconds\":2,\"seq\":1841,\"sample_age_ms\":2310,\"rate_pph\":-1.5,\"anomaly\":0,\"alarm\":0},"
+      "{\"mac\":\"5C:CF:7F:1A:2B:3D\",\"name\":null,\"percent\":null,\"age_seconds\":41,\"seq\":7,\"sample_age_ms\":null,\"rate_pph\":null,\"anomaly\":2,\"alarm\":4}]",
+      DS_END,
+      { { RX_ALL, "Roof tank", "5C:CF:7F:1A:2B:3C", 62.5f, 2, 1841, 2310, -1.5f, 0, 0 },
+        { DR_MAC | DR_AGE | DR_SEQ | DR_ANOMALY | DR_ALARM, "", "5C:CF:7F:1A:2B:3D", 0, 41, 7, 0, 0, 2, 4 } } },
+    { "full row (web UI)",
+      "[{\"mac\":null,\"ip\":\"192.168.1.61\",\"rssi\":-67,\"name\":\"Sump\",\"percent\":100,\"age_seconds\":0,\"totalHeightCm\":120,\"sensorToMaxCm\":2.5,"
+      "\"seq\":4294967295,\"sample_age_ms\":15,\"rate_pph\":12.3,\"tte_s\":null,\"ttf_s\":0,\"anomaly\":0,\"alarm\":2,\"loss_pct\":0.4,\"jitter_ms\":31,\"report_interval_ms\":2500}]",
+      DS_END,
+      { { DR_NAME | DR_PERCENT | DR_AGE | DR_SEQ | DR_SAMPLE_AGE | DR_RATE | DR_ANOMALY | DR_ALARM, "Sump", "", 100, 0, 4294967295u, 15, 12.3f, 0, 2 } } },
+    { "escapes and \\u",
+      "[{\"name\":\"Tank \\\"A\\\"\\\\1\",\"age_seconds\":1},{\"name\":\"Caf\\u00e9 \\u2192 B\",\"age_seconds\":3}]",
+      DS_END,
+      { { DR_NAME | DR_AGE, "Tank \"A\"\\1", "", 0, 1, 0, 0, 0, 0, 0 },
+        { DR_NAME | DR_AGE, "Caf? ? B", "", 0, 3, 0, 0, 0, 0, 0 } } },
+    { "pretty printed",
+      "[\n  {\n    \"name\" : \"North\" ,\n    \"percent\" : 7.25 ,\n    \"age_seconds\" : 9\n  } ,\n  { \"name\": \"South\", \"age_seconds\": 1e1 }\n]\n",
+      DS_END,
+      { { DR_NAME | DR_PERCENT | DR_AGE, "North", "", 7.25f, 9, 0, 0, 0, 0, 0 },
+        { DR_NAME | DR_AGE, "South", "", 0, 10, 0, 0, 0, 0, 0 } } },
+    { "nested value skipped",
+      "[{\"name\":\"x\",\"extra\":{\"a\":[1,{\"b\":\"}]\\\"\"}],\"c\":null},\"percent\":5,\"age_seconds\":0}]",
+      DS_END,
+      { { DR_NAME | DR_PERCENT | DR_AGE, "x", "", 5, 0, 0, 0, 0, 0, 0 } } },
+    { "long name cut",
+      "[{\"name\":\"0123456789012345678901234567890123456789\",\"age_seconds\":0}]",
+      DS_END,
+      { { DR_NAME | DR_AGE, "0123456789012345678901234567890", "", 0, 0, 0, 0, 0, 0, 0 } } },
+    { "error object", "{\"ok\":false,\"msg\":\"busy\"}", DS_ERROR, {} },
+    { "cut mid-row",
+      "[{\"name\":\"A\",\"age_seconds\":1},{\"name\":\"B\",\"perc",
+      DS_ROW,
+      { { DR_NAME | DR_AGE, "A", "", 0, 1, 0, 0, 0, 0, 0 } } },
+  };
+}
+
+// a body the sender would send for n devices, receiver query shape
+std::string body(int n) {
+  std::string s = "[";
+  char row[256];
+  for (int i = 0; i < n; i++) {
+    bool stale = i % 7 == 3, unnamed = i % 11 == 5;
+    snprintf(row, sizeof(row),
+             "%s{\"mac\":\"5C:CF:7F:%02X:%02X:%02X\",\"name\":%s%s%d%s,\"percent\":%.1f,\"age_seconds\":%d,\"seq\":%u,"
+             "\"sample_age_ms\":%d,\"rate_pph\":%.1f,\"anomaly\":%d,\"alarm\":%d}",
+             i ? "," : "", i >> 16 & 255, i >> 8 & 255, i & 255, unnamed ? "null" : "\"Tank-", "", unnamed ? 0 : i,
+             unnamed ? "" : "\"", (i * 37 % 1000) / 10.0, stale ? 40 + i % 60 : i % 5, 1000u + i * 13,
+             (i % 5) * 1000 + 210, (i % 9 - 4) * 0.7, i % 13 == 0 ? 1 : 0, stale ? 4 : 0);
+    s += row;
+  }
+  return s + "]";
+}
+
+int main() {
+  for (const Case& c : recorded()) {
+    for (size_t chunk = 0; chunk <= 64; chunk = chunk ? chunk * 2 : 1) {
+      Parsed p = parse(c.body, chunk);
+      bool ok = p.last == c.last && p.rows.size() == c.rows.size();
+      for (size_t i = 0; ok && i < c.rows.size(); i++) ok = same(p.rows[i], c.rows[i]);
+      check(ok, c.what, c.body);
+      if (!ok) break;
+    }
+  }
+  // early stop: the receiver's cap on a big body leaves the rest unread
+  std::string big = body(1024);
+  Parsed capped = parse(big, READ_BUF, MAX_CACHE);
+  check(capped.rows.size() == (size_t)MAX_CACHE && capped.bytes < big.size() / 16, "stop at MAX_CACHE", "body(1024)");
+  // generated bodies come back as written
+  Parsed all = parse(big, READ_BUF);
+  bool ok = all.last == DS_END && all.rows.size() == 1024;
+  for (int i = 0; ok && i < 1024; i++) ok = all.rows[i].seq == 1000u + i * 13 && (i % 11 == 5 || (all.rows[i].has & DR_NAME));
+  check(ok, "body(1024) round trip", "body(1024)");
+  printf("recorded bodies: %zu cases x 8 chunkings, %d failures\n", recorded().size(), failures);
+
+  printf("parser state %zu B + read buffer %d B, at any size\n", sizeof(DeviceStream), READ_BUF);
+  printf("%8s %9s %13s %11s %13s %11s %16s\n", "devices", "body_B", "all_us", "all_ns/B", "cap32_us", "cap32_B", "before_peak_B");
+  for (int n : { 4, 128, 1024 }) {
+    std::string b = body(n);
+    const int reps = n >= 1024 ? 200 : 2000;
+    double allUs = 0, capUs = 0;
+    uint32_t capBytes = 0;
+    size_t sink = 0;
+    for (int pass = 0; pass < 2; pass++) {   // first pass warms up
+      auto t0 = std::chrono::steady_clock::now();
+      for (int r = 0; r < reps; r++) sink += parse(b, READ_BUF).rows.size();
+      auto t1 = std::chrono::steady_clock::now();
+      for (int r = 0; r < reps; r++) { Parsed p = parse(b, READ_BUF, MAX_CACHE); sink += p.rows.size(); capBytes = p.bytes; }
+      auto t2 = std::chrono::steady_clock::now();
+      allUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / reps;
+      capUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / reps;
+    }
+    if (sink == 0) printf("?");
+    printf("%8d %9zu %13.1f %11.2f %13.1f %11u %16zu\n", n, b.size(), allUs, allUs * 1000 / b.size(), capUs, capBytes,
+           b.size() + OLD_DOC);
+  }
+  return failures ? 1 : 0;
+}
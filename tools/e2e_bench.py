@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+e2e_bench.py
+  - sensor-to-display latency and sustained reports/s of the report
+    pipeline, on Linux against host builds of the firmwares: a fleet from
+    tools/fleet_sim.py (sender-server, --sensors esp8266 builds, --receivers
+    display builds) plus --extra sensors posting /api/report at --rate
+    reports/s each (tools/report_bench.py's HTTP sensor), to push the
+    sender harder than the firmware sensors' own interval does
+  - the stages are stamped by the firmwares themselves: the sensor's
+    sample time rides with the report (age_ms), the sender keeps it per
+    device (sample_age_ms in /api/devices) and the receiver adds its own
+    poll-to-render time; they log one bench line per BENCH_LOG_INTERVAL_MS
+    (10 s). The first window of each board is boot and is skipped
+  - prints one JSON line, sorted keys, so two runs diff line for line:
+      e2e_*      receivers' sensor-to-LCD latency; p50 is the median of the
+                 windows, p99/p999/max the worst window
+      ingest_*   sender's report service time, same aggregation
+      reports_s  reports the sender applied per second (firmware + extra)
+      sensor_*   firmware sensors' POST round trip and failures
+      heap       lowest free heap of the sender and of any receiver/sensor
+      python3 tools/e2e_bench.py --arduinojson ~/Arduino/libraries/ArduinoJson --sensors 16 --extra 32 --rate 2 --seconds 60
+"""
+
+import argparse
+import json
+import os
+import random
+import sys
+import threading
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import fleet_sim      # noqa: E402
+import report_bench   # noqa: E402
+
+
+def windows(board, kind):
+    lines = [j for j in board.json_lines() if j.get("bench") == kind]
+    return lines[1:]
+
+
+def median(xs):
+    xs = sorted(xs)
+    return xs[len(xs) // 2] if xs else 0
+
+
+def aggregate(ws, unit):
+    return {
+        "n": sum(w["n"] if "n" in w else w.get("reports", 0) for w in ws),
+        "p50_" + unit: median([w["p50_" + unit] for w in ws]),
+        "p99_" + unit: max([w["p99_" + unit] for w in ws] or [0]),
+        "p999_" + unit: max([w["p999_" + unit] for w in ws] or [0]),
+        "max_" + unit: max([w["max_" + unit] for w in ws] or [0]),
+    }
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    fleet_sim.add_args(ap)
+    ap.add_argument("--extra", type=int, default=0, help="HTTP sensors from this script on top of the firmware ones")
+    ap.add_argument("--rate", type=float, default=0.4, help="reports/s per extra sensor")
+    args = ap.parse_args()
+    if args.lora:
+        sys.exit("e2e_bench: the report pipeline is the WiFi fleet")
+    args.scale = 1.0   # the extra sensors run in real time
+
+    boards = fleet_sim.fleet(args)
+    sent, errors = [], []
+
+    def load():
+        if args.extra == 0:
+            return
+        time.sleep(2.0)   # sender up and joined
+        deadline = time.monotonic() + args.seconds - 3.0
+        rnd = random.Random(args.seed)
+        threads = [threading.Thread(target=report_bench.http_sensor,
+                                    args=("127.0.0.1", args.port, bytes([2, 0x45, 0, 0, i >> 8, i & 0xFF]),
+                                          "load-%d" % i, 1.0 / args.rate, deadline, sent, errors))
+                   for i in range(args.extra)]
+        for t in threads:
+            time.sleep(rnd.uniform(0, 1.0 / args.rate / max(1, args.extra)))
+            t.start()
+        for t in threads:
+            t.join()
+
+    fleet_sim.run(boards, load)
+
+    sender = boards[0]
+    receivers = [b for b in boards if b.name.startswith("receiver")]
+    sensors = [b for b in boards if b.name.startswith("sensor")]
+    ingest = windows(sender, "ingest")
+    e2e = [w for r in receivers for w in windows(r, "e2e")]
+    sensor_w = [w for s in sensors for w in windows(s, "sensor")]
+    exits = {b.name: b.summary()["exit"] or {} for b in boards}
+    window_s = sum(w["window_ms"] for w in ingest) / 1000.0
+    out = {
+        "sensors": args.sensors, "extra": args.extra, "rate": args.rate, "receivers": args.receivers,
+        "seconds": args.seconds,
+        "reports_s": round(sum(w["reports"] for w in ingest) / window_s, 2) if window_s else 0,
+        "e2e": aggregate(e2e, "ms"),
+        "ingest": aggregate(ingest, "us"),
+        "sensor_posts": sum(w["posts"] for w in sensor_w),
+        "sensor_fail": sum(w["fail"] for w in sensor_w),
+        "sensor_post_p99_ms": max([w["post_p99_ms"] for w in sensor_w] or [0]),
+        "extra_sent": len(sent), "extra_errors": len(errors),
+        "heap": {
+            "sender_min_free": exits[sender.name].get("min_free_heap"),
+            "sensor_min_free": min([exits[s.name].get("min_free_heap", 0) for s in sensors] or [0]),
+            "receiver_min_free": min([exits[r.name].get("min_free_heap", 0) for r in receivers] or [0]),
+        },
+        "sender_max_rss_kb": exits[sender.name].get("max_rss_kb"),
+        "sender_cpu_s": exits[sender.name].get("cpu_s"),
+    }
+    print(json.dumps(out, sort_keys=True))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,159 @@
+/*
+  echo_gate_sim.cpp
+  - Host simulation of lora/sender.c's sweep: six tanks (tankCfg), five
+    pings each through a shared trigger, fixed timeouts as they were
+    (30 ms pulseIn timeout, 60 ms between pings, 100 ms between tanks)
+    against common/echo_gate.h's adaptive gate
+  - Levels drain slowly and refill at pump speed, so gates have to follow
+    real moves; pings are lost at random (PING_LOSS) and one run has a dead
+    sensor, one a tank A that runs dry and stays empty for a while (its echo
+    is the bottom, the edge of the gate). Both schemes see the same levels
+    and the same losses
+  - pulseIn's timeout runs from the trigger, so it also covers the HC-SR04's
+    lead-in before ECHO rises (the 8-cycle 40 kHz burst plus the module's
+    own latency): uniform LEADIN_MIN_US..LEADIN_MAX_US per ping. An echo
+    whose lead-in + width overruns the timeout is lost, and counted when the
+    gate cut off one the fixed timeout would have had
+  - Prints time per tank by fill, time per sweep, and how often the two
+    schemes' readings differ (a reading the gate cut off)
+      g++ -std=c++11 -O2 -Wall -Wextra tools/echo_gate_sim.cpp -o /tmp/echo_gate_sim && /tmp/echo_gate_sim
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include "../common/level_fixed.h"
+#include "../common/echo_gate.h"
+
+const float SOUND_SPEED = 0.0343f;                    // cm/us, as lora/sender.c
+const int TANKS = 6;
+const int SAMPLES = 5;
+const float PING_LOSS = 0.03f;
+const float NOISE_CM = 0.4f;
+const float SWEEP_PERIOD_S = 4.0f;                    // sweep + send + IDLE_MS, roughly
+const int SWEEPS = 20000;                             // ~22 h per run
+const uint32_t ECHO_MIN_US = levelUsForCm(2.0f, SOUND_SPEED);
+const uint32_t ECHO_MAX_US = levelUsForCm(450.0f, SOUND_SPEED);
+const uint32_t GATE_MARGIN_US = levelUsForCm(8.0f, SOUND_SPEED);
+const uint32_t FIXED_TIMEOUT_US = 30000, FIXED_DELAY_US = 60000, FIXED_GAP_US = 100000;
+const uint32_t LEADIN_MIN_US = 200, LEADIN_MAX_US = ECHO_GATE_LEADIN_US;   // trigger -> ECHO high
+const uint32_t MISS = 0xFFFFFFFFu;
+
+struct Tank { float height, offsetFull; };
+const Tank tanks[TANKS] = { {90, 5}, {125, 3}, {110, 2}, {150, 4}, {200, 6}, {175, 2.5f} };   // lora/sender.c tankCfg
+
+// level in cm of water: drains at 0.05..0.2 cm/s to 10..40 %, then a pump refills at 0.5 cm/s to ~97 %
+struct Level {
+  float cm, rate;
+  bool filling;
+  int dry;              // sweeps left empty before the refill
+};
+
+struct Stats {
+  double tankUs[3] = { 0, 0, 0 };     // by fill: <30 %, 30..70 %, >70 %
+  long tankN[3] = { 0, 0, 0 };
+  double sweepUs = 0;
+  long noEcho = 0;
+  long cut = 0;                       // echoes the timeout cut off
+};
+
+uint32_t median(uint32_t* r) {
+  std::sort(r, r + SAMPLES);
+  return r[SAMPLES / 2] == MISS ? 0 : r[SAMPLES / 2];
+}
+
+int bucket(float pct) { return pct < 30 ? 0 : pct > 70 ? 2 : 1; }
+
+void run(const char* what, bool deadSensor, bool dryTank) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> u(0, 1);
+  std::normal_distribution<float> noise(0, NOISE_CM);
+  std::uniform_int_distribution<uint32_t> leadIn(LEADIN_MIN_US, LEADIN_MAX_US);
+  Level lv[TANKS];
+  for (int t = 0; t < TANKS; t++) lv[t] = { tanks[t].height * (0.3f + 0.1f * t), 0.05f + 0.03f * t, false, 0 };
+  EchoGate gate[TANKS];
+  for (int t = 0; t < TANKS; t++) gateReset(gate[t]);
+  Stats fixed, adaptive;
+  long differ = 0, readings = 0;
+
+  for (int sweep = 0; sweep < SWEEPS; sweep++) {
+    uint64_t fixedSweep = 0, gateSweep = 0;
+    for (int t = 0; t < TANKS; t++) {
+      const Tank& k = tanks[t];
+      EchoGeometry geo = { levelUsForCm(k.offsetFull, SOUND_SPEED), levelUsForCm(k.height + k.offsetFull, SOUND_SPEED) };
+      float distCm = k.height + k.offsetFull - lv[t].cm;
+      uint32_t fixedR[SAMPLES], gateR[SAMPLES];
+      uint64_t fixedUs = 0, gateUs = 0;
+      for (int s = 0; s < SAMPLES; s++) {
+        bool lost = (deadSensor && t == 5) || u(rng) < PING_LOSS;
+        uint32_t echo = lost ? 0 : levelUsForCm(distCm + noise(rng), SOUND_SPEED);
+        if (echo && (echo < ECHO_MIN_US || echo > ECHO_MAX_US)) echo = 0;
+        uint32_t done = leadIn(rng) + echo;     // pulseIn returns when ECHO falls
+
+        uint32_t f = echo && done <= FIXED_TIMEOUT_US ? echo : 0;
+        fixedUs += (f ? done : FIXED_TIMEOUT_US) + FIXED_DELAY_US;
+        fixedR[s] = f ? f : MISS;
+
+        uint32_t timeout = gateTimeoutUs(gate[t], geo, GATE_MARGIN_US);
+        uint32_t g = echo && done <= timeout ? echo : 0;
+        gateOnPing(gate[t], g);
+        gateUs += (g ? done : timeout) + gateDelayMs(gate[t], timeout) * 1000;
+        gateR[s] = g ? g : MISS;
+        adaptive.cut += f && !g;
+      }
+      uint32_t fm = median(fixedR), gm = median(gateR);
+      gateOnReading(gate[t], gm);
+      if (t < TANKS - 1) {
+        fixedUs += FIXED_GAP_US;
+        const EchoGate& next = gate[t + 1];
+        EchoGeometry ng = { levelUsForCm(tanks[t + 1].offsetFull, SOUND_SPEED), levelUsForCm(tanks[t + 1].height + tanks[t + 1].offsetFull, SOUND_SPEED) };
+        gateUs += gateDelayMs(next, gateTimeoutUs(next, ng, GATE_MARGIN_US)) * 1000;
+      }
+      int b = bucket(100.0f * lv[t].cm / k.height);
+      fixed.tankUs[b] += fixedUs; fixed.tankN[b]++;
+      adaptive.tankUs[b] += gateUs; adaptive.tankN[b]++;
+      fixed.noEcho += fm == 0;
+      adaptive.noEcho += gm == 0;
+      readings++;
+      if ((fm == 0) != (gm == 0) || (fm && gm && (fm > gm ? fm - gm : gm - fm) > levelUsForCm(1.0f, SOUND_SPEED))) differ++;
+      fixedSweep += fixedUs;
+      gateSweep += gateUs;
+
+      // move the level
+      Level& l = lv[t];
+      if (l.filling) {
+        l.cm += 0.5f * SWEEP_PERIOD_S;
+        if (l.cm >= 0.97f * k.height) { l.cm = 0.97f * k.height; l.filling = false; }
+      } else {
+        l.cm -= l.rate * SWEEP_PERIOD_S;
+        if (dryTank && t == 0) {
+          if (l.cm <= 0) { l.cm = 0; if (++l.dry >= 200) { l.dry = 0; l.filling = true; } }
+        } else if (l.cm <= (0.1f + 0.05f * t) * k.height) l.filling = true;
+      }
+    }
+    fixed.sweepUs += fixedSweep;
+    adaptive.sweepUs += gateSweep;
+  }
+
+  printf("%s (%d sweeps)\n", what, SWEEPS);
+  const char* names[3] = { "<30%", "30-70%", ">70%" };
+  for (int b = 0; b < 3; b++) {
+    if (!fixed.tankN[b]) continue;
+    double f = fixed.tankUs[b] / fixed.tankN[b] / 1000, a = adaptive.tankUs[b] / adaptive.tankN[b] / 1000;
+    printf("  per tank %-7s fixed %6.1f ms  adaptive %6.1f ms  (-%.0f%%)\n", names[b], f, a, 100 * (1 - a / f));
+  }
+  double f = fixed.sweepUs / SWEEPS / 1000, a = adaptive.sweepUs / SWEEPS / 1000;
+  printf("  per sweep        fixed %6.1f ms  adaptive %6.1f ms  (-%.0f%%)\n", f, a, 100 * (1 - a / f));
+  printf("  no echo: fixed %ld, adaptive %ld of %ld; readings differing by >1 cm: %ld\n",
+         fixed.noEcho, adaptive.noEcho, readings, differ);
+  printf("  pings the gate cut off that the fixed timeout caught: %ld of %ld\n", adaptive.cut, readings * SAMPLES);
+}
+
+int main() {
+  run("all sensors working", false, false);
+  run("Tank F sensor dead", true, false);
+  run("Tank A runs dry", false, true);
+  return 0;
+}
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+embed_web_ui.py
+  - gzip web/index.html at build time and emit sender-server-ui.h
+  - output holds the compressed page as a flash array plus a strong ETag
+  - re-run after every edit to web/index.html:
+      python3 tools/embed_web_ui.py
+"""
+
+import gzip
+import hashlib
+import os
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SRC = os.path.join(ROOT, "web", "index.html")
+DST = os.path.join(ROOT, "sender-server-ui.h")
+
+
+def main():
+    with open(SRC, "rb") as f:
+        raw = f.read()
+    # mtime=0 keeps the output byte-identical for identical input
+    gz = gzip.compress(raw, compresslevel=9, mtime=0)
+    etag = hashlib.sha1(gz).hexdigest()[:16]
+
+    lines = []
+    for i in range(0, len(gz), 16):
+        lines.append("  " + ",".join("0x%02x" % b for b in gz[i:i + 16]) + ",")
+
+    out = []
+    out.append("/*")
+    out.append("  sender-server-ui.h  (generated by tools/embed_web_ui.py - do not edit)")
+    out.append("  - source: web/index.html (%d bytes raw, %d bytes gzip)" % (len(raw), len(gz)))
+    out.append("*/")
+    out.append("#pragma once")
+    out.append("")
+    out.append('const char INDEX_HTML_ETAG[] = "\\"%s\\"";' % etag)
+    out.append("const size_t INDEX_HTML_GZ_LEN = %d;" % len(gz))
+    out.append("const uint8_t INDEX_HTML_GZ[] PROGMEM = {")
+    out.extend(lines)
+    out.append("};")
+    out.append("")
+
+    with open(DST, "w", newline="\n") as f:
+        f.write("\n".join(out))
+    print("%s: %d -> %d bytes, etag %s" % (os.path.relpath(DST, ROOT), len(raw), len(gz), etag))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
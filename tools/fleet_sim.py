@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+fleet_sim.py
+  - runs a fleet of host builds (host/host.cpp) on this machine: one
+    sender-server, N esp8266 sensors and M display receivers talking HTTP
+    and ESP-NOW over loopback, or (--lora) a LoRa sender, N relays and a
+    receiver on the host LoRa air
+  - builds the binaries into --bin first if they are missing (--rebuild to
+    force); sender-server and esp8266 need ArduinoJson (--arduinojson DIR,
+    the library checkout whose src/ has ArduinoJson.h)
+  - each board gets its own directory under --work (LittleFS, EEPROM,
+    log); sensors start with EEPROM config "sim-<i>" so they show up as
+    separate tanks, each with its own level, drift and echo loss
+  - prints one JSON line per board when the run ends: its last bench line
+    of each kind (the firmwares log them every BENCH_LOG_INTERVAL_MS) and
+    the harness's exit line (CPU, peak RSS, lowest free heap)
+      python3 tools/fleet_sim.py --arduinojson ~/Arduino/libraries/ArduinoJson --sensors 32 --receivers 2 --seconds 60
+      python3 tools/fleet_sim.py --lora --relays 1 --seconds 120 --scale 4 --lcd
+  - the sender listens on --port; it also answers as 192.168.4.1 and
+    192.168.1.50 (the addresses in the sketches), so tools/poll_bench.py
+    and tools/report_bench.py can load it: poll_bench.py 127.0.0.1 --port <port>
+"""
+
+import argparse
+import json
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+HOST_SRC = ["host/host.cpp", "host/host_net.cpp", "host/host_radio.cpp"]
+FIRMWARE = {
+    "sender": ("sender-server.cpp", "-DESP32 -DESPNOW_UDP_STANDIN", True),
+    "sensor": ("esp8266.cpp", "-DESP8266", True),
+    "receiver": ("ESP32-reciever-display.cpp", "-DESP32", False),
+    "lora-sender": ("lora/sender.c", "-DESP32", False),
+    "lora-receiver": ("lora/reciever.c", "-DESP32", False),
+    "lora-relay": ("lora/relay.c", "-DESP32", False),
+}
+SENDER_ADDRS = ["192.168.4.1", "192.168.1.50"]
+
+
+def build(kind, args):
+    src, plat, needs_json = FIRMWARE[kind]
+    out = os.path.join(args.bin, "host-" + kind)
+    if os.path.exists(out) and not args.rebuild:
+        return out
+    cmd = ["g++", "-std=gnu++17", "-O2", "-pthread", "-DARDUINO"] + plat.split() + ["-include", "Arduino.h", "-I" + os.path.join(ROOT, "host")]
+    if needs_json:
+        if not args.arduinojson:
+            sys.exit("fleet_sim: %s needs ArduinoJson, pass --arduinojson" % src)
+        cmd.append("-I" + os.path.join(args.arduinojson, "src"))
+    cmd += ["-x", "c++", os.path.join(ROOT, src), "-x", "none"] + [os.path.join(ROOT, s) for s in HOST_SRC] + ["-o", out]
+    os.makedirs(args.bin, exist_ok=True)
+    print("fleet_sim: building %s" % out, file=sys.stderr)
+    subprocess.check_call(cmd)
+    return out
+
+
+def mac(role, i):
+    return "02:48:%02X:00:%02X:%02X" % (role, i >> 8, i & 0xFF)
+
+
+def sensor_eeprom(path, name):
+    # persisted_config_t in esp8266.cpp: name[16], totalHeightCm, sensorToMaxCm, magic
+    cfg = struct.pack("<16sffI", name.encode()[:16], 100.0, 10.0, 0xA5A5A5A5)
+    with open(path, "wb") as f:
+        f.write(cfg + b"\xff" * (128 - len(cfg)))
+
+
+class Board:
+    def __init__(self, name, binary, env, work):
+        self.name = name
+        self.dir = os.path.join(work, name)
+        os.makedirs(self.dir, exist_ok=True)
+        self.env = dict(os.environ, HOST_FS_DIR=os.path.join(self.dir, "fs"), HOST_EEPROM=os.path.join(self.dir, "eeprom.bin"), **env)
+        self.binary = binary
+        self.log = os.path.join(self.dir, "serial.log")
+
+    def start(self):
+        self.proc = subprocess.Popen([self.binary], env=self.env, cwd=self.dir,
+                                     stdout=open(self.log, "w"), stderr=subprocess.STDOUT)
+
+    def json_lines(self):
+        with open(self.log, errors="replace") as f:
+            for line in f:
+                start = line.find("{")
+                if start < 0:
+                    continue
+                try:
+                    yield json.loads(line[start:])
+                except ValueError:
+                    continue
+
+    def summary(self):
+        bench, exit_line = {}, None
+        for j in self.json_lines():
+            if "bench" in j:
+                bench[j["bench"]] = j
+            elif j.get("host") == "exit":
+                exit_line = j
+        return {"board": self.name, "bench": bench, "exit": exit_line}
+
+
+def add_args(ap):
+    ap.add_argument("--sensors", type=int, default=4)
+    ap.add_argument("--receivers", type=int, default=1)
+    ap.add_argument("--lora", action="store_true", help="LoRa fleet: lora/sender.c, --relays relays, one receiver")
+    ap.add_argument("--relays", type=int, default=0)
+    ap.add_argument("--seconds", type=float, default=30.0, help="sketch time")
+    ap.add_argument("--scale", type=float, default=1.0, help="HOST_CLOCK_SCALE: sketch seconds per real second")
+    ap.add_argument("--port", type=int, default=18080, help="local port playing the sender's port 80")
+    ap.add_argument("--echo-loss", type=float, default=0.0, help="HOST_ECHO_LOSS_PCT per sensor")
+    ap.add_argument("--lcd", action="store_true", help="receivers print their panel (HOST_LCD=1)")
+    ap.add_argument("--arduinojson")
+    ap.add_argument("--bin", default="/tmp/fleet_sim/bin")
+    ap.add_argument("--work", default="/tmp/fleet_sim/run")
+    ap.add_argument("--rebuild", action="store_true")
+    ap.add_argument("--seed", type=int, default=1)
+
+
+def fleet(args):
+    rnd = random.Random(args.seed)
+    shutil.rmtree(args.work, ignore_errors=True)
+    run_ms = str(int(args.seconds * 1000))
+    common = {"HOST_CLOCK_SCALE": str(args.scale), "HOST_RUN_MS": run_ms}
+    boards = []
+    if args.lora:
+        boards.append(Board("lora-receiver", build("lora-receiver", args),
+                            dict(common, HOST_IP="10.0.0.1", HOST_MAC=mac(1, 0), HOST_LCD="1" if args.lcd else "0"), args.work))
+        for i in range(args.relays):
+            boards.append(Board("lora-relay-%d" % i, build("lora-relay", args),
+                                dict(common, HOST_IP="10.0.1.%d" % (i + 1), HOST_MAC=mac(2, i)), args.work))
+        boards.append(Board("lora-sender", build("lora-sender", args),
+                            dict(common, HOST_IP="10.0.2.1", HOST_MAC=mac(3, 0)),
+                            args.work))
+    else:
+        routes = ",".join("%s=%d" % (a, args.port) for a in SENDER_ADDRS)
+        common["HOST_ROUTES"] = routes
+        boards.append(Board("sender", build("sender", args),
+                            dict(common, HOST_IP=SENDER_ADDRS[1], HOST_MAC=mac(1, 0), HOST_HTTP_PORT=str(args.port)), args.work))
+        sensor_bin = build("sensor", args)
+        for i in range(args.sensors):
+            b = Board("sensor-%d" % i, sensor_bin,
+                      dict(common, HOST_IP="192.168.4.%d" % (10 + i % 240), HOST_MAC=mac(2, i),
+                           HOST_LEVEL_CM="%.1f" % rnd.uniform(15, 80), HOST_LEVEL_RATE_CM_H="%.1f" % rnd.uniform(-30, 30),
+                           HOST_ECHO_LOSS_PCT=str(args.echo_loss)), args.work)
+            sensor_eeprom(b.env["HOST_EEPROM"], "sim-%d" % i)
+            boards.append(b)
+        receiver_bin = build("receiver", args)
+        for i in range(args.receivers):
+            boards.append(Board("receiver-%d" % i, receiver_bin,
+                                dict(common, HOST_IP="192.168.1.%d" % (60 + i), HOST_MAC=mac(3, i),
+                                     HOST_LCD="1" if args.lcd else "0"), args.work))
+
+    return boards
+
+
+def run(boards, during=None):
+    """start the boards (the first one a moment early), call during() while they run, wait for all"""
+    boards[0].start()
+    time.sleep(0.3)   # the sender (or LoRa receiver) is listening before anyone calls
+    for b in boards[1:]:
+        b.start()
+    if during:
+        during()
+    try:
+        for b in boards:
+            b.proc.wait()
+    except KeyboardInterrupt:
+        for b in boards:
+            b.proc.terminate()
+        for b in boards:
+            b.proc.wait()
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    add_args(ap)
+    boards = fleet(ap.parse_args())
+    run(boards)
+    for b in boards:
+        print(json.dumps(b.summary(), sort_keys=True))
+
+
+if __name__ == "__main__":
+    main()
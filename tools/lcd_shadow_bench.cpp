@@ -0,0 +1,178 @@
+/*
+  lcd_shadow_bench.cpp
+  - Host benchmark of common/lcd_shadow.h against a mock PCF8574 I2C
+    backpack, counting bytes on the bus per frame (address bytes included)
+    the way each driver the sketches use puts an LCD write on the wire, in
+    4-bit mode:
+      LiquidCrystal_I2C (ESP32 receiver): each nibble is three one-byte
+        transactions (data, E high, E low) -> 6 transactions, 12 bytes per
+        LCD write, and 51 us of delayMicroseconds per nibble
+      hd44780_I2Cexp (lora/reciever.c): both nibbles with their E pulses in
+        one transaction -> 5 bytes per LCD write
+    clear() is one command plus the panel's 1.52 ms busy time
+  - Sequences are the sketches' real frames: renderLCD/showMessage
+    (ESP32-reciever-display.cpp) and drawTankPage (lora/reciever.c), each
+    against the clear-and-rewrite they replaced. Bus time is at 100 kHz
+    (9 bit times per byte, plus start/stop per transaction)
+      g++ -std=c++14 -O2 -Wall -Wextra tools/lcd_shadow_bench.cpp -o /tmp/lcd_shadow_bench && /tmp/lcd_shadow_bench
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "../common/lcd_shadow.h"
+
+const double I2C_HZ = 100000;
+const double CLEAR_BUSY_US = 1520;
+
+enum Driver { LIQUIDCRYSTAL_I2C, HD44780_I2CEXP };
+
+// an HD44780 behind a PCF8574: keeps what the panel shows, counts the bus
+struct MockLcd {
+  Driver driver;
+  char panel[4][20];
+  int col, row;
+  long writes, bytes, transactions;
+  double busyUs;                 // waits on the panel itself (clear/home)
+
+  explicit MockLcd(Driver d) : driver(d) { reset(); clear(); writes = bytes = transactions = 0; busyUs = 0; }
+  void reset() { writes = bytes = transactions = 0; busyUs = 0; }
+
+  void lcdWrite() {              // one command or data byte to the HD44780
+    writes++;
+    if (driver == LIQUIDCRYSTAL_I2C) { transactions += 6; bytes += 6 * 2; busyUs += 2 * 51; }   // pulseEnable's delays
+    else { transactions += 1; bytes += 1 + 4; }
+  }
+  void clear() {
+    lcdWrite();
+    busyUs += CLEAR_BUSY_US;
+    memset(panel, ' ', sizeof(panel));
+    col = row = 0;
+  }
+  void setCursor(uint8_t c, uint8_t r) { lcdWrite(); col = c; row = r; }
+  size_t write(uint8_t ch) {
+    lcdWrite();
+    if (row < 4 && col < 20) panel[row][col] = ch;
+    col++;
+    return 1;
+  }
+  void print(const char* s) { while (*s) write((uint8_t)*s++); }
+  double busUs() const { return (bytes * 9 + transactions * 2) * 1e6 / I2C_HZ + busyUs; }
+};
+
+/* frames, as the sketches draw them */
+struct Item { const char* label; float percent; char mark; };
+
+template <class Screen>
+void receiverFrame(Screen& screen, const Item* items, int n) {   // renderLCD
+  screen.clear();
+  for (int r = 0; r < 4 && r < n; ++r) {
+    char pct[8];
+    if (items[r].percent < 0) strcpy(pct, "--.-%");
+    else snprintf(pct, sizeof(pct), "%5.1f%%", items[r].percent);
+    char mark[2] = { items[r].mark, 0 };
+    screen.print(0, r, items[r].label);
+    screen.print(20 - strlen(pct) - 1, r, mark);
+    screen.print(20 - strlen(pct), r, pct);
+  }
+}
+
+struct Tank { const char* name; float percent; int rssi; float snr; int loss; int sf; unsigned long ageMs; };
+
+template <class Screen>
+void tankFrame(Screen& screen, const Tank& t) {                  // drawTankPage
+  char line[32], pct[12];   // printLine clips at 20
+  screen.clear();
+  screen.printLine(0, t.name);
+  snprintf(pct, sizeof(pct), "%5.1f", t.percent);
+  snprintf(line, sizeof(line), "Level: %s %%", pct);
+  screen.printLine(1, line);
+  snprintf(line, sizeof(line), "%ddBm %.1fdB L%d%% SF%d", t.rssi, t.snr, t.loss, t.sf);
+  screen.printLine(2, line);
+  if (t.ageMs <= 1000) snprintf(line, sizeof(line), "Updated: <1s ago");
+  else snprintf(line, sizeof(line), "Updated: %lus ago", t.ageMs / 1000);
+  screen.printLine(3, line);
+}
+
+// the old path: lcd.clear(), then every row rewritten from column 0
+struct Repaint {
+  MockLcd& lcd;
+  char rows[4][21];
+  explicit Repaint(MockLcd& l) : lcd(l) {}
+  void clear() { memset(rows, 0, sizeof(rows)); }
+  void print(uint8_t col, uint8_t row, const char* s) {
+    for (uint8_t c = col; c < 20 && *s; ++c) {
+      for (uint8_t k = strlen(rows[row]); k < c; ++k) rows[row][k] = ' ';
+      rows[row][c] = *s++;
+    }
+  }
+  void printLine(uint8_t row, const char* s) { memset(rows[row], 0, 21); print(0, row, s); }
+  void flush() {
+    lcd.clear();
+    for (int r = 0; r < 4; ++r) {
+      lcd.setCursor(0, r);
+      lcd.print(rows[r]);
+      for (int c = strlen(rows[r]); c < 20; ++c) lcd.write(' ');   // safePrintLine padded each row
+    }
+  }
+};
+
+template <class Frame>
+void row(const char* name, Driver d, Frame before, Frame after, int frames) {
+  // before: every frame is a full repaint
+  MockLcd a(d);
+  Repaint old(a);
+  for (int f = 0; f <= frames; ++f) {
+    if (f == 1) a.reset();            // frame 0 puts the starting screen up
+    before(old, f);
+    old.flush();
+  }
+  MockLcd b(d);
+  LcdShadow<MockLcd> screen(b);
+  for (int f = 0; f <= frames; ++f) {
+    if (f == 1) b.reset();
+    after(screen, f);
+    screen.flush();
+  }
+  if (memcmp(a.panel, b.panel, sizeof(a.panel))) printf("MISMATCH %s\n", name);
+  printf("%-34s %-18s %7.1f %7.1f %8.0f %8.0f %8.2f %8.2f\n", name, d == LIQUIDCRYSTAL_I2C ? "LiquidCrystal_I2C" : "hd44780_I2Cexp",
+         (double)a.writes / frames, (double)b.writes / frames, (double)a.bytes / frames, (double)b.bytes / frames,
+         a.busUs() / frames / 1000, b.busUs() / frames / 1000);
+}
+
+int main() {
+  const int FRAMES = 100;
+  Item page1[4] = { { "Roof tank", 62.5f, ' ' }, { "Sump", 100.0f, '+' }, { "Garden", 18.2f, '!' }, { "Kitchen", -1, '?' } };
+  Item page2[4] = { { "North", 44.0f, ' ' }, { "South", 71.3f, '-' }, { "East", 9.9f, '!' }, { "West", 55.5f, ' ' } };
+  Tank tank = { "Tank 2", 47.3f, -97, 6.5f, 2, 9, 0 };
+
+  printf("%-34s %-18s %7s %7s %8s %8s %8s %8s\n", "sequence (per frame)", "driver", "wr_was", "wr_now", "B_was", "B_now", "ms_was",
+         "ms_now");
+  const Driver DRIVERS[] = { LIQUIDCRYSTAL_I2C, HD44780_I2CEXP };
+  for (Driver d : DRIVERS) {
+    // ESP32 receiver: a poll every 3 s, one device's percent moved by 0.1
+    auto poll = [&](auto& s, int f) { Item p[4]; memcpy(p, page1, sizeof(p)); p[f % 3].percent += 0.1f * (f % 2); receiverFrame(s, p, 4); };
+    row("receiver poll, one percent moves", d, poll, poll, FRAMES);
+    // ... the page timer flips between two pages
+    auto flip = [&](auto& s, int f) { receiverFrame(s, f % 2 ? page2 : page1, 4); };
+    row("receiver page flip", d, flip, flip, FRAMES);
+    // ... a poll with nothing new (most polls at steady state)
+    auto same = [&](auto& s, int) { receiverFrame(s, page1, 4); };
+    row("receiver poll, nothing changed", d, same, same, FRAMES);
+    // ... a status message replacing the page and going again
+    auto msg = [&](auto& s, int f) {
+      if (f % 2) { s.clear(); s.printLine(0, "HTTP poll failed"); s.printLine(1, "code: -1"); }
+      else receiverFrame(s, page1, 4);
+    };
+    row("receiver status message / page", d, msg, msg, FRAMES);
+    // LoRa receiver: showTankPage every second, age ticks up
+    auto tick = [&](auto& s, int f) { Tank t = tank; t.ageMs = 1000 + f * 1000UL; tankFrame(s, t); };
+    row("tank page, 1 s age tick", d, tick, tick, FRAMES);
+    // ... a new reading lands: level, link line and age change
+    auto reading = [&](auto& s, int f) { Tank t = tank; t.percent += f * 0.4f; t.rssi -= f % 3; t.snr += (f % 2) * 0.5f; tankFrame(s, t); };
+    row("tank page, new reading", d, reading, reading, FRAMES);
+    // ... paging between two tanks
+    auto tanks = [&](auto& s, int f) { Tank t = tank; if (f % 2) { t.name = "Tank 5"; t.percent = 81.0f; t.rssi = -88; } tankFrame(s, t); };
+    row("tank page flip", d, tanks, tanks, FRAMES);
+  }
+  return 0;
+}
@@ -0,0 +1,121 @@
+/*
+  level_fixed_bench.cpp
+  - Host check of common/level_fixed.h against the float paths it replaced
+    (esp8266.cpp: (us / 2) / 29.1 and compute_percent_from_distance;
+    lora/sender.c: us * 0.0343 / 2 and calcLevelPercent)
+  - Every echo time over each sketch's range: lora/sender.c's six tanks,
+    esp8266.cpp over heights 20..400 cm and sensor-to-max 0..30 cm. Fails
+    (exit 1) if any reading is off by more than 0.1 % of the tank
+  - Then times both paths per reading (CPU cycles via rdtsc on x86, ns
+    elsewhere). This host has an FPU, so the float path is as cheap as it
+    gets here; on the ESP8266 each float divide is a libgcc call. The
+    sensor's bench line reports the kernel's cycles on the device
+    (level_cycles_max)
+      g++ -std=c++11 -O2 -Wall -Wextra tools/level_fixed_bench.cpp -o /tmp/level_fixed_bench && /tmp/level_fixed_bench
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "../common/level_fixed.h"
+
+const float MAX_ERR_PCT = 0.1f;
+
+// ----- the float paths as they were -----
+float espPercent(uint32_t us, float total, float s2m) {
+  if (us == 0) return -1.0f;
+  float measured = (us / 2.0f) / 29.1f;
+  float filled = total - (s2m + measured);
+  if (filled < 0) filled = 0;
+  if (filled > total) filled = total;
+  return (filled / total) * 100.0f;
+}
+
+float loraPercent(uint32_t us, float height, float offsetFull) {
+  if (us == 0) return -1.0f;
+  float dist = (us * 0.0343f) / 2.0f;
+  float water = height - (dist - offsetFull);
+  if (water < 0) water = 0;
+  if (water > height) water = height;
+  return water / height * 100.0f;
+}
+
+float fixedPercent(const LevelScale& s, uint32_t us) {
+  uint16_t p = levelPermille(s, us);
+  return p == LEVEL_NO_ECHO ? -1.0f : p / 10.0f;
+}
+
+float worst = 0;
+long checked = 0;
+
+void check(const char* what, float ref, float got, uint32_t us) {
+  float err = fabsf(ref - got);
+  checked++;
+  if (err > worst) worst = err;
+  if (err > MAX_ERR_PCT) {
+    printf("FAIL %s us=%u float %.3f%% fixed %.3f%%\n", what, us, ref, got);
+    exit(1);
+  }
+}
+
+struct Tank { float height, offsetFull; };
+const Tank loraTanks[] = { {90, 5}, {125, 3}, {110, 2}, {150, 4}, {200, 6}, {175, 2.5f} };   // lora/sender.c tankCfg
+const uint32_t LORA_K = levelUsFactorCmPerUs(0.0343f);
+const uint32_t ESP_K = levelUsFactorUsPerCm(29.1f);
+
+uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+int main() {
+  for (const Tank& t : loraTanks) {
+    LevelScale s = levelScale(LORA_K, t.height, t.height + t.offsetFull);
+    for (uint32_t us = 0; us <= levelUsForCm(400.0f, 0.0343f); us++) check("lora", loraPercent(us, t.height, t.offsetFull), fixedPercent(s, us), us);
+  }
+  float loraWorst = worst;
+  for (float h = 20; h <= 400; h += 5) {
+    for (float s2m = 0; s2m <= 30; s2m += 2.5f) {
+      LevelScale s = levelScale(ESP_K, h, h - s2m);
+      for (uint32_t us = 0; us <= 38000; us++) check("esp8266", espPercent(us, h, s2m), fixedPercent(s, us), us);
+    }
+  }
+  printf("equivalence: %ld readings, max error %.3f%% of the tank (lora tanks %.3f%%), limit %.1f%%\n",
+         checked, worst, loraWorst, MAX_ERR_PCT);
+
+  // timing: same inputs through both paths
+  const int N = 1 << 20;
+  std::vector<uint32_t> us(N);
+  for (int i = 0; i < N; i++) us[i] = 200 + (uint32_t)(i * 2654435761u) % 30000;
+  LevelScale s = levelScale(ESP_K, 120.0f, 118.0f);
+  volatile float sinkF = 0;
+  volatile uint32_t sinkI = 0;
+  for (int round = 0; round < 3; round++) {
+    uint64_t t0 = ticks();
+    float accF = 0;
+    for (int i = 0; i < N; i++) accF += espPercent(us[i], 120.0f, 2.0f);
+    uint64_t t1 = ticks();
+    uint32_t accI = 0;
+    for (int i = 0; i < N; i++) accI += levelPermille(s, us[i]);
+    uint64_t t2 = ticks();
+    sinkF = accF;
+    sinkI = accI;
+#if defined(__x86_64__) || defined(__i386__)
+    const char* unit = "cycles";
+#else
+    const char* unit = "ns";
+#endif
+    if (round == 2) printf("per reading: float %.2f %s, fixed %.2f %s (host)\n", (double)(t1 - t0) / N, unit, (double)(t2 - t1) / N, unit);
+  }
+  (void)sinkF;
+  (void)sinkI;
+  return 0;
+}
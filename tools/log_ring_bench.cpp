@@ -0,0 +1,211 @@
+/*
+  log_ring_bench.cpp
+  - Host cost of a log call through common/log_ring.h against the
+    synchronous Serial.printf it replaced, with the lines the firmwares
+    actually log (sender-server.cpp's per-report line, esp8266.cpp's
+    per-POST line, the LoRa receiver's per-packet line)
+  - Synchronous: a model UART at 115200 baud (10 bits a byte) behind a
+    128-byte TX FIFO, as on the ESP32/ESP8266 with no TX buffer: printf
+    returns once the last byte is in the FIFO, so a line waits for the
+    bytes ahead of it. Its cost is that wait (model time) plus the format
+  - Deferred: LOGI formats into the ring and returns; logDrain() then
+    moves what fits into the same FIFO. Both are timed on this CPU, per
+    call, for bursts of 1, 4 and 8 lines every 100 ms (the UART moves 1152
+    bytes in that time, so none of them outruns it on average; a burst
+    bigger than the FIFO is what blocks printf). A loop() drains once per
+    10 ms. The drop path of a full ring is timed too
+  - LOGD above LOG_LEVEL: checks the arguments are not evaluated
+  - Four producer threads against one consumer: every line drained is
+    whole, and drained + dropped == written. Fails (exit 1) otherwise
+      g++ -std=c++14 -O2 -Wall -Wextra -pthread tools/log_ring_bench.cpp -o /tmp/log_ring_bench && /tmp/log_ring_bench
+*/
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#define LOG_SLOTS 16
+#define LOG_LINE_MAX 160
+#include "../common/log_ring.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double nowNs() {
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 115200 baud, 128-byte FIFO; time is port.h's virtual clock
+struct ModelUart {
+  static const int FIFO = 128;
+  double fifoBytes = 0;          // bytes not yet on the wire
+  uint64_t lastUs = 0;
+  uint64_t waitedUs = 0;         // time a writer spent blocked on the FIFO
+  size_t written = 0;
+
+  void settle() {
+    uint64_t now = port_virtual_us();
+    fifoBytes -= (now - lastUs) * 11520.0 / 1e6;
+    if (fifoBytes < 0) fifoBytes = 0;
+    lastUs = now;
+  }
+  int availableForWrite() {
+    settle();
+    return FIFO - (int)(fifoBytes + 0.999);
+  }
+  // blocking, like HardwareSerial with no TX buffer
+  size_t write(const uint8_t* b, size_t n) {
+    (void)b;   // only how many bytes go out costs time
+    for (size_t k = 0; k < n; k++) {
+      settle();
+      if (fifoBytes + 1 > FIFO) {
+        uint64_t wait = (uint64_t)((fifoBytes + 1 - FIFO) * 1e6 / 11520.0) + 1;
+        port_advance_us(wait);
+        waitedUs += wait;
+        settle();
+      }
+      fifoBytes += 1;
+    }
+    written += n;
+    return n;
+  }
+  void printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    write((const uint8_t*)buf, n);
+  }
+};
+
+// a consumer that never waits (the multi-producer check is about the ring)
+struct StringSink {
+  std::string out;
+  int availableForWrite() { return 4096; }
+  size_t write(const uint8_t* b, size_t n) { out.append((const char*)b, n); return n; }
+};
+
+// the three hot-path lines, with the arguments they are logged with
+struct Line { const char* what; int kind; };
+const Line LINES[] = { { "sender report", 0 }, { "sensor POST", 1 }, { "lora packet", 2 } };
+
+template <class Emit>
+void emit(int kind, int i, Emit e) {
+  switch (kind) {
+    case 0: e("Report: idx=%d name=%s mac=%s pct=%.1f seq=%lu", i & 127, "Tank-12", "5C:CF:7F:12:34:56", 61.3f + (i & 7), (unsigned long)i); break;
+    case 1: e("POST /api/report {\"name\":\"Tank-1\",\"percent\":%.1f,\"seq\":%lu,\"age_ms\":%lu,\"rssi\":%d}", 47.5f, (unsigned long)i, 12ul, -61); break;
+    default: e("Packet node=%u seq=%u rssi=%d snr=%.1f tanks=%d len=%d", 1u, (unsigned)i, -104, 9.0f, 6, 96); break;
+  }
+}
+
+static int sideEffects = 0;
+__attribute__((unused)) static int expensive() { return ++sideEffects; }
+
+int main() {
+  const int LOOPS = 20000;
+  int fails = 0;
+
+  // --- 1. cost per call, synchronous vs deferred ---
+  printf("%-14s %-12s %12s %12s %12s %10s\n", "line", "lines/100ms", "sync us", "LOGI ns", "drain ns", "dropped");
+  for (const Line& l : LINES) {
+    for (int perBurst : { 1, 4, 8 }) {
+      // synchronous: model time blocked in the UART + host time to format
+      ModelUart uart;
+      port_virtual_us() = 0;
+      double t0 = nowNs();
+      for (int i = 0; i < LOOPS; i++) {
+        if (i % 10 == 0)
+          for (int k = 0; k < perBurst; k++) emit(l.kind, i, [&](const char* fmt, auto... a) { uart.printf(fmt, a...); });
+        port_advance_us(10000);
+      }
+      const int calls = LOOPS / 10 * perBurst;
+      double syncFormatNs = (nowNs() - t0) / calls;
+      double syncUs = (double)uart.waitedUs / calls + syncFormatNs / 1000.0;
+
+      // deferred: LOGI per line, one logDrain per loop
+      ModelUart wire;
+      port_virtual_us() = 0;
+      LogRing& r = logRing();
+      uint32_t dropped0 = r.dropped.load();
+      double callNs = 0, drainNs = 0;
+      for (int i = 0; i < LOOPS; i++) {
+        double a = nowNs();
+        if (i % 10 == 0)
+          for (int k = 0; k < perBurst; k++) emit(l.kind, i, [&](const char* fmt, auto... x) { LOGI(fmt, x...); });
+        double b = nowNs();
+        logDrain(wire);
+        double c = nowNs();
+        callNs += b - a;
+        drainNs += c - b;
+        port_advance_us(10000);
+      }
+      unsigned long dropped = r.dropped.load() - dropped0;
+      if (wire.waitedUs) {
+        printf("FAIL %s: logDrain blocked on the UART for %llu us\n", l.what, (unsigned long long)wire.waitedUs);
+        fails++;
+      }
+      printf("%-14s %-12d %12.1f %12.1f %12.1f %10lu\n", l.what, perBurst, syncUs, callNs / calls, drainNs / LOOPS, dropped);
+      logFlush(wire);
+    }
+  }
+
+  // drop path alone: ring full, nobody drains
+  {
+    ModelUart wire;
+    logFlush(wire);
+    for (int i = 0; i < LOG_SLOTS; i++) LOGI("fill %d", i);
+    double t0 = nowNs();
+    for (int i = 0; i < LOOPS; i++) LOGI("Report: idx=%d name=%s pct=%.1f", i, "Tank-12", 61.3f);
+    printf("full ring: %.1f ns per dropped call\n", (nowNs() - t0) / LOOPS);
+    logFlush(wire);
+  }
+
+  // --- 2. LOGD above LOG_LEVEL compiles away, arguments included ---
+  double t0 = nowNs();
+  for (int i = 0; i < LOOPS; i++) LOGD("never %d", expensive());
+  double offNs = (nowNs() - t0) / LOOPS;
+  printf("LOGD with LOG_LEVEL_INFO: %.2f ns per call, arguments evaluated %d times\n", offNs, sideEffects);
+  if (sideEffects != 0) { printf("FAIL disabled level evaluated its arguments\n"); fails++; }
+
+  // --- 3. four producers, one consumer ---
+  {
+    ModelUart flushed;
+    logFlush(flushed);
+    StringSink wire;
+    uint32_t dropped0 = logRing().dropped.load();
+    const int PER = 20000;
+    std::atomic<int> running(4);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; p++)
+      producers.emplace_back([p, &running] {
+        for (int i = 0; i < PER; i++) {
+          LOGI("p%d n=%06d %s", p, i, "xxxxxxxxxxxxxxxxxxxxxxxx");
+          if (i % 4 == 3) std::this_thread::sleep_for(std::chrono::microseconds(20));   // bursts, not a flood
+        }
+        running--;
+      });
+    while (running.load() > 0 || logRing().tail.load() != logRing().head.load()) logDrain(wire);
+    for (auto& t : producers) t.join();
+    int whole = 0, broken = 0;
+    size_t at = 0;
+    while (at < wire.out.size()) {
+      size_t e = wire.out.find('\n', at);
+      if (e == std::string::npos) { broken++; break; }
+      std::string line = wire.out.substr(at, e - at);
+      int p, n;
+      char tail[64];
+      if (line.compare(0, 2, "W ") == 0 && line.find("[log]") != std::string::npos) { at = e + 1; continue; }
+      if (sscanf(line.c_str(), "I p%d n=%d %63s", &p, &n, tail) == 3 && strcmp(tail, "xxxxxxxxxxxxxxxxxxxxxxxx") == 0) whole++;
+      else broken++;
+      at = e + 1;
+    }
+    unsigned long dropped = logRing().dropped.load() - dropped0;
+    printf("4 producers x %d: %d drained whole, %lu dropped, %d broken\n", PER, whole, dropped, broken);
+    if (broken || whole + dropped != 4ul * PER) { printf("FAIL multi-producer accounting\n"); fails++; }
+  }
+
+  printf("%s\n", fails ? "FAILED" : "ok");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,281 @@
+/*
+  mqtt_egress_bench.cpp
+  - Host run of common/mqtt_egress.h as sender-server's mqttTick() drives it
+    (10 ms loop, flush every MQTT_INTERVAL_MS, MQTT_PUBLISH_PER_LOOP per
+    loop, QoS 1 in flight capped), at 500 devices, into an in-process
+    stand-in broker: PUBLISH packets in MQTT 3.1.1 wire format go through a
+    client send buffer and a link of fixed bytes/s; the broker keeps
+    retained payloads per topic and sends PUBACKs one round trip later.
+    A full send buffer fails the publish (esp-mqtt would block loop() on it)
+  - Phases: steady (reports every 2.5 s), burst (every 250 ms, e.g. backlogs
+    draining), broker down, back (reconnect republishes every device),
+    flapping (the connection drops every 3 s: reconnects within
+    MQTT_RESYNC_MIN_MS do not start the republish over, the pending one
+    runs once the interval is up), quiet
+  - Prints per phase: reports/s in, messages/s at the broker, queue depth
+    p50/max, drops, publishes refused, change -> broker latency p50/p99,
+    full republishes; at the end whether every
+    retained level/alarm topic holds the device's latest value
+      g++ -std=c++11 -O2 -Wall -Wextra tools/mqtt_egress_bench.cpp -o /tmp/mqtt_egress_bench && /tmp/mqtt_egress_bench
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "../common/mqtt_egress.h"
+
+const int DEVICES = 500;
+const int QUEUE = 256;                      // sender-server's MQTT_QUEUE is 128 for 128 devices
+const unsigned long TICK_MS = 10;           // loop() period
+const unsigned long INTERVAL_MS = 1000;     // MQTT_INTERVAL_MS
+const int PUBLISH_PER_LOOP = 16;            // MQTT_PUBLISH_PER_LOOP
+const int INFLIGHT_MAX = 8;                 // MQTT_INFLIGHT_MAX
+const unsigned long RESYNC_MIN_MS = 60000;  // MQTT_RESYNC_MIN_MS
+const int SNDBUF = 5744;                    // lwIP TCP_SND_BUF on the ESP32
+const unsigned long RTT_MS = 20;
+const int SEQ_RING = 256;                   // report times kept per device, for latency
+
+struct Phase { const char* name; unsigned long endMs, reportMs; bool brokerUp; unsigned long flapMs; };
+const Phase PHASES[] = {
+  { "steady", 30000, 2500, true, 0 },
+  { "burst", 45000, 250, true, 0 },
+  { "broker down", 65000, 2500, false, 0 },
+  { "back", 90000, 2500, true, 0 },
+  { "flapping", 110000, 2500, true, 3000 },
+  { "quiet", 150000, 0, true, 0 },
+};
+
+struct Device {
+  char name[16];
+  uint8_t mac[6];
+  float percent;
+  uint32_t seq;
+  unsigned long nextReportMs;
+  uint8_t alarm;
+  unsigned long alarmSinceMs;
+  unsigned long reportedAt[SEQ_RING];
+};
+Device dev[DEVICES];
+MqttEgress<DEVICES, QUEUE> egress;
+unsigned long now = 0;
+
+/* stand-in broker and the link to it */
+struct Broker {
+  bool up;
+  std::vector<uint8_t> sndbuf;        // client side, not yet on the wire
+  std::vector<uint8_t> rx;            // broker side, not yet parsed
+  std::deque<std::pair<unsigned long, uint16_t>> pubacks;   // due time, packet id
+  std::map<std::string, std::string> retained;
+  long messages, bytes;
+  std::vector<double> latency;        // change -> broker, ms
+  int linkBytesPerTick;
+};
+Broker broker;
+int inflight = 0;
+uint16_t nextPacketId = 1;
+bool resync = false;
+long lastResync = -1;
+int resyncs = 0;
+
+void put16(std::vector<uint8_t>& b, uint16_t v) { b.push_back(v >> 8); b.push_back(v & 255); }
+
+// esp_mqtt_client_publish: the packet into the send buffer, -1 if it does not fit
+int publish(const char* topic, const char* payload, int len, int qos, int retain) {
+  if (!broker.up) return -1;
+  std::vector<uint8_t> p;
+  int tlen = strlen(topic);
+  int remaining = 2 + tlen + (qos ? 2 : 0) + len;
+  p.push_back(0x30 | qos << 1 | retain);
+  do { uint8_t b = remaining & 127; remaining >>= 7; p.push_back(b | (remaining ? 128 : 0)); } while (remaining);
+  put16(p, tlen);
+  p.insert(p.end(), topic, topic + tlen);
+  uint16_t id = 0;
+  if (qos) { if (!nextPacketId) nextPacketId = 1; id = nextPacketId++; put16(p, id); }
+  p.insert(p.end(), payload, payload + len);
+  if (broker.sndbuf.size() + p.size() > (size_t)SNDBUF) return -1;
+  broker.sndbuf.insert(broker.sndbuf.end(), p.begin(), p.end());
+  return id;
+}
+
+// the broker reads what arrived: PUBLISH -> retained + PUBACK later
+void brokerParse() {
+  size_t off = 0;
+  std::vector<uint8_t>& b = broker.rx;
+  while (off + 2 <= b.size()) {
+    size_t i = off + 1;
+    uint32_t remaining = 0, shift = 0;
+    while (i < b.size() && (b[i] & 128)) { remaining |= (b[i] & 127) << shift; shift += 7; i++; }
+    if (i >= b.size()) break;
+    remaining |= b[i++] << shift;
+    if (i + remaining > b.size()) break;
+    int qos = (b[off] >> 1) & 3;
+    uint16_t tlen = b[i] << 8 | b[i + 1];
+    std::string topic((const char*)&b[i + 2], tlen);
+    size_t pl = i + 2 + tlen;
+    if (qos) { broker.pubacks.push_back({ now + RTT_MS, (uint16_t)(b[pl] << 8 | b[pl + 1]) }); pl += 2; }
+    std::string payload((const char*)&b[pl], i + remaining - pl);
+    if (b[off] & 1) broker.retained[topic] = payload;
+    broker.messages++;
+    // latency: the level message carries the seq of the reading it shows
+    unsigned d, s;
+    if (sscanf(topic.c_str(), "tanks/Tank-%u/level", &d) == 1 && sscanf(payload.c_str(), "{\"percent\":%*[^,],\"seq\":%u", &s) == 1 && d < DEVICES)
+      broker.latency.push_back((double)(now - dev[d].reportedAt[s % SEQ_RING]));
+    off = i + remaining;
+  }
+  b.erase(b.begin(), b.begin() + off);
+}
+
+void linkTick() {
+  if (!broker.up) return;
+  int n = std::min((int)broker.sndbuf.size(), broker.linkBytesPerTick);
+  broker.rx.insert(broker.rx.end(), broker.sndbuf.begin(), broker.sndbuf.begin() + n);
+  broker.sndbuf.erase(broker.sndbuf.begin(), broker.sndbuf.begin() + n);
+  broker.bytes += n;
+  brokerParse();
+  while (!broker.pubacks.empty() && broker.pubacks.front().first <= now) {   // MQTT_EVENT_PUBLISHED
+    broker.pubacks.pop_front();
+    if (inflight > 0) inflight--;
+  }
+}
+
+void setBroker(bool up) {
+  if (up == broker.up) return;
+  broker.up = up;
+  broker.sndbuf.clear();
+  broker.rx.clear();
+  broker.pubacks.clear();
+  inflight = 0;
+  if (up) resync = true;   // MQTT_EVENT_CONNECTED
+}
+
+/* sender side, as in sender-server.cpp */
+const char* alarmState(uint8_t a) { return a == 0 ? "ok" : a == 1 ? "low " : "high "; }
+
+bool build(int i, MqttKind kind, MqttMsg& m, int levelQos) {
+  if (kind == MQTT_LEVEL) {
+    mqttLevelPayload(m, dev[i].percent, dev[i].seq, 300L, true, -1.5f);
+    m.qos = levelQos;
+  } else {
+    mqttAlarmPayload(m, dev[i].alarm, alarmState(dev[i].alarm), (now - dev[i].alarmSinceMs) / 1000UL);
+    m.qos = 1;
+  }
+  return true;
+}
+
+unsigned long lastFlush = 0;
+
+void mqttTick(int levelQos) {
+  if (!broker.up) return;
+  if (resync && (lastResync < 0 || now - lastResync >= RESYNC_MIN_MS)) {
+    resync = false;
+    lastResync = now;
+    resyncs++;
+    for (int i = 0; i < DEVICES; i++) egressMark(egress, i, (MqttKind)(MQTT_LEVEL | MQTT_ALARM));
+  }
+  if (now - lastFlush >= INTERVAL_MS) {
+    lastFlush = now;
+    egressFlush(egress, [levelQos](int i, MqttKind k, MqttMsg& m) { return build(i, k, m, levelQos); });
+  }
+  char topic[MQTT_TOPIC_MAX];
+  for (int k = 0; k < PUBLISH_PER_LOOP; k++) {
+    MqttMsg* m = egressFront(egress);
+    if (!m) break;
+    if (m->qos && inflight >= INFLIGHT_MAX) break;
+    if (mqttTopic(topic, sizeof(topic), "tanks", dev[m->dev].name, dev[m->dev].mac, m->kind) < 0) { egressSkip(egress); continue; }
+    if (publish(topic, m->payload, m->len, m->qos, 1) < 0) { egress.failed++; break; }
+    if (m->qos) inflight++;
+    egressPop(egress);
+  }
+}
+
+double pct(std::vector<double> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+void run(const char* what, int levelQos, int linkBytesPerSec) {
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> step(-1.5f, 1.0f);
+  for (int i = 0; i < DEVICES; i++) {
+    snprintf(dev[i].name, sizeof(dev[i].name), "Tank-%d", i);
+    const uint8_t mac[6] = { 0x24, 0x6F, 0x28, 0x10, (uint8_t)(i >> 8), (uint8_t)i };
+    memcpy(dev[i].mac, mac, 6);
+    dev[i].percent = 10 + (i * 37) % 85;
+    dev[i].seq = 0;
+    dev[i].nextReportMs = i * 2500 / DEVICES;
+    dev[i].alarm = 0;
+    dev[i].alarmSinceMs = 0;
+  }
+  egressInit(egress);
+  broker = Broker();
+  broker.linkBytesPerTick = linkBytesPerSec * TICK_MS / 1000;
+  broker.up = false;
+  setBroker(true);
+  lastFlush = 0;
+  lastResync = -1;
+  resyncs = 0;
+  now = 0;
+  double cpuUs = 0;
+
+  printf("%s, link %d KB/s, queue %d\n", what, linkBytesPerSec / 1000, QUEUE);
+  for (const Phase& ph : PHASES) {
+    setBroker(ph.brokerUp);
+    unsigned long start = now;
+    long reports = 0, msgs0 = broker.messages;
+    uint32_t drop0 = egress.dropped, fail0 = egress.failed;
+    int resync0 = resyncs;
+    broker.latency.clear();
+    std::vector<double> depth;
+    for (; now < ph.endMs; now += TICK_MS) {
+      if (ph.flapMs) setBroker((now - start) / ph.flapMs % 2 == 1);
+      for (int i = 0; ph.reportMs && i < DEVICES; i++) {
+        Device& d = dev[i];
+        if (now < d.nextReportMs) continue;
+        d.nextReportMs = now + ph.reportMs;
+        d.percent = std::min(100.0f, std::max(0.0f, d.percent + step(rng) * ph.reportMs / 2500.0f));
+        d.seq++;
+        d.reportedAt[d.seq % SEQ_RING] = now;
+        reports++;
+        egressMark(egress, i, MQTT_LEVEL);
+        uint8_t a = d.percent < 15 ? 1 : d.percent > 95 ? 2 : (d.alarm == 1 && d.percent < 17) ? 1 : (d.alarm == 2 && d.percent > 93) ? 2 : 0;
+        if (a != d.alarm) { d.alarm = a; d.alarmSinceMs = now; egressMark(egress, i, MQTT_ALARM); }
+      }
+      auto t0 = std::chrono::steady_clock::now();
+      mqttTick(levelQos);
+      cpuUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+      linkTick();
+      depth.push_back(egressDepth(egress));
+    }
+    double secs = (now - start) / 1000.0;
+    printf("  %-11s  in %6.0f reports/s  out %5.0f msg/s  queue p50 %3.0f max %3.0f  dropped %5u  refused %5u  latency p50 %5.0f ms p99 %5.0f ms  republishes %d\n",
+           ph.name, reports / secs, (broker.messages - msgs0) / secs, pct(depth, 0.5), pct(depth, 1.0),
+           egress.dropped - drop0, egress.failed - fail0, pct(broker.latency, 0.5), pct(broker.latency, 0.99), resyncs - resync0);
+  }
+  int stale = 0;
+  for (int i = 0; i < DEVICES; i++) {
+    char topic[MQTT_TOPIC_MAX];
+    unsigned s = 0, a = 99;
+    mqttTopic(topic, sizeof(topic), "tanks", dev[i].name, dev[i].mac, MQTT_LEVEL);
+    sscanf(broker.retained[topic].c_str(), "{\"percent\":%*[^,],\"seq\":%u", &s);
+    mqttTopic(topic, sizeof(topic), "tanks", dev[i].name, dev[i].mac, MQTT_ALARM);
+    sscanf(broker.retained[topic].c_str(), "{\"alarm\":%u", &a);
+    if (s != dev[i].seq || a != dev[i].alarm) stale++;
+  }
+  printf("  changes %u, published %u (%.1f changes per message), egress CPU %.2f us per message; retained topics behind the device: %d of %d\n",
+         egress.marked, egress.published, (double)egress.marked / egress.published, cpuUs / egress.published, stale, DEVICES);
+}
+
+int main() {
+  run("levels QoS 0, alarms QoS 1", 0, 1000000);
+  run("levels QoS 1, alarms QoS 1", 1, 1000000);
+  run("levels QoS 1, alarms QoS 1, slow link", 1, 16000);
+  return 0;
+}
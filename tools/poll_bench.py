@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+poll_bench.py
+  - hammer the sender's read endpoints with N concurrent pollers (UI tabs,
+    LCD receivers) and report client-side latency percentiles
+  - each poller loops GET <path> with its own keep-alive connection, like
+    the receiver does; the sender's own view is on /api/metrics
+      python3 tools/poll_bench.py 192.168.4.1 --pollers 3 --seconds 30
+      python3 tools/poll_bench.py sender.local --path "/api/devices?active=1&limit=32"
+"""
+
+import argparse
+import http.client
+import threading
+import time
+
+
+def poller(host, port, path, interval, deadline, out, errors):
+    conn = None
+    while time.monotonic() < deadline:
+        t0 = time.monotonic()
+        try:
+            if conn is None:
+                conn = http.client.HTTPConnection(host, port, timeout=5)
+            conn.request("GET", path)
+            resp = conn.getresponse()
+            resp.read()
+            if resp.status != 200:
+                errors.append(resp.status)
+            else:
+                out.append((time.monotonic() - t0) * 1000.0)
+        except (OSError, http.client.HTTPException) as e:
+            errors.append(type(e).__name__)
+            if conn is not None:
+                conn.close()
+            conn = None
+        left = interval - (time.monotonic() - t0)
+        if left > 0:
+            time.sleep(left)
+    if conn is not None:
+        conn.close()
+
+
+def pct(sorted_ms, q):
+    if not sorted_ms:
+        return 0.0
+    return sorted_ms[min(len(sorted_ms) - 1, int(q * (len(sorted_ms) - 1) + 0.5))]
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=80)
+    ap.add_argument("--path", default="/api/devices")
+    ap.add_argument("--pollers", type=int, default=3)
+    ap.add_argument("--interval", type=float, default=0.0, help="seconds between polls per poller (0 = back to back)")
+    ap.add_argument("--seconds", type=float, default=20.0)
+    args = ap.parse_args()
+
+    deadline = time.monotonic() + args.seconds
+    lat, errors = [], []
+    threads = [threading.Thread(target=poller, args=(args.host, args.port, args.path, args.interval, deadline, lat, errors))
+               for _ in range(args.pollers)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    lat.sort()
+    print('{"pollers":%d,"path":"%s","req_s":%.1f,"errors":%d,"p50_ms":%.1f,"p90_ms":%.1f,"p99_ms":%.1f,"max_ms":%.1f}'
+          % (args.pollers, args.path, len(lat) / args.seconds, len(errors),
+             pct(lat, 0.5), pct(lat, 0.9), pct(lat, 0.99), lat[-1] if lat else 0.0))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,334 @@
+/*
+  relay_sim.cpp
+  - Host network simulation of lora/relay.c: 20 sensors and 3 relays, up to
+    3 radio hops to the receiver (sensor -> C -> A -> receiver), 1 ms steps
+      receiver <- sensors 1-6, relay A, relay B
+      relay A  <- sensors 7-11, relay C
+      relay B  <- sensors 12-15
+      relay C  <- sensors 16-20
+  - Radio model: one channel, a node hears its parent, its children and its
+    siblings; any overlap of two frames audible at a listener loses both
+    (no capture), a node cannot receive while it transmits (hidden
+    terminals between cells are what the relays' backoff has to cope with)
+  - Same rules as the sketches: sensors send every 4.4 s (lora/sender.c
+    today), 30 s or 60 s, in ACK mode with lora_arq.h retries, every hop ACKs 20 ms after the uplink, relays are
+    deaf while sending; the relay's dedup, aggregate and backoff are
+    lora_relay.h itself. Carrier sense is ideal here (the SX127x RSSI check
+    in relay.c misses frames below the noise floor)
+  - Three forwarding modes: every reading as its own full frame, compact
+    entries sent as soon as the backoff ends, and one aggregate per
+    RELAY_CYCLE_MS. Reports delivery and end-to-end latency per hop count
+    and the channel busy share around the receiver and each relay
+      g++ -std=c++11 -O2 -Wall -Wextra tools/relay_sim.cpp -o /tmp/relay_sim && /tmp/relay_sim
+*/
+
+#include <stdio.h>
+#include <deque>
+#include <random>
+#include <vector>
+#include "../common/latency_hist.h"
+#include "../lora/lora_adr.h"
+#include "../lora/lora_arq.h"
+#include "../lora/lora_proto.h"
+#include "../lora/lora_relay.h"
+
+const unsigned long SIM_MS = 6 * 3600 * 1000ul;
+const unsigned long REPLY_DELAY_MS = 20;      // ADR_REPLY_DELAY_MS
+const unsigned long RX_WINDOW_SLACK_MS = 100;
+const unsigned long SETTLE_MS = 30000;        // readings younger than this at the end are not counted
+
+enum Role { RECEIVER, RELAY, SENSOR };
+enum Mode { PER_FRAME, COMPACT, AGGREGATE };
+const char* MODE_NAMES[] = { "per-frame", "compact", "aggregate" };
+
+struct Air {
+  int src, dst;
+  unsigned long start, end;
+  bool down;
+  uint16_t seq;
+  std::vector<uint8_t> bytes;
+};
+
+struct Ack { unsigned long at; int dst; uint16_t seq; };
+
+struct SimNode {
+  Role role;
+  uint8_t id;
+  int parent;
+  int hops;                  // radio hops to the receiver (sensors)
+  unsigned long txEnd;
+  // sending side (lora_tx.h)
+  bool sending, waiting, acked;
+  std::vector<uint8_t> frame;
+  int airLen;
+  uint16_t seq;
+  uint8_t attempt;
+  unsigned long windowEnd, retryAt, nextDueMs;
+  // sensor
+  unsigned long nextReadingMs;
+  // relay
+  RelayAgg agg;
+  RelayDedup dedup;
+  std::deque<LoraAggEntry> queue;
+  unsigned long sendAt;
+  unsigned long namesSentMs[256];
+  // downlinks to send (ACKs)
+  std::vector<Ack> acks;
+};
+
+struct Sim {
+  Mode mode;
+  uint8_t sf;
+  unsigned long intervalMs;   // sensor reading to reading
+  std::mt19937 rng;
+  std::vector<SimNode> n;
+  std::vector<Air> air;
+  std::vector<std::vector<unsigned long> > born;   // [origin][seq] = reading time
+  std::vector<std::vector<bool> > got;
+  LatencyHist latency[4];
+  long generated[4], delivered[4];
+  unsigned long busyMs[4];
+  double airMsTotal;
+  unsigned long tNow;
+
+  bool hears(int a, int b) const {
+    if (a == b) return true;
+    return n[a].parent == b || n[b].parent == a || (n[a].parent == n[b].parent && n[a].parent >= 0);
+  }
+
+  unsigned long airMs(int len) const { return loraAirtimeUs(sf, LORA_BW_HZ, LORA_CR, len) / 1000 + 1; }
+  unsigned long windowMs() const { return RX_WINDOW_SLACK_MS + airMs(sizeof(LoraHeader)); }
+
+  bool channelBusy(int l) const {
+    for (const Air& a : air) if (a.src != l && a.start <= tNow && tNow < a.end && hears(a.src, l)) return true;
+    return false;
+  }
+
+  void transmit(int src, int dst, const uint8_t* bytes, int len, int airLen, bool down, uint16_t seq) {
+    Air a;
+    a.src = src; a.dst = dst; a.start = tNow; a.end = tNow + airMs(airLen); a.down = down; a.seq = seq;
+    a.bytes.assign(bytes, bytes + len);
+    n[src].txEnd = a.end;
+    airMsTotal += a.end - a.start;
+    air.push_back(a);
+  }
+
+  void sendFrame(int i) {
+    SimNode& s = n[i];
+    LoraHeader* h = (LoraHeader*)s.frame.data();
+    h->flags |= LORA_FLAG_ACK_REQ;
+    transmit(i, s.parent, s.frame.data(), s.frame.size(), s.airLen, false, h->seq);
+    s.waiting = true;
+    s.acked = false;
+    s.retryAt = 0;
+    s.windowEnd = s.txEnd + windowMs();
+  }
+
+  void startSend(int i, unsigned long nextDueMs) {
+    n[i].sending = true;
+    n[i].attempt = 0;
+    n[i].nextDueMs = nextDueMs;
+    sendFrame(i);
+  }
+
+  void finishSend(int i) {
+    SimNode& s = n[i];
+    s.sending = false;
+    if (s.role == RELAY) aggReset(s.agg, s.id);
+  }
+
+  void onWindowEnd(int i) {
+    SimNode& s = n[i];
+    s.waiting = false;
+    if (s.acked || s.attempt >= ARQ_MAX_RETRIES) { finishSend(i); return; }
+    unsigned long backoff = arqBackoffMs(s.attempt, rng());
+    if (!arqRetryFits(tNow, s.nextDueMs, backoff, airMs(s.airLen) + windowMs())) { finishSend(i); return; }
+    s.attempt++;
+    s.retryAt = tNow + backoff;
+  }
+
+  void recordDelivery(uint8_t origin, uint16_t seq) {
+    if (seq >= got[origin].size() || got[origin][seq]) return;
+    got[origin][seq] = true;
+    unsigned long b = born[origin][seq];
+    if (b + SETTLE_MS > SIM_MS) return;
+    int hops = n[origin + 3].hops;
+    delivered[hops]++;
+    latency[hops].record(tNow - b);
+  }
+
+  void relayQueue(int i, LoraAggEntry e, const char* names) {
+    SimNode& r = n[i];
+    if (relaySeen(r.dedup, e.origin, e.seq)) return;
+    if (mode == PER_FRAME) {
+      if (r.queue.empty()) r.sendAt = tNow + relayBackoffMs(rng());
+      r.queue.push_back(e);
+      return;
+    }
+    if (names && r.namesSentMs[e.origin] && tNow - r.namesSentMs[e.origin] < RELAY_NAMES_MS) names = nullptr;
+    bool namesIn = false;
+    if (!aggCount(r.agg)) r.sendAt = tNow + (mode == AGGREGATE ? RELAY_CYCLE_MS : 0) + relayBackoffMs(rng());
+    if (!aggAdd(r.agg, e, names, &namesIn)) return;   // full: lost here, the sim never fills a frame
+    if (namesIn) r.namesSentMs[e.origin] = tNow | 1;
+  }
+
+  void onUplink(const Air& a) {
+    SimNode& l = n[a.dst];
+    if (l.role == RELAY && l.sending) return;   // busy with its own uplink
+    l.acks.push_back({ a.end + REPLY_DELAY_MS, a.src, a.seq });
+    LoraHeader h;
+    memcpy(&h, a.bytes.data(), sizeof(h));
+    static const char names[AGG_NAMES_LEN] = "Tank";
+    if (!(h.flags & LORA_FLAG_AGGREGATE)) {
+      if (l.role == RECEIVER) { recordDelivery(h.nodeId, h.seq); return; }
+      LoraAggEntry e;
+      e.origin = h.nodeId; e.hops = 1; e.seq = h.seq;
+      relayQueue(a.dst, e, names);
+      return;
+    }
+    LoraAggEntry e;
+    const char* entryNames;
+    for (int off = AGG_FIRST; (off = aggNext(a.bytes.data(), a.bytes.size(), off, e, entryNames)) > 0; ) {
+      if (l.role == RECEIVER) { recordDelivery(e.origin, e.seq); continue; }
+      uint8_t hops = e.hops & LORA_AGG_HOPS;
+      if (hops >= RELAY_MAX_HOPS) continue;
+      e.hops = hops + 1;
+      relayQueue(a.dst, e, entryNames);
+    }
+  }
+
+  void deliver(const Air& a) {
+    int l = a.dst;
+    for (const Air& b : air) {
+      if (&b == &a || b.end <= a.start || b.start >= a.end) continue;
+      if (b.src == l || hears(b.src, l)) return;   // collision, or the listener was transmitting
+    }
+    if (a.down) {
+      SimNode& s = n[l];
+      if (s.waiting && s.frame.size() && ((LoraHeader*)s.frame.data())->seq == a.seq) s.acked = true;
+      return;
+    }
+    onUplink(a);
+  }
+
+  void relayTick(int i) {
+    SimNode& r = n[i];
+    bool pending = mode == PER_FRAME ? !r.queue.empty() : aggCount(r.agg) > 0;
+    if (!pending || r.sending || !r.acks.empty() || tNow < r.sendAt || r.txEnd > tNow) return;
+    if (channelBusy(i)) { r.sendAt = tNow + 1 + relayBackoffMs(rng()); return; }
+    if (mode == PER_FRAME) {
+      aggReset(r.agg, r.id);
+      aggAdd(r.agg, r.queue.front(), nullptr);
+      r.queue.pop_front();
+      r.airLen = sizeof(StructMessage);   // forwarded as received: full frame with names
+    } else {
+      r.airLen = r.agg.len;
+    }
+    aggHeader(r.agg).seq = r.seq++;
+    r.frame.assign(r.agg.buf, r.agg.buf + r.agg.len);
+    startSend(i, tNow + RELAY_CYCLE_MS);
+    if (mode == PER_FRAME && !r.queue.empty()) r.sendAt = tNow + relayBackoffMs(rng());
+  }
+
+  void sensorTick(int i) {
+    SimNode& s = n[i];
+    if (s.sending || tNow < s.nextReadingMs) return;
+    StructMessage msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.hdr.magic = LORA_MAGIC;
+    msg.hdr.version = LORA_VERSION;
+    msg.hdr.nodeId = s.id;
+    msg.hdr.seq = s.seq++;
+    msg.hdr.sf = sf;
+    born[s.id].push_back(tNow);
+    got[s.id].push_back(false);
+    if (tNow + SETTLE_MS <= SIM_MS) generated[s.hops]++;
+    s.frame.assign((uint8_t*)&msg, (uint8_t*)&msg + sizeof(msg));
+    s.airLen = sizeof(msg);
+    startSend(i, tNow + intervalMs);
+    s.nextReadingMs = tNow + intervalMs;
+  }
+
+  void run() {
+    for (tNow = 0; tNow < SIM_MS; tNow++) {
+      for (size_t k = 0; k < air.size(); k++) if (air[k].end == tNow) deliver(air[k]);
+      for (size_t k = 0; k < air.size(); ) {
+        if (air[k].end + 3000 < tNow) { air[k] = air.back(); air.pop_back(); } else k++;
+      }
+      for (int l = 0; l < 4; l++) {
+        for (const Air& a : air) if (a.start <= tNow && tNow < a.end && hears(a.src, l)) { busyMs[l]++; break; }
+      }
+      for (int i = 0; i < (int)n.size(); i++) {
+        SimNode& s = n[i];
+        for (size_t k = 0; k < s.acks.size(); ) {
+          if (s.acks[k].at <= tNow && s.txEnd <= tNow) {
+            LoraHeader d;
+            memset(&d, 0, sizeof(d));
+            d.flags = LORA_FLAG_DOWNLINK;
+            d.seq = s.acks[k].seq;
+            transmit(i, s.acks[k].dst, (uint8_t*)&d, sizeof(d), sizeof(d), true, d.seq);
+            s.acks.erase(s.acks.begin() + k);
+          } else k++;
+        }
+        if (s.waiting && tNow >= s.windowEnd) onWindowEnd(i);
+        if (s.sending && !s.waiting && s.retryAt && tNow >= s.retryAt && s.txEnd <= tNow) sendFrame(i);
+        if (s.role == SENSOR) sensorTick(i);
+        else if (s.role == RELAY) relayTick(i);
+      }
+    }
+  }
+
+  Sim(Mode m, uint8_t sf_, unsigned long interval) : mode(m), sf(sf_), intervalMs(interval), rng(11), airMsTotal(0), tNow(0) {
+    for (int h = 0; h < 4; h++) { generated[h] = 0; delivered[h] = 0; busyMs[h] = 0; }
+    // 0 receiver, 1-3 relays A B C (ids 100..102), 4-23 sensors 1..20
+    const int parents[] = { -1, 0, 0, 1 };
+    for (int i = 0; i < 24; i++) {
+      SimNode s;
+      memset(s.namesSentMs, 0, sizeof(s.namesSentMs));
+      s.role = i == 0 ? RECEIVER : i < 4 ? RELAY : SENSOR;
+      s.id = i < 4 ? (i ? 99 + i : 0) : i - 3;
+      s.parent = i < 4 ? parents[i] : s.id <= 6 ? 0 : s.id <= 11 ? 1 : s.id <= 15 ? 2 : 3;
+      s.hops = s.parent == 0 ? 1 : s.parent == 3 ? 3 : 2;
+      s.txEnd = 0;
+      s.sending = s.waiting = s.acked = false;
+      s.airLen = 0;
+      s.seq = 0;
+      s.attempt = 0;
+      s.windowEnd = s.retryAt = s.nextDueMs = 0;
+      s.nextReadingMs = rng() % intervalMs;
+      aggReset(s.agg, s.id);
+      relayDedupReset(s.dedup);
+      s.sendAt = 0;
+      n.push_back(s);
+    }
+    born.resize(21);
+    got.resize(21);
+  }
+
+  void report() {
+    printf("%3lus %-9s SF%-2u", intervalMs / 1000, MODE_NAMES[mode], sf);
+    for (int h = 1; h <= 3; h++) {
+      printf("  %d-hop %5.1f%% p50 %5lu p99 %5lu", h, 100.0 * delivered[h] / generated[h],
+             (unsigned long)latency[h].percentile(0.5f), (unsigned long)latency[h].percentile(0.99f));
+    }
+    printf("  busy R %4.1f%% A %4.1f%% B %4.1f%% C %4.1f%%  air/reading %4.0f ms\n",
+           100.0 * busyMs[0] / SIM_MS, 100.0 * busyMs[1] / SIM_MS, 100.0 * busyMs[2] / SIM_MS, 100.0 * busyMs[3] / SIM_MS,
+           airMsTotal / (generated[1] + generated[2] + generated[3]));
+  }
+};
+
+int main() {
+  printf("20 sensors, latency in ms from reading to receiver, busy = channel audible there\n");
+  const unsigned long intervals[] = { 4400, 30000, 60000 };   // lora/sender.c today: 2.4 s sweep + 2 s idle
+  const uint8_t sfs[] = { 7, 9 };
+  for (unsigned long interval : intervals) {
+    for (uint8_t sf : sfs) {
+      for (int m = PER_FRAME; m <= AGGREGATE; m++) {
+        Sim sim((Mode)m, sf, interval);
+        sim.run();
+        sim.report();
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,447 @@
+/*
+  repl_sim.cpp
+  - Host test of common/repl_log.h: two sender instances, A and B, each a
+    thread with its own device table, change log and listener on 127.0.0.1,
+    pulling the other with sender-server's constants (REPL_PULL_MS,
+    REPL_RETRY_MS, REPL_TIMEOUT_MS). Their clocks are offset, so only
+    ages cross the wire. Reports are a form body, not the firmware's JSON
+  - 32 sensors, 24 reporting to A and 8 to B, every 2.5 s; a reading queues
+    until it is answered, and after SENDER_FAILOVER_FAILS requests that get no
+    answer within SENDER_TIMEOUT_MS a sensor switches senders (esp8266.cpp)
+  - Timeline: both up for 10 s; A hangs for 15 s (listener open, nothing
+    answered, like a wedged board); A comes back empty with a new epoch and
+    catches up from B by snapshot; 10 s more
+  - Prints replication lag (reading applied at one instance -> at the other),
+    failover time of A's sensors (A hangs -> first reading B accepts from
+    them), readings A answered but never passed on, A's catch-up time, and
+    whether both tables agree at the end
+      g++ -std=c++11 -O2 -Wall -Wextra -pthread tools/repl_sim.cpp -o /tmp/repl_sim && /tmp/repl_sim
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common/repl_log.h"
+
+const int MAX_DEVICES = 128;
+const int SENSORS = 32, ON_A = 24;
+const unsigned long REPORT_MS = 2500;
+const int LOG_ENTRIES = 256;                                  // sender-server REPL_LOG_ENTRIES
+const unsigned long PULL_MS = 500, RETRY_MS = 2000, PEER_TIMEOUT_MS = 300;   // a whole pull: 3 x REPL_TIMEOUT_MS
+const unsigned long SENSOR_TIMEOUT_MS = 2000;                 // esp8266.cpp SENDER_TIMEOUT_MS
+const int FAILOVER_FAILS = 2;                                 // esp8266.cpp SENDER_FAILOVER_FAILS
+const double HANG_AT_MS = 10000, BACK_AT_MS = 25000, END_MS = 35000;
+const int PORT_A = 18081, PORT_B = 18082;
+
+const auto simStart = std::chrono::steady_clock::now();
+double msNow() { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - simStart).count(); }
+void sleepMs(double ms) { std::this_thread::sleep_for(std::chrono::microseconds((long)(ms * 1000))); }
+
+/* what happened to each reading: when each instance applied it, and how */
+struct ReadingFate {
+  double at[2] = { -1, -1 };
+  bool replicated[2] = { false, false };
+  bool fromLog[2] = { false, false };   // replicated through the log, not a snapshot
+};
+std::mutex fateMu;
+std::map<uint64_t, ReadingFate> fates;
+
+void noteApplied(int inst, int sensor, uint32_t seq, bool replicated, bool fromLog) {
+  std::lock_guard<std::mutex> g(fateMu);
+  ReadingFate& f = fates[(uint64_t)sensor << 32 | seq];
+  if (f.at[inst] >= 0) return;
+  f.at[inst] = msNow();
+  f.replicated[inst] = replicated;
+  f.fromLog[inst] = fromLog;
+}
+
+/* sockets: one request per connection, HTTP/1.0 style */
+int connectTimeout(int port, unsigned long ms) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  sockaddr_in a = {};
+  a.sin_family = AF_INET;
+  a.sin_port = htons(port);
+  a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, (sockaddr*)&a, sizeof(a)) < 0 && errno != EINPROGRESS) { close(fd); return -1; }
+  pollfd p = { fd, POLLOUT, 0 };
+  int err = 0;
+  socklen_t len = sizeof(err);
+  if (poll(&p, 1, ms) != 1 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err) { close(fd); return -1; }
+  return fd;
+}
+
+// reads until the peer closes or the deadline passes; -1 on timeout
+int readAll(int fd, char* buf, int cap, double deadline) {
+  int n = 0;
+  for (;;) {
+    int left = (int)(deadline - msNow());
+    pollfd p = { fd, POLLIN, 0 };
+    if (left <= 0 || poll(&p, 1, left) != 1) return -1;
+    int r = read(fd, buf + n, cap - n);
+    if (r <= 0) return n;
+    n += r;
+    if (n == cap) return n;
+  }
+}
+
+// status code, body into body/bodyLen; -1 if nothing came back in time
+int httpRequest(int port, const char* method, const char* path, const char* form, char* body, int cap, int* bodyLen, unsigned long timeoutMs) {
+  double deadline = msNow() + timeoutMs;
+  int fd = connectTimeout(port, timeoutMs);
+  if (fd < 0) return -1;
+  char req[512];
+  int n = snprintf(req, sizeof(req), "%s %s HTTP/1.0\r\nContent-Length: %d\r\n\r\n%s", method, path, (int)strlen(form), form);
+  if (write(fd, req, n) != n) { close(fd); return -1; }
+  static thread_local char resp[sizeof(ReplPageHeader) + REPL_PAGE * sizeof(ReplRecord) + 256];
+  int len = readAll(fd, resp, sizeof(resp), deadline);
+  close(fd);
+  char* end = len > 0 ? (char*)memmem(resp, len, "\r\n\r\n", 4) : nullptr;
+  int code = 0;
+  if (!end || sscanf(resp, "HTTP/1.0 %d", &code) != 1) return -1;
+  *bodyLen = std::min((int)(resp + len - end - 4), cap);
+  memcpy(body, end + 4, *bodyLen);
+  return code;
+}
+
+void respond(int fd, int code, const void* body, int len) {
+  char hdr[128];
+  int n = snprintf(hdr, sizeof(hdr), "HTTP/1.0 %d X\r\nContent-Length: %d\r\n\r\n", code, len);
+  if (write(fd, hdr, n) == n && len) (void)!write(fd, body, len);
+}
+
+/* a sender instance */
+struct Dev {
+  bool used;
+  char name[32];
+  uint32_t seq;
+  uint32_t sampleMs;        // on this instance's clock, 0 = none
+  uint16_t permille;
+  float totalHeightCm, sensorToMaxCm;
+};
+
+struct Instance {
+  int idx, port;
+  uint32_t clockOffset;
+  std::mutex mu;            // the table, against the final comparison
+  Dev dev[MAX_DEVICES];
+  ReplLog<LOG_ENTRIES> log;
+  ReplPeer peer;
+  bool peerUp;
+  double lastPull;
+  int listenFd;
+  std::atomic<bool> hung{ false }, stop{ false };
+  Instance* other;
+  double caughtUpAt;        // snapshot of the peer finished, after a restart
+  uint32_t millis() { return (uint32_t)msNow() + clockOffset; }
+
+  void boot(uint32_t epoch) {
+    memset(dev, 0, sizeof(dev));
+    replInit(log, epoch);
+    replPeerReset(peer);
+    peerUp = true;          // first pull right away
+    lastPull = -1e9;
+    caughtUpAt = -1;
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in a = {};
+    a.sin_family = AF_INET;
+    a.sin_port = htons(port);
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenFd, (sockaddr*)&a, sizeof(a)) < 0 || listen(listenFd, 64) < 0) { perror("listen"); exit(1); }
+  }
+
+  int slot(const char* name) {
+    int free = -1;
+    for (int i = 0; i < MAX_DEVICES; i++) {
+      if (dev[i].used && strncmp(dev[i].name, name, sizeof(dev[i].name)) == 0) return i;
+      if (!dev[i].used && free < 0) free = i;
+    }
+    if (free >= 0) { dev[free].used = true; snprintf(dev[free].name, sizeof(dev[free].name), "%.31s", name); }
+    return free;
+  }
+
+  // newer readings only, as sender-server's batch and replication paths
+  bool apply(int i, uint32_t seq, uint32_t sampleMs, uint16_t permille) {
+    if (dev[i].sampleMs != 0 && (int32_t)(sampleMs - dev[i].sampleMs) <= 0) return false;
+    dev[i].seq = seq;
+    dev[i].sampleMs = sampleMs ? sampleMs : 1;
+    dev[i].permille = permille;
+    dev[i].totalHeightCm = 120;
+    dev[i].sensorToMaxCm = 2;
+    return true;
+  }
+
+  void logReport(int i) {
+    ReplRecord& e = replAppend(log);
+    e.type = REPL_REPORT;
+    memcpy(e.name, dev[i].name, sizeof(e.name));
+    e.sensorSeq = dev[i].seq;
+    e.timeMs = dev[i].sampleMs;
+    e.permille = dev[i].permille;
+    e.totalHeightCm = dev[i].totalHeightCm;
+    e.sensorToMaxCm = dev[i].sensorToMaxCm;
+  }
+
+  // POST /api/report  name=..&seq=..&permille=..&age_ms=..
+  void handleReport(int fd, const char* form) {
+    char name[32];
+    unsigned seq, permille, age;
+    if (sscanf(form, "name=%31[^&]&seq=%u&permille=%u&age_ms=%u", name, &seq, &permille, &age) != 4) { respond(fd, 400, "", 0); return; }
+    std::lock_guard<std::mutex> g(mu);
+    int i = slot(name);
+    if (i < 0) { respond(fd, 500, "", 0); return; }
+    if (apply(i, seq, millis() - age, permille)) {
+      logReport(i);
+      noteApplied(idx, atoi(name + 5), seq, false, false);
+    }
+    respond(fd, 200, "{\"ok\":true}", 11);
+  }
+
+  // sender-server's replSnapshotPage, reports only (no configs in this run)
+  int snapshotPage(int s, ReplRecord* out, ReplPageHeader& h) {
+    replPageInit(h, log.epoch);
+    h.flags = REPL_PAGE_SNAPSHOT;
+    h.upto = log.next - 1;
+    int n = 0;
+    uint32_t now = millis();
+    for (; s >= 0 && s < MAX_DEVICES && n + 2 <= REPL_PAGE; s++) {
+      if (!dev[s].used || dev[s].sampleMs == 0) continue;
+      ReplRecord& r = out[n++];
+      memset(&r, 0, sizeof(r));
+      r.seq = h.upto;
+      r.type = REPL_REPORT;
+      memcpy(r.name, dev[s].name, sizeof(r.name));
+      r.sensorSeq = dev[s].seq;
+      r.timeMs = now - dev[s].sampleMs;
+      r.permille = dev[s].permille;
+    }
+    h.count = n;
+    h.cursor = s < MAX_DEVICES ? s : -1;
+    return n;
+  }
+
+  // GET /api/replog?since=N | ?snapshot=slot
+  void handleReplog(int fd, const char* query) {
+    static thread_local uint8_t buf[sizeof(ReplPageHeader) + REPL_PAGE * sizeof(ReplRecord)];
+    ReplPageHeader& h = *(ReplPageHeader*)buf;
+    ReplRecord* recs = (ReplRecord*)(buf + sizeof(h));
+    std::lock_guard<std::mutex> g(mu);
+    unsigned long v = 0;
+    int n;
+    if (sscanf(query, "?snapshot=%lu", &v) == 1) n = snapshotPage((int)v, recs, h);
+    else n = sscanf(query, "?since=%lu", &v) == 1 ? replCopySince(log, v, recs, REPL_PAGE, millis(), h) : -1;
+    if (n < 0) { respond(fd, 400, "", 0); return; }
+    respond(fd, 200, buf, sizeof(h) + n * sizeof(ReplRecord));
+  }
+
+  void serveOne() {
+    pollfd p = { listenFd, POLLIN, 0 };
+    if (poll(&p, 1, 2) != 1) return;
+    int fd = accept(listenFd, nullptr, nullptr);
+    if (fd < 0) return;
+    char req[1024];
+    int n = 0;
+    double deadline = msNow() + 200;
+    char* end = nullptr;
+    int want = -1;
+    while (n < (int)sizeof(req) - 1) {
+      pollfd q = { fd, POLLIN, 0 };
+      if (poll(&q, 1, std::max(1, (int)(deadline - msNow()))) != 1) break;
+      int r = read(fd, req + n, sizeof(req) - 1 - n);
+      if (r <= 0) break;
+      n += r;
+      req[n] = 0;
+      if (!end && (end = strstr(req, "\r\n\r\n"))) {
+        const char* cl = strstr(req, "Content-Length: ");
+        want = (int)(end + 4 - req) + (cl ? atoi(cl + 16) : 0);
+      }
+      if (end && n >= want) break;
+    }
+    char method[8], path[128];
+    if (end && sscanf(req, "%7s %127s", method, path) == 2) {
+      if (!strcmp(method, "POST") && !strcmp(path, "/api/report")) handleReport(fd, end + 4);
+      else if (!strncmp(path, "/api/replog", 11)) handleReplog(fd, path + 11);
+      else respond(fd, 404, "", 0);
+    }
+    close(fd);
+  }
+
+  // sender-server's replTick
+  void pullTick() {
+    double now = msNow();
+    double wait = !peerUp ? RETRY_MS : peer.more ? 0 : PULL_MS;
+    if (now - lastPull < wait) return;
+    lastPull = now;
+    char path[48] = "/api/replog";
+    replPeerQuery(peer, path + 11, sizeof(path) - 11);
+    static thread_local uint8_t buf[sizeof(ReplPageHeader) + REPL_PAGE * sizeof(ReplRecord)];
+    int len = -1;
+    int code = httpRequest(other->port, "GET", path, "", (char*)buf, sizeof(buf), &len, PEER_TIMEOUT_MS);
+    if (code != 200 || !replPageValid(buf, len)) { peerUp = false; return; }
+    peerUp = true;
+    const ReplPageHeader& h = *(const ReplPageHeader*)buf;
+    bool snapshot = (h.flags & REPL_PAGE_SNAPSHOT) != 0;
+    if (!replPeerOnPage(peer, h)) return;
+    const ReplRecord* recs = (const ReplRecord*)(buf + sizeof(h));
+    std::lock_guard<std::mutex> g(mu);
+    uint32_t t = millis();
+    for (int k = 0; k < h.count; k++) {
+      const ReplRecord& e = recs[k];
+      if (e.type != REPL_REPORT) continue;
+      char name[sizeof(e.name) + 1];
+      memcpy(name, e.name, sizeof(e.name));
+      name[sizeof(e.name)] = 0;
+      int i = slot(name);
+      if (i >= 0 && apply(i, e.sensorSeq, t - e.timeMs, e.permille)) noteApplied(idx, atoi(name + 5), e.sensorSeq, true, !snapshot);
+    }
+    if (snapshot && peer.cursor < 0 && caughtUpAt < 0) caughtUpAt = msNow();
+  }
+
+  void run() {
+    while (!stop) {
+      if (hung) { sleepMs(5); continue; }
+      serveOne();
+      pullTick();
+    }
+  }
+};
+
+Instance inst[2];
+
+/* a sensor: esp8266.cpp's backlog and failover, one reading per request */
+struct SensorStats {
+  std::atomic<int> target{ 0 };
+  double firstOnBAfterHang = -1;
+  bool onAAtHang = false;
+};
+SensorStats sensors[SENSORS];
+std::atomic<bool> hangNoted{ false };
+
+void sensorRun(int s) {
+  SensorStats& st = sensors[s];
+  st.target = s < ON_A ? 0 : 1;
+  struct Reading { uint32_t seq; double tMs; };
+  std::deque<Reading> queue;
+  uint32_t seq = 1;
+  int fails = 0;
+  double nextReport = REPORT_MS * s / SENSORS, retryAt = 0;
+  char name[16];
+  snprintf(name, sizeof(name), "Tank-%d", s);
+  while (msNow() < END_MS) {
+    double now = msNow();
+    if (now >= HANG_AT_MS && !st.onAAtHang && hangNoted && st.firstOnBAfterHang < 0 && st.target == 0) st.onAAtHang = true;
+    if (now >= nextReport) { queue.push_back({ seq++, now }); nextReport += REPORT_MS; }
+    if (queue.empty() || now < retryAt) { sleepMs(5); continue; }
+    char form[96], body[64];
+    int len;
+    snprintf(form, sizeof(form), "name=%s&seq=%u&permille=%u&age_ms=%u", name, queue.front().seq,
+             (unsigned)(300 + queue.front().seq * 7 % 500), (unsigned)(now - queue.front().tMs));
+    int t = st.target;
+    int code = httpRequest(t ? PORT_B : PORT_A, "POST", "/api/report", form, body, sizeof(body), &len, SENSOR_TIMEOUT_MS);
+    if (code == 200) {
+      queue.pop_front();
+      fails = 0;
+      retryAt = 0;
+      if (t == 1 && st.onAAtHang && st.firstOnBAfterHang < 0) st.firstOnBAfterHang = msNow() - HANG_AT_MS;
+    } else {
+      if (++fails >= FAILOVER_FAILS) { fails = 0; st.target = 1 - t; }
+      retryAt = msNow() + REPORT_MS;   // flushBacklog waits an interval after a failure
+    }
+  }
+}
+
+double pct(std::vector<double>& v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+int main() {
+  for (int i = 0; i < 2; i++) {
+    inst[i].idx = i;
+    inst[i].port = i ? PORT_B : PORT_A;
+    inst[i].clockOffset = i ? 123456789u : 4000000000u;   // A's wraps during the run
+    inst[i].other = &inst[1 - i];
+    inst[i].boot(0x1000 + i);
+  }
+  std::thread instThreads[2] = { std::thread(&Instance::run, &inst[0]), std::thread(&Instance::run, &inst[1]) };
+  std::vector<std::thread> sensorThreads;
+  for (int s = 0; s < SENSORS; s++) sensorThreads.emplace_back(sensorRun, s);
+
+  sleepMs(HANG_AT_MS - msNow());
+  inst[0].hung = true;
+  hangNoted = true;
+  printf("t=%5.1f s  A hangs\n", msNow() / 1000);
+
+  sleepMs(BACK_AT_MS - msNow());
+  {
+    std::lock_guard<std::mutex> g(inst[0].mu);
+    close(inst[0].listenFd);
+    inst[0].boot(0x2000);
+  }
+  double backAt = msNow();
+  inst[0].hung = false;
+  printf("t=%5.1f s  A back, empty, new epoch\n", backAt / 1000);
+
+  for (auto& t : sensorThreads) t.join();
+  sleepMs(3 * PULL_MS);   // last pulls
+  for (int i = 0; i < 2; i++) inst[i].stop = true;
+  for (auto& t : instThreads) t.join();
+
+  // lag: applied at the origin -> applied at the other through the log
+  std::vector<double> lag[2];
+  int lost = 0, answeredByA = 0;
+  for (auto& kv : fates) {
+    const ReadingFate& f = kv.second;
+    for (int to = 0; to < 2; to++)
+      if (f.fromLog[to] && f.at[1 - to] >= 0 && !f.replicated[1 - to]) lag[to].push_back(f.at[to] - f.at[1 - to]);
+    if (f.at[0] >= 0 && !f.replicated[0] && f.at[0] < HANG_AT_MS) {
+      answeredByA++;
+      if (f.at[1] < 0) lost++;
+    }
+  }
+  for (int to = 0; to < 2; to++)
+    printf("replication lag %s->%s: %zu readings, p50 %.0f ms, p90 %.0f ms, p99 %.0f ms, max %.0f ms\n",
+           to ? "A" : "B", to ? "B" : "A", lag[to].size(), pct(lag[to], 0.5), pct(lag[to], 0.9), pct(lag[to], 0.99), pct(lag[to], 1.0));
+
+  std::vector<double> fo;
+  int stuck = 0;
+  for (int s = 0; s < SENSORS; s++) {
+    if (!sensors[s].onAAtHang) continue;
+    if (sensors[s].firstOnBAfterHang < 0) stuck++;
+    else fo.push_back(sensors[s].firstOnBAfterHang);
+  }
+  printf("failover of A's %zu sensors to B: p50 %.1f s, max %.1f s (%d never made it)\n",
+         fo.size() + stuck, pct(fo, 0.5) / 1000, pct(fo, 1.0) / 1000, stuck);
+  printf("readings A answered before hanging: %d, never reached B: %d\n", answeredByA, lost);
+  printf("A's catch-up from B after coming back: %.0f ms\n", inst[0].caughtUpAt < 0 ? -1.0 : inst[0].caughtUpAt - backAt);
+
+  int devices = 0, differ = 0;
+  for (int i = 0; i < MAX_DEVICES; i++) {
+    const Dev& b = inst[1].dev[i];
+    if (!b.used) continue;
+    devices++;
+    int j = -1;
+    for (int k = 0; k < MAX_DEVICES; k++) if (inst[0].dev[k].used && !strcmp(inst[0].dev[k].name, b.name)) j = k;
+    if (j < 0 || inst[0].dev[j].seq != b.seq || inst[0].dev[j].permille != b.permille) differ++;
+  }
+  printf("tables at the end: %d devices, %d differ\n", devices, differ);
+  return differ != 0;
+}
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+report_bench.py
+  - N virtual sensors reporting to the sender over HTTP (POST /api/report,
+    a new connection per report like esp8266.cpp) and over the ESP-NOW
+    stand-in (the same frames as common/espnow_frame.h, over UDP 4210;
+    only in a sender built with -DESPNOW_UDP_STANDIN, as tools/fleet_sim.py
+    builds it)
+  - delivery latency is send -> 200 / send -> config reply with our seq;
+    reports/s is what got answered. One JSON line per transport; the
+    sender's own view is its ingest bench line and /api/metrics
+  - each sensor gets a random locally administered MAC, so the runs show up
+    as separate devices ("bench-N"); they stay in the table until deleted
+      python3 tools/report_bench.py 192.168.4.1 --sensors 8 --seconds 30
+      python3 tools/report_bench.py 192.168.4.1 --mode espnow --interval 0
+"""
+
+import argparse
+import http.client
+import json
+import random
+import socket
+import struct
+import threading
+import time
+
+ESPNOW_MAGIC = 0x54
+ESPNOW_VERSION = 1
+ESPNOW_REPORT = 1
+ESPNOW_CONFIG = 2
+REPORT_FMT = "<4BIIHbff16s"    # EspNowReport
+CONFIG_FMT = "<4BIIff16s"      # EspNowConfig
+
+
+def random_mac():
+    b = [random.randrange(256) for _ in range(6)]
+    b[0] = (b[0] & 0xFC) | 0x02     # locally administered, unicast
+    return bytes(b)
+
+
+def http_sensor(host, port, mac, name, interval, deadline, out, errors):
+    seq = 0
+    while time.monotonic() < deadline:
+        t0 = time.monotonic()
+        body = json.dumps({"name": name, "percent": random.uniform(0, 100), "seq": seq, "age_ms": 0,
+                           "totalHeightCm": 120.0, "sensorToMaxCm": 2.0,
+                           "mac": ":".join("%02X" % b for b in mac), "rssi": -60})
+        seq += 1
+        conn = http.client.HTTPConnection(host, port, timeout=5)
+        try:
+            conn.request("POST", "/api/report", body, {"Content-Type": "application/json"})
+            resp = conn.getresponse()
+            resp.read()
+            if resp.status != 200:
+                errors.append(resp.status)
+            else:
+                out.append((time.monotonic() - t0) * 1000.0)
+        except (OSError, http.client.HTTPException) as e:
+            errors.append(type(e).__name__)
+        finally:
+            conn.close()
+        left = interval - (time.monotonic() - t0)
+        if left > 0:
+            time.sleep(left)
+
+
+def espnow_sensor(host, port, mac, name, interval, deadline, out, errors):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(1.0)
+    seq = 0
+    while time.monotonic() < deadline:
+        t0 = time.monotonic()
+        frame = struct.pack(REPORT_FMT, ESPNOW_MAGIC, ESPNOW_VERSION, ESPNOW_REPORT, 0, seq, 0,
+                            random.randrange(1001), -60, 120.0, 2.0, name.encode()[:16])
+        sock.sendto(mac + frame, (host, port))
+        try:
+            while True:   # skip late replies to earlier reports
+                data = sock.recv(64)
+                if len(data) != struct.calcsize(CONFIG_FMT):
+                    continue
+                f = struct.unpack(CONFIG_FMT, data)
+                if f[0] == ESPNOW_MAGIC and f[2] == ESPNOW_CONFIG and f[4] == seq:
+                    out.append((time.monotonic() - t0) * 1000.0)
+                    break
+        except OSError as e:
+            errors.append(type(e).__name__)
+        seq += 1
+        left = interval - (time.monotonic() - t0)
+        if left > 0:
+            time.sleep(left)
+    sock.close()
+
+
+def pct(sorted_ms, q):
+    if not sorted_ms:
+        return 0.0
+    return sorted_ms[min(len(sorted_ms) - 1, int(q * (len(sorted_ms) - 1) + 0.5))]
+
+
+def run(transport, target, args):
+    deadline = time.monotonic() + args.seconds
+    lat, errors = [], []
+    port = args.http_port if transport == "http" else args.udp_port
+    threads = [threading.Thread(target=target, args=(args.host, port, random_mac(), "bench-%d" % i,
+                                                    args.interval, deadline, lat, errors))
+               for i in range(args.sensors)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    lat.sort()
+    print('{"transport":"%s","sensors":%d,"reports_s":%.1f,"errors":%d,"p50_ms":%.1f,"p90_ms":%.1f,"p99_ms":%.1f,"max_ms":%.1f}'
+          % (transport, args.sensors, len(lat) / args.seconds, len(errors),
+             pct(lat, 0.5), pct(lat, 0.9), pct(lat, 0.99), lat[-1] if lat else 0.0))
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("host")
+    ap.add_argument("--mode", choices=["http", "espnow", "both"], default="both")
+    ap.add_argument("--http-port", type=int, default=80)
+    ap.add_argument("--udp-port", type=int, default=4210)
+    ap.add_argument("--sensors", type=int, default=4)
+    ap.add_argument("--interval", type=float, default=0.0, help="seconds between reports per sensor (0 = back to back)")
+    ap.add_argument("--seconds", type=float, default=20.0)
+    args = ap.parse_args()
+
+    if args.mode in ("http", "both"):
+        run("http", http_sensor, args)
+    if args.mode in ("espnow", "both"):
+        run("espnow", espnow_sensor, args)
+
+
+if __name__ == "__main__":
+    main()
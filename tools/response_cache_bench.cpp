@@ -0,0 +1,177 @@
+/*
+  response_cache_bench.cpp
+  - Host benchmark of common/response_cache.h in front of sender-server's
+    read endpoints: a 128-device table, 32 sensors reporting every 2.5 s
+    (each report bumps tableVersion, as does the 1 s station sweep; the
+    device list, listVersion, does not change) and polling /api/config
+    every 15 s, which is keyed on the device's config version and report
+    interval, so readings do not invalidate it
+  - N pollers: two thirds are UI tabs (/api/devices + /status every 2 s;
+    browsers revalidate with If-None-Match), one third LCD receivers (the
+    receiver's /api/devices query every 3 s, no ETag)
+  - Each request runs its handler without and with the cache; prints the
+    hit and 304 rates, mean handler time and the requests per CPU second
+    that leaves. Bodies are built with snprintf in writeDeviceJson's shape
+    (no ArduinoJson on the host); the ESP32 is far slower per body, so the
+    ratio is the number to look at
+      g++ -std=c++11 -O2 -Wall -Wextra tools/response_cache_bench.cpp -o /tmp/response_cache_bench && /tmp/response_cache_bench
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "../common/response_cache.h"
+
+const int MAX_DEVICES = 128;
+const int REPORTING = 32;
+const unsigned long REPORT_MS = 2500, CONFIG_POLL_MS = 15000, UI_MS = 2000, LCD_MS = 3000, SWEEP_MS = 1000;
+const unsigned long RUN_MS = 60000;
+const char* UI_PATH = "/api/devices";
+const char* LCD_PATH = "/api/devices?active=1&alarmed=1&fields=name,mac,percent,age_seconds,seq,sample_age_ms,rate_pph,anomaly,alarm&limit=32";
+
+struct Device {
+  char name[32];
+  unsigned char mac[6];
+  float percent, totalHeightCm, sensorToMaxCm, rssi, lossPct, jitterMs, ratePph;
+  unsigned long lastSeen, sampleMs;
+  unsigned seq, alarm, anomaly;
+  uint32_t configVersion;
+};
+Device devices[MAX_DEVICES];
+uint32_t tableVersion = 0;   // every change
+uint32_t listVersion = 0;    // devices added / edited / alarm changes; none in this run
+uint32_t statusVersion = 1;
+ResponseCache<std::string, 8> cache;
+
+void appendDevice(std::string& out, const Device& d, bool full, unsigned long now) {
+  char buf[512];
+  if (full)
+    snprintf(buf, sizeof(buf),
+             "{\"mac\":\"%02X:%02X:%02X:%02X:%02X:%02X\",\"ip\":\"192.168.4.%d\",\"rssi\":%d,\"name\":\"%s\",\"percent\":%.1f,"
+             "\"age_seconds\":%lu,\"totalHeightCm\":%.1f,\"sensorToMaxCm\":%.1f,\"seq\":%u,\"sample_age_ms\":%lu,"
+             "\"rate_pph\":%.1f,\"tte_s\":null,\"ttf_s\":null,\"anomaly\":%u,\"alarm\":%u,\"loss_pct\":%.1f,"
+             "\"jitter_ms\":%ld,\"report_interval_ms\":2500}",
+             d.mac[0], d.mac[1], d.mac[2], d.mac[3], d.mac[4], d.mac[5], d.mac[5], (int)d.rssi, d.name, d.percent,
+             (now - d.lastSeen) / 1000, d.totalHeightCm, d.sensorToMaxCm, d.seq, now - d.sampleMs,
+             d.ratePph, d.anomaly, d.alarm, d.lossPct, (long)d.jitterMs);
+  else
+    snprintf(buf, sizeof(buf),
+             "{\"name\":\"%s\",\"mac\":\"%02X:%02X:%02X:%02X:%02X:%02X\",\"percent\":%.1f,\"age_seconds\":%lu,\"seq\":%u,"
+             "\"sample_age_ms\":%lu,\"rate_pph\":%.1f,\"anomaly\":%u,\"alarm\":%u}",
+             d.name, d.mac[0], d.mac[1], d.mac[2], d.mac[3], d.mac[4], d.mac[5], d.percent, (now - d.lastSeen) / 1000,
+             d.seq, now - d.sampleMs, d.ratePph, d.anomaly, d.alarm);
+  out += buf;
+}
+
+std::string buildDevices(bool full, unsigned long now) {
+  std::string out = "[";
+  int n = 0;
+  for (int i = 0; i < MAX_DEVICES; i++) {
+    if (!full && (now - devices[i].lastSeen > 15000 || n == 32)) continue;
+    if (n++) out += ',';
+    appendDevice(out, devices[i], full, now);
+  }
+  return out + "]";
+}
+
+std::string buildConfig(int i) {
+  char buf[200];
+  snprintf(buf, sizeof(buf), "{\"name\":\"%.31s\",\"totalHeightCm\":%.1f,\"sensorToMaxCm\":%.1f,\"reportIntervalMs\":2500}",
+           devices[i].name, devices[i].totalHeightCm, devices[i].sensorToMaxCm);
+  return buf;
+}
+
+std::string buildStatus() {
+  return "{\"ok\":true,\"ap_ssid\":\"Sender-Direct\",\"ap_ip\":\"192.168.4.1\",\"sta_connected\":true,\"sta_ip\":\"192.168.1.50\"}";
+}
+
+enum Kind { K_DEVICES_UI, K_DEVICES_LCD, K_STATUS, K_CONFIG };
+size_t sink = 0;
+
+// the handler as it was: build every time
+void serveUncached(Kind k, int dev, unsigned long now) {
+  std::string body = k == K_STATUS ? buildStatus() : k == K_CONFIG ? buildConfig(dev) : buildDevices(k == K_DEVICES_UI, now);
+  sink += body.size();
+}
+
+// the handler with the cache; returns true for a 304
+bool serveCached(Kind k, int dev, unsigned long now, std::string* etag) {
+  std::string variant = k == K_STATUS ? "/status" : k == K_CONFIG ? std::string("/api/config?name=") + devices[dev].name
+                      : k == K_DEVICES_UI ? UI_PATH : LCD_PATH;
+  uint32_t version = k == K_STATUS ? statusVersion : k == K_CONFIG ? devices[dev].configVersion : listVersion;
+  uint32_t epoch = (k == K_DEVICES_UI || k == K_DEVICES_LCD) ? now / 1000 : k == K_CONFIG ? 2500 : CACHE_TIMELESS;
+  CachedBody<std::string>* c = cacheFind(cache, variant, version, epoch);
+  if (!c) {
+    std::string body = k == K_STATUS ? buildStatus() : k == K_CONFIG ? buildConfig(dev) : buildDevices(k == K_DEVICES_UI, now);
+    c = cacheStore(cache, variant, version, epoch, body, now);
+  }
+  if (etag && *etag == c->etag) return true;
+  if (etag) *etag = c->etag;
+  sink += c->body.size();
+  return false;
+}
+
+double usNow() {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void run(int pollers) {
+  for (int i = 0; i < MAX_DEVICES; i++) {
+    Device& d = devices[i];
+    snprintf(d.name, sizeof(d.name), "Tank-%d", i + 1);
+    unsigned char mac[6] = { 0x24, 0x6F, 0x28, 0x10, (unsigned char)(i >> 8), (unsigned char)i };
+    memcpy(d.mac, mac, 6);
+    d.percent = 50; d.totalHeightCm = 120; d.sensorToMaxCm = 2; d.rssi = -60; d.lossPct = 0.5f; d.jitterMs = 40; d.ratePph = -1.5f;
+    d.lastSeen = 0; d.sampleMs = 0; d.seq = 0; d.alarm = 0; d.anomaly = 0; d.configVersion = i + 1;
+  }
+  cacheInit(cache, 48 * 1024, 0x5eed);
+  tableVersion = 0;
+  listVersion = 0;
+
+  struct Poller { Kind kind; unsigned long periodMs, nextMs; std::string etag; };
+  std::vector<Poller> ps;
+  for (int p = 0; p < pollers; p++) {
+    bool ui = p % 3 != 2;
+    ps.push_back({ ui ? K_DEVICES_UI : K_DEVICES_LCD, ui ? UI_MS : LCD_MS, (unsigned long)(p * 137 % 2000), std::string() });
+    if (ui) ps.push_back({ K_STATUS, UI_MS, (unsigned long)(p * 137 % 2000), std::string() });
+  }
+
+  long requests = 0, notModified = 0;
+  double offUs = 0, onUs = 0;
+  for (unsigned long now = 1; now <= RUN_MS; now++) {
+    if (now % SWEEP_MS == 0) tableVersion++;
+    for (int s = 0; s < REPORTING; s++) {
+      if ((now + s * 79) % REPORT_MS == 0) {
+        Device& d = devices[s];
+        d.percent = 20 + (now / 100 + s) % 60; d.seq++; d.lastSeen = now; d.sampleMs = now;
+        tableVersion++;
+      }
+      if ((now + s * 467) % CONFIG_POLL_MS == 0) {
+        double t0 = usNow(); serveUncached(K_CONFIG, s, now);
+        double t1 = usNow(); serveCached(K_CONFIG, s, now, nullptr);
+        double t2 = usNow();
+        offUs += t1 - t0; onUs += t2 - t1; requests++;
+      }
+    }
+    for (Poller& p : ps) {
+      if (now < p.nextMs) continue;
+      p.nextMs = now + p.periodMs;
+      bool revalidates = p.kind != K_DEVICES_LCD;   // browsers do, the receiver's HTTPClient does not
+      double t0 = usNow(); serveUncached(p.kind, 0, now);
+      double t1 = usNow(); bool nm = serveCached(p.kind, 0, now, revalidates ? &p.etag : nullptr);
+      double t2 = usNow();
+      offUs += t1 - t0; onUs += t2 - t1; requests++;
+      notModified += nm;
+    }
+  }
+  printf("%2d pollers: %6.1f req/s offered, hit rate %5.1f%%, 304 %5.1f%% | per request %7.1f -> %6.1f us | capacity %7.0f -> %8.0f req/s (x%.1f)\n",
+         pollers, requests * 1000.0 / RUN_MS, 100.0 * cache.hits / (cache.hits + cache.misses), 100.0 * notModified / requests,
+         offUs / requests, onUs / requests, requests / offUs * 1e6, requests / onUs * 1e6, offUs / onUs);
+}
+
+int main() {
+  for (int n : { 1, 10, 50 }) run(n);
+  return sink == 0;
+}
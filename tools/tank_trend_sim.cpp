@@ -0,0 +1,193 @@
+/*
+  tank_trend_sim.cpp
+  - Host run of common/tank_trend.h over synthetic level traces, one
+    reading per 2.5 s report (sender-server.cpp feeds trendUpdate the same
+    way), with gaussian reading noise:
+      fill    pump at +30 %/h: rate, time-to-full, no flags
+      drain   use at -40 %/h: rate, time-to-empty, no leak (that is use)
+      flat    8 h with noise only: flat, no flags
+      leak    flat, then -1 %/h for 8 h: LEAK within the CUSUM's budget
+              (settle + LEAK_ALARM_PCT over the slack); a refill clears it
+      stuck   the raw value frozen mid-tank: STUCK after STUCK_REPORTS,
+              cleared by the first reading that moves
+      no-echo NOECHO_REPORTS timeouts: STUCK; the first valid echo clears
+              it, also when it repeats the reading before the outage
+  - Rates and times are checked once the regression has settled (3 tau)
+    to within 10 %. Prints one line per trace; exit 1 on any failure
+      g++ -std=c++11 -O2 -Wall -Wextra tools/tank_trend_sim.cpp -o /tmp/tank_trend_sim && /tmp/tank_trend_sim
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <random>
+#include "../common/tank_trend.h"
+
+const unsigned long REPORT_MS = 2500;
+const float NOISE_PCT = 0.15f;
+const float SETTLED_S = 3.0f * TREND_TAU_S;
+
+static int fails = 0;
+
+static void check(bool ok, const char* trace, const char* what) {
+  if (!ok) { printf("FAIL %s: %s\n", trace, what); fails++; }
+}
+
+static bool near(float got, float want, float rel) { return fabsf(got - want) <= fabsf(want) * rel; }
+
+struct Run {
+  TankTrend t;
+  unsigned long ms = 1000;
+  std::mt19937 rng{ 11 };
+  std::normal_distribution<float> noise{ 0, NOISE_PCT };
+  float level = 0;        // true level, %
+  Run(float start) : level(start) { trendReset(t); }
+
+  // advance one report at ratePph; returns the reading fed
+  float step(float ratePph, bool noisy = true) {
+    level += ratePph * REPORT_MS / 3.6e6f;
+    if (level < 0) level = 0;
+    if (level > 100) level = 100;
+    float r = level + (noisy ? noise(rng) : 0.0f);
+    if (r < 0) r = 0;
+    if (r > 100) r = 100;
+    trendUpdate(t, r, ms);
+    ms += REPORT_MS;
+    return r;
+  }
+  long reports(float seconds) const { return (long)(seconds * 1000 / REPORT_MS); }
+};
+
+static void fill() {
+  const char* name = "fill";
+  Run r(20);
+  for (long i = r.reports(SETTLED_S); i > 0; --i) r.step(30);
+  float pph = trendRatePph(r.t);
+  long ttf = trendSecondsToFull(r.t);
+  float wantTtf = (100 - r.level) / 30 * 3600;
+  printf("%-8s level %5.1f%%  rate %+6.2f %%/h (30.00)  to full %5ld s (%.0f)  to empty %ld  flags %u\n",
+         name, r.t.level, pph, ttf, wantTtf, trendSecondsToEmpty(r.t), r.t.flags);
+  check(near(pph, 30, 0.1f), name, "rate");
+  check(near((float)ttf, wantTtf, 0.1f), name, "time to full");
+  check(trendSecondsToEmpty(r.t) == -1, name, "time to empty while filling");
+  check(r.t.flags == 0, name, "flags");
+}
+
+static void drain() {
+  const char* name = "drain";
+  Run r(95);
+  uint8_t seen = 0;
+  for (long i = r.reports(SETTLED_S); i > 0; --i) { r.step(-40); seen |= r.t.flags; }
+  float pph = trendRatePph(r.t);
+  long tte = trendSecondsToEmpty(r.t);
+  float wantTte = r.level / 40 * 3600;
+  printf("%-8s level %5.1f%%  rate %+6.2f %%/h (-40.00)  to empty %5ld s (%.0f)  to full %ld  flags %u\n",
+         name, r.t.level, pph, tte, wantTte, trendSecondsToFull(r.t), seen);
+  check(near(pph, -40, 0.1f), name, "rate");
+  check(near((float)tte, wantTte, 0.1f), name, "time to empty");
+  check(trendSecondsToFull(r.t) == -1, name, "time to full while draining");
+  check(seen == 0, name, "flags");
+}
+
+static void flat() {
+  const char* name = "flat";
+  Run r(63);
+  uint8_t seen = 0;
+  for (long i = r.reports(8 * 3600.0f); i > 0; --i) { r.step(0); seen |= r.t.flags; }
+  printf("%-8s level %5.1f%%  rate %+6.2f %%/h  flat %d  to empty %ld  to full %ld  flags seen %u\n",
+         name, r.t.level, trendRatePph(r.t), trendIsFlat(r.t), trendSecondsToEmpty(r.t), trendSecondsToFull(r.t), seen);
+  check(trendIsFlat(r.t), name, "not flat");
+  check(trendSecondsToEmpty(r.t) == -1 && trendSecondsToFull(r.t) == -1, name, "times on a flat tank");
+  check(seen == 0, name, "false flag");
+}
+
+static void leak() {
+  const char* name = "leak";
+  const float LEAK_PPH = 1.0f;
+  Run r(70);
+  for (long i = r.reports(3600); i > 0; --i) r.step(0);
+  check(r.t.flags == 0, name, "flag before the leak");
+  // budget: settle, then LEAK_ALARM_PCT beyond the slack at (rate - slack), plus a tau for the rate to show
+  float budgetS = LEAK_SETTLE_S + LEAK_ALARM_PCT / (LEAK_PPH - LEAK_SLACK_PPH) * 3600 + TREND_TAU_S;
+  long at = -1;
+  float ratePph = 0;
+  for (long i = 0; i < r.reports(8 * 3600.0f); ++i) {
+    r.step(-LEAK_PPH);
+    if (at < 0 && (r.t.flags & TREND_LEAK)) { at = i; ratePph = trendRatePph(r.t); }
+  }
+  float atS = at < 0 ? -1 : at * REPORT_MS / 1000.0f;
+  // refill at pump speed: the leak flag goes
+  long cleared = -1;
+  for (long i = 0; i < r.reports(600); ++i) {
+    r.step(30);
+    if (cleared < 0 && !(r.t.flags & TREND_LEAK)) cleared = i;
+  }
+  printf("%-8s -%.1f %%/h: rate %+6.2f %%/h, LEAK after %.0f s (budget %.0f)  refill cleared it after %ld reports\n",
+         name, LEAK_PPH, ratePph, atS, budgetS, cleared);
+  check(at >= 0, name, "never flagged");
+  check(at >= 0 && atS <= budgetS, name, "flagged late");
+  check(cleared >= 0, name, "refill did not clear");
+}
+
+static void stuck() {
+  const char* name = "stuck";
+  Run r(40);
+  for (long i = r.reports(600); i > 0; --i) r.step(0);
+  long at = -1;
+  for (long i = 0; i < STUCK_REPORTS + 50; ++i) {
+    trendUpdate(r.t, 41.7f, r.ms);
+    r.ms += REPORT_MS;
+    if (at < 0 && (r.t.flags & TREND_STUCK)) at = i + 1;
+  }
+  r.step(0);    // the raw value moves
+  bool cleared = !(r.t.flags & TREND_STUCK);
+  printf("%-8s frozen at 41.7%%: STUCK after %ld reports (%u)  first moving reading clears it %d\n",
+         name, at, STUCK_REPORTS, cleared);
+  check(at == STUCK_REPORTS + 1 || at == STUCK_REPORTS, name, "flagged at the wrong count");
+  check(cleared, name, "not cleared by a moving reading");
+
+  // frozen at 100 % is a full tank, not a stuck sensor
+  Run full(100);
+  for (long i = 0; i < STUCK_REPORTS * 2; ++i) full.step(0, false);
+  check(!(full.t.flags & TREND_STUCK), name, "flagged a full tank");
+}
+
+static void noEcho() {
+  const char* name = "no-echo";
+  for (int same = 0; same < 2; ++same) {
+    Run r(55);
+    float last = 0;
+    for (long i = r.reports(600); i > 0; --i) last = r.step(0);
+    long at = -1;
+    for (long i = 0; i < NOECHO_REPORTS + 10; ++i) {
+      trendUpdate(r.t, -1, r.ms);
+      r.ms += REPORT_MS;
+      if (at < 0 && (r.t.flags & TREND_STUCK)) at = i + 1;
+    }
+    // the echo comes back, either repeating the reading before the outage or not
+    if (same) { trendUpdate(r.t, last, r.ms); r.ms += REPORT_MS; }
+    else r.step(0);
+    bool cleared = !(r.t.flags & TREND_STUCK);
+    printf("%-8s %s: STUCK after %ld timeouts (%u)  first echo clears it %d\n",
+           name, same ? "echo repeats last reading" : "echo moves", at, NOECHO_REPORTS, cleared);
+    check(at == NOECHO_REPORTS, name, "flagged at the wrong count");
+    check(cleared, name, "first valid echo did not clear STUCK");
+  }
+  // back after a gap long enough to restart the filter
+  Run r(55);
+  for (long i = r.reports(600); i > 0; --i) r.step(0);
+  for (long i = 0; i < NOECHO_REPORTS; ++i) { trendUpdate(r.t, -1, r.ms); r.ms += REPORT_MS; }
+  r.ms += (unsigned long)(TREND_MAX_GAP_S * 1000) * 2;
+  r.step(0);
+  check(!(r.t.flags & TREND_STUCK), name, "echo after a long gap did not clear STUCK");
+}
+
+int main() {
+  fill();
+  drain();
+  flat();
+  leak();
+  stuck();
+  noEcho();
+  printf("%s\n", fails ? "FAILED" : "ok");
+  return fails ? 1 : 0;
+}
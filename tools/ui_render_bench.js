@@ -0,0 +1,111 @@
+#!/usr/bin/env node
+/*
+  ui_render_bench.js
+  - headless Chromium (puppeteer) render time of the embedded UI's device
+    table at 128, 1000 and 5000 devices
+  - fetch() is stubbed in the page with a generated fleet, so the numbers
+    are JSON parse + table update + layout, no network; each update round
+    changes 10 % of the levels and ticks every age, like a 2 s poll
+  - the stub answers /api/devices the way handleGetDevices does: every
+    field of writeDeviceJson's row unless the URL has fields=, then only
+    those, so body_bytes is what the sender would build and send
+  - prints one JSON line per page and fleet size: the first render, the
+    median of the update rounds, the body size and the count the page
+    shows; exit 1 if a page shows fewer devices than the fleet has. Pass an
+    older index.html to compare
+      NODE_PATH=$(npm root -g) node tools/ui_render_bench.js
+      git show HEAD~1:web/index.html > /tmp/old.html && NODE_PATH=$(npm root -g) node tools/ui_render_bench.js web/index.html /tmp/old.html
+*/
+
+const fs = require('fs');
+const path = require('path');
+const puppeteer = require('puppeteer');
+
+const SIZES = [128, 1000, 5000];
+const ROUNDS = 5;
+const ROUND_LIMIT_MS = 60000;   // skip the remaining rounds of a page that is this slow
+
+// runs in the page before its scripts: fleet generator + fetch stub
+function installStub(n) {
+  let tick = 0;
+  const fleet = [];
+  for (let i = 0; i < n; i++) {
+    const b = [0x24, 0x6f, 0x28, (i >> 16) & 255, (i >> 8) & 255, i & 255];
+    fleet.push({ mac: b.map(x => x.toString(16).padStart(2, '0').toUpperCase()).join(':'), ip: '192.168.4.' + (i % 250 + 2),
+      rssi: -50 - (i % 40), name: 'Tank-' + (i + 1), percent: (i * 37) % 100, age_seconds: i % 15, totalHeightCm: 120,
+      sensorToMaxCm: 2, seq: 0, sample_age_ms: 300, rate_pph: -1.5, tte_s: null, ttf_s: null, anomaly: 0,
+      alarm: i % 50 === 0 ? 1 : 0, loss_pct: 0.4, jitter_ms: 35, report_interval_ms: 2500 });
+  }
+  window.__benchReady = false;
+  window.__benchStep = () => {
+    tick++;
+    for (let i = 0; i < fleet.length; i++) {
+      const d = fleet[i];
+      d.age_seconds = (d.age_seconds + 2) % 15;
+      if ((i + tick) % 10 === 0) { d.percent = Math.round(((d.percent + 3.3) % 100) * 10) / 10; d.seq++; }
+    }
+  };
+  const json = body => Promise.resolve(new Response(JSON.stringify(body), { headers: { 'Content-Type': 'application/json' } }));
+  window.__bodyBytes = 0;
+  window.fetch = url => {
+    const u = new URL(String(url), location.href);
+    if (u.pathname === '/status') return json({ ok: true, sta_ip: '192.168.1.50' });
+    const rows = window.__benchReady ? fleet : [];
+    const fields = u.searchParams.get('fields');
+    const keep = fields ? fields.split(',').filter(f => f in fleet[0]) : [];
+    const body = keep.length ? rows.map(d => Object.fromEntries(keep.map(f => [f, d[f]]))) : rows;
+    const text = JSON.stringify(body);
+    window.__bodyBytes = text.length;
+    return Promise.resolve(new Response(text, { headers: { 'Content-Type': 'application/json' } }));
+  };
+  window.setInterval = () => 0;   // rounds are driven from here
+}
+
+async function measure(page) {
+  return page.evaluate(async () => {
+    const t0 = performance.now();
+    await load();
+    document.body.getBoundingClientRect();
+    document.getElementById('tbl').offsetHeight;   // force layout
+    return performance.now() - t0;
+  });
+}
+
+async function benchPage(browser, file, n) {
+  const page = await browser.newPage();
+  await page.setViewport({ width: 1280, height: 800 });
+  await page.evaluateOnNewDocument(installStub, n);
+  await page.setRequestInterception(true);
+  const html = fs.readFileSync(file, 'utf8');
+  page.on('request', r => r.respond({ status: 200, contentType: 'text/html', body: html }));
+  await page.goto('http://sender.bench/', { waitUntil: 'load' });
+  await page.evaluate(() => { window.__benchReady = true; });
+  const first = await measure(page);
+  const updates = [];
+  for (let r = 0; r < ROUNDS && first < ROUND_LIMIT_MS; r++) {
+    await page.evaluate(() => window.__benchStep());
+    updates.push(await measure(page));
+  }
+  const rows = await page.evaluate(() => document.querySelectorAll('#tbl tbody tr').length);
+  const bodyBytes = await page.evaluate(() => window.__bodyBytes);
+  const shown = await page.evaluate(() => parseInt(document.getElementById('count').innerText, 10) || 0);
+  await page.close();
+  updates.sort((a, b) => a - b);
+  return { page: path.basename(file), devices: n, first_ms: +first.toFixed(1),
+           update_p50_ms: updates.length ? +updates[updates.length >> 1].toFixed(1) : null, dom_rows: rows,
+           body_bytes: bodyBytes, shown };
+}
+
+(async () => {
+  const files = process.argv.length > 2 ? process.argv.slice(2) : [path.join(__dirname, '..', 'web', 'index.html')];
+  const browser = await puppeteer.launch({ headless: 'shell', args: ['--no-sandbox'], protocolTimeout: 600000 });
+  try {
+    for (const f of files) for (const n of SIZES) {
+      const r = await benchPage(browser, f, n);
+      console.log(JSON.stringify(r));
+      if (r.shown !== n) process.exitCode = 1;
+    }
+  } finally {
+    await browser.close();
+  }
+})();